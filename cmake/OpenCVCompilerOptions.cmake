@@ -232,6 +232,53 @@ if(MSVC)
   endif()
 endif()
 
+# Flags for the kernels in src/ssse3/, src/popcnt/, src/avx/ and src/avx2/ of the modules (see ocv_glob_module_sources).
+# The rest of the library keeps the baseline instruction set, and the kernels are selected at runtime.
+set(OPENCV_SSSE3_FLAGS "")
+set(OPENCV_POPCNT_FLAGS "")
+set(OPENCV_AVX_FLAGS "")
+set(OPENCV_AVX2_FLAGS "")
+if(ENABLE_DISPATCH)
+  if(CMAKE_COMPILER_IS_GNUCXX AND NOT MINGW)
+    ocv_check_flag_support(CXX -mssse3 _varname)
+    if(${_varname})
+      set(OPENCV_SSSE3_FLAGS "-mssse3")
+      set(HAVE_DISPATCH_SSSE3 1)
+    endif()
+    ocv_check_flag_support(CXX -mpopcnt _varname)
+    if(${_varname})
+      set(OPENCV_POPCNT_FLAGS "-mpopcnt")
+      set(HAVE_DISPATCH_POPCNT 1)
+    endif()
+    ocv_check_flag_support(CXX -mavx _varname)
+    if(${_varname})
+      set(OPENCV_AVX_FLAGS "-mavx")
+    endif()
+    ocv_check_flag_support(CXX -mavx2 _varname)
+    if(${_varname})
+      set(OPENCV_AVX2_FLAGS "-mavx2")
+    endif()
+  elseif(MSVC)
+    # SSSE3 and POPCNT intrinsics do not need a special /arch option
+    if(NOT MSVC_VERSION LESS 1500)
+      set(HAVE_DISPATCH_SSSE3 1)
+      set(HAVE_DISPATCH_POPCNT 1)
+    endif()
+    if(NOT MSVC_VERSION LESS 1600)
+      set(OPENCV_AVX_FLAGS "/arch:AVX")
+    endif()
+    if(NOT MSVC_VERSION LESS 1800)
+      set(OPENCV_AVX2_FLAGS "/arch:AVX2")
+    endif()
+  endif()
+endif()
+if(OPENCV_AVX_FLAGS)
+  set(HAVE_DISPATCH_AVX 1)
+endif()
+if(OPENCV_AVX2_FLAGS)
+  set(HAVE_DISPATCH_AVX2 1)
+endif()
+
 # Extra link libs if the user selects building static libs:
 if(NOT BUILD_SHARED_LIBS AND CMAKE_COMPILER_IS_GNUCXX AND NOT ANDROID)
   # Android does not need these settings because they are already set by toolchain file
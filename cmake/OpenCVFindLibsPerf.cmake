@@ -12,6 +12,12 @@ if(WITH_CSTRIPES)
   include("${OpenCV_SOURCE_DIR}/cmake/OpenCVDetectCStripes.cmake")
 endif(WITH_CSTRIPES)
 
+# --- pthreads-based parallel_for ---
+ocv_clear_vars(HAVE_PTHREADS_PF)
+if(WITH_PTHREADS_PF AND HAVE_LIBPTHREAD)
+  set(HAVE_PTHREADS_PF 1)
+endif()
+
 # --- IPP ---
 ocv_clear_vars(IPP_FOUND)
 if(WITH_IPP)
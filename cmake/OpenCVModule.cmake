@@ -427,6 +427,8 @@ macro(ocv_glob_module_sources)
   file(GLOB lib_hdrs "include/opencv2/${name}/*.hpp" "include/opencv2/${name}/*.h")
   file(GLOB lib_hdrs_detail "include/opencv2/${name}/detail/*.hpp" "include/opencv2/${name}/detail/*.h")
 
+  ocv_dispatch_module_sources(lib_srcs)
+
   source_group("Src" FILES ${lib_srcs} ${lib_int_hdrs})
   source_group("Include" FILES ${lib_hdrs})
   source_group("Include\\detail" FILES ${lib_hdrs_detail})
@@ -434,6 +436,31 @@ macro(ocv_glob_module_sources)
   ocv_set_module_sources(${ARGN} HEADERS ${lib_hdrs} ${lib_hdrs_detail} SOURCES ${lib_srcs} ${lib_int_hdrs})
 endmacro()
 
+# builds the sources in src/ssse3/, src/popcnt/, src/avx/ and src/avx2/ with the corresponding instruction set,
+# or removes them from the list when the compiler can not do it
+# Usage:
+#   ocv_dispatch_module_sources(<sources list variable>)
+macro(ocv_dispatch_module_sources srcs_var)
+  foreach(_isa SSSE3 POPCNT AVX AVX2)
+    string(TOLOWER "${_isa}" _isa_dir)
+    file(GLOB _isa_srcs "src/${_isa_dir}/*.cpp")
+    if(_isa_srcs)
+      if(HAVE_DISPATCH_${_isa})
+        set(_isa_flags "${OPENCV_${_isa}_FLAGS}")
+        if(MSVC)
+          # the precompiled header is built for the baseline instruction set
+          set(_isa_flags "${_isa_flags} /Y-")
+        endif()
+        set_source_files_properties(${_isa_srcs} PROPERTIES COMPILE_FLAGS "${_isa_flags}")
+      else()
+        list(REMOVE_ITEM ${srcs_var} ${_isa_srcs})
+      endif()
+    endif()
+  endforeach()
+  unset(_isa_srcs)
+  unset(_isa_flags)
+endmacro()
+
 # creates OpenCV module in current folder
 # creates new target, configures standard dependencies, compilers flags, install rules
 # Usage:
@@ -127,6 +127,18 @@
 /* Intel Integrated Performance Primitives */
 #cmakedefine  HAVE_IPP
 
+/* SSSE3 variants of SIMD kernels, selected at runtime */
+#cmakedefine  HAVE_DISPATCH_SSSE3
+
+/* POPCNT variants of SIMD kernels, selected at runtime */
+#cmakedefine  HAVE_DISPATCH_POPCNT
+
+/* AVX variants of SIMD kernels, selected at runtime */
+#cmakedefine  HAVE_DISPATCH_AVX
+
+/* AVX2 variants of SIMD kernels, selected at runtime */
+#cmakedefine  HAVE_DISPATCH_AVX2
+
 /* OpenCV compiled as static or dynamic libs */
 #cmakedefine  BUILD_SHARED_LIBS
 
@@ -169,6 +181,9 @@
 /* C= */
 #cmakedefine  HAVE_CSTRIPES
 
+/* pthreads-based thread pool for parallel_for_ */
+#cmakedefine  HAVE_PTHREADS_PF
+
 /* Eigen Matrix & Linear Algebra Library */
 #cmakedefine  HAVE_EIGEN
 
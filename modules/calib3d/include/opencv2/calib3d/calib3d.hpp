@@ -704,6 +704,11 @@ public:
     CV_WRAP_AS(compute) virtual void operator()(InputArray left, InputArray right,
                                                 OutputArray disp);
 
+    //! the same as above, but the image is split into horizontal bands of bandHeight rows processed in parallel
+    //! (0 - the whole image is one band), and the scratch buffers take at most maxBufferSize bytes (0 - no limit)
+    void operator()(InputArray left, InputArray right, OutputArray disp,
+                    int bandHeight, size_t maxBufferSize=0);
+
     CV_PROP_RW int minDisparity;
     CV_PROP_RW int numberOfDisparities;
     CV_PROP_RW int SADWindowSize;
@@ -0,0 +1,114 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "stereosgbm_avx2.hpp"
+#include <limits.h>
+
+namespace cv
+{
+namespace avx2
+{
+
+static inline __m256i updatePath( const short* Lr_prev, int d, __m256i Cpd, __m256i _P1, __m256i _delta )
+{
+    __m256i L = _mm256_loadu_si256((const __m256i*)(Lr_prev + d));
+    L = _mm256_min_epi16(L, _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(Lr_prev + d - 1)), _P1));
+    L = _mm256_min_epi16(L, _mm256_adds_epi16(_mm256_loadu_si256((const __m256i*)(Lr_prev + d + 1)), _P1));
+    L = _mm256_min_epi16(L, _delta);
+    return _mm256_adds_epi16(_mm256_subs_epi16(L, _delta), Cpd);
+}
+
+static inline short reduceMin( __m256i v )
+{
+    __m128i m = _mm_min_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    m = _mm_min_epi16(m, _mm_srli_si128(m, 8));
+    m = _mm_min_epi16(m, _mm_srli_si128(m, 4));
+    m = _mm_min_epi16(m, _mm_srli_si128(m, 2));
+    return (short)_mm_cvtsi128_si32(m);
+}
+
+void aggregatePaths4( const short* Cp, short* Sp, short* Lr_p, int D2,
+                      const short* Lr_p0, const short* Lr_p1,
+                      const short* Lr_p2, const short* Lr_p3,
+                      const int* delta, int P1, int D, short* minLr )
+{
+    __m256i _P1 = _mm256_set1_epi16((short)P1);
+    __m256i _delta0 = _mm256_set1_epi16((short)delta[0]);
+    __m256i _delta1 = _mm256_set1_epi16((short)delta[1]);
+    __m256i _delta2 = _mm256_set1_epi16((short)delta[2]);
+    __m256i _delta3 = _mm256_set1_epi16((short)delta[3]);
+    __m256i _minL0 = _mm256_set1_epi16(SHRT_MAX), _minL1 = _minL0, _minL2 = _minL0, _minL3 = _minL0;
+
+    for( int d = 0; d < D; d += 16 )
+    {
+        __m256i Cpd = _mm256_loadu_si256((const __m256i*)(Cp + d));
+        __m256i L0 = updatePath(Lr_p0, d, Cpd, _P1, _delta0);
+        __m256i L1 = updatePath(Lr_p1, d, Cpd, _P1, _delta1);
+        __m256i L2 = updatePath(Lr_p2, d, Cpd, _P1, _delta2);
+        __m256i L3 = updatePath(Lr_p3, d, Cpd, _P1, _delta3);
+
+        _mm256_storeu_si256((__m256i*)(Lr_p + d), L0);
+        _mm256_storeu_si256((__m256i*)(Lr_p + d + D2), L1);
+        _mm256_storeu_si256((__m256i*)(Lr_p + d + D2*2), L2);
+        _mm256_storeu_si256((__m256i*)(Lr_p + d + D2*3), L3);
+
+        _minL0 = _mm256_min_epi16(_minL0, L0);
+        _minL1 = _mm256_min_epi16(_minL1, L1);
+        _minL2 = _mm256_min_epi16(_minL2, L2);
+        _minL3 = _mm256_min_epi16(_minL3, L3);
+
+        // the same order of the saturated additions as in the SSE2 branch
+        __m256i Sval = _mm256_loadu_si256((const __m256i*)(Sp + d));
+        Sval = _mm256_adds_epi16(Sval, _mm256_adds_epi16(L0, L1));
+        Sval = _mm256_adds_epi16(Sval, _mm256_adds_epi16(L2, L3));
+        _mm256_storeu_si256((__m256i*)(Sp + d), Sval);
+    }
+
+    minLr[0] = reduceMin(_minL0);
+    minLr[1] = reduceMin(_minL1);
+    minLr[2] = reduceMin(_minL2);
+    minLr[3] = reduceMin(_minL3);
+}
+
+}
+}
@@ -0,0 +1,62 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#ifndef __OPENCV_CALIB3D_STEREOSGBM_AVX2_HPP__
+#define __OPENCV_CALIB3D_STEREOSGBM_AVX2_HPP__
+
+namespace cv
+{
+namespace avx2
+{
+
+// updates the 4 paths of the forward SGBM pass at a single pixel: Lr_p[d + D2*k] is computed from Lr_pk[d],
+// Lr_pk[d-1], Lr_pk[d+1] and delta[k] (k = 0..3), the sum of the 4 paths is added to Sp[d] with saturation
+// and min_d Lr_p[d + D2*k] is stored to minLr[k]. D must be divisible by 16.
+void aggregatePaths4( const short* Cp, short* Sp, short* Lr_p, int D2,
+                      const short* Lr_p0, const short* Lr_p1,
+                      const short* Lr_p2, const short* Lr_p3,
+                      const int* delta, int P1, int D, short* minLr );
+
+}
+}
+
+#endif
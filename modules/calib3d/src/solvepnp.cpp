@@ -115,31 +115,6 @@ namespace cv
             transform(points, modif_points, transformation);
         }
 
-        class Mutex
-        {
-        public:
-            Mutex() {
-            }
-            void lock()
-            {
-#ifdef HAVE_TBB
-                resultsMutex.lock();
-#endif
-            }
-
-            void unlock()
-            {
-#ifdef HAVE_TBB
-                resultsMutex.unlock();
-#endif
-            }
-
-        private:
-#ifdef HAVE_TBB
-            tbb::mutex resultsMutex;
-#endif
-        };
-
         struct CameraParameters
         {
             void init(Mat _intrinsics, Mat _distCoeffs)
@@ -217,33 +192,37 @@ namespace cv
                 }
             }
 
+            AutoLock lock(resultsMutex);
             if (localInliers.size() > inliers.size())
             {
-                resultsMutex.lock();
-
                 inliers.clear();
                 inliers.resize(localInliers.size());
                 memcpy(&inliers[0], &localInliers[0], sizeof(int) * localInliers.size());
                 localRvec.copyTo(rvec);
                 localTvec.copyTo(tvec);
-
-                resultsMutex.unlock();
             }
         }
 
-        class PnPSolver
+        class PnPSolver : public ParallelLoopBody
         {
         public:
-            void operator()( const BlockedRange& r ) const
+            void operator()( const Range& r ) const
             {
+                // every stripe draws its own samples, so the result does not depend on the thread timing
+                RNG generator(rngState + (uint64)r.start);
                 vector<char> pointsMask(objectPoints.cols, 0);
                 memset(&pointsMask[0], 1, MIN_POINTS_COUNT );
-                for( int i=r.begin(); i!=r.end(); ++i )
+                for( int i=r.start; i!=r.end; ++i )
                 {
-                    generateVar(pointsMask);
+                    generateVar(generator, pointsMask);
                     pnpTask(pointsMask, objectPoints, imagePoints, parameters,
                             inliers, rvec, tvec, initRvec, initTvec, syncMutex);
-                    if ((int)inliers.size() >= parameters.minInliersCount)
+                    bool found;
+                    {
+                        AutoLock lock(syncMutex);
+                        found = (int)inliers.size() >= parameters.minInliersCount;
+                    }
+                    if (found)
                     {
 #ifdef HAVE_TBB
                         tbb::task::self().cancel_group_execution();
@@ -261,7 +240,7 @@ namespace cv
                 rvec.copyTo(initRvec);
                 tvec.copyTo(initTvec);
 
-                generator.state = theRNG().state; //to control it somehow...
+                rngState = theRNG().state; //to control it somehow...
             }
         private:
             PnPSolver& operator=(const PnPSolver&);
@@ -272,11 +251,11 @@ namespace cv
             Mat &rvec, &tvec;
             vector<int>& inliers;
             Mat initRvec, initTvec;
+            uint64 rngState;
 
-            static RNG generator;
             static Mutex syncMutex;
 
-            void generateVar(vector<char>& mask) const
+            static void generateVar(RNG& generator, vector<char>& mask)
             {
                 int size = (int)mask.size();
                 for (int i = 0; i < size; i++)
@@ -291,7 +270,6 @@ namespace cv
         };
 
         Mutex PnPSolver::syncMutex;
-        RNG PnPSolver::generator;
 
     }
 }
@@ -336,8 +314,8 @@ void cv::solvePnPRansac(InputArray _opoints, InputArray _ipoints,
 
     if (objectPoints.cols >= pnpransac::MIN_POINTS_COUNT)
     {
-        parallel_for(BlockedRange(0,iterationsCount), cv::pnpransac::PnPSolver(objectPoints, imagePoints, params,
-                                                                               localRvec, localTvec, localInliers));
+        parallel_for_(Range(0,iterationsCount), cv::pnpransac::PnPSolver(objectPoints, imagePoints, params,
+                                                                         localRvec, localTvec, localInliers));
     }
 
     if (localInliers.size() >= (size_t)pnpransac::MIN_POINTS_COUNT)
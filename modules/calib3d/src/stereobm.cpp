@@ -673,7 +673,7 @@ findStereoCorrespondenceBM( const Mat& left, const Mat& right,
     }
 }
 
-struct PrefilterInvoker
+struct PrefilterInvoker : public ParallelLoopBody
 {
     PrefilterInvoker(const Mat& left0, const Mat& right0, Mat& left, Mat& right,
                      uchar* buf0, uchar* buf1, CvStereoBMState* _state )
@@ -684,12 +684,15 @@ struct PrefilterInvoker
         state = _state;
     }
 
-    void operator()( int ind ) const
+    void operator()( const Range& range ) const
     {
-        if( state->preFilterType == CV_STEREO_BM_NORMALIZED_RESPONSE )
-            prefilterNorm( *imgs0[ind], *imgs[ind], state->preFilterSize, state->preFilterCap, buf[ind] );
-        else
-            prefilterXSobel( *imgs0[ind], *imgs[ind], state->preFilterCap );
+        for( int ind = range.start; ind < range.end; ind++ )
+        {
+            if( state->preFilterType == CV_STEREO_BM_NORMALIZED_RESPONSE )
+                prefilterNorm( *imgs0[ind], *imgs[ind], state->preFilterSize, state->preFilterCap, buf[ind] );
+            else
+                prefilterXSobel( *imgs0[ind], *imgs[ind], state->preFilterCap );
+        }
     }
 
     const Mat* imgs0[2];
@@ -699,7 +702,7 @@ struct PrefilterInvoker
 };
 
 
-struct FindStereoCorrespInvoker
+struct FindStereoCorrespInvoker : public ParallelLoopBody
 {
     FindStereoCorrespInvoker( const Mat& _left, const Mat& _right,
                               Mat& _disp, CvStereoBMState* _state,
@@ -713,12 +716,12 @@ struct FindStereoCorrespInvoker
         validDisparityRect = _validDisparityRect;
     }
 
-    void operator()( const BlockedRange& range ) const
+    void operator()( const Range& range ) const
     {
         int cols = left->cols, rows = left->rows;
-        int _row0 = min(cvRound(range.begin() * rows / nstripes), rows);
-        int _row1 = min(cvRound(range.end() * rows / nstripes), rows);
-        uchar *ptr = state->slidingSumBuf->data.ptr + range.begin() * stripeBufSize;
+        int _row0 = min(cvRound(range.start * rows / nstripes), rows);
+        int _row1 = min(cvRound(range.end * rows / nstripes), rows);
+        uchar *ptr = state->slidingSumBuf->data.ptr + range.start * stripeBufSize;
         int FILTERED = (state->minDisparity - 1)*16;
 
         Rect roi = validDisparityRect & Rect(0, _row0, cols, _row1 - _row0);
@@ -871,14 +874,10 @@ static void findStereoCorrespondenceBM( const Mat& left0, const Mat& right0, Mat
     const bool useShorts = false;
 #endif
 
-#ifdef HAVE_TBB
     const double SAD_overhead_coeff = 10.0;
-    double N0 = 8000000 / (useShorts ? 1 : 4);  // approx tbb's min number instructions reasonable for one thread
+    double N0 = 8000000 / (useShorts ? 1 : 4);  // approx min number instructions reasonable for one thread
     double maxStripeSize = min(max(N0 / (width * ndisp), (wsz-1) * SAD_overhead_coeff), (double)height);
-    int nstripes = cvCeil(height / maxStripeSize);
-#else
-    const int nstripes = 1;
-#endif
+    int nstripes = getNumThreads() > 1 ? cvCeil(height / maxStripeSize) : 1;
 
     int bufSize = max(bufSize0 * nstripes, max(bufSize1 * 2, bufSize2));
 
@@ -889,8 +888,7 @@ static void findStereoCorrespondenceBM( const Mat& left0, const Mat& right0, Mat
     }
 
     uchar *_buf = state->slidingSumBuf->data.ptr;
-    int idx[] = {0,1};
-    parallel_do(idx, idx+2, PrefilterInvoker(left0, right0, left, right, _buf, _buf + bufSize1, state));
+    parallel_for_(Range(0, 2), PrefilterInvoker(left0, right0, left, right, _buf, _buf + bufSize1, state), 2);
 
     Rect validDisparityRect(0, 0, width, height), R1 = state->roi1, R2 = state->roi2;
     validDisparityRect = getValidDisparityROI(R1.area() > 0 ? Rect(0, 0, width, height) : validDisparityRect,
@@ -898,9 +896,9 @@ static void findStereoCorrespondenceBM( const Mat& left0, const Mat& right0, Mat
                                               state->minDisparity, state->numberOfDisparities,
                                               state->SADWindowSize);
 
-    parallel_for(BlockedRange(0, nstripes),
-                 FindStereoCorrespInvoker(left, right, disp, state, nstripes,
-                                          bufSize0, useShorts, validDisparityRect));
+    parallel_for_(Range(0, nstripes),
+                  FindStereoCorrespInvoker(left, right, disp, state, nstripes,
+                                           bufSize0, useShorts, validDisparityRect), nstripes);
 
     if( state->speckleRange >= 0 && state->speckleWindowSize > 0 )
     {
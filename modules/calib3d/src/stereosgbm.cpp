@@ -51,6 +51,9 @@
 
 #include "precomp.hpp"
 #include <limits.h>
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/stereosgbm_avx2.hpp"
+#endif
 
 namespace cv
 {
@@ -276,6 +279,30 @@ static void calcPixelCostBT( const Mat& img1, const Mat& img2, int y,
 }
 
 
+/*
+ returns the size of the buffer used by computeDisparitySGBM to process nrows rows
+ of a width-pixel wide image with cn channels
+ */
+static size_t getSGBMBufferSize( int width, int cn, int nrows, const StereoSGBM& params )
+{
+    int minD = params.minDisparity, maxD = minD + params.numberOfDisparities;
+    int SH2 = (params.SADWindowSize > 0 ? params.SADWindowSize : 5)/2;
+    int width1 = max(width + min(minD, 0) - max(maxD, 0), 0);
+    int D = maxD - minD, D2 = D+16;
+    const int NLR = 2, LrBorder = NLR - 1;
+
+    size_t costBufSize = (size_t)width1*D;
+    size_t CSBufSize = costBufSize*(params.fullDP ? nrows : 1);
+    size_t minLrSize = (width1 + LrBorder*2)*NR2, LrSize = minLrSize*D2;
+    int hsumBufNRows = SH2*2 + 2;
+
+    return (LrSize + minLrSize)*NLR*sizeof(CostType) + // minLr[] and Lr[]
+    costBufSize*(hsumBufNRows + 1)*sizeof(CostType) + // hsumBuf, pixdiff
+    CSBufSize*2*sizeof(CostType) + // C, S
+    width*16*cn*sizeof(PixType) + // temp buffer for computing per-pixel cost
+    width*(sizeof(CostType) + sizeof(DispType)) + 1024; // disp2cost + disp2
+}
+
 /*
  computes disparity for "roi" in img1 w.r.t. img2 and write it to disp1buf.
  that is, disp1buf(x, y)=d means that img1(x+roi.x, y+roi.y) ~ img2(x+roi.x-d, y+roi.y).
@@ -295,10 +322,14 @@ static void calcPixelCostBT( const Mat& img1, const Mat& img2, int y,
 
  disp2cost also has the same size as img1 (or img2).
  It contains the minimum current cost, used to find the best disparity, corresponding to the minimal cost.
+
+ only the rows from "rows" are processed; the paths that come from above (and, in the case of fullDP,
+ from below) start at the band borders, so the rows outside "validRows" are only used to warm the paths up.
+ the disparity is written to the rows from "validRows".
  */
 static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
                                  Mat& disp1, const StereoSGBM& params,
-                                 Mat& buffer )
+                                 Mat& buffer, Range rows, Range validRows )
 {
 #if CV_SSE2
     static const uchar LSBTab[] =
@@ -315,6 +346,9 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
 
     volatile bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
 #endif
+#ifdef HAVE_DISPATCH_AVX2
+    bool useAVX2 = checkHardwareSupport(CV_CPU_AVX2);
+#endif
 
     const int ALIGN = 16;
     const int DISP_SHIFT = StereoSGBM::DISP_SHIFT;
@@ -329,6 +363,7 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
     int disp12MaxDiff = params.disp12MaxDiff > 0 ? params.disp12MaxDiff : 1;
     int P1 = params.P1 > 0 ? params.P1 : 2, P2 = max(params.P2 > 0 ? params.P2 : 5, P1+1);
     int k, width = disp1.cols, height = disp1.rows;
+    int ys = rows.start, ye = rows.end;
     int minX1 = max(maxD, 0), maxX1 = width + min(minD, 0);
     int D = maxD - minD, width1 = maxX1 - minX1;
     int INVALID_DISP = minD - 1, INVALID_DISP_SCALED = INVALID_DISP*DISP_SCALE;
@@ -362,14 +397,10 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
     // we keep pixel difference cost (C) and the summary cost over NR directions (S).
     // we also keep all the partial costs for the previous line L_r(x,d) and also min_k L_r(x, k)
     size_t costBufSize = width1*D;
-    size_t CSBufSize = costBufSize*(params.fullDP ? height : 1);
+    size_t CSBufSize = costBufSize*(params.fullDP ? ye - ys : 1);
     size_t minLrSize = (width1 + LrBorder*2)*NR2, LrSize = minLrSize*D2;
     int hsumBufNRows = SH2*2 + 2;
-    size_t totalBufSize = (LrSize + minLrSize)*NLR*sizeof(CostType) + // minLr[] and Lr[]
-    costBufSize*(hsumBufNRows + 1)*sizeof(CostType) + // hsumBuf, pixdiff
-    CSBufSize*2*sizeof(CostType) + // C, S
-    width*16*img1.channels()*sizeof(PixType) + // temp buffer for computing per-pixel cost
-    width*(sizeof(CostType) + sizeof(DispType)) + 1024; // disp2cost + disp2
+    size_t totalBufSize = getSGBMBufferSize(width, img1.channels(), ye - ys, params);
 
     if( !buffer.data || !buffer.isContinuous() ||
         buffer.cols*buffer.rows*buffer.elemSize() < totalBufSize )
@@ -395,12 +426,12 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
 
         if( pass == 1 )
         {
-            y1 = 0; y2 = height; dy = 1;
+            y1 = ys; y2 = ye; dy = 1;
             x1 = 0; x2 = width1; dx = 1;
         }
         else
         {
-            y1 = height-1; y2 = -1; dy = -1;
+            y1 = ye-1; y2 = ys-1; dy = -1;
             x1 = width1-1; x2 = -1; dx = -1;
         }
 
@@ -423,12 +454,12 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
         {
             int x, d;
             DispType* disp1ptr = disp1.ptr<DispType>(y);
-            CostType* C = Cbuf + (!params.fullDP ? 0 : y*costBufSize);
-            CostType* S = Sbuf + (!params.fullDP ? 0 : y*costBufSize);
+            CostType* C = Cbuf + (!params.fullDP ? 0 : (y - ys)*costBufSize);
+            CostType* S = Sbuf + (!params.fullDP ? 0 : (y - ys)*costBufSize);
 
             if( pass == 1 ) // compute C on the first pass, and reuse it on the second pass, if any.
             {
-                int dy1 = y == 0 ? 0 : y + SH2, dy2 = y == 0 ? SH2 : dy1;
+                int dy1 = y == ys ? max(y - SH2, 0) : y + SH2, dy2 = y == ys ? y + SH2 : dy1;
 
                 for( k = dy1; k <= dy2; k++ )
                 {
@@ -446,10 +477,13 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
                                 hsumAdd[d] = (CostType)(hsumAdd[d] + pixDiff[x + d]*scale);
                         }
 
-                        if( y > 0 )
+                        if( y > ys )
                         {
                             const CostType* hsumSub = hsumBuf + (max(y - SH2 - 1, 0) % hsumBufNRows)*costBufSize;
-                            const CostType* Cprev = !params.fullDP || y == 0 ? C : C - costBufSize;
+                            const CostType* Cprev = !params.fullDP ? C : C - costBufSize;
+
+                            for( d = 0; d < D; d++ )
+                                C[d] = (CostType)(Cprev[d] + hsumAdd[d] - hsumSub[d]);
 
                             for( x = D; x < width1*D; x += D )
                             {
@@ -496,10 +530,17 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
                             }
                         }
                     }
+                    else if( params.fullDP && y > ys )
+                    {
+                        // near the bottom border C is not updated; in the single-pass mode
+                        // it is kept in place, here it is copied from the previous row
+                        memcpy( C, C - costBufSize, costBufSize*sizeof(CostType) );
+                    }
 
-                    if( y == 0 )
+                    if( y == ys )
                     {
-                        int scale = k == 0 ? SH2 + 1 : 1;
+                        // the rows above the image are replaced with the row 0
+                        int scale = k == 0 ? SH2 - y + 1 : 1;
                         for( x = 0; x < width1*D; x++ )
                             C[x] = (CostType)(C[x] + hsumAdd[x]*scale);
                     }
@@ -553,6 +594,15 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
                 const CostType* Cp = C + x*D;
                 CostType* Sp = S + x*D;
 
+            #ifdef HAVE_DISPATCH_AVX2
+                if( useAVX2 )
+                {
+                    int delta[] = { delta0, delta1, delta2, delta3 };
+                    avx2::aggregatePaths4(Cp, Sp, Lr_p, D2, Lr_p0, Lr_p1, Lr_p2, Lr_p3,
+                                          delta, P1, D, &minLr[0][xm]);
+                }
+                else
+            #endif
             #if CV_SSE2
                 if( useSIMD )
                 {
@@ -656,7 +706,7 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
                 }
             }
 
-            if( pass == npasses )
+            if( pass == npasses && validRows.start <= y && y < validRows.end )
             {
                 for( x = 0; x < width; x++ )
                 {
@@ -817,11 +867,134 @@ static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
     }
 }
 
+/*
+ the number of rows processed above (and, in the case of fullDP, below) each band
+ in order to bring the vertical and the diagonal paths to the band borders
+ */
+static int getSGBMBandOverlap( const StereoSGBM& params )
+{
+    int SH2 = (params.SADWindowSize > 0 ? params.SADWindowSize : 5)/2;
+    return SH2 + 32;
+}
+
+class SGBMBandInvoker : public ParallelLoopBody
+{
+public:
+    SGBMBandInvoker( const Mat& _img1, const Mat& _img2, Mat& _disp1, const StereoSGBM& _params,
+                     Mat& _buffer, size_t _bandBufSize, int _bandHeight, int _nstripes )
+    {
+        img1 = &_img1;
+        img2 = &_img2;
+        disp1 = &_disp1;
+        params = &_params;
+        buffer = &_buffer;
+        bandBufSize = _bandBufSize;
+        bandHeight = _bandHeight;
+        nstripes = _nstripes;
+        overlap = getSGBMBandOverlap(_params);
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int height = disp1->rows, nbands = (height + bandHeight - 1)/bandHeight;
+
+        // every stripe processes its bands one by one in its own part of the buffer
+        for( int i = range.start; i < range.end; i++ )
+        {
+            Mat buf = buffer->colRange((int)(bandBufSize*i), (int)(bandBufSize*(i+1)));
+
+            for( int j = i; j < nbands; j += nstripes )
+            {
+                int y0 = j*bandHeight, y1 = min(y0 + bandHeight, height);
+                Range rows(max(y0 - overlap, 0), params->fullDP ? min(y1 + overlap, height) : y1);
+                computeDisparitySGBM( *img1, *img2, *disp1, *params, buf, rows, Range(y0, y1) );
+            }
+        }
+    }
+
+protected:
+    const Mat* img1;
+    const Mat* img2;
+    Mat* disp1;
+    const StereoSGBM* params;
+    Mat* buffer;
+    size_t bandBufSize;
+    int bandHeight, nstripes, overlap;
+};
+
+/*
+ splits the image into horizontal bands of bandHeight0 rows (0 - the whole image is one band)
+ and processes them in parallel. if maxBufferSize is set, the number of bands processed at the same
+ time is limited, so that the total buffer size does not exceed it; in the fullDP mode the band height
+ is also derived from maxBufferSize unless it is set explicitly.
+ */
+static void computeDisparitySGBM( const Mat& img1, const Mat& img2,
+                                 Mat& disp1, const StereoSGBM& params,
+                                 Mat& buffer, int bandHeight0, size_t maxBufSize )
+{
+    int width = disp1.cols, height = disp1.rows, cn = img1.channels();
+    int minD = params.minDisparity, maxD = minD + params.numberOfDisparities;
+    int overlap = getSGBMBandOverlap(params), noverlaps = params.fullDP ? 2 : 1;
+    int bandHeight = bandHeight0 > 0 ? min(bandHeight0, height) : height;
+
+    if( max(maxD, 0) >= width + min(minD, 0) )
+    {
+        computeDisparitySGBM( img1, img2, disp1, params, buffer, Range(0, height), Range(0, height) );
+        return;
+    }
+
+    CV_Assert( (maxD - minD) % 16 == 0 );
+
+    if( bandHeight0 == 0 && maxBufSize > 0 && params.fullDP &&
+        getSGBMBufferSize(width, cn, height, params) > maxBufSize )
+    {
+        // take the highest bands that fit into the buffer together with the overlapping rows
+        size_t bufSize0 = getSGBMBufferSize(width, cn, 0, params);
+        size_t rowBufSize = getSGBMBufferSize(width, cn, 1, params) - bufSize0;
+        int maxRows = maxBufSize > bufSize0 ? (int)min((maxBufSize - bufSize0)/rowBufSize, (size_t)height) : 0;
+        bandHeight = max(maxRows - overlap*noverlaps, 1);
+    }
+
+    int nbands = (height + bandHeight - 1)/bandHeight;
+    size_t bandBufSize = getSGBMBufferSize(width, cn, nbands > 1 ?
+                            min(bandHeight + overlap*noverlaps, height) : height, params);
+    int nstripes = min(nbands, max(getNumThreads(), 1));
+
+    if( maxBufSize > 0 )
+    {
+        if( bandBufSize > maxBufSize )
+            CV_Error( CV_StsOutOfRange, "maxBufferSize is too small to process a single band; "
+                     "increase maxBufferSize or reduce bandHeight" );
+        nstripes = (int)min((size_t)nstripes, maxBufSize/bandBufSize);
+    }
+
+    if( nbands == 1 )
+    {
+        computeDisparitySGBM( img1, img2, disp1, params, buffer, Range(0, height), Range(0, height) );
+        return;
+    }
+
+    size_t totalBufSize = bandBufSize*nstripes;
+    if( !buffer.data || !buffer.isContinuous() ||
+        buffer.cols*buffer.rows*buffer.elemSize() < totalBufSize )
+        buffer.create(1, (int)totalBufSize, CV_8U);
+
+    parallel_for_(Range(0, nstripes), SGBMBandInvoker(img1, img2, disp1, params, buffer,
+                                                      bandBufSize, bandHeight, nstripes));
+}
+
 typedef cv::Point_<short> Point2s;
 
 void StereoSGBM::operator ()( InputArray _left, InputArray _right,
                              OutputArray _disp )
 {
+    (*this)(_left, _right, _disp, 0, 0);
+}
+
+void StereoSGBM::operator ()( InputArray _left, InputArray _right,
+                             OutputArray _disp, int bandHeight, size_t maxBufferSize )
+{
+    CV_Assert( bandHeight >= 0 );
     Mat left = _left.getMat(), right = _right.getMat();
     CV_Assert( left.size() == right.size() && left.type() == right.type() &&
               left.depth() == DataType<PixType>::depth );
@@ -829,7 +1002,7 @@ void StereoSGBM::operator ()( InputArray _left, InputArray _right,
     _disp.create( left.size(), CV_16S );
     Mat disp = _disp.getMat();
 
-    computeDisparitySGBM( left, right, disp, *this, buffer );
+    computeDisparitySGBM( left, right, disp, *this, buffer, bandHeight, maxBufferSize );
     medianBlur(disp, disp, 3);
 
     if( speckleWindowSize > 0 )
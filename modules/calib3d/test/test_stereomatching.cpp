@@ -763,3 +763,62 @@ protected:
 
 TEST(Calib3d_StereoBM, regression) { CV_StereoBMTest test; test.safe_run(); }
 TEST(Calib3d_StereoSGBM, regression) { CV_StereoSGBMTest test; test.safe_run(); }
+
+static void makeStereoPair( Mat& left, Mat& right )
+{
+    Size sz(320, 240);
+    RNG rng(0x1234);
+    Mat texture(sz.height, sz.width + 64, CV_8U);
+    rng.fill(texture, RNG::UNIFORM, 0, 256);
+    GaussianBlur(texture, texture, Size(3, 3), 0);
+
+    // the background is 16 pixels away and the rectangle in the middle is 24 pixels away
+    left = texture.colRange(0, sz.width).clone();
+    right.create(sz, CV_8U);
+    Rect fg(100, 60, 120, 100);
+    for( int y = 0; y < sz.height; y++ )
+        for( int x = 0; x < sz.width; x++ )
+        {
+            int d = fg.contains(Point(x, y)) ? 24 : 16;
+            right.at<uchar>(y, x) = texture.at<uchar>(y, x + d);
+        }
+}
+
+TEST(Calib3d_StereoSGBM, bands)
+{
+    Mat left, right;
+    makeStereoPair(left, right);
+    cvtest::ParallelSettingsGuard guard;
+
+    for( int fullDP = 0; fullDP <= 1; fullDP++ )
+    {
+        StereoSGBM sgbm(0, 64, 5, 8*25, 32*25, 1, 63, 10, 0, 0, fullDP != 0);
+        Mat ref, disp1, disp4, diff;
+        sgbm(left, right, ref);
+
+        setNumThreads(1);
+        sgbm(left, right, disp1, 32);
+        setNumThreads(4);
+        sgbm(left, right, disp4, 32);
+
+        // the band layout does not depend on the number of threads
+        EXPECT_EQ(0, norm(disp1, disp4, NORM_INF));
+
+        // the paths coming from above (and from below) are restarted at each band,
+        // so some pixels may get a different disparity than in the whole-image result
+        absdiff(ref, disp4, diff);
+        EXPECT_LE(countNonZero(diff > StereoSGBM::DISP_SCALE), ref.rows*ref.cols/100) << "fullDP=" << fullDP;
+    }
+
+    StereoSGBM sgbm(0, 64, 5, 8*25, 32*25, 1, 63, 10, 0, 0, true);
+    Mat ref, disp, diff;
+    sgbm(left, right, ref);
+
+    // C and S take 240*256*64*4 bytes (about 16Mb) in the fullDP mode, so the limit splits the image into bands
+    setNumThreads(4);
+    sgbm(left, right, disp, 0, (size_t)8 << 20);
+    absdiff(ref, disp, diff);
+    EXPECT_LE(countNonZero(diff > StereoSGBM::DISP_SCALE), ref.rows*ref.cols/100);
+
+    EXPECT_THROW(sgbm(left, right, disp, 0, (size_t)1 << 16), cv::Exception);
+}
@@ -271,6 +271,7 @@ CV_EXPORTS_W int64 getCPUTickCount();
   - CV_CPU_SSE4_2 - SSE 4.2
   - CV_CPU_POPCNT - POPCOUNT
   - CV_CPU_AVX - AVX
+  - CV_CPU_AVX2 - AVX 2
 
   \note {Note that the function output is not static. Once you called cv::useOptimized(false),
   most of the hardware acceleration is disabled and thus the function will returns false,
@@ -1439,6 +1440,60 @@ public:
     virtual void deallocate(int* refcount, uchar* datastart, uchar* data) = 0;
 };
 
+/*!
+   Pooling array allocator
+
+   The released buffers are not returned to the system but kept for reuse, which
+   saves the malloc/free calls when the same matrices are created and released again and again
+   (e.g. per-frame buffers in video processing). Buffers up to 256K are rounded to the size classes
+   and cached per thread, bigger ones are rounded to the page size and shared between the threads.
+   The data is always aligned by 64 bytes.
+
+   Use setDefaultAllocator(getPoolMatAllocator()) or set OPENCV_MAT_ALLOCATOR=pool environment variable
+   to make Mat::create() use the pool for all the matrices that do not have a custom allocator.
+*/
+class CV_EXPORTS PoolMatAllocator : public MatAllocator
+{
+public:
+    struct CV_EXPORTS Stats
+    {
+        Stats();
+        int64 hits; //!< the number of allocations served from the pool
+        int64 misses; //!< the number of allocations that went to the system
+        size_t bytesInUse; //!< the total size of the buffers currently used by matrices
+        size_t bytesCached; //!< the total size of the buffers kept for reuse
+        size_t bytesReserved; //!< the total size of the buffers obtained from the system and not released yet
+        size_t peakBytesReserved; //!< the maximum of bytesReserved
+    };
+
+    //! the pool keeps at most maxCachedBytes of the unused buffers, of which at most maxThreadCachedBytes per thread
+    PoolMatAllocator(size_t maxCachedBytes=(size_t)256 << 20, size_t maxThreadCachedBytes=(size_t)4 << 20);
+    virtual ~PoolMatAllocator();
+    virtual void allocate(int dims, const int* sizes, int type, int*& refcount,
+                          uchar*& datastart, uchar*& data, size_t* step);
+    virtual void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    //! returns the usage statistics; the numbers are approximate while other threads use the allocator
+    Stats getStats() const;
+    //! returns the shared unused buffers and the ones cached by the calling thread to the system
+    void releaseCachedMemory();
+
+    struct Impl;
+protected:
+    Impl* impl;
+
+private:
+    PoolMatAllocator(const PoolMatAllocator&);
+    PoolMatAllocator& operator = (const PoolMatAllocator&);
+};
+
+//! returns the process-wide instance of PoolMatAllocator
+CV_EXPORTS PoolMatAllocator* getPoolMatAllocator();
+//! returns the allocator used by Mat::create() for the matrices without a custom allocator; 0 means fastMalloc()
+CV_EXPORTS MatAllocator* getDefaultAllocator();
+//! sets the allocator used by Mat::create() for the matrices without a custom allocator; 0 means fastMalloc()
+CV_EXPORTS void setDefaultAllocator(MatAllocator* allocator);
+
 /*!
    The n-dimensional matrix class.
 
@@ -1913,11 +1968,13 @@ public:
     template<typename _Tp> MatConstIterator_<_Tp> begin() const;
     template<typename _Tp> MatConstIterator_<_Tp> end() const;
 
-    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG };
+    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG,
+           DEFAULT_ALLOCATOR_FLAG=1 << 13 };
 
     /*! includes several bit-fields:
          - the magic signature
          - continuity flag
+         - the flag telling that the data was allocated by the default allocator
          - depth
          - number of channels
      */
@@ -3985,7 +4042,8 @@ public:
         FORMAT_MASK=(7<<3),
         FORMAT_AUTO=0,
         FORMAT_XML=(1<<3),
-        FORMAT_YAML=(2<<3)
+        FORMAT_YAML=(2<<3),
+        FORMAT_BINARY=(3<<3) //! raw aligned data blocks; when reading, the file is memory-mapped
     };
     enum
     {
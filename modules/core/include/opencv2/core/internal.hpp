@@ -120,6 +120,14 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 #    include <nmmintrin.h>
 #    define CV_SSE4_2 1
 #  endif
+#  if defined __POPCNT__ || (defined _MSC_VER && _MSC_VER >= 1500)
+#    ifdef _MSC_VER
+#      include <nmmintrin.h>
+#    else
+#      include <popcntintrin.h>
+#    endif
+#    define CV_POPCNT 1
+#  endif
 #  if defined __AVX__ || (defined _MSC_FULL_VER && _MSC_FULL_VER >= 160040219)
 // MS Visual Studio 2010 (2012?) has no macro pre-defined to identify the use of /arch:AVX
 // See: http://connect.microsoft.com/VisualStudio/feedback/details/605858/arch-avx-should-define-a-predefined-macro-in-x64-and-set-a-unique-value-for-m-ix86-fp-in-win32
@@ -131,6 +139,10 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 #      define __xgetbv() 0
 #    endif
 #  endif
+#  if defined __AVX2__
+#    include <immintrin.h>
+#    define CV_AVX2 1
+#  endif
 #endif
 
 #ifdef __ARM_NEON__
@@ -160,6 +172,16 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 #ifndef CV_AVX
 #  define CV_AVX 0
 #endif
+#ifndef CV_AVX2
+#  define CV_AVX2 0
+#endif
+
+/* The kernels for the instruction sets above the build baseline live in src/ssse3/, src/popcnt/,
+   src/avx/ and src/avx2/ of a module. They are compiled with the matching flags when HAVE_DISPATCH_<ISA>
+   is defined in cvconfig.h, and the callers choose them at runtime with checkHardwareSupport(). */
+#ifndef CV_POPCNT
+#  define CV_POPCNT 0
+#endif
 #ifndef CV_NEON
 #  define CV_NEON 0
 #endif
@@ -245,10 +267,56 @@ namespace cv
 
     class Split {};
 
+    template<typename Body> class ParallelReduceStripes : public ParallelLoopBody
+    {
+    public:
+        ParallelReduceStripes( Body** _bodies, const BlockedRange& _range, int _nstripes )
+            : bodies(_bodies), range(_range), nstripes(_nstripes) {}
+
+        void operator()( const Range& r ) const
+        {
+            int len = range.end() - range.begin();
+            for( int i = r.start; i < r.end; i++ )
+            {
+                int b = range.begin() + (int)((int64)len*i/nstripes);
+                int e = range.begin() + (int)((int64)len*(i+1)/nstripes);
+                (*bodies[i])(BlockedRange(b, e, range.grainsize()));
+            }
+        }
+
+    protected:
+        Body** bodies;
+        BlockedRange range;
+        int nstripes;
+    };
+
+    // The range is split into one stripe per thread, every stripe but the first one is processed
+    // by its own copy of the body made with the splitting constructor Body(Body&, Split), and the
+    // partial results are merged into the original body with join() in the stripe order,
+    // so the result does not depend on the scheduling.
     template<typename Body> static inline
     void parallel_reduce( const BlockedRange& range, Body& body )
     {
-        body(range);
+        int nstripes = std::min(range.end() - range.begin(), getNumThreads());
+        if( nstripes <= 1 )
+        {
+            body(range);
+            return;
+        }
+
+        std::vector<Ptr<Body> > partial(nstripes);
+        std::vector<Body*> bodies(nstripes);
+        bodies[0] = &body;
+        for( int i = 1; i < nstripes; i++ )
+        {
+            partial[i] = Ptr<Body>(new Body(body, Split()));
+            bodies[i] = (Body*)partial[i];
+        }
+
+        parallel_for_(Range(0, nstripes), ParallelReduceStripes<Body>(&bodies[0], range, nstripes), nstripes);
+
+        for( int i = 1; i < nstripes; i++ )
+            body.join(*bodies[i]);
     }
 #endif
 } //namespace cv
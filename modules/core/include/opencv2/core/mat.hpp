@@ -368,6 +368,12 @@ inline void Mat::release()
     data = datastart = dataend = datalimit = 0;
     size.p[0] = 0;
     refcount = 0;
+    // the next create() takes the default allocator that is current at that time
+    if( flags & DEFAULT_ALLOCATOR_FLAG )
+    {
+        allocator = 0;
+        flags &= ~DEFAULT_ALLOCATOR_FLAG;
+    }
 }
 
 inline Mat Mat::operator()( Range _rowRange, Range _colRange ) const
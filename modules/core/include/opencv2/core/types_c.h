@@ -1755,6 +1755,7 @@ typedef struct CvFileStorage CvFileStorage;
 #define CV_STORAGE_FORMAT_AUTO   0
 #define CV_STORAGE_FORMAT_XML    8
 #define CV_STORAGE_FORMAT_YAML  16
+#define CV_STORAGE_FORMAT_BINARY 24
 
 /* List of attributes: */
 typedef struct CvAttrList
@@ -1809,6 +1810,12 @@ struct CvTypeInfo;
 
 #define CV_NODE_SEQ_SIMPLE 256
 #define CV_NODE_SEQ_IS_SIMPLE(seq) (((seq)->flags & CV_NODE_SEQ_SIMPLE) != 0)
+/* the sequence refers to the raw data block of a binary storage, so it has no CvFileNode elements;
+   use cvReadRawData() or cvStartReadRawData()/cvReadRawDataSlice() to read it. Such sequences are
+   only seen through cv::FileNode: cvGetFileNode(), cvGetFileNodeByName() and cvGetRootFileNode()
+   convert the raw data blocks inside of the returned node to the regular sequences of file nodes */
+#define CV_NODE_SEQ_BINARY 512
+#define CV_NODE_SEQ_IS_BINARY(seq) (((seq)->flags & CV_NODE_SEQ_BINARY) != 0)
 
 typedef struct CvString
 {
@@ -42,7 +42,15 @@
 
 #include "precomp.hpp"
 
-#define CV_USE_SYSTEM_MALLOC 1
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#include <windows.h>
+#undef small
+#undef min
+#undef max
+#undef abs
+#endif
+
+#include <map>
 
 namespace cv
 {
@@ -53,12 +61,6 @@ static void* OutOfMemoryError(size_t size)
     return 0;
 }
 
-#if CV_USE_SYSTEM_MALLOC
-
-#if defined WIN32 || defined _WIN32
-void deleteThreadAllocData() {}
-#endif
-
 void* fastMalloc( size_t size )
 {
     uchar* udata = (uchar*)malloc(size + sizeof(void*) + CV_MALLOC_ALIGN);
@@ -80,606 +82,523 @@ void fastFree(void* ptr)
     }
 }
 
-#else //CV_USE_SYSTEM_MALLOC
+/****************************************************************************************\
+*                                  Pool matrix allocator                                 *
+\****************************************************************************************/
 
-#if 0
-#define SANITY_CHECK(block) \
-    CV_Assert(((size_t)(block) & (MEM_BLOCK_SIZE-1)) == 0 && \
-        (unsigned)(block)->binIdx <= (unsigned)MAX_BIN && \
-        (block)->signature == MEM_BLOCK_SIGNATURE)
-#else
-#define SANITY_CHECK(block)
-#endif
+/*
+   Blocks up to MAX_SMALL_BLOCK bytes are rounded up to one of the size classes
+   (4 classes per power of two, starting from 64 bytes) and, when released, are kept
+   in the per-thread free lists of the releasing thread. When a thread cache grows
+   above its limit, the blocks go to the shared per-class lists; when those grow above
+   the global limit, the memory is returned to the system.
+
+   Bigger blocks are rounded up to the page size and kept in a shared multimap sorted by size,
+   so that a request can be served by any cached block that is not more than 1/8 larger.
 
-#define STAT(stmt)
+   Every block is preceded by a small header (the original malloc'ed pointer, the block size
+   and the class index) and the user data is always aligned by POOL_ALIGN bytes.
+*/
 
-#ifdef WIN32
-struct CriticalSection
+enum
 {
-    CriticalSection() { InitializeCriticalSection(&cs); }
-    ~CriticalSection() { DeleteCriticalSection(&cs); }
-    void lock() { EnterCriticalSection(&cs); }
-    void unlock() { LeaveCriticalSection(&cs); }
-    bool trylock() { return TryEnterCriticalSection(&cs) != 0; }
+    POOL_ALIGN = 64,
+    POOL_MIN_SHIFT = 6,
+    POOL_MAX_SHIFT = 18,
+    POOL_CLASSES_PER_SHIFT = 4,
+    POOL_CLASSES = (POOL_MAX_SHIFT - POOL_MIN_SHIFT)*POOL_CLASSES_PER_SHIFT + 1,
+    POOL_PAGE_SIZE = 4096
+};
 
-    CRITICAL_SECTION cs;
+static const size_t MAX_SMALL_BLOCK = (size_t)1 << POOL_MAX_SHIFT;
+static const size_t DEFAULT_MAX_CACHED_BYTES = (size_t)256 << 20;
+static const size_t DEFAULT_MAX_THREAD_CACHED_BYTES = (size_t)4 << 20;
+
+struct PoolBlockHeader
+{
+    void* udata;
+    size_t size;
+    int cls;
 };
 
-void* SystemAlloc(size_t size)
+struct PoolNode
 {
-    void* ptr = malloc(size);
-    return ptr ? ptr : OutOfMemoryError(size);
-}
+    PoolNode* next;
+};
 
-void SystemFree(void* ptr, size_t)
+static inline int poolSizeClass( size_t size )
 {
-    free(ptr);
+    if( size <= ((size_t)1 << POOL_MIN_SHIFT) )
+        return 0;
+    size_t s = size - 1;
+    int shift = POOL_MIN_SHIFT;
+    while( (s >> shift) != 0 )
+        shift++;
+    // here 2^(shift-1) < size <= 2^shift; split this range into POOL_CLASSES_PER_SHIFT classes
+    int sub = (int)((s >> (shift - 3)) & (POOL_CLASSES_PER_SHIFT - 1));
+    return (shift - 1 - POOL_MIN_SHIFT)*POOL_CLASSES_PER_SHIFT + sub + 1;
 }
-#else //WIN32
-
-#include <sys/mman.h>
 
-struct CriticalSection
+static inline size_t poolClassSize( int cls )
 {
-    CriticalSection() { pthread_mutex_init(&mutex, 0); }
-    ~CriticalSection() { pthread_mutex_destroy(&mutex); }
-    void lock() { pthread_mutex_lock(&mutex); }
-    void unlock() { pthread_mutex_unlock(&mutex); }
-    bool trylock() { return pthread_mutex_trylock(&mutex) == 0; }
+    if( cls == 0 )
+        return (size_t)1 << POOL_MIN_SHIFT;
+    int shift = (cls - 1)/POOL_CLASSES_PER_SHIFT + POOL_MIN_SHIFT;
+    int sub = (cls - 1) % POOL_CLASSES_PER_SHIFT;
+    return ((size_t)1 << shift) + ((size_t)(sub + 1) << (shift - 2));
+}
 
-    pthread_mutex_t mutex;
-};
+static void* poolSystemAlloc( size_t size, int cls )
+{
+    uchar* udata = (uchar*)malloc(size + sizeof(PoolBlockHeader) + POOL_ALIGN);
+    if( !udata )
+        return OutOfMemoryError(size);
+    uchar* data = alignPtr(udata + sizeof(PoolBlockHeader), POOL_ALIGN);
+    PoolBlockHeader* hdr = (PoolBlockHeader*)data - 1;
+    hdr->udata = udata;
+    hdr->size = size;
+    hdr->cls = cls;
+    return data;
+}
 
-void* SystemAlloc(size_t size)
+static inline PoolBlockHeader* poolHeader( void* ptr )
 {
-    #ifndef MAP_ANONYMOUS
-    #define MAP_ANONYMOUS MAP_ANON
-    #endif
-    void* ptr = 0;
-    ptr = mmap(ptr, size, (PROT_READ | PROT_WRITE), MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
-    return ptr != MAP_FAILED ? ptr : OutOfMemoryError(size);
+    return (PoolBlockHeader*)ptr - 1;
 }
 
-void SystemFree(void* ptr, size_t size)
+static void poolSystemFree( void* ptr )
 {
-    munmap(ptr, size);
+    free(poolHeader(ptr)->udata);
 }
-#endif //WIN32
 
-struct AutoLock
+struct PoolThreadCache
 {
-    AutoLock(CriticalSection& _cs) : cs(&_cs) { cs->lock(); }
-    ~AutoLock() { cs->unlock(); }
-    CriticalSection* cs;
+    PoolThreadCache( PoolMatAllocator::Impl* _owner ) : owner(_owner), cachedBytes(0),
+        hits(0), misses(0), bytesInUse(0), prev(0), next(0)
+    {
+        memset(lists, 0, sizeof(lists));
+    }
+
+    PoolMatAllocator::Impl* owner;
+    PoolNode* lists[POOL_CLASSES];
+    size_t cachedBytes;
+    int64 hits, misses, bytesInUse;
+    PoolThreadCache* prev;
+    PoolThreadCache* next;
 };
 
-const size_t MEM_BLOCK_SIGNATURE = 0x01234567;
-const int MEM_BLOCK_SHIFT = 14;
-const size_t MEM_BLOCK_SIZE = 1 << MEM_BLOCK_SHIFT;
-const size_t HDR_SIZE = 128;
-const size_t MAX_BLOCK_SIZE = MEM_BLOCK_SIZE - HDR_SIZE;
-const int MAX_BIN = 28;
+struct PoolMatAllocator::Impl
+{
+    Impl( size_t _maxCachedBytes, size_t _maxThreadCachedBytes );
+    ~Impl();
 
-static const int binSizeTab[MAX_BIN+1] =
-{ 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 128, 160, 192, 256, 320, 384, 480, 544, 672, 768,
-896, 1056, 1328, 1600, 2688, 4048, 5408, 8128, 16256 };
+    void* alloc( size_t size );
+    void release( void* ptr );
 
-struct MallocTables
-{
-    void initBinTab()
-    {
-        int i, j = 0, n;
-        for( i = 0; i <= MAX_BIN; i++ )
-        {
-            n = binSizeTab[i]>>3;
-            for( ; j <= n; j++ )
-                binIdx[j] = (uchar)i;
-        }
-    }
-    int bin(size_t size)
-    {
-        assert( size <= MAX_BLOCK_SIZE );
-        return binIdx[(size + 7)>>3];
-    }
+    void* systemAlloc( size_t size, int cls );
+    void systemFree( void* ptr );
+    void releaseShared( void* ptr );
 
-    MallocTables()
-    {
-        initBinTab();
-    }
+    PoolThreadCache* threadCache( bool create );
+    void retireThreadCache( PoolThreadCache* tc );
+    void releaseCachedMemory();
+    Stats stats();
 
-    uchar binIdx[MAX_BLOCK_SIZE/8+1];
-};
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    DWORD tlsKey;
+#else
+    pthread_key_t tlsKey;
+#endif
 
-MallocTables mallocTables;
+    size_t maxCachedBytes, maxThreadCachedBytes;
 
-struct Node
-{
-    Node* next;
+    // the shared pool
+    Mutex poolMutex;
+    PoolNode* lists[POOL_CLASSES];
+    std::multimap<size_t, void*> bigBlocks;
+    size_t cachedBytes, reservedBytes, peakReservedBytes;
+
+    // all the thread caches; used to collect the statistics
+    Mutex registryMutex;
+    PoolThreadCache* caches;
+    int64 retiredHits, retiredMisses, retiredBytesInUse;
 };
 
-struct ThreadData;
+#if defined WIN32 || defined _WIN32 || defined WINCE
+// there are no TLS destructors on Windows; the thread caches are released
+// from DllMain via deleteThreadAllocData(), which needs all the live pools
+static Mutex poolInstancesMutex;
+static std::vector<PoolMatAllocator::Impl*> poolInstances;
+#else
+static void deletePoolThreadCache( void* data )
+{
+    PoolThreadCache* tc = (PoolThreadCache*)data;
+    tc->owner->retireThreadCache(tc);
+}
+#endif
 
-struct Block
+PoolMatAllocator::Impl::Impl( size_t _maxCachedBytes, size_t _maxThreadCachedBytes )
 {
-    Block(Block* _next)
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    tlsKey = TlsAlloc();
+    CV_Assert( tlsKey != TLS_OUT_OF_INDEXES );
+    AutoLock lock(poolInstancesMutex);
+    poolInstances.push_back(this);
+#else
+    CV_Assert( pthread_key_create(&tlsKey, deletePoolThreadCache) == 0 );
+#endif
+    maxCachedBytes = _maxCachedBytes;
+    maxThreadCachedBytes = std::min(_maxThreadCachedBytes, _maxCachedBytes);
+    memset(lists, 0, sizeof(lists));
+    cachedBytes = reservedBytes = peakReservedBytes = 0;
+    caches = 0;
+    retiredHits = retiredMisses = retiredBytesInUse = 0;
+}
+
+PoolMatAllocator::Impl::~Impl()
+{
+    releaseCachedMemory();
+#if defined WIN32 || defined _WIN32 || defined WINCE
     {
-        signature = MEM_BLOCK_SIGNATURE;
-        prev = 0;
-        next = _next;
-        privateFreeList = publicFreeList = 0;
-        bumpPtr = endPtr = 0;
-        objSize = 0;
-        threadData = 0;
-        data = (uchar*)this + HDR_SIZE;
+        AutoLock lock(poolInstancesMutex);
+        poolInstances.erase(std::find(poolInstances.begin(), poolInstances.end(), this));
     }
-
-    ~Block() {}
-
-    void init(Block* _prev, Block* _next, int _objSize, ThreadData* _threadData)
+    TlsFree(tlsKey);
+#else
+    pthread_key_delete(tlsKey);
+#endif
+    // after the key is deleted, no thread can reach its cache, so all of them can be released here
+    while( caches )
     {
-        prev = _prev;
-        if(prev)
-            prev->next = this;
-        next = _next;
-        if(next)
-            next->prev = this;
-        objSize = _objSize;
-        binIdx = mallocTables.bin(objSize);
-        threadData = _threadData;
-        privateFreeList = publicFreeList = 0;
-        bumpPtr = data;
-        int nobjects = MAX_BLOCK_SIZE/objSize;
-        endPtr = bumpPtr + nobjects*objSize;
-        almostEmptyThreshold = (nobjects + 1)/2;
-        allocated = 0;
+        PoolThreadCache* tc = caches;
+        caches = tc->next;
+        for( int i = 0; i < POOL_CLASSES; i++ )
+            for( PoolNode* node = tc->lists[i]; node != 0; )
+            {
+                PoolNode* next = node->next;
+                poolSystemFree(node);
+                node = next;
+            }
+        delete tc;
     }
+}
 
-    bool isFilled() const { return allocated > almostEmptyThreshold; }
-
-    size_t signature;
-    Block* prev;
-    Block* next;
-    Node* privateFreeList;
-    Node* publicFreeList;
-    uchar* bumpPtr;
-    uchar* endPtr;
-    uchar* data;
-    ThreadData* threadData;
-    int objSize;
-    int binIdx;
-    int allocated;
-    int almostEmptyThreshold;
-    CriticalSection cs;
-};
-
-struct BigBlock
+PoolThreadCache* PoolMatAllocator::Impl::threadCache( bool create )
 {
-    BigBlock(int bigBlockSize, BigBlock* _next)
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    PoolThreadCache* tc = (PoolThreadCache*)TlsGetValue(tlsKey);
+#else
+    PoolThreadCache* tc = (PoolThreadCache*)pthread_getspecific(tlsKey);
+#endif
+    if( !tc && create )
     {
-        first = alignPtr((Block*)(this+1), MEM_BLOCK_SIZE);
-        next = _next;
-        nblocks = (int)(((char*)this + bigBlockSize - (char*)first)/MEM_BLOCK_SIZE);
-        Block* p = 0;
-        for( int i = nblocks-1; i >= 0; i-- )
-            p = ::new((uchar*)first + i*MEM_BLOCK_SIZE) Block(p);
+        tc = new PoolThreadCache(this);
+        {
+            AutoLock lock(registryMutex);
+            tc->next = caches;
+            if( caches )
+                caches->prev = tc;
+            caches = tc;
+        }
+#if defined WIN32 || defined _WIN32 || defined WINCE
+        TlsSetValue(tlsKey, tc);
+#else
+        pthread_setspecific(tlsKey, tc);
+#endif
     }
+    return tc;
+}
 
-    ~BigBlock()
-    {
-        for( int i = nblocks-1; i >= 0; i-- )
-            ((Block*)((uchar*)first+i*MEM_BLOCK_SIZE))->~Block();
-    }
+void PoolMatAllocator::Impl::retireThreadCache( PoolThreadCache* tc )
+{
+    // the blocks go directly to the shared pool, so that no new thread cache is created here
+    for( int i = 0; i < POOL_CLASSES; i++ )
+        for( PoolNode* node = tc->lists[i]; node != 0; )
+        {
+            PoolNode* next = node->next;
+            releaseShared(node);
+            node = next;
+        }
 
-    BigBlock* next;
-    Block* first;
-    int nblocks;
-};
+    AutoLock lock(registryMutex);
+    if( tc->prev )
+        tc->prev->next = tc->next;
+    else
+        caches = tc->next;
+    if( tc->next )
+        tc->next->prev = tc->prev;
+    retiredHits += tc->hits;
+    retiredMisses += tc->misses;
+    retiredBytesInUse += tc->bytesInUse;
+    delete tc;
+}
 
-struct BlockPool
+void* PoolMatAllocator::Impl::systemAlloc( size_t size, int cls )
 {
-    BlockPool(int _bigBlockSize=1<<20) : pool(0), bigBlockSize(_bigBlockSize)
-    {
-    }
+    void* ptr = poolSystemAlloc(size, cls);
+    AutoLock lock(poolMutex);
+    reservedBytes += size;
+    peakReservedBytes = std::max(peakReservedBytes, reservedBytes);
+    return ptr;
+}
+
+void PoolMatAllocator::Impl::systemFree( void* ptr )
+{
+    reservedBytes -= poolHeader(ptr)->size;
+    poolSystemFree(ptr);
+}
 
-    ~BlockPool()
+void* PoolMatAllocator::Impl::alloc( size_t size )
+{
+    PoolThreadCache* tc = threadCache(true);
+    void* ptr = 0;
+    int cls = -1;
+
+    if( size <= MAX_SMALL_BLOCK )
     {
-        AutoLock lock(cs);
-        while( pool )
+        cls = poolSizeClass(size);
+        size = poolClassSize(cls);
+        PoolNode* node = tc->lists[cls];
+        if( node )
         {
-            BigBlock* nextBlock = pool->next;
-            pool->~BigBlock();
-            SystemFree(pool, bigBlockSize);
-            pool = nextBlock;
+            tc->lists[cls] = node->next;
+            tc->cachedBytes -= size;
         }
+        else
+        {
+            AutoLock lock(poolMutex);
+            node = lists[cls];
+            if( node )
+            {
+                lists[cls] = node->next;
+                cachedBytes -= size;
+            }
+        }
+        ptr = node;
     }
-
-    Block* alloc()
+    else
     {
-        AutoLock lock(cs);
-        Block* block;
-        if( !freeBlocks )
+        size = alignSize(size, POOL_PAGE_SIZE);
+        AutoLock lock(poolMutex);
+        std::multimap<size_t, void*>::iterator it = bigBlocks.lower_bound(size);
+        if( it != bigBlocks.end() && it->first <= size + size/8 )
         {
-            BigBlock* bblock = ::new(SystemAlloc(bigBlockSize)) BigBlock(bigBlockSize, pool);
-            assert( bblock != 0 );
-            freeBlocks = bblock->first;
-            pool = bblock;
+            ptr = it->second;
+            cachedBytes -= it->first;
+            bigBlocks.erase(it);
         }
-        block = freeBlocks;
-        freeBlocks = freeBlocks->next;
-        if( freeBlocks )
-            freeBlocks->prev = 0;
-        STAT(stat.bruttoBytes += MEM_BLOCK_SIZE);
-        return block;
     }
 
-    void free(Block* block)
+    if( ptr )
+        tc->hits++;
+    else
     {
-        AutoLock lock(cs);
-        block->prev = 0;
-        block->next = freeBlocks;
-        freeBlocks = block;
-        STAT(stat.bruttoBytes -= MEM_BLOCK_SIZE);
+        tc->misses++;
+        ptr = systemAlloc(size, cls);
     }
+    tc->bytesInUse += poolHeader(ptr)->size;
+    return ptr;
+}
 
-    CriticalSection cs;
-    Block* freeBlocks;
-    BigBlock* pool;
-    int bigBlockSize;
-    int blocksPerBigBlock;
-};
-
-BlockPool mallocPool;
+void PoolMatAllocator::Impl::release( void* ptr )
+{
+    PoolBlockHeader* hdr = poolHeader(ptr);
+    PoolThreadCache* tc = threadCache(true);
+    tc->bytesInUse -= hdr->size;
 
-enum { START=0, FREE=1, GC=2 };
+    if( hdr->cls >= 0 && tc->cachedBytes + hdr->size <= maxThreadCachedBytes )
+    {
+        PoolNode* node = (PoolNode*)ptr;
+        node->next = tc->lists[hdr->cls];
+        tc->lists[hdr->cls] = node;
+        tc->cachedBytes += hdr->size;
+    }
+    else
+        releaseShared(ptr);
+}
 
-struct ThreadData
+void PoolMatAllocator::Impl::releaseShared( void* ptr )
 {
-    ThreadData() { for(int i = 0; i <= MAX_BIN; i++) bins[i][START] = bins[i][FREE] = bins[i][GC] = 0; }
-    ~ThreadData()
+    PoolBlockHeader* hdr = poolHeader(ptr);
+    AutoLock lock(poolMutex);
+
+    if( cachedBytes + hdr->size > maxCachedBytes )
+        systemFree(ptr);
+    else
     {
-        // mark all the thread blocks as abandoned or even release them
-        for( int i = 0; i <= MAX_BIN; i++ )
+        if( hdr->cls >= 0 )
         {
-            Block *bin = bins[i][START], *block = bin;
-            bins[i][START] = bins[i][FREE] = bins[i][GC] = 0;
-            if( block )
-            {
-                do
-                {
-                    Block* next = block->next;
-                    int allocated = block->allocated;
-                    {
-                    AutoLock lock(block->cs);
-                    block->next = block->prev = 0;
-                    block->threadData = 0;
-                    Node *node = block->publicFreeList;
-                    for( ; node != 0; node = node->next )
-                        allocated--;
-                    }
-                    if( allocated == 0 )
-                        mallocPool.free(block);
-                    block = next;
-                }
-                while( block != bin );
-            }
+            PoolNode* node = (PoolNode*)ptr;
+            node->next = lists[hdr->cls];
+            lists[hdr->cls] = node;
         }
+        else
+            bigBlocks.insert(std::make_pair(hdr->size, ptr));
+        cachedBytes += hdr->size;
     }
+}
 
-    void moveBlockToFreeList( Block* block )
+void PoolMatAllocator::Impl::releaseCachedMemory()
+{
+    PoolThreadCache* tc = threadCache(false);
+    AutoLock lock(poolMutex);
+
+    // the caches of the other threads can not be touched safely, so only
+    // the shared pool and the cache of the calling thread are released
+    if( tc )
     {
-        int i = block->binIdx;
-        Block*& freePtr = bins[i][FREE];
-        CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-        if( block != freePtr )
+        for( int i = 0; i < POOL_CLASSES; i++ )
         {
-            Block*& gcPtr = bins[i][GC];
-            if( gcPtr == block )
-                gcPtr = block->next;
-            if( block->next != block )
+            for( PoolNode* node = tc->lists[i]; node != 0; )
             {
-                block->prev->next = block->next;
-                block->next->prev = block->prev;
+                PoolNode* next = node->next;
+                systemFree(node);
+                node = next;
             }
-            block->next = freePtr->next;
-            block->prev = freePtr;
-            freePtr = block->next->prev = block->prev->next = block;
+            tc->lists[i] = 0;
         }
+        tc->cachedBytes = 0;
     }
 
-    Block* bins[MAX_BIN+1][3];
-
-#ifdef WIN32
-#ifdef WINCE
-#   define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
-#endif //WINCE
-
-    static DWORD tlsKey;
-    static ThreadData* get()
+    for( int i = 0; i < POOL_CLASSES; i++ )
     {
-        ThreadData* data;
-        if( tlsKey == TLS_OUT_OF_INDEXES )
-            tlsKey = TlsAlloc();
-        data = (ThreadData*)TlsGetValue(tlsKey);
-        if( !data )
+        for( PoolNode* node = lists[i]; node != 0; )
         {
-            data = new ThreadData;
-            TlsSetValue(tlsKey, data);
+            PoolNode* next = node->next;
+            systemFree(node);
+            node = next;
         }
-        return data;
-    }
-#else //WIN32
-    static void deleteData(void* data)
-    {
-        delete (ThreadData*)data;
+        lists[i] = 0;
     }
 
-    static pthread_key_t tlsKey;
-    static ThreadData* get()
+    for( std::multimap<size_t, void*>::iterator it = bigBlocks.begin(); it != bigBlocks.end(); ++it )
+        systemFree(it->second);
+    bigBlocks.clear();
+    cachedBytes = 0;
+}
+
+PoolMatAllocator::Stats PoolMatAllocator::Impl::stats()
+{
+    Stats s;
+    AutoLock lock(registryMutex);
+    s.hits = retiredHits;
+    s.misses = retiredMisses;
+    int64 bytesInUse = retiredBytesInUse;
+    size_t threadCachedBytes = 0;
+
+    // the counters of the other threads are read without synchronization,
+    // so the numbers are only approximate while the allocator is in use
+    for( PoolThreadCache* tc = caches; tc != 0; tc = tc->next )
     {
-        ThreadData* data;
-        if( !tlsKey )
-            pthread_key_create(&tlsKey, deleteData);
-        data = (ThreadData*)pthread_getspecific(tlsKey);
-        if( !data )
-        {
-            data = new ThreadData;
-            pthread_setspecific(tlsKey, data);
-        }
-        return data;
+        s.hits += tc->hits;
+        s.misses += tc->misses;
+        bytesInUse += tc->bytesInUse;
+        threadCachedBytes += tc->cachedBytes;
     }
-#endif //WIN32
-};
 
-#ifdef WIN32
-DWORD ThreadData::tlsKey = TLS_OUT_OF_INDEXES;
+    AutoLock poolLock(poolMutex);
+    s.bytesInUse = (size_t)std::max(bytesInUse, (int64)0);
+    s.bytesCached = cachedBytes + threadCachedBytes;
+    s.bytesReserved = reservedBytes;
+    s.peakBytesReserved = peakReservedBytes;
+    return s;
+}
 
-void deleteThreadAllocData()
+
+PoolMatAllocator::Stats::Stats()
+    : hits(0), misses(0), bytesInUse(0), bytesCached(0), bytesReserved(0), peakBytesReserved(0)
 {
-    if( ThreadData::tlsKey != TLS_OUT_OF_INDEXES )
-        delete (ThreadData*)TlsGetValue( ThreadData::tlsKey );
 }
 
-#else //WIN32
-pthread_key_t ThreadData::tlsKey = 0;
-#endif //WIN32
+PoolMatAllocator::PoolMatAllocator( size_t maxCachedBytes, size_t maxThreadCachedBytes )
+{
+    impl = new Impl(maxCachedBytes, maxThreadCachedBytes);
+}
 
-#if 0
-static void checkList(ThreadData* tls, int idx)
+PoolMatAllocator::~PoolMatAllocator()
 {
-    Block* block = tls->bins[idx][START];
-    if( !block )
-    {
-        CV_DbgAssert( tls->bins[idx][FREE] == 0 && tls->bins[idx][GC] == 0 );
-    }
-    else
-    {
-        bool gcInside = false;
-        bool freeInside = false;
-        do
-        {
-            if( tls->bins[idx][FREE] == block )
-                freeInside = true;
-            if( tls->bins[idx][GC] == block )
-                gcInside = true;
-            block = block->next;
-        }
-        while( block != tls->bins[idx][START] );
-        CV_DbgAssert( gcInside && freeInside );
-    }
+    delete impl;
 }
-#else
-#define checkList(tls, idx)
-#endif
 
-void* fastMalloc( size_t size )
+void PoolMatAllocator::allocate(int dims, const int* sizes, int type, int*& refcount,
+                                uchar*& datastart, uchar*& data, size_t* step)
 {
-    if( size > MAX_BLOCK_SIZE )
+    size_t total = CV_ELEM_SIZE(type);
+    for( int i = dims-1; i >= 0; i-- )
     {
-        size_t size1 = size + sizeof(uchar*)*2 + MEM_BLOCK_SIZE;
-        uchar* udata = (uchar*)SystemAlloc(size1);
-        uchar** adata = alignPtr((uchar**)udata + 2, MEM_BLOCK_SIZE);
-        adata[-1] = udata;
-        adata[-2] = (uchar*)size1;
-        return adata;
+        if( step )
+            step[i] = total;
+        total *= sizes[i];
     }
+    size_t totalsize = alignSize(total, (int)sizeof(*refcount));
+    data = datastart = (uchar*)impl->alloc(totalsize + sizeof(*refcount));
+    refcount = (int*)(data + totalsize);
+    *refcount = 1;
+}
 
-    {
-    ThreadData* tls = ThreadData::get();
-    int idx = mallocTables.bin(size);
-    Block*& startPtr = tls->bins[idx][START];
-    Block*& gcPtr = tls->bins[idx][GC];
-    Block*& freePtr = tls->bins[idx][FREE], *block = freePtr;
-    checkList(tls, idx);
-    size = binSizeTab[idx];
-    STAT(
-        stat.nettoBytes += size;
-        stat.mallocCalls++;
-        );
-    uchar* data = 0;
-
-    for(;;)
-    {
-        if( block )
-        {
-            // try to find non-full block
-            for(;;)
-            {
-                CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-                if( block->bumpPtr )
-                {
-                    data = block->bumpPtr;
-                    if( (block->bumpPtr += size) >= block->endPtr )
-                        block->bumpPtr = 0;
-                    break;
-                }
-
-                if( block->privateFreeList )
-                {
-                    data = (uchar*)block->privateFreeList;
-                    block->privateFreeList = block->privateFreeList->next;
-                    break;
-                }
-
-                if( block == startPtr )
-                    break;
-                block = block->next;
-            }
-#if 0
-            avg_k += _k;
-            avg_nk++;
-            if( avg_nk == 1000 )
-            {
-                printf("avg search iters per 1e3 allocs = %g\n", (double)avg_k/avg_nk );
-                avg_k = avg_nk = 0;
-            }
-#endif
+void PoolMatAllocator::deallocate(int*, uchar* datastart, uchar*)
+{
+    if( datastart )
+        impl->release(datastart);
+}
 
-            freePtr = block;
-            if( !data )
-            {
-                block = gcPtr;
-                for( int k = 0; k < 2; k++ )
-                {
-                    SANITY_CHECK(block);
-                    CV_DbgAssert( block->next->prev == block && block->prev->next == block );
-                    if( block->publicFreeList )
-                    {
-                        {
-                        AutoLock lock(block->cs);
-                        block->privateFreeList = block->publicFreeList;
-                        block->publicFreeList = 0;
-                        }
-                        Node* node = block->privateFreeList;
-                        for(;node != 0; node = node->next)
-                            --block->allocated;
-                        data = (uchar*)block->privateFreeList;
-                        block->privateFreeList = block->privateFreeList->next;
-                        gcPtr = block->next;
-                        if( block->allocated+1 <= block->almostEmptyThreshold )
-                            tls->moveBlockToFreeList(block);
-                        break;
-                    }
-                    block = block->next;
-                }
-                if( !data )
-                    gcPtr = block;
-            }
-        }
+PoolMatAllocator::Stats PoolMatAllocator::getStats() const
+{
+    return impl->stats();
+}
 
-        if( data )
-            break;
-        block = mallocPool.alloc();
-        block->init(startPtr ? startPtr->prev : block, startPtr ? startPtr : block, (int)size, tls);
-        if( !startPtr )
-            startPtr = gcPtr = freePtr = block;
-        checkList(tls, block->binIdx);
-        SANITY_CHECK(block);
-    }
+void PoolMatAllocator::releaseCachedMemory()
+{
+    impl->releaseCachedMemory();
+}
 
-    ++block->allocated;
-    return data;
-    }
+
+static Mutex poolMatAllocatorMutex;
+static PoolMatAllocator* poolMatAllocator = 0;
+
+PoolMatAllocator* getPoolMatAllocator()
+{
+    AutoLock lock(poolMatAllocatorMutex);
+    // the instance is never destroyed, since matrices may be released after main() returns
+    if( !poolMatAllocator )
+        poolMatAllocator = new PoolMatAllocator;
+    return poolMatAllocator;
 }
 
-void fastFree( void* ptr )
+static MatAllocator* initDefaultAllocator()
 {
-    if( ((size_t)ptr & (MEM_BLOCK_SIZE-1)) == 0 )
-    {
-        if( ptr != 0 )
-        {
-            void* origPtr = ((void**)ptr)[-1];
-            size_t sz = (size_t)((void**)ptr)[-2];
-            SystemFree( origPtr, sz );
-        }
-        return;
-    }
+    const char* name = getenv("OPENCV_MAT_ALLOCATOR");
+    return name && strcmp(name, "pool") == 0 ? getPoolMatAllocator() : 0;
+}
 
-    {
-    ThreadData* tls = ThreadData::get();
-    Node* node = (Node*)ptr;
-    Block* block = (Block*)((size_t)ptr & -(int)MEM_BLOCK_SIZE);
-    assert( block->signature == MEM_BLOCK_SIGNATURE );
+static MatAllocator* volatile defaultMatAllocator = initDefaultAllocator();
 
-    if( block->threadData == tls )
-    {
-        STAT(
-        stat.nettoBytes -= block->objSize;
-        stat.freeCalls++;
-        float ratio = (float)stat.nettoBytes/stat.bruttoBytes;
-        if( stat.minUsageRatio > ratio )
-            stat.minUsageRatio = ratio;
-        );
-
-        SANITY_CHECK(block);
-
-        bool prevFilled = block->isFilled();
-        --block->allocated;
-        if( !block->isFilled() && (block->allocated == 0 || prevFilled) )
-        {
-            if( block->allocated == 0 )
-            {
-                int idx = block->binIdx;
-                Block*& startPtr = tls->bins[idx][START];
-                Block*& freePtr = tls->bins[idx][FREE];
-                Block*& gcPtr = tls->bins[idx][GC];
-
-                if( block == block->next )
-                {
-                    CV_DbgAssert( startPtr == block && freePtr == block && gcPtr == block );
-                    startPtr = freePtr = gcPtr = 0;
-                }
-                else
-                {
-                    if( freePtr == block )
-                        freePtr = block->next;
-                    if( gcPtr == block )
-                        gcPtr = block->next;
-                    if( startPtr == block )
-                        startPtr = block->next;
-                    block->prev->next = block->next;
-                    block->next->prev = block->prev;
-                }
-                mallocPool.free(block);
-                checkList(tls, idx);
-                return;
-            }
+MatAllocator* getDefaultAllocator()
+{
+    return defaultMatAllocator;
+}
 
-            tls->moveBlockToFreeList(block);
-        }
-        node->next = block->privateFreeList;
-        block->privateFreeList = node;
-    }
-    else
-    {
-        AutoLock lock(block->cs);
-        SANITY_CHECK(block);
+void setDefaultAllocator(MatAllocator* allocator)
+{
+    defaultMatAllocator = allocator;
+}
 
-        node->next = block->publicFreeList;
-        block->publicFreeList = node;
-        if( block->threadData == 0 )
+#if defined WIN32 || defined _WIN32 || defined WINCE
+void deleteThreadAllocData()
+{
+    AutoLock lock(poolInstancesMutex);
+    for( size_t i = 0; i < poolInstances.size(); i++ )
+    {
+        PoolMatAllocator::Impl* impl = poolInstances[i];
+        PoolThreadCache* tc = impl->threadCache(false);
+        if( tc )
         {
-            // take ownership of the abandoned block.
-            // note that it can happen at the same time as
-            // ThreadData::deleteData() marks the blocks as abandoned,
-            // so this part of the algorithm needs to be checked for data races
-            int idx = block->binIdx;
-            block->threadData = tls;
-            Block*& startPtr = tls->bins[idx][START];
-
-            if( startPtr )
-            {
-                block->next = startPtr;
-                block->prev = startPtr->prev;
-                block->next->prev = block->prev->next = block;
-            }
-            else
-                startPtr = tls->bins[idx][FREE] = tls->bins[idx][GC] = block;
+            TlsSetValue(impl->tlsKey, 0);
+            impl->retireThreadCache(tc);
         }
     }
-    }
 }
-
-#endif //CV_USE_SYSTEM_MALLOC
+#endif
 
 }
 
@@ -47,6 +47,12 @@
 // */
 
 #include "precomp.hpp"
+#ifdef HAVE_DISPATCH_AVX
+#  include "avx/arithm_avx.hpp"
+#endif
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/arithm_avx2.hpp"
+#endif
 
 namespace cv
 {
@@ -463,6 +469,21 @@ struct _VNot8u { __m128i operator()(const __m128i& a, const __m128i&) const { re
 #define IF_SIMD(op) NOP
 #endif
 
+// calls the AVX/AVX2 variant of a binary operation when the CPU has it; IPP does its own dispatching
+#if defined HAVE_DISPATCH_AVX && !ARITHM_USE_IPP
+#define DISPATCH_AVX(func) \
+    if( USE_AVX ) { avx::func(src1, step1, src2, step2, dst, step, sz.width, sz.height); return; }
+#else
+#define DISPATCH_AVX(func)
+#endif
+
+#if defined HAVE_DISPATCH_AVX2 && !ARITHM_USE_IPP
+#define DISPATCH_AVX2(func) \
+    if( USE_AVX2 ) { avx2::func(src1, step1, src2, step2, dst, step, sz.width, sz.height); return; }
+#else
+#define DISPATCH_AVX2(func)
+#endif
+
 template<> inline uchar OpAdd<uchar>::operator ()(uchar a, uchar b) const
 { return CV_FAST_CAST_8U(a + b); }
 template<> inline uchar OpSub<uchar>::operator ()(uchar a, uchar b) const
@@ -532,6 +553,7 @@ static void add8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX2(add8u);
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_8u_C1RSfs(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz, 0),
            (vBinOp8<uchar, OpAdd<uchar>, IF_SIMD(_VAdd8u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -573,6 +595,7 @@ static void add32f( const float* src1, size_t step1,
                     const float* src2, size_t step2,
                     float* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX(add32f);
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAdd_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
            (vBinOp32f<OpAdd<float>, IF_SIMD(_VAdd32f)>(src1, step1, src2, step2, dst, step, sz)));
@@ -589,6 +612,7 @@ static void sub8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX2(sub8u);
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_8u_C1RSfs(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz, 0),
            (vBinOp8<uchar, OpSub<uchar>, IF_SIMD(_VSub8u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -630,6 +654,7 @@ static void sub32f( const float* src1, size_t step1,
                    const float* src2, size_t step2,
                    float* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX(sub32f);
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiSub_32f_C1R(src2, (int)step2, src1, (int)step1, dst, (int)step, (IppiSize&)sz),
            (vBinOp32f<OpSub<float>, IF_SIMD(_VSub32f)>(src1, step1, src2, step2, dst, step, sz)));
@@ -649,6 +674,7 @@ static void max8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX2(max8u);
 #if (ARITHM_USE_IPP == 1)
   {
     uchar* s1 = (uchar*)src1;
@@ -724,6 +750,7 @@ static void max32f( const float* src1, size_t step1,
                     const float* src2, size_t step2,
                     float* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX(max32f);
 #if (ARITHM_USE_IPP == 1)
   {
     float* s1 = (float*)src1;
@@ -757,6 +784,7 @@ static void min8u( const uchar* src1, size_t step1,
                    const uchar* src2, size_t step2,
                    uchar* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX2(min8u);
 #if (ARITHM_USE_IPP == 1)
   {
     uchar* s1 = (uchar*)src1;
@@ -832,6 +860,7 @@ static void min32f( const float* src1, size_t step1,
                     const float* src2, size_t step2,
                     float* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX(min32f);
 #if (ARITHM_USE_IPP == 1)
   {
     float* s1 = (float*)src1;
@@ -865,6 +894,7 @@ static void absdiff8u( const uchar* src1, size_t step1,
                        const uchar* src2, size_t step2,
                        uchar* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX2(absdiff8u);
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_8u_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
            (vBinOp8<uchar, OpAbsDiff<uchar>, IF_SIMD(_VAbsDiff8u)>(src1, step1, src2, step2, dst, step, sz)));
@@ -904,6 +934,7 @@ static void absdiff32f( const float* src1, size_t step1,
                         const float* src2, size_t step2,
                         float* dst, size_t step, Size sz, void* )
 {
+    DISPATCH_AVX(absdiff32f);
     IF_IPP(fixSteps(sz, sizeof(dst[0]), step1, step2, step);
            ippiAbsDiff_32f_C1R(src1, (int)step1, src2, (int)step2, dst, (int)step, (IppiSize&)sz),
            (vBinOp32f<OpAbsDiff<float>, IF_SIMD(_VAbsDiff32f)>(src1, step1, src2, step2, dst, step, sz)));
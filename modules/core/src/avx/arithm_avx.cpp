@@ -0,0 +1,144 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "arithm_avx.hpp"
+
+namespace cv
+{
+namespace avx
+{
+
+struct VAdd32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_add_ps(a, b); }
+    float operator()(float a, float b) const { return a + b; }
+};
+
+struct VSub32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_sub_ps(a, b); }
+    float operator()(float a, float b) const { return a - b; }
+};
+
+struct VMin32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_min_ps(a, b); }
+    float operator()(float a, float b) const { return b < a ? b : a; }
+};
+
+struct VMax32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_max_ps(a, b); }
+    float operator()(float a, float b) const { return a < b ? b : a; }
+};
+
+struct VAbsDiff32f
+{
+    __m256 operator()(const __m256& a, const __m256& b) const
+    { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), _mm256_sub_ps(a, b)); }
+    float operator()(float a, float b) const { return (float)fabs(a - b); }
+};
+
+template<class Op> static void
+vBinOp32f( const float* src1, size_t step1, const float* src2, size_t step2,
+           float* dst, size_t step, int width, int height )
+{
+    Op op;
+
+    for( ; height--; src1 = (const float*)((const uchar*)src1 + step1),
+                     src2 = (const float*)((const uchar*)src2 + step2),
+                     dst = (float*)((uchar*)dst + step) )
+    {
+        int x = 0;
+        for( ; x <= width - 16; x += 16 )
+        {
+            __m256 r0 = _mm256_loadu_ps(src1 + x);
+            __m256 r1 = _mm256_loadu_ps(src1 + x + 8);
+            r0 = op(r0, _mm256_loadu_ps(src2 + x));
+            r1 = op(r1, _mm256_loadu_ps(src2 + x + 8));
+            _mm256_storeu_ps(dst + x, r0);
+            _mm256_storeu_ps(dst + x + 8, r1);
+        }
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m256 r0 = _mm256_loadu_ps(src1 + x);
+            r0 = op(r0, _mm256_loadu_ps(src2 + x));
+            _mm256_storeu_ps(dst + x, r0);
+        }
+        for( ; x < width; x++ )
+            dst[x] = op(src1[x], src2[x]);
+    }
+}
+
+void add32f( const float* src1, size_t step1, const float* src2, size_t step2,
+             float* dst, size_t step, int width, int height )
+{
+    vBinOp32f<VAdd32f>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void sub32f( const float* src1, size_t step1, const float* src2, size_t step2,
+             float* dst, size_t step, int width, int height )
+{
+    vBinOp32f<VSub32f>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void min32f( const float* src1, size_t step1, const float* src2, size_t step2,
+             float* dst, size_t step, int width, int height )
+{
+    vBinOp32f<VMin32f>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void max32f( const float* src1, size_t step1, const float* src2, size_t step2,
+             float* dst, size_t step, int width, int height )
+{
+    vBinOp32f<VMax32f>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void absdiff32f( const float* src1, size_t step1, const float* src2, size_t step2,
+                 float* dst, size_t step, int width, int height )
+{
+    vBinOp32f<VAbsDiff32f>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+}
+}
@@ -0,0 +1,70 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "matmul_avx.hpp"
+
+namespace cv
+{
+namespace avx
+{
+
+void scaleAdd_32f( const float* src1, const float* src2, float* dst, int len, float alpha )
+{
+    int i = 0;
+    __m256 a8 = _mm256_set1_ps(alpha);
+    for( ; i <= len - 16; i += 16 )
+    {
+        __m256 x0, x1, y0, y1, t0, t1;
+        x0 = _mm256_loadu_ps(src1 + i); x1 = _mm256_loadu_ps(src1 + i + 8);
+        y0 = _mm256_loadu_ps(src2 + i); y1 = _mm256_loadu_ps(src2 + i + 8);
+        t0 = _mm256_add_ps(_mm256_mul_ps(x0, a8), y0);
+        t1 = _mm256_add_ps(_mm256_mul_ps(x1, a8), y1);
+        _mm256_storeu_ps(dst + i, t0);
+        _mm256_storeu_ps(dst + i + 8, t1);
+    }
+    for( ; i < len; i++ )
+        dst[i] = src1[i]*alpha + src2[i];
+}
+
+}
+}
@@ -0,0 +1,142 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "arithm_avx2.hpp"
+
+namespace cv
+{
+namespace avx2
+{
+
+struct VAdd8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epu8(a, b); }
+    uchar operator()(int a, int b) const { int s = a + b; return (uchar)(s < 255 ? s : 255); }
+};
+
+struct VSub8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epu8(a, b); }
+    uchar operator()(int a, int b) const { int s = a - b; return (uchar)(s > 0 ? s : 0); }
+};
+
+struct VMin8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_min_epu8(a, b); }
+    uchar operator()(int a, int b) const { return (uchar)(a < b ? a : b); }
+};
+
+struct VMax8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_max_epu8(a, b); }
+    uchar operator()(int a, int b) const { return (uchar)(a > b ? a : b); }
+};
+
+struct VAbsDiff8u
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)); }
+    uchar operator()(int a, int b) const { return (uchar)(a > b ? a - b : b - a); }
+};
+
+template<class Op> static void
+vBinOp8u( const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+          uchar* dst, size_t step, int width, int height )
+{
+    Op op;
+
+    for( ; height--; src1 += step1, src2 += step2, dst += step )
+    {
+        int x = 0;
+        for( ; x <= width - 64; x += 64 )
+        {
+            __m256i r0 = _mm256_loadu_si256((const __m256i*)(src1 + x));
+            __m256i r1 = _mm256_loadu_si256((const __m256i*)(src1 + x + 32));
+            r0 = op(r0, _mm256_loadu_si256((const __m256i*)(src2 + x)));
+            r1 = op(r1, _mm256_loadu_si256((const __m256i*)(src2 + x + 32)));
+            _mm256_storeu_si256((__m256i*)(dst + x), r0);
+            _mm256_storeu_si256((__m256i*)(dst + x + 32), r1);
+        }
+        for( ; x <= width - 32; x += 32 )
+        {
+            __m256i r0 = _mm256_loadu_si256((const __m256i*)(src1 + x));
+            r0 = op(r0, _mm256_loadu_si256((const __m256i*)(src2 + x)));
+            _mm256_storeu_si256((__m256i*)(dst + x), r0);
+        }
+        for( ; x < width; x++ )
+            dst[x] = op(src1[x], src2[x]);
+    }
+}
+
+void add8u( const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+            uchar* dst, size_t step, int width, int height )
+{
+    vBinOp8u<VAdd8u>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void sub8u( const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+            uchar* dst, size_t step, int width, int height )
+{
+    vBinOp8u<VSub8u>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void min8u( const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+            uchar* dst, size_t step, int width, int height )
+{
+    vBinOp8u<VMin8u>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void max8u( const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+            uchar* dst, size_t step, int width, int height )
+{
+    vBinOp8u<VMax8u>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+void absdiff8u( const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+                uchar* dst, size_t step, int width, int height )
+{
+    vBinOp8u<VAbsDiff8u>(src1, step1, src2, step2, dst, step, width, height);
+}
+
+}
+}
@@ -0,0 +1,88 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "matmul_avx2.hpp"
+
+namespace cv
+{
+namespace avx2
+{
+
+double dotProd_8u( const uchar* src1, const uchar* src2, int len )
+{
+    double r = 0;
+    int i = 0, j, blockSize0 = (1 << 13), blockSize;
+
+    // the 32-bit lanes can not overflow within a block
+    while( i < len )
+    {
+        blockSize = len - i < blockSize0 ? len - i : blockSize0;
+        __m256i s = _mm256_setzero_si256();
+        int s1 = 0;
+        j = 0;
+        for( ; j <= blockSize - 32; j += 32 )
+        {
+            __m128i a0 = _mm_loadu_si128((const __m128i*)(src1 + j));
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(src1 + j + 16));
+            __m128i b0 = _mm_loadu_si128((const __m128i*)(src2 + j));
+            __m128i b1 = _mm_loadu_si128((const __m128i*)(src2 + j + 16));
+            s = _mm256_add_epi32(s, _mm256_madd_epi16(_mm256_cvtepu8_epi16(a0), _mm256_cvtepu8_epi16(b0)));
+            s = _mm256_add_epi32(s, _mm256_madd_epi16(_mm256_cvtepu8_epi16(a1), _mm256_cvtepu8_epi16(b1)));
+        }
+        for( ; j < blockSize; j++ )
+            s1 += src1[j]*src2[j];
+
+        __m128i s4 = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        CV_DECL_ALIGNED(16) int buf[4];
+        _mm_store_si128((__m128i*)buf, s4);
+        r += (double)buf[0] + buf[1] + buf[2] + buf[3] + s1;
+
+        src1 += blockSize;
+        src2 += blockSize;
+        i += blockSize;
+    }
+    return r;
+}
+
+}
+}
@@ -0,0 +1,84 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "stat_avx2.hpp"
+
+namespace cv
+{
+namespace avx2
+{
+
+static inline __m256i loadHammingVec( const uchar* a, const uchar* b, int i )
+{
+    __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+    return b ? _mm256_xor_si256(x, _mm256_loadu_si256((const __m256i*)(b + i))) : x;
+}
+
+// the bits of each nibble are looked up in the 16-entry table with vpshufb
+static inline __m256i popCountVec( __m256i x, __m256i lut, __m256i m4 )
+{
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(x, m4)),
+                           _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), m4)));
+}
+
+int normHamming( const uchar* a, const uchar* b, int n )
+{
+    int i = 0;
+    __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                   0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    __m256i m4 = _mm256_set1_epi8(0x0f), z = _mm256_setzero_si256(), sum = z;
+    for( ; i <= n - 64; i += 64 )
+    {
+        __m256i c0 = popCountVec(loadHammingVec(a, b, i), lut, m4);
+        __m256i c1 = popCountVec(loadHammingVec(a, b, i + 32), lut, m4);
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_add_epi8(c0, c1), z));
+    }
+    for( ; i < n; i += 32 )
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(popCountVec(loadHammingVec(a, b, i), lut, m4), z));
+
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    return _mm_cvtsi128_si32(s) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(s, s));
+}
+
+}
+}
@@ -41,6 +41,12 @@
 //M*/
 
 #include "precomp.hpp"
+#ifdef HAVE_DISPATCH_AVX
+#  include "avx/matmul_avx.hpp"
+#endif
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/matmul_avx2.hpp"
+#endif
 
 #ifdef HAVE_IPP
 #include "ippversion.h"
@@ -1968,6 +1974,13 @@ static void scaleAdd_32f(const float* src1, const float* src2, float* dst,
 {
     float alpha = *_alpha;
     int i = 0;
+#ifdef HAVE_DISPATCH_AVX
+    if( USE_AVX )
+    {
+        avx::scaleAdd_32f(src1, src2, dst, len, alpha);
+        return;
+    }
+#endif
 #if CV_SSE2
     if( USE_SSE2 )
     {
@@ -2665,6 +2678,10 @@ static double dotProd_8u(const uchar* src1, const uchar* src2, int len)
 #else
     int i = 0;
 
+#ifdef HAVE_DISPATCH_AVX2
+    if( USE_AVX2 )
+        return avx2::dotProd_8u(src1, src2, len);
+#endif
 #if CV_SSE2
     if( USE_SSE2 )
     {
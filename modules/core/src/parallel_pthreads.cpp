@@ -0,0 +1,382 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+#if defined HAVE_PTHREADS_PF
+
+#include <pthread.h>
+
+/* The pthreads backend keeps a persistent pool of (N-1) worker threads, the thread
+   calling parallel_for_ acts as the N-th one. Each job is split into N contiguous stripe
+   ranges (one per thread); a thread consumes its own range stripe by stripe from the front
+   and, once it is empty, steals the back half of the largest remaining range of another
+   thread. Nested calls and calls issued while the pool is busy are executed serially. */
+
+namespace cv
+{
+
+class ParallelJob
+{
+public:
+    ParallelJob(const Range& _range, const ParallelLoopBody& _body, int _nslots)
+        : body(&_body), nslots(_nslots), slots(_nslots), failed(false)
+    {
+        pthread_mutex_init(&errorMutex, 0);
+        int len = _range.end - _range.start;
+        for( int i = 0; i < nslots; i++ )
+        {
+            pthread_mutex_init(&slots[i].mutex, 0);
+            slots[i].begin = _range.start + (int)((int64)len*i/nslots);
+            slots[i].end = _range.start + (int)((int64)len*(i+1)/nslots);
+        }
+    }
+
+    ~ParallelJob()
+    {
+        for( int i = 0; i < nslots; i++ )
+            pthread_mutex_destroy(&slots[i].mutex);
+        pthread_mutex_destroy(&errorMutex);
+    }
+
+    void run(int slot)
+    {
+        try
+        {
+            for(;;)
+            {
+                int i;
+                while( !failed && (i = pop(slot)) >= 0 )
+                    (*body)(Range(i, i + 1));
+                if( failed || !steal(slot) )
+                    break;
+            }
+        }
+        catch(const cv::Exception& e)
+        {
+            setError(e);
+        }
+        catch(const std::exception& e)
+        {
+            setError(cv::Exception(CV_StsError, e.what(), "cv::parallel_for_", __FILE__, __LINE__));
+        }
+        catch(...)
+        {
+            setError(cv::Exception(CV_StsError, "Unknown exception", "cv::parallel_for_", __FILE__, __LINE__));
+        }
+    }
+
+    // the first exception thrown by the loop body is re-thrown on the calling thread
+    void rethrowError()
+    {
+        if( failed )
+            throw error;
+    }
+
+protected:
+    struct Slot
+    {
+        pthread_mutex_t mutex;
+        int begin, end;
+    };
+
+    int pop(int slot)
+    {
+        Slot& s = slots[slot];
+        int i = -1;
+        pthread_mutex_lock(&s.mutex);
+        if( s.begin < s.end )
+            i = s.begin++;
+        pthread_mutex_unlock(&s.mutex);
+        return i;
+    }
+
+    bool steal(int slot)
+    {
+        // pick the victim with the most remaining work; the sizes are read without locking,
+        // so they are re-checked under the victim's lock
+        for(;;)
+        {
+            int victim = -1, maxlen = 0;
+            for( int k = 1; k < nslots; k++ )
+            {
+                int j = (slot + k) % nslots;
+                int len = slots[j].end - slots[j].begin;
+                if( len > maxlen )
+                    maxlen = len, victim = j;
+            }
+            if( victim < 0 )
+                return false;
+
+            Slot& v = slots[victim];
+            int b = 0, e = 0;
+            pthread_mutex_lock(&v.mutex);
+            if( v.begin < v.end )
+            {
+                e = v.end;
+                b = v.end - (v.end - v.begin + 1)/2;
+                v.end = b;
+            }
+            pthread_mutex_unlock(&v.mutex);
+
+            if( b < e )
+            {
+                Slot& s = slots[slot];
+                pthread_mutex_lock(&s.mutex);
+                s.begin = b;
+                s.end = e;
+                pthread_mutex_unlock(&s.mutex);
+                return true;
+            }
+        }
+    }
+
+    void setError(const cv::Exception& e)
+    {
+        pthread_mutex_lock(&errorMutex);
+        if( !failed )
+        {
+            error = e;
+            failed = true;
+        }
+        pthread_mutex_unlock(&errorMutex);
+    }
+
+    const ParallelLoopBody* body;
+    int nslots;
+    AutoBuffer<Slot, 16> slots;
+
+    pthread_mutex_t errorMutex;
+    volatile bool failed;
+    cv::Exception error;
+};
+
+
+class ThreadPool
+{
+public:
+    ThreadPool() : nthreads(0), requestedThreads(0), job(0), generation(0), activeWorkers(0), stopping(false)
+    {
+        pthread_mutex_init(&mutex, 0);
+        pthread_mutex_init(&jobMutex, 0);
+        pthread_cond_init(&taskCond, 0);
+        pthread_cond_init(&doneCond, 0);
+        pthread_key_create(&threadIdxKey, 0);
+    }
+
+    ~ThreadPool()
+    {
+        stop();
+        pthread_key_delete(threadIdxKey);
+        pthread_cond_destroy(&doneCond);
+        pthread_cond_destroy(&taskCond);
+        pthread_mutex_destroy(&jobMutex);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    void run(const Range& range, const ParallelLoopBody& body, int nthreads_)
+    {
+        // the worker threads never re-enter the pool, and concurrent or nested jobs
+        // issued while the pool is busy are not interleaved: they just run serially
+        if( nthreads_ <= 1 || range.end - range.start <= 1 || getThreadNum() != 0 ||
+            pthread_mutex_trylock(&jobMutex) != 0 )
+        {
+            body(range);
+            return;
+        }
+
+        if( requestedThreads != nthreads_ )
+            restart(nthreads_);
+
+        ParallelJob pjob(range, body, nthreads);
+
+        pthread_mutex_lock(&mutex);
+        job = &pjob;
+        generation++;
+        pthread_cond_broadcast(&taskCond);
+        pthread_mutex_unlock(&mutex);
+
+        pjob.run(0);
+
+        pthread_mutex_lock(&mutex);
+        job = 0;
+        while( activeWorkers > 0 )
+            pthread_cond_wait(&doneCond, &mutex);
+        pthread_mutex_unlock(&mutex);
+
+        pthread_mutex_unlock(&jobMutex);
+        pjob.rethrowError();
+    }
+
+    void setNumThreads(int n)
+    {
+        // the workers are (re)started lazily by the next parallel_for_ call
+        pthread_mutex_lock(&jobMutex);
+        if( n != requestedThreads )
+            stop();
+        pthread_mutex_unlock(&jobMutex);
+    }
+
+    int getThreadNum()
+    {
+        return (int)(size_t)pthread_getspecific(threadIdxKey);
+    }
+
+protected:
+    struct WorkerArg
+    {
+        ThreadPool* pool;
+        int idx;
+    };
+
+    static void* workerProc(void* arg)
+    {
+        WorkerArg* warg = (WorkerArg*)arg;
+        warg->pool->workerLoop(warg->idx);
+        return 0;
+    }
+
+    void workerLoop(int idx)
+    {
+        pthread_setspecific(threadIdxKey, (void*)(size_t)idx);
+        unsigned seenGeneration = 0;
+
+        pthread_mutex_lock(&mutex);
+        for(;;)
+        {
+            while( !stopping && (job == 0 || generation == seenGeneration) )
+                pthread_cond_wait(&taskCond, &mutex);
+            if( stopping )
+                break;
+
+            seenGeneration = generation;
+            ParallelJob* j = job;
+            activeWorkers++;
+            pthread_mutex_unlock(&mutex);
+
+            j->run(idx);
+
+            pthread_mutex_lock(&mutex);
+            if( --activeWorkers == 0 )
+                pthread_cond_signal(&doneCond);
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+
+    void restart(int n)
+    {
+        stop();
+        requestedThreads = n;
+        workerArgs.resize(n);
+        workers.resize(n);
+        nthreads = 1;
+        for( int i = 1; i < n; i++ )
+        {
+            workerArgs[i].pool = this;
+            workerArgs[i].idx = i;
+            if( pthread_create(&workers[i], 0, workerProc, &workerArgs[i]) != 0 )
+                break;
+            nthreads++;
+        }
+    }
+
+    void stop()
+    {
+        requestedThreads = 0;
+        if( nthreads <= 1 )
+        {
+            nthreads = 0;
+            return;
+        }
+
+        pthread_mutex_lock(&mutex);
+        stopping = true;
+        pthread_cond_broadcast(&taskCond);
+        pthread_mutex_unlock(&mutex);
+
+        for( int i = 1; i < nthreads; i++ )
+            pthread_join(workers[i], 0);
+
+        stopping = false;
+        nthreads = 0;
+    }
+
+    int nthreads, requestedThreads;
+    vector<pthread_t> workers;
+    vector<WorkerArg> workerArgs;
+
+    pthread_mutex_t mutex;
+    pthread_mutex_t jobMutex;
+    pthread_cond_t taskCond;
+    pthread_cond_t doneCond;
+    pthread_key_t threadIdxKey;
+
+    ParallelJob* job;
+    unsigned generation;
+    int activeWorkers;
+    bool stopping;
+};
+
+static ThreadPool& getThreadPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, int nthreads)
+{
+    getThreadPool().run(range, body, nthreads);
+}
+
+void parallel_pthreads_set_threads_num(int nthreads)
+{
+    getThreadPool().setNumThreads(nthreads);
+}
+
+int parallel_pthreads_get_thread_num()
+{
+    return getThreadPool().getThreadNum();
+}
+
+}
+
+#endif // HAVE_PTHREADS_PF
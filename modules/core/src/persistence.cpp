@@ -47,6 +47,18 @@
 #include <iterator>
 #include <wchar.h>
 
+#if (defined WIN32 || defined _WIN32) && !defined WINCE
+#  include <windows.h>
+#  include <io.h>
+#  undef small
+#  undef min
+#  undef max
+#  undef abs
+#elif !defined WIN32 && !defined _WIN32
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
 #define USE_ZLIB 1
 
 #ifdef __APPLE__
@@ -270,9 +282,45 @@ typedef struct CvFileStorage
     std::deque<char>* outbuf;
 
     bool is_opened;
+
+    // binary format
+    struct CvFileMapping* mapping;
+    cv::Mutex* raw_seq_mutex;
+    int raw_seq_count;
+    size_t bin_pos;
+    std::vector<char>* bin_raw;
+    int bin_raw_count;
+    char bin_raw_dt[256];
 }
 CvFileStorage;
 
+/* the content of the binary file storage opened for reading; it is shared by the storage
+   and the matrices that refer to the raw data blocks, so it is reference-counted */
+typedef struct CvFileMapping
+{
+    int refcount;
+    uchar* data;
+    size_t size;
+    bool is_mapped;
+}
+CvFileMapping;
+
+/* the sequence that refers to a raw data block of a binary storage instead of storing file nodes */
+typedef struct CvFileRawSeq
+{
+    CV_SEQUENCE_FIELDS()
+    const char* dt;
+    const uchar* raw_data;
+    int raw_count;
+}
+CvFileRawSeq;
+
+static void icvBinEndStream( CvFileStorage* fs );
+static void icvReleaseFileMapping( CvFileMapping* mapping );
+static void icvFSExpandRawSeq( CvFileStorage* fs, CvFileNode* node );
+static void icvFSExpandRawSubtree( CvFileStorage* fs, CvFileNode* node );
+static int icvDecodeFormat( const char* dt, int* fmt_pairs, int max_len );
+
 static void icvPuts( CvFileStorage* fs, const char* str )
 {
     if( fs->outbuf )
@@ -360,6 +408,7 @@ static void icvRewind( CvFileStorage* fs )
 #define CV_XML_INDENT  2
 #define CV_YML_INDENT_FLOW  1
 #define CV_FS_MAX_LEN 4096
+#define CV_FS_MAX_FMT_PAIRS  128
 
 #define CV_FILE_STORAGE ('Y' + ('A' << 8) + ('M' << 16) + ('L' << 24))
 #define CV_IS_FILE_STORAGE(fs) ((fs) != 0 && (fs)->flags == CV_FILE_STORAGE)
@@ -563,9 +612,14 @@ icvClose( CvFileStorage* fs, std::string* out )
                 while( fs->write_stack->total > 0 )
                     cvEndWriteStruct(fs);
             }
-            icvFSFlush(fs);
-            if( fs->fmt == CV_STORAGE_FORMAT_XML )
-                icvPuts( fs, "</opencv_storage>\n" );
+            if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+                icvBinEndStream(fs);
+            else
+            {
+                icvFSFlush(fs);
+                if( fs->fmt == CV_STORAGE_FORMAT_XML )
+                    icvPuts( fs, "</opencv_storage>\n" );
+            }
         }
 
         icvCloseFile(fs);
@@ -599,6 +653,9 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
 
         if( fs->outbuf )
             delete fs->outbuf;
+        delete fs->bin_raw;
+        delete fs->raw_seq_mutex;
+        icvReleaseFileMapping( fs->mapping );
 
         memset( fs, 0, sizeof(*fs) );
         cvFree( &fs );
@@ -656,10 +713,10 @@ cvGetHashedKey( CvFileStorage* fs, const char* str, int len, int create_missing
 }
 
 
-CV_IMPL CvFileNode*
-cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
-               const CvStringHashNode* key,
-               int create_missing )
+static CvFileNode*
+icvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
+                const CvStringHashNode* key,
+                int create_missing )
 {
     CvFileNode* value = 0;
     int k = 0, attempts = 1;
@@ -731,8 +788,8 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
 }
 
 
-CV_IMPL CvFileNode*
-cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+static CvFileNode*
+icvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
 {
     CvFileNode* value = 0;
     int i, len, tab_size;
@@ -802,8 +859,8 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
 }
 
 
-CV_IMPL CvFileNode*
-cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
+static CvFileNode*
+icvGetRootFileNode( const CvFileStorage* fs, int stream_index )
 {
     CV_CHECK_FILE_STORAGE(fs);
 
@@ -814,6 +871,60 @@ cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
 }
 
 
+/* The C API gives access to the file nodes, and the callers read the sequences
+   of the nodes directly (cvGetSeqElem(), cvStartReadSeq() etc.). So, before
+   a node is returned by it, the raw data blocks inside of the node are
+   converted to the regular sequences. The C++ API and the readers below use
+   the internal functions above and keep the blocks as they are. */
+
+CV_IMPL CvFileNode*
+cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
+               const CvStringHashNode* key,
+               int create_missing )
+{
+    CvFileNode* node = icvGetFileNode( fs, _map_node, key, create_missing );
+    if( node && fs->raw_seq_count > 0 )
+        icvFSExpandRawSubtree( fs, node );
+    return node;
+}
+
+
+CV_IMPL CvFileNode*
+cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const char* str )
+{
+    CvFileNode* node = icvGetFileNodeByName( fs, _map_node, str );
+    if( node && fs->raw_seq_count > 0 )
+        icvFSExpandRawSubtree( (CvFileStorage*)fs, node );
+    return node;
+}
+
+
+CV_IMPL CvFileNode*
+cvGetRootFileNode( const CvFileStorage* fs, int stream_index )
+{
+    CvFileNode* node = icvGetRootFileNode( fs, stream_index );
+    if( node && fs->raw_seq_count > 0 )
+        icvFSExpandRawSubtree( (CvFileStorage*)fs, node );
+    return node;
+}
+
+
+static inline int
+icvReadIntByName( const CvFileStorage* fs, const CvFileNode* map,
+                  const char* name, int default_value )
+{
+    return cvReadInt( icvGetFileNodeByName( fs, map, name ), default_value );
+}
+
+
+static inline const char*
+icvReadStringByName( const CvFileStorage* fs, const CvFileNode* map,
+                     const char* name, const char* default_value )
+{
+    return cvReadString( icvGetFileNodeByName( fs, map, name ), default_value );
+}
+
+
 /* returns the sequence element by its index */
 /*CV_IMPL CvFileNode*
 cvGetFileNodeFromSeq( CvFileStorage* fs,
@@ -1057,7 +1168,7 @@ icvYMLParseKey( CvFileStorage* fs, char* ptr,
         CV_PARSE_ERROR( "An empty key" );
 
     str_hash_node = cvGetHashedKey( fs, ptr, (int)(endptr - ptr), 1 );
-    *value_placeholder = cvGetFileNode( fs, map_node, str_hash_node, 1 );
+    *value_placeholder = icvGetFileNode( fs, map_node, str_hash_node, 1 );
     ptr = saveptr;
 
     return ptr;
@@ -1929,7 +2040,7 @@ icvXMLParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node,
             if( is_noname )
                 elem = (CvFileNode*)cvSeqPush( node->data.seq, 0 );
             else
-                elem = cvGetFileNode( fs, node, key, 1 );
+                elem = icvGetFileNode( fs, node, key, 1 );
 
             ptr = icvXMLParseValue( fs, ptr, elem, elem_type);
             if( !is_noname )
@@ -2512,171 +2623,1032 @@ icvXMLWriteScalar( CvFileStorage* fs, const char* key, const char* data, int len
 
 
 static void
-icvXMLWriteInt( CvFileStorage* fs, const char* key, int value )
+icvXMLWriteInt( CvFileStorage* fs, const char* key, int value )
+{
+    char buf[128], *ptr = icv_itoa( value, buf, 10 );
+    int len = (int)strlen(ptr);
+    icvXMLWriteScalar( fs, key, ptr, len );
+}
+
+
+static void
+icvXMLWriteReal( CvFileStorage* fs, const char* key, double value )
+{
+    char buf[128];
+    int len = (int)strlen( icvDoubleToString( buf, value ));
+    icvXMLWriteScalar( fs, key, buf, len );
+}
+
+
+static void
+icvXMLWriteString( CvFileStorage* fs, const char* key, const char* str, int quote )
+{
+    char buf[CV_FS_MAX_LEN*6+16];
+    char* data = (char*)str;
+    int i, len;
+
+    if( !str )
+        CV_Error( CV_StsNullPtr, "Null string pointer" );
+
+    len = (int)strlen(str);
+    if( len > CV_FS_MAX_LEN )
+        CV_Error( CV_StsBadArg, "The written string is too long" );
+
+    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
+    {
+        int need_quote = quote || len == 0;
+        data = buf;
+        *data++ = '\"';
+        for( i = 0; i < len; i++ )
+        {
+            char c = str[i];
+
+            if( (uchar)c >= 128 || c == ' ' )
+            {
+                *data++ = c;
+                need_quote = 1;
+            }
+            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
+            {
+                *data++ = '&';
+                if( c == '<' )
+                {
+                    memcpy(data, "lt", 2);
+                    data += 2;
+                }
+                else if( c == '>' )
+                {
+                    memcpy(data, "gt", 2);
+                    data += 2;
+                }
+                else if( c == '&' )
+                {
+                    memcpy(data, "amp", 3);
+                    data += 3;
+                }
+                else if( c == '\'' )
+                {
+                    memcpy(data, "apos", 4);
+                    data += 4;
+                }
+                else if( c == '\"' )
+                {
+                    memcpy( data, "quot", 4);
+                    data += 4;
+                }
+                else
+                {
+                    sprintf( data, "#x%02x", (uchar)c );
+                    data += 4;
+                }
+                *data++ = ';';
+                need_quote = 1;
+            }
+            else
+                *data++ = c;
+        }
+        if( !need_quote && (cv_isdigit(str[0]) ||
+            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
+            need_quote = 1;
+
+        if( need_quote )
+            *data++ = '\"';
+        len = (int)(data - buf) - !need_quote;
+        *data++ = '\0';
+        data = buf + !need_quote;
+    }
+
+    icvXMLWriteScalar( fs, key, data, len );
+}
+
+
+static void
+icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+{
+    int len;
+    int multiline;
+    const char* eol;
+    char* ptr;
+
+    if( !comment )
+        CV_Error( CV_StsNullPtr, "Null comment" );
+
+    if( strstr(comment, "--") != 0 )
+        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
+
+    len = (int)strlen(comment);
+    eol = strchr(comment, '\n');
+    multiline = eol != 0;
+    ptr = fs->buffer;
+
+    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
+        ptr = icvXMLFlush( fs );
+    else if( ptr > fs->buffer_start + fs->struct_indent )
+        *ptr++ = ' ';
+
+    if( !multiline )
+    {
+        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
+        sprintf( ptr, "<!-- %s -->", comment );
+        len = (int)strlen(ptr);
+    }
+    else
+    {
+        strcpy( ptr, "<!--" );
+        len = 4;
+    }
+
+    fs->buffer = ptr + len;
+    ptr = icvXMLFlush(fs);
+
+    if( multiline )
+    {
+        while( comment )
+        {
+            if( eol )
+            {
+                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
+                memcpy( ptr, comment, eol - comment + 1 );
+                ptr += eol - comment;
+                comment = eol + 1;
+                eol = strchr( comment, '\n' );
+            }
+            else
+            {
+                len = (int)strlen(comment);
+                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
+                memcpy( ptr, comment, len );
+                ptr += len;
+                comment = 0;
+            }
+            fs->buffer = ptr;
+            ptr = icvXMLFlush( fs );
+        }
+        sprintf( ptr, "-->" );
+        fs->buffer = ptr + 3;
+        icvXMLFlush( fs );
+    }
+}
+
+
+/****************************************************************************************\
+*                                     Binary Format                                      *
+\****************************************************************************************/
+
+/*
+   The binary storage starts with CV_BIN_SIGNATURE followed by the 32-bit byte order mark.
+   Then the streams follow, each of them is a collection. Every node is stored as
+   the 1-byte tag (CV_NODE_INT, CV_NODE_REAL, CV_NODE_STR, CV_NODE_SEQ, CV_NODE_MAP or CV_BIN_RAW),
+   the key (only inside maps) and the value:
+
+     int        - 32-bit integer
+     real       - 64-bit floating-point number
+     string     - 32-bit length + characters (also used for the keys and the type names)
+     collection - the type name + the elements + CV_BIN_END tag
+     raw data   - the format (dt) + 32-bit number of elements + padding + the data,
+                  written by cvWriteRawData(). The data starts at CV_BIN_ALIGN-aligned
+                  offset in the file, so when the file is memory-mapped, the matrices can refer
+                  to it directly.
+
+   The numbers are stored in the native byte order.
+*/
+
+#define CV_BIN_SIGNATURE "%BINARY:1.0\n"
+#define CV_BIN_BYTE_ORDER 0x01020304
+#define CV_BIN_HEADER_SIZE 16
+#define CV_BIN_ALIGN 64
+#define CV_BIN_END 0
+#define CV_BIN_RAW 7
+
+// iterates through the scalars of raw data, laid out as in cvWriteRawData() and cvReadRawDataSlice()
+typedef struct CvRawDataCursor
+{
+    const int* fmt_pairs;
+    int fmt_pair_count;
+    int k, i;
+    size_t offset;
+}
+CvRawDataCursor;
+
+static void
+icvInitRawDataCursor( CvRawDataCursor* cursor, const int* fmt_pairs, int fmt_pair_count, int pos )
+{
+    cursor->fmt_pairs = fmt_pairs;
+    cursor->fmt_pair_count = fmt_pair_count;
+    cursor->k = cursor->i = 0;
+    cursor->offset = 0;
+
+    if( fmt_pair_count == 1 )
+    {
+        cursor->i = pos % fmt_pairs[0];
+        cursor->offset = (size_t)pos*CV_ELEM_SIZE(fmt_pairs[1]);
+    }
+    else
+    {
+        for( ; pos > 0; pos-- )
+        {
+            int elem_size = CV_ELEM_SIZE(fmt_pairs[cursor->k*2+1]);
+            if( cursor->i == 0 )
+                cursor->offset = cv::alignSize(cursor->offset, elem_size);
+            cursor->offset += elem_size;
+            if( ++cursor->i == fmt_pairs[cursor->k*2] )
+            {
+                cursor->i = 0;
+                if( ++cursor->k == fmt_pair_count )
+                    cursor->k = 0;
+            }
+        }
+    }
+}
+
+// returns the offset of the current scalar and moves the cursor to the next one
+static size_t
+icvNextRawDataScalar( CvRawDataCursor* cursor, int* elem_type )
+{
+    int type = cursor->fmt_pairs[cursor->k*2+1];
+    int elem_size = CV_ELEM_SIZE(type);
+    size_t offset;
+
+    if( cursor->i == 0 )
+        cursor->offset = cv::alignSize(cursor->offset, elem_size);
+    offset = cursor->offset;
+    cursor->offset += elem_size;
+    if( ++cursor->i == cursor->fmt_pairs[cursor->k*2] )
+    {
+        cursor->i = 0;
+        if( ++cursor->k == cursor->fmt_pair_count )
+            cursor->k = 0;
+    }
+    *elem_type = type;
+    return offset;
+}
+
+// returns the size of len records of raw data
+static size_t
+icvCalcRawDataSize( const int* fmt_pairs, int fmt_pair_count, int len )
+{
+    if( fmt_pair_count == 1 )
+        return (size_t)len*fmt_pairs[0]*CV_ELEM_SIZE(fmt_pairs[1]);
+
+    CvRawDataCursor cursor;
+    int i, cn = 0, elem_type;
+    for( i = 0; i < fmt_pair_count; i++ )
+        cn += fmt_pairs[i*2];
+    icvInitRawDataCursor( &cursor, fmt_pairs, fmt_pair_count, 0 );
+    for( i = 0; i < len*cn; i++ )
+        icvNextRawDataScalar( &cursor, &elem_type );
+    return cursor.offset;
+}
+
+// converts a scalar of raw data to the file node
+static void
+icvLoadRawScalar( const uchar* ptr, int elem_type, CvFileNode* node )
+{
+    node->tag = CV_NODE_INT;
+    node->info = 0;
+
+    switch( elem_type )
+    {
+    case CV_8U:
+        node->data.i = *ptr;
+        break;
+    case CV_8S:
+        node->data.i = *(const schar*)ptr;
+        break;
+    case CV_16U:
+        node->data.i = *(const ushort*)ptr;
+        break;
+    case CV_16S:
+        node->data.i = *(const short*)ptr;
+        break;
+    case CV_32S:
+        node->data.i = *(const int*)ptr;
+        break;
+    case CV_32F:
+        node->tag = CV_NODE_REAL;
+        node->data.f = *(const float*)ptr;
+        break;
+    case CV_64F:
+        node->tag = CV_NODE_REAL;
+        node->data.f = *(const double*)ptr;
+        break;
+    case CV_USRTYPE1: /* reference */
+        node->data.i = (int)*(const size_t*)ptr;
+        break;
+    default:
+        CV_Error( CV_StsBadArg, "Unsupported type of raw data" );
+    }
+}
+
+// converts the numerical file node to a scalar of raw data
+static void
+icvStoreRawScalar( const CvFileNode* node, int elem_type, char* data )
+{
+    if( CV_NODE_IS_INT(node->tag) )
+    {
+        int ival = node->data.i;
+
+        switch( elem_type )
+        {
+        case CV_8U:
+            *(uchar*)data = CV_CAST_8U(ival);
+            break;
+        case CV_8S:
+            *(char*)data = CV_CAST_8S(ival);
+            break;
+        case CV_16U:
+            *(ushort*)data = CV_CAST_16U(ival);
+            break;
+        case CV_16S:
+            *(short*)data = CV_CAST_16S(ival);
+            break;
+        case CV_32S:
+            *(int*)data = ival;
+            break;
+        case CV_32F:
+            *(float*)data = (float)ival;
+            break;
+        case CV_64F:
+            *(double*)data = (double)ival;
+            break;
+        case CV_USRTYPE1: /* reference */
+            *(size_t*)data = ival;
+            break;
+        default:
+            assert(0);
+        }
+    }
+    else if( CV_NODE_IS_REAL(node->tag) )
+    {
+        double fval = node->data.f;
+        int ival;
+
+        switch( elem_type )
+        {
+        case CV_8U:
+            ival = cvRound(fval);
+            *(uchar*)data = CV_CAST_8U(ival);
+            break;
+        case CV_8S:
+            ival = cvRound(fval);
+            *(char*)data = CV_CAST_8S(ival);
+            break;
+        case CV_16U:
+            ival = cvRound(fval);
+            *(ushort*)data = CV_CAST_16U(ival);
+            break;
+        case CV_16S:
+            ival = cvRound(fval);
+            *(short*)data = CV_CAST_16S(ival);
+            break;
+        case CV_32S:
+            ival = cvRound(fval);
+            *(int*)data = ival;
+            break;
+        case CV_32F:
+            *(float*)data = (float)fval;
+            break;
+        case CV_64F:
+            *(double*)data = fval;
+            break;
+        case CV_USRTYPE1: /* reference */
+            ival = cvRound(fval);
+            *(size_t*)data = ival;
+            break;
+        default:
+            assert(0);
+        }
+    }
+    else
+        CV_Error( CV_StsError,
+        "The sequence element is not a numerical scalar" );
+}
+
+// appends the scalars of raw data to the sequence of file nodes
+static void
+icvExpandRawData( CvSeq* seq, const char* dt, const uchar* data, int len )
+{
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count, i, total, elem_type;
+    CvRawDataCursor cursor;
+
+    fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+    for( i = 0, total = 0; i < fmt_pair_count; i++ )
+        total += fmt_pairs[i*2];
+    total *= len;
+
+    icvInitRawDataCursor( &cursor, fmt_pairs, fmt_pair_count, 0 );
+    for( i = 0; i < total; i++ )
+    {
+        size_t offset = icvNextRawDataScalar( &cursor, &elem_type );
+        icvLoadRawScalar( data + offset, elem_type, (CvFileNode*)cvSeqPush( seq, 0 ));
+    }
+}
+
+/* replaces the raw data block with the regular sequence of file nodes.
+   It is done when the sequence elements are accessed individually. The storage
+   may be read from several threads, so the conversion is done under the lock and
+   the node is switched to the new sequence only when the sequence is complete. */
+static void
+icvFSExpandRawSeq( CvFileStorage* fs, CvFileNode* node )
+{
+    cv::AutoLock lock( *fs->raw_seq_mutex );
+
+    if( !CV_NODE_SEQ_IS_BINARY(node->data.seq) )
+        return;
+
+    const CvFileRawSeq* raw_seq = (const CvFileRawSeq*)node->data.seq;
+    CvSeq* seq = cvCreateSeq( 0, sizeof(CvSeq), sizeof(CvFileNode), fs->memstorage );
+
+    icvExpandRawData( seq, raw_seq->dt, raw_seq->raw_data, raw_seq->raw_count );
+    seq->flags |= CV_NODE_SEQ_SIMPLE;
+
+    // CV_XADD is a full memory barrier, so the sequence is written out before it is published
+    CV_XADD( &fs->raw_seq_count, -1 );
+    node->data.seq = seq;
+}
+
+static void
+icvFSExpandRawSubtree( CvFileStorage* fs, CvFileNode* node )
+{
+    if( !CV_NODE_IS_COLLECTION(node->tag) )
+        return;
+
+    CvSeq* seq = node->data.seq;
+    if( CV_NODE_IS_SEQ(node->tag) && CV_NODE_SEQ_IS_BINARY(seq) )
+    {
+        // the raw data block consists of numbers only
+        icvFSExpandRawSeq( fs, node );
+        return;
+    }
+
+    int i, total = seq->total, elem_size = seq->elem_size;
+    CvSeqReader reader;
+
+    cvStartReadSeq( seq, &reader, 0 );
+    for( i = 0; i < total; i++ )
+    {
+        if( !CV_NODE_IS_MAP(node->tag) || CV_IS_SET_ELEM(reader.ptr) )
+            icvFSExpandRawSubtree( fs, CV_NODE_IS_MAP(node->tag) ?
+                                   &((CvFileMapNode*)reader.ptr)->value : (CvFileNode*)reader.ptr );
+        CV_NEXT_SEQ_ELEM( elem_size, reader );
+    }
+}
+
+
+static CvFileMapping*
+icvMapFile( CvFileStorage* fs )
+{
+    CvFileMapping* mapping = new CvFileMapping;
+    mapping->refcount = 1;
+    mapping->data = 0;
+    mapping->size = 0;
+    mapping->is_mapped = false;
+
+    // map the file, so that the raw data blocks can be used without copying
+#if (defined WIN32 || defined _WIN32) && !defined WINCE
+    if( fs->file )
+    {
+        HANDLE file = (HANDLE)_get_osfhandle(_fileno(fs->file));
+        LARGE_INTEGER size;
+        if( file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+            (unsigned long long)size.QuadPart <= (unsigned long long)(size_t)-1 )
+        {
+            HANDLE file_mapping = CreateFileMapping(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+            if( file_mapping )
+            {
+                mapping->data = (uchar*)MapViewOfFile(file_mapping, FILE_MAP_COPY, 0, 0, 0);
+                mapping->size = (size_t)size.QuadPart;
+                mapping->is_mapped = mapping->data != 0;
+                CloseHandle(file_mapping);
+            }
+        }
+    }
+#elif !defined WIN32 && !defined _WIN32
+    if( fs->file )
+    {
+        struct stat st;
+        int fd = fileno(fs->file);
+        if( fstat(fd, &st) == 0 && st.st_size > 0 && (unsigned long long)st.st_size <= (unsigned long long)(size_t)-1 )
+        {
+            // the pages are private and writable, so that the matrices referring to them can be modified
+            void* ptr = mmap(0, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if( ptr != MAP_FAILED )
+            {
+                mapping->data = (uchar*)ptr;
+                mapping->size = (size_t)st.st_size;
+                mapping->is_mapped = true;
+            }
+        }
+    }
+#endif
+
+    if( !mapping->is_mapped )
+    {
+        // compressed or not mappable files are read into the memory
+        std::vector<uchar> buf;
+        size_t len = 0, chunk = 1 << 20;
+        FILE* file = fs->file ? fopen( fs->filename, "rb" ) : 0;
+
+        for(;;)
+        {
+            size_t count = 0;
+            buf.resize( len + chunk );
+            if( file )
+                count = fread( &buf[len], 1, chunk, file );
+#if USE_ZLIB
+            else if( fs->gzfile )
+            {
+                int gzcount = gzread( fs->gzfile, &buf[len], (unsigned)chunk );
+                count = gzcount > 0 ? (size_t)gzcount : 0;
+            }
+#endif
+            len += count;
+            if( count < chunk )
+                break;
+        }
+        if( file )
+            fclose( file );
+
+        mapping->data = (uchar*)cvAlloc( std::max(len, (size_t)1) );
+        if( len > 0 )
+            memcpy( mapping->data, &buf[0], len );
+        mapping->size = len;
+    }
+
+    return mapping;
+}
+
+
+static void
+icvReleaseFileMapping( CvFileMapping* mapping )
+{
+    if( mapping && CV_XADD(&mapping->refcount, -1) == 1 )
+    {
+        if( !mapping->is_mapped )
+            cvFree( &mapping->data );
+#if (defined WIN32 || defined _WIN32) && !defined WINCE
+        else
+            UnmapViewOfFile( mapping->data );
+#elif !defined WIN32 && !defined _WIN32
+        else
+            munmap( mapping->data, mapping->size );
+#endif
+        delete mapping;
+    }
+}
+
+
+/****************************************************************************************\
+*                                     Binary Parser                                      *
+\****************************************************************************************/
+
+static const uchar*
+icvBinReadBytes( CvFileStorage* fs, const uchar* ptr, void* dst, size_t len )
+{
+    if( (size_t)(fs->mapping->data + fs->mapping->size - ptr) < len )
+        CV_PARSE_ERROR( "Unexpected end of file" );
+    memcpy( dst, ptr, len );
+    return ptr + len;
+}
+
+
+static const uchar*
+icvBinReadString( CvFileStorage* fs, const uchar* ptr, const char** str, int* len )
+{
+    ptr = icvBinReadBytes( fs, ptr, len, sizeof(*len) );
+    if( *len < 0 || (size_t)(fs->mapping->data + fs->mapping->size - ptr) < (size_t)*len )
+        CV_PARSE_ERROR( "Invalid string length" );
+    *str = (const char*)ptr;
+    return ptr + *len;
+}
+
+
+static const uchar*
+icvBinParseRawData( CvFileStorage* fs, const uchar* ptr, CvFileNode* node )
+{
+    int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], fmt_pair_count;
+    int i, len = 0, count = 0, cn = 0;
+    const uchar* end = fs->mapping->data + fs->mapping->size;
+    const char* str = 0;
+    CvString dt;
+    size_t size;
+
+    ptr = icvBinReadString( fs, ptr, &str, &len );
+    if( len <= 0 || len > CV_FS_MAX_LEN )
+        CV_PARSE_ERROR( "Invalid format of the raw data" );
+    dt = cvMemStorageAllocString( fs->memstorage, str, len );
+    fmt_pair_count = icvDecodeFormat( dt.ptr, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
+    for( i = 0; i < fmt_pair_count; i++ )
+        cn += fmt_pairs[i*2];
+
+    ptr = icvBinReadBytes( fs, ptr, &count, sizeof(count) );
+    if( count < 0 || (cn > 0 && count > INT_MAX/cn) )
+        CV_PARSE_ERROR( "Invalid size of the raw data" );
+
+    ptr = fs->mapping->data + cv::alignSize( (size_t)(ptr - fs->mapping->data), CV_BIN_ALIGN );
+    size = icvCalcRawDataSize( fmt_pairs, fmt_pair_count, count );
+    if( ptr > end || (size_t)(end - ptr) < size )
+        CV_PARSE_ERROR( "Unexpected end of file" );
+
+    if( node->data.seq->total == 0 && (size_t)(end - ptr) > size && ptr[size] == CV_BIN_END )
+    {
+        // the whole sequence is a single raw data block, so refer to it instead of converting the data to file nodes
+        CvFileRawSeq* seq = (CvFileRawSeq*)cvMemStorageAlloc( fs->memstorage, sizeof(CvFileRawSeq) );
+        memset( seq, 0, sizeof(*seq) );
+        seq->flags = CV_SEQ_MAGIC_VAL | CV_NODE_SEQ_SIMPLE | CV_NODE_SEQ_BINARY;
+        seq->header_size = sizeof(CvFileRawSeq);
+        seq->elem_size = sizeof(CvFileNode);
+        seq->total = count*cn;
+        seq->storage = fs->memstorage;
+        seq->dt = dt.ptr;
+        seq->raw_data = ptr;
+        seq->raw_count = count;
+        node->data.seq = (CvSeq*)seq;
+        fs->raw_seq_count++;
+    }
+    else
+        icvExpandRawData( node->data.seq, dt.ptr, ptr, count );
+
+    return ptr + size;
+}
+
+
+static const uchar*
+icvBinParseValue( CvFileStorage* fs, const uchar* ptr, CvFileNode* node, int tag )
+{
+    const char* str = 0;
+    int len = 0;
+
+    memset( node, 0, sizeof(*node) );
+
+    if( CV_NODE_IS_INT(tag) )
+    {
+        node->tag = CV_NODE_INT;
+        ptr = icvBinReadBytes( fs, ptr, &node->data.i, sizeof(node->data.i) );
+    }
+    else if( CV_NODE_IS_REAL(tag) )
+    {
+        node->tag = CV_NODE_REAL;
+        ptr = icvBinReadBytes( fs, ptr, &node->data.f, sizeof(node->data.f) );
+    }
+    else if( CV_NODE_IS_STRING(tag) )
+    {
+        ptr = icvBinReadString( fs, ptr, &str, &len );
+        node->tag = CV_NODE_STRING;
+        node->data.str = cvMemStorageAllocString( fs->memstorage, str, len );
+    }
+    else if( CV_NODE_IS_COLLECTION(tag) && CV_NODE_TYPE(tag) != CV_BIN_RAW )
+    {
+        int struct_type = CV_NODE_TYPE(tag), is_simple = 1;
+
+        ptr = icvBinReadString( fs, ptr, &str, &len );
+        if( len > 0 )
+        {
+            char type_name[CV_FS_MAX_LEN + 1];
+            if( len > CV_FS_MAX_LEN )
+                CV_PARSE_ERROR( "Too long type name" );
+            memcpy( type_name, str, len );
+            type_name[len] = '\0';
+            node->info = cvFindType( type_name );
+        }
+
+        icvFSCreateCollection( fs, struct_type + (node->info ? CV_NODE_USER : 0), node );
+
+        for(;;)
+        {
+            CvFileNode* elem = 0;
+            uchar elem_tag = 0;
+
+            ptr = icvBinReadBytes( fs, ptr, &elem_tag, 1 );
+            if( elem_tag == CV_BIN_END )
+                break;
+
+            if( elem_tag == CV_BIN_RAW )
+            {
+                if( struct_type != CV_NODE_SEQ || CV_NODE_SEQ_IS_BINARY(node->data.seq) )
+                    CV_PARSE_ERROR( "Raw data may only be stored in a sequence" );
+                ptr = icvBinParseRawData( fs, ptr, node );
+                continue;
+            }
+
+            if( struct_type == CV_NODE_MAP )
+            {
+                ptr = icvBinReadString( fs, ptr, &str, &len );
+                if( len == 0 )
+                    CV_PARSE_ERROR( "An empty key" );
+                elem = icvGetFileNode( fs, node, cvGetHashedKey( fs, str, len, 1 ), 1 );
+            }
+            else
+                elem = (CvFileNode*)cvSeqPush( node->data.seq, 0 );
+
+            ptr = icvBinParseValue( fs, ptr, elem, elem_tag );
+            if( struct_type == CV_NODE_MAP )
+                elem->tag |= CV_NODE_NAMED;
+            is_simple &= !CV_NODE_IS_COLLECTION(elem->tag);
+        }
+        node->data.seq->flags |= is_simple ? CV_NODE_SEQ_SIMPLE : 0;
+    }
+    else
+        CV_PARSE_ERROR( "Invalid node type" );
+
+    return ptr;
+}
+
+
+static void
+icvBinParse( CvFileStorage* fs )
+{
+    const uchar *ptr, *end;
+    int byte_order = 0;
+
+    fs->mapping = icvMapFile( fs );
+    fs->raw_seq_mutex = new cv::Mutex;
+    ptr = fs->mapping->data;
+    end = ptr + fs->mapping->size;
+
+    if( fs->mapping->size < CV_BIN_HEADER_SIZE ||
+        memcmp( ptr, CV_BIN_SIGNATURE, strlen(CV_BIN_SIGNATURE) ) != 0 )
+        CV_PARSE_ERROR( "Invalid binary storage header" );
+    memcpy( &byte_order, ptr + strlen(CV_BIN_SIGNATURE), sizeof(byte_order) );
+    if( byte_order != CV_BIN_BYTE_ORDER )
+        CV_PARSE_ERROR( "The binary storage has been written on a machine with different byte order" );
+
+    for( ptr += CV_BIN_HEADER_SIZE; ptr < end; )
+    {
+        uchar tag = *ptr++;
+        if( !CV_NODE_IS_MAP(tag) && !CV_NODE_IS_SEQ(tag) )
+            CV_PARSE_ERROR( "Only collections as binary storage streams are supported" );
+        ptr = icvBinParseValue( fs, ptr, (CvFileNode*)cvSeqPush( fs->roots, 0 ), tag );
+    }
+}
+
+
+/****************************************************************************************\
+*                                     Binary Emitter                                     *
+\****************************************************************************************/
+
+static void
+icvBinWrite( CvFileStorage* fs, const void* data, size_t len )
+{
+    const char* ptr = (const char*)data;
+
+    if( fs->outbuf )
+        std::copy( ptr, ptr + len, std::back_inserter(*fs->outbuf) );
+    else if( fs->file )
+    {
+        if( fwrite( ptr, 1, len, fs->file ) != len )
+            CV_Error( CV_StsError, "Could not write data to the file storage" );
+    }
+#if USE_ZLIB
+    else if( fs->gzfile )
+    {
+        for( size_t ofs = 0; ofs < len; )
+        {
+            unsigned chunk = (unsigned)std::min(len - ofs, (size_t)1 << 30);
+            if( gzwrite( fs->gzfile, ptr + ofs, chunk ) != (int)chunk )
+                CV_Error( CV_StsError, "Could not write data to the file storage" );
+            ofs += chunk;
+        }
+    }
+#endif
+    else
+        CV_Error( CV_StsError, "The storage is not opened" );
+
+    fs->bin_pos += len;
+}
+
+
+static void
+icvBinWriteString( CvFileStorage* fs, const char* str, int len )
+{
+    icvBinWrite( fs, &len, sizeof(len) );
+    if( len > 0 )
+        icvBinWrite( fs, str, len );
+}
+
+
+static void
+icvBinFlushRawData( CvFileStorage* fs )
+{
+    static const char zeros[CV_BIN_ALIGN] = {0};
+    uchar tag = CV_BIN_RAW;
+
+    if( fs->bin_raw_count == 0 )
+        return;
+
+    icvBinWrite( fs, &tag, 1 );
+    icvBinWriteString( fs, fs->bin_raw_dt, (int)strlen(fs->bin_raw_dt) );
+    icvBinWrite( fs, &fs->bin_raw_count, sizeof(fs->bin_raw_count) );
+    icvBinWrite( fs, zeros, cv::alignSize(fs->bin_pos, CV_BIN_ALIGN) - fs->bin_pos );
+    icvBinWrite( fs, &(*fs->bin_raw)[0], fs->bin_raw->size() );
+
+    std::vector<char>().swap( *fs->bin_raw );
+    fs->bin_raw_count = 0;
+}
+
+
+// checks that the node may be added to the current collection and opens the root collection if needed
+static void
+icvBinStartNode( CvFileStorage* fs, const char* key )
+{
+    int struct_flags = fs->struct_flags;
+
+    icvBinFlushRawData( fs );
+
+    if( !CV_NODE_IS_COLLECTION(struct_flags) )
+    {
+        // the type of the stream root is defined by the first element
+        uchar tag = (uchar)(key ? CV_NODE_MAP : CV_NODE_SEQ);
+        icvBinWrite( fs, &tag, 1 );
+        icvBinWriteString( fs, 0, 0 );
+        struct_flags = tag;
+        fs->is_first = 0;
+    }
+    else if( CV_NODE_IS_MAP(struct_flags) ^ (key != 0) )
+        CV_Error( CV_StsBadArg, "An attempt to add element without a key to a map, "
+                                "or add element with key to sequence" );
+
+    fs->struct_flags = struct_flags & ~CV_NODE_EMPTY;
+}
+
+
+static void
+icvBinWriteNodeHeader( CvFileStorage* fs, const char* key, int tag )
+{
+    uchar ctag = (uchar)tag;
+    int keylen = 0;
+
+    if( key && key[0] == '\0' )
+        key = 0;
+    if( key )
+    {
+        keylen = (int)strlen(key);
+        if( keylen > CV_FS_MAX_LEN )
+            CV_Error( CV_StsBadArg, "The key is too long" );
+    }
+
+    icvBinStartNode( fs, key );
+    icvBinWrite( fs, &ctag, 1 );
+    if( key )
+        icvBinWriteString( fs, key, keylen );
+}
+
+
+static void
+icvBinStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
+                        const char* type_name CV_DEFAULT(0))
+{
+    int parent_flags;
+
+    struct_flags = (struct_flags & (CV_NODE_TYPE_MASK|CV_NODE_FLOW)) | CV_NODE_EMPTY;
+    if( !CV_NODE_IS_COLLECTION(struct_flags))
+        CV_Error( CV_StsBadArg,
+        "Some collection type - CV_NODE_SEQ or CV_NODE_MAP, must be specified" );
+
+    icvBinWriteNodeHeader( fs, key, struct_flags & ~CV_NODE_EMPTY );
+    icvBinWriteString( fs, type_name, type_name ? (int)strlen(type_name) : 0 );
+
+    parent_flags = fs->struct_flags;
+    cvSeqPush( fs->write_stack, &parent_flags );
+    fs->struct_flags = struct_flags;
+}
+
+
+static void
+icvBinEndWriteStruct( CvFileStorage* fs )
+{
+    int parent_flags = 0;
+    uchar tag = CV_BIN_END;
+
+    if( fs->write_stack->total == 0 )
+        CV_Error( CV_StsError, "EndWriteStruct w/o matching StartWriteStruct" );
+
+    icvBinFlushRawData( fs );
+    icvBinWrite( fs, &tag, 1 );
+
+    cvSeqPop( fs->write_stack, &parent_flags );
+    fs->struct_flags = parent_flags;
+}
+
+
+static void
+icvBinEndStream( CvFileStorage* fs )
+{
+    while( fs->write_stack->total > 0 )
+        icvBinEndWriteStruct(fs);
+
+    if( CV_NODE_IS_COLLECTION(fs->struct_flags) )
+    {
+        uchar tag = CV_BIN_END;
+        icvBinFlushRawData( fs );
+        icvBinWrite( fs, &tag, 1 );
+    }
+    fs->struct_flags = CV_NODE_EMPTY;
+}
+
+
+static void
+icvBinStartNextStream( CvFileStorage* fs )
 {
-    char buf[128], *ptr = icv_itoa( value, buf, 10 );
-    int len = (int)strlen(ptr);
-    icvXMLWriteScalar( fs, key, ptr, len );
+    icvBinEndStream( fs );
 }
 
 
 static void
-icvXMLWriteReal( CvFileStorage* fs, const char* key, double value )
+icvBinWriteInt( CvFileStorage* fs, const char* key, int value )
 {
-    char buf[128];
-    int len = (int)strlen( icvDoubleToString( buf, value ));
-    icvXMLWriteScalar( fs, key, buf, len );
+    icvBinWriteNodeHeader( fs, key, CV_NODE_INT );
+    icvBinWrite( fs, &value, sizeof(value) );
 }
 
 
 static void
-icvXMLWriteString( CvFileStorage* fs, const char* key, const char* str, int quote )
+icvBinWriteReal( CvFileStorage* fs, const char* key, double value )
 {
-    char buf[CV_FS_MAX_LEN*6+16];
-    char* data = (char*)str;
-    int i, len;
+    icvBinWriteNodeHeader( fs, key, CV_NODE_REAL );
+    icvBinWrite( fs, &value, sizeof(value) );
+}
 
-    if( !str )
-        CV_Error( CV_StsNullPtr, "Null string pointer" );
 
-    len = (int)strlen(str);
-    if( len > CV_FS_MAX_LEN )
-        CV_Error( CV_StsBadArg, "The written string is too long" );
+static void
+icvBinWriteString( CvFileStorage* fs, const char* key, const char* str, int /*quote*/ )
+{
+    icvBinWriteNodeHeader( fs, key, CV_NODE_STRING );
+    icvBinWriteString( fs, str, str ? (int)strlen(str) : 0 );
+}
 
-    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
-    {
-        int need_quote = quote || len == 0;
-        data = buf;
-        *data++ = '\"';
-        for( i = 0; i < len; i++ )
-        {
-            char c = str[i];
 
-            if( (uchar)c >= 128 || c == ' ' )
-            {
-                *data++ = c;
-                need_quote = 1;
-            }
-            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
-            {
-                *data++ = '&';
-                if( c == '<' )
-                {
-                    memcpy(data, "lt", 2);
-                    data += 2;
-                }
-                else if( c == '>' )
-                {
-                    memcpy(data, "gt", 2);
-                    data += 2;
-                }
-                else if( c == '&' )
-                {
-                    memcpy(data, "amp", 3);
-                    data += 3;
-                }
-                else if( c == '\'' )
-                {
-                    memcpy(data, "apos", 4);
-                    data += 4;
-                }
-                else if( c == '\"' )
-                {
-                    memcpy( data, "quot", 4);
-                    data += 4;
-                }
-                else
-                {
-                    sprintf( data, "#x%02x", (uchar)c );
-                    data += 4;
-                }
-                *data++ = ';';
-                need_quote = 1;
-            }
-            else
-                *data++ = c;
-        }
-        if( !need_quote && (cv_isdigit(str[0]) ||
-            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
-            need_quote = 1;
+static void
+icvBinWriteComment( CvFileStorage*, const char*, int )
+{
+}
 
-        if( need_quote )
-            *data++ = '\"';
-        len = (int)(data - buf) - !need_quote;
-        *data++ = '\0';
-        data = buf + !need_quote;
+
+static void
+icvBinWriteRawData( CvFileStorage* fs, const char* data, int len, const char* dt,
+                    const int* fmt_pairs, int fmt_pair_count )
+{
+    if( fmt_pair_count == 0 )
+        return;
+
+    // the consecutive blocks of the same simple format (e.g. the rows of a non-continuous matrix)
+    // are merged, so that the reader gets them as a single block
+    if( fs->bin_raw_count == 0 || fmt_pair_count != 1 ||
+        strcmp( fs->bin_raw_dt, dt ) != 0 || fs->bin_raw_count > INT_MAX - len )
+    {
+        if( strlen(dt) >= sizeof(fs->bin_raw_dt) )
+            CV_Error( CV_StsBadArg, "Too long data type specification" );
+        icvBinStartNode( fs, 0 );
+        strcpy( fs->bin_raw_dt, dt );
     }
 
-    icvXMLWriteScalar( fs, key, data, len );
+    fs->bin_raw->insert( fs->bin_raw->end(), data, data + icvCalcRawDataSize( fmt_pairs, fmt_pair_count, len ));
+    fs->bin_raw_count += len;
 }
 
 
+// reads the slice of the raw data block; reader->delta_index is the index of the next scalar to read
 static void
-icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+icvReadRawDataSliceBinary( CvSeqReader* reader, int len, char* data, const int* fmt_pairs, int fmt_pair_count )
 {
-    int len;
-    int multiline;
-    const char* eol;
-    char* ptr;
-
-    if( !comment )
-        CV_Error( CV_StsNullPtr, "Null comment" );
+    const CvFileRawSeq* seq = (const CvFileRawSeq*)reader->seq;
+    int src_fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], src_fmt_pair_count;
+    int pos = reader->delta_index;
 
-    if( strstr(comment, "--") != 0 )
-        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
-
-    len = (int)strlen(comment);
-    eol = strchr(comment, '\n');
-    multiline = eol != 0;
-    ptr = fs->buffer;
+    if( len < 0 || pos + len > seq->total )
+        CV_Error( CV_StsOutOfRange, "The requested slice is out of the sequence range" );
 
-    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
-        ptr = icvXMLFlush( fs );
-    else if( ptr > fs->buffer_start + fs->struct_indent )
-        *ptr++ = ' ';
+    src_fmt_pair_count = icvDecodeFormat( seq->dt, src_fmt_pairs, CV_FS_MAX_FMT_PAIRS );
 
-    if( !multiline )
+    if( fmt_pair_count == 1 && src_fmt_pair_count == 1 && fmt_pairs[1] == src_fmt_pairs[1] )
     {
-        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
-        sprintf( ptr, "<!-- %s -->", comment );
-        len = (int)strlen(ptr);
+        if( len % fmt_pairs[0] != 0 )
+            CV_Error( CV_StsBadSize, "The sequence slice does not fit an integer number of records" );
+        size_t elem_size = CV_ELEM_SIZE(fmt_pairs[1]);
+        memcpy( data, seq->raw_data + pos*elem_size, len*elem_size );
     }
     else
     {
-        strcpy( ptr, "<!--" );
-        len = 4;
-    }
+        CvRawDataCursor src, dst;
+        CvFileNode node;
+        int i, src_type, dst_type;
 
-    fs->buffer = ptr + len;
-    ptr = icvXMLFlush(fs);
+        icvInitRawDataCursor( &src, src_fmt_pairs, src_fmt_pair_count, pos );
+        icvInitRawDataCursor( &dst, fmt_pairs, fmt_pair_count, 0 );
 
-    if( multiline )
-    {
-        while( comment )
+        for( i = 0; i < len; i++ )
         {
-            if( eol )
-            {
-                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
-                memcpy( ptr, comment, eol - comment + 1 );
-                ptr += eol - comment;
-                comment = eol + 1;
-                eol = strchr( comment, '\n' );
-            }
-            else
-            {
-                len = (int)strlen(comment);
-                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
-                memcpy( ptr, comment, len );
-                ptr += len;
-                comment = 0;
-            }
-            fs->buffer = ptr;
-            ptr = icvXMLFlush( fs );
+            size_t src_offset = icvNextRawDataScalar( &src, &src_type );
+            size_t dst_offset = icvNextRawDataScalar( &dst, &dst_type );
+            icvLoadRawScalar( seq->raw_data + src_offset, src_type, &node );
+            icvStoreRawScalar( &node, dst_type, data + dst_offset );
         }
-        sprintf( ptr, "-->" );
-        fs->buffer = ptr + 3;
-        icvXMLFlush( fs );
+
+        if( dst.k != 0 || dst.i != 0 )
+            CV_Error( CV_StsBadSize, "The sequence slice does not fit an integer number of records" );
     }
+
+    reader->delta_index = pos + len;
 }
 
 
@@ -2694,6 +3666,7 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     bool mem = (flags & CV_STORAGE_MEMORY) != 0;
     bool write_mode = (flags & 3) != 0;
     bool isGZ = false;
+    bool binary = write_mode && (flags & CV_STORAGE_FORMAT_MASK) == CV_STORAGE_FORMAT_BINARY;
     size_t fnamelen = 0;
 
     if( !filename || filename[0] == '\0' )
@@ -2708,6 +3681,9 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     if( mem && append )
         CV_Error( CV_StsBadFlag, "CV_STORAGE_APPEND and CV_STORAGE_MEMORY are not currently compatible" );
 
+    if( binary && (mem || append) )
+        CV_Error( CV_StsNotImplemented, "The binary file storage can only be written to a new file" );
+
     fs = (CvFileStorage*)cvAlloc( sizeof(*fs) );
     memset( fs, 0, sizeof(*fs));
 
@@ -2738,7 +3714,7 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         if( !isGZ )
         {
-            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+            fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : binary ? "wb" : !append ? "wt" : "a+t" );
             if( !fs->file )
                 goto _exit_;
         }
@@ -2856,6 +3832,20 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
             fs->write_comment = icvXMLWriteComment;
             fs->start_next_stream = icvXMLStartNextStream;
         }
+        else if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+        {
+            int byte_order = CV_BIN_BYTE_ORDER;
+            fs->bin_raw = new std::vector<char>;
+            icvBinWrite( fs, CV_BIN_SIGNATURE, strlen(CV_BIN_SIGNATURE) );
+            icvBinWrite( fs, &byte_order, sizeof(byte_order) );
+            fs->start_write_struct = icvBinStartWriteStruct;
+            fs->end_write_struct = icvBinEndWriteStruct;
+            fs->write_int = icvBinWriteInt;
+            fs->write_real = icvBinWriteReal;
+            fs->write_string = icvBinWriteString;
+            fs->write_comment = icvBinWriteComment;
+            fs->start_next_stream = icvBinStartNextStream;
+        }
         else
         {
             if( !append )
@@ -2881,10 +3871,15 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
 
         size_t buf_size = 1 << 20;
         const char* yaml_signature = "%YAML:";
+        const char* binary_signature = "%BINARY:";
         char buf[16];
         icvGets( fs, buf, sizeof(buf)-2 );
         fs->fmt = strncmp( buf, yaml_signature, strlen(yaml_signature) ) == 0 ?
-            CV_STORAGE_FORMAT_YAML : CV_STORAGE_FORMAT_XML;
+            CV_STORAGE_FORMAT_YAML : strncmp( buf, binary_signature, strlen(binary_signature) ) == 0 ?
+            CV_STORAGE_FORMAT_BINARY : CV_STORAGE_FORMAT_XML;
+
+        if( fs->fmt == CV_STORAGE_FORMAT_BINARY && mem )
+            CV_Error( CV_StsNotImplemented, "The binary file storage can not be read from memory" );
 
         if( !isGZ )
         {
@@ -2906,22 +3901,27 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         fs->roots = cvCreateSeq( 0, sizeof(CvSeq),
                         sizeof(CvFileNode), fs->memstorage );
 
-        fs->buffer = fs->buffer_start = (char*)cvAlloc( buf_size + 256 );
-        fs->buffer_end = fs->buffer_start + buf_size;
-        fs->buffer[0] = '\n';
-        fs->buffer[1] = '\0';
-
-        //mode = cvGetErrMode();
-        //cvSetErrMode( CV_ErrModeSilent );
-        if( fs->fmt == CV_STORAGE_FORMAT_XML )
-            icvXMLParse( fs );
+        if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+            icvBinParse( fs );
         else
-            icvYMLParse( fs );
-        //cvSetErrMode( mode );
+        {
+            fs->buffer = fs->buffer_start = (char*)cvAlloc( buf_size + 256 );
+            fs->buffer_end = fs->buffer_start + buf_size;
+            fs->buffer[0] = '\n';
+            fs->buffer[1] = '\0';
 
-        // release resources that we do not need anymore
-        cvFree( &fs->buffer_start );
-        fs->buffer = fs->buffer_end = 0;
+            //mode = cvGetErrMode();
+            //cvSetErrMode( CV_ErrModeSilent );
+            if( fs->fmt == CV_STORAGE_FORMAT_XML )
+                icvXMLParse( fs );
+            else
+                icvYMLParse( fs );
+            //cvSetErrMode( mode );
+
+            // release resources that we do not need anymore
+            cvFree( &fs->buffer_start );
+            fs->buffer = fs->buffer_end = 0;
+        }
     }
     fs->is_opened = true;
 
@@ -3004,7 +4004,6 @@ cvStartNextStream( CvFileStorage* fs )
 
 
 static const char icvTypeSymbol[] = "ucwsifdr";
-#define CV_FS_MAX_FMT_PAIRS  128
 
 static char*
 icvEncodeFormat( int elem_type, char* dt )
@@ -3131,6 +4130,12 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
     if( !data0 )
         CV_Error( CV_StsNullPtr, "Null data pointer" );
 
+    if( fs->fmt == CV_STORAGE_FORMAT_BINARY )
+    {
+        icvBinWriteRawData( fs, data0, len, dt, fmt_pairs, fmt_pair_count );
+        return;
+    }
+
     if( fmt_pair_count == 1 )
     {
         fmt_pairs[0] *= len;
@@ -3225,7 +4230,16 @@ cvStartReadRawData( const CvFileStorage* fs, const CvFileNode* src, CvSeqReader*
     }
     else if( node_type == CV_NODE_SEQ )
     {
-        cvStartReadSeq( src->data.seq, reader, 0 );
+        // the raw data block may be converted to file nodes by another thread, so the sequence is read once
+        CvSeq* seq = src->data.seq;
+        if( CV_NODE_SEQ_IS_BINARY(seq) )
+        {
+            // the raw data block is read directly, delta_index is used as the position in it
+            memset( reader, 0, sizeof(*reader) );
+            reader->seq = seq;
+        }
+        else
+            cvStartReadSeq( seq, reader, 0 );
     }
     else if( node_type == CV_NODE_NONE )
     {
@@ -3254,6 +4268,12 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
 
     fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
 
+    if( reader->seq && CV_NODE_SEQ_IS_BINARY(reader->seq) )
+    {
+        icvReadRawDataSliceBinary( reader, len, data0, fmt_pairs, fmt_pair_count );
+        return;
+    }
+
     for(;;)
     {
         for( k = 0; k < fmt_pair_count; k++ )
@@ -3268,103 +4288,8 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
 
             for( i = 0; i < count; i++ )
             {
-                CvFileNode* node = (CvFileNode*)reader->ptr;
-                if( CV_NODE_IS_INT(node->tag) )
-                {
-                    int ival = node->data.i;
-
-                    switch( elem_type )
-                    {
-                    case CV_8U:
-                        *(uchar*)data = CV_CAST_8U(ival);
-                        data++;
-                        break;
-                    case CV_8S:
-                        *(char*)data = CV_CAST_8S(ival);
-                        data++;
-                        break;
-                    case CV_16U:
-                        *(ushort*)data = CV_CAST_16U(ival);
-                        data += sizeof(ushort);
-                        break;
-                    case CV_16S:
-                        *(short*)data = CV_CAST_16S(ival);
-                        data += sizeof(short);
-                        break;
-                    case CV_32S:
-                        *(int*)data = ival;
-                        data += sizeof(int);
-                        break;
-                    case CV_32F:
-                        *(float*)data = (float)ival;
-                        data += sizeof(float);
-                        break;
-                    case CV_64F:
-                        *(double*)data = (double)ival;
-                        data += sizeof(double);
-                        break;
-                    case CV_USRTYPE1: /* reference */
-                        *(size_t*)data = ival;
-                        data += sizeof(size_t);
-                        break;
-                    default:
-                        assert(0);
-                        return;
-                    }
-                }
-                else if( CV_NODE_IS_REAL(node->tag) )
-                {
-                    double fval = node->data.f;
-                    int ival;
-
-                    switch( elem_type )
-                    {
-                    case CV_8U:
-                        ival = cvRound(fval);
-                        *(uchar*)data = CV_CAST_8U(ival);
-                        data++;
-                        break;
-                    case CV_8S:
-                        ival = cvRound(fval);
-                        *(char*)data = CV_CAST_8S(ival);
-                        data++;
-                        break;
-                    case CV_16U:
-                        ival = cvRound(fval);
-                        *(ushort*)data = CV_CAST_16U(ival);
-                        data += sizeof(ushort);
-                        break;
-                    case CV_16S:
-                        ival = cvRound(fval);
-                        *(short*)data = CV_CAST_16S(ival);
-                        data += sizeof(short);
-                        break;
-                    case CV_32S:
-                        ival = cvRound(fval);
-                        *(int*)data = ival;
-                        data += sizeof(int);
-                        break;
-                    case CV_32F:
-                        *(float*)data = (float)fval;
-                        data += sizeof(float);
-                        break;
-                    case CV_64F:
-                        *(double*)data = fval;
-                        data += sizeof(double);
-                        break;
-                    case CV_USRTYPE1: /* reference */
-                        ival = cvRound(fval);
-                        *(size_t*)data = ival;
-                        data += sizeof(size_t);
-                        break;
-                    default:
-                        assert(0);
-                        return;
-                    }
-                }
-                else
-                    CV_Error( CV_StsError,
-                    "The sequence element is not a numerical scalar" );
+                icvStoreRawScalar( (CvFileNode*)reader->ptr, elem_type, data );
+                data += elem_size;
 
                 CV_NEXT_SEQ_ELEM( sizeof(CvFileNode), *reader );
                 if( !--len )
@@ -3406,12 +4331,20 @@ icvWriteFileNode( CvFileStorage* fs, const char* name, const CvFileNode* node );
 static void
 icvWriteCollection( CvFileStorage* fs, const CvFileNode* node )
 {
-    int i, total = node->data.seq->total;
-    int elem_size = node->data.seq->elem_size;
+    const CvSeq* node_seq = node->data.seq;
+    int i, total = node_seq->total;
+    int elem_size = node_seq->elem_size;
     int is_map = CV_NODE_IS_MAP(node->tag);
     CvSeqReader reader;
 
-    cvStartReadSeq( node->data.seq, &reader, 0 );
+    if( CV_NODE_SEQ_IS_BINARY(node_seq) )
+    {
+        const CvFileRawSeq* seq = (const CvFileRawSeq*)node_seq;
+        cvWriteRawData( fs, seq->raw_data, seq->raw_count, seq->dt );
+        return;
+    }
+
+    cvStartReadSeq( node_seq, &reader, 0 );
 
     for( i = 0; i < total; i++ )
     {
@@ -3567,16 +4500,16 @@ icvReadMat( CvFileStorage* fs, CvFileNode* node )
     CvFileNode* data;
     int rows, cols, elem_type;
 
-    rows = cvReadIntByName( fs, node, "rows", -1 );
-    cols = cvReadIntByName( fs, node, "cols", -1 );
-    dt = cvReadStringByName( fs, node, "dt", 0 );
+    rows = icvReadIntByName( fs, node, "rows", -1 );
+    cols = icvReadIntByName( fs, node, "cols", -1 );
+    dt = icvReadStringByName( fs, node, "dt", 0 );
 
     if( rows < 0 || cols < 0 || !dt )
         CV_Error( CV_StsError, "Some of essential matrix attributes are absent" );
 
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
@@ -3653,8 +4586,8 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     int sizes[CV_MAX_DIM], dims, elem_type;
     int i, total_size;
 
-    sizes_node = cvGetFileNodeByName( fs, node, "sizes" );
-    dt = cvReadStringByName( fs, node, "dt", 0 );
+    sizes_node = icvGetFileNodeByName( fs, node, "sizes" );
+    dt = icvReadStringByName( fs, node, "dt", 0 );
 
     if( !sizes_node || !dt )
         CV_Error( CV_StsError, "Some of essential matrix attributes are absent" );
@@ -3668,7 +4601,7 @@ icvReadMatND( CvFileStorage* fs, CvFileNode* node )
     cvReadRawData( fs, sizes_node, sizes, "i" );
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
@@ -3806,8 +4739,8 @@ icvReadSparseMat( CvFileStorage* fs, CvFileNode* node )
     int sizes[CV_MAX_DIM_HEAP], dims, elem_type, cn;
     int i;
 
-    sizes_node = cvGetFileNodeByName( fs, node, "sizes" );
-    dt = cvReadStringByName( fs, node, "dt", 0 );
+    sizes_node = icvGetFileNodeByName( fs, node, "sizes" );
+    dt = icvReadStringByName( fs, node, "dt", 0 );
 
     if( !sizes_node || !dt )
         CV_Error( CV_StsError, "Some of essential matrix attributes are absent" );
@@ -3821,7 +4754,7 @@ icvReadSparseMat( CvFileStorage* fs, CvFileNode* node )
     cvReadRawData( fs, sizes_node, sizes, "i" );
     elem_type = icvDecodeSimpleFormat( dt );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data || !CV_NODE_IS_SEQ(data->tag) )
         CV_Error( CV_StsError, "The matrix data is not found in file storage" );
 
@@ -3829,6 +4762,8 @@ icvReadSparseMat( CvFileStorage* fs, CvFileNode* node )
 
     cn = CV_MAT_CN(elem_type);
     int idx[CV_MAX_DIM_HEAP];
+    if( CV_NODE_SEQ_IS_BINARY(data->data.seq) )
+        icvFSExpandRawSeq( fs, data );
     elements = data->data.seq;
     cvStartReadRawData( fs, data, &reader );
 
@@ -3944,20 +4879,20 @@ icvReadImage( CvFileStorage* fs, CvFileNode* node )
     int y, width, height, elem_type, coi, depth;
     const char* origin, *data_order;
 
-    width = cvReadIntByName( fs, node, "width", 0 );
-    height = cvReadIntByName( fs, node, "height", 0 );
-    dt = cvReadStringByName( fs, node, "dt", 0 );
-    origin = cvReadStringByName( fs, node, "origin", 0 );
+    width = icvReadIntByName( fs, node, "width", 0 );
+    height = icvReadIntByName( fs, node, "height", 0 );
+    dt = icvReadStringByName( fs, node, "dt", 0 );
+    origin = icvReadStringByName( fs, node, "origin", 0 );
 
     if( width == 0 || height == 0 || dt == 0 || origin == 0 )
         CV_Error( CV_StsError, "Some of essential image attributes are absent" );
 
     elem_type = icvDecodeSimpleFormat( dt );
-    data_order = cvReadStringByName( fs, node, "layout", "interleaved" );
+    data_order = icvReadStringByName( fs, node, "layout", "interleaved" );
     if( strcmp( data_order, "interleaved" ) != 0 )
         CV_Error( CV_StsError, "Only interleaved images can be read" );
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The image data is not found in file storage" );
 
@@ -3968,14 +4903,14 @@ icvReadImage( CvFileStorage* fs, CvFileNode* node )
     depth = cvIplDepth(elem_type);
     image = cvCreateImage( cvSize(width,height), depth, CV_MAT_CN(elem_type) );
 
-    roi_node = cvGetFileNodeByName( fs, node, "roi" );
+    roi_node = icvGetFileNodeByName( fs, node, "roi" );
     if( roi_node )
     {
-        roi.x = cvReadIntByName( fs, roi_node, "x", 0 );
-        roi.y = cvReadIntByName( fs, roi_node, "y", 0 );
-        roi.width = cvReadIntByName( fs, roi_node, "width", 0 );
-        roi.height = cvReadIntByName( fs, roi_node, "height", 0 );
-        coi = cvReadIntByName( fs, roi_node, "coi", 0 );
+        roi.x = icvReadIntByName( fs, roi_node, "x", 0 );
+        roi.y = icvReadIntByName( fs, roi_node, "y", 0 );
+        roi.width = icvReadIntByName( fs, roi_node, "width", 0 );
+        roi.height = icvReadIntByName( fs, roi_node, "height", 0 );
+        coi = icvReadIntByName( fs, roi_node, "coi", 0 );
 
         cvSetImageROI( image, roi );
         cvSetImageCOI( image, coi );
@@ -4232,9 +5167,9 @@ icvReadSeq( CvFileStorage* fs, CvFileNode* node )
     const char* dt;
     char* endptr = 0;
 
-    flags_str = cvReadStringByName( fs, node, "flags", 0 );
-    total = cvReadIntByName( fs, node, "count", -1 );
-    dt = cvReadStringByName( fs, node, "dt", 0 );
+    flags_str = icvReadStringByName( fs, node, "flags", 0 );
+    total = icvReadIntByName( fs, node, "count", -1 );
+    dt = icvReadStringByName( fs, node, "dt", 0 );
 
     if( !flags_str || total == -1 || !dt )
         CV_Error( CV_StsError, "Some of essential sequence attributes are absent" );
@@ -4283,15 +5218,15 @@ icvReadSeq( CvFileStorage* fs, CvFileNode* node )
         }
     }
 
-    header_dt = cvReadStringByName( fs, node, "header_dt", 0 );
-    header_node = cvGetFileNodeByName( fs, node, "header_user_data" );
+    header_dt = icvReadStringByName( fs, node, "header_dt", 0 );
+    header_node = icvGetFileNodeByName( fs, node, "header_user_data" );
 
     if( (header_dt != 0) ^ (header_node != 0) )
         CV_Error( CV_StsError,
         "One of \"header_dt\" and \"header_user_data\" is there, while the other is not" );
 
-    rect_node = cvGetFileNodeByName( fs, node, "rect" );
-    origin_node = cvGetFileNodeByName( fs, node, "origin" );
+    rect_node = icvGetFileNodeByName( fs, node, "rect" );
+    origin_node = icvGetFileNodeByName( fs, node, "origin" );
 
     if( (header_node != 0) + (rect_node != 0) + (origin_node != 0) > 1 )
         CV_Error( CV_StsError, "Only one of \"header_user_data\", \"rect\" and \"origin\" tags may occur" );
@@ -4315,17 +5250,17 @@ icvReadSeq( CvFileStorage* fs, CvFileNode* node )
     else if( rect_node )
     {
         CvPoint2DSeq* point_seq = (CvPoint2DSeq*)seq;
-        point_seq->rect.x = cvReadIntByName( fs, rect_node, "x", 0 );
-        point_seq->rect.y = cvReadIntByName( fs, rect_node, "y", 0 );
-        point_seq->rect.width = cvReadIntByName( fs, rect_node, "width", 0 );
-        point_seq->rect.height = cvReadIntByName( fs, rect_node, "height", 0 );
-        point_seq->color = cvReadIntByName( fs, node, "color", 0 );
+        point_seq->rect.x = icvReadIntByName( fs, rect_node, "x", 0 );
+        point_seq->rect.y = icvReadIntByName( fs, rect_node, "y", 0 );
+        point_seq->rect.width = icvReadIntByName( fs, rect_node, "width", 0 );
+        point_seq->rect.height = icvReadIntByName( fs, rect_node, "height", 0 );
+        point_seq->color = icvReadIntByName( fs, node, "color", 0 );
     }
     else if( origin_node )
     {
         CvChain* chain = (CvChain*)seq;
-        chain->origin.x = cvReadIntByName( fs, origin_node, "x", 0 );
-        chain->origin.y = cvReadIntByName( fs, origin_node, "y", 0 );
+        chain->origin.x = icvReadIntByName( fs, origin_node, "x", 0 );
+        chain->origin.y = icvReadIntByName( fs, origin_node, "y", 0 );
     }
 
     cvSeqPushMulti( seq, 0, total, 0 );
@@ -4334,7 +5269,7 @@ icvReadSeq( CvFileStorage* fs, CvFileNode* node )
     for( i = 0; i < fmt_pair_count; i += 2 )
         items_per_elem += fmt_pairs[i];
 
-    data = cvGetFileNodeByName( fs, node, "data" );
+    data = icvGetFileNodeByName( fs, node, "data" );
     if( !data )
         CV_Error( CV_StsError, "The image data is not found in file storage" );
 
@@ -4359,7 +5294,7 @@ static void*
 icvReadSeqTree( CvFileStorage* fs, CvFileNode* node )
 {
     void* ptr = 0;
-    CvFileNode *sequences_node = cvGetFileNodeByName( fs, node, "sequences" );
+    CvFileNode *sequences_node = icvGetFileNodeByName( fs, node, "sequences" );
     CvSeq* sequences;
     CvSeq* root = 0;
     CvSeq* parent = 0;
@@ -4382,7 +5317,7 @@ icvReadSeqTree( CvFileStorage* fs, CvFileNode* node )
         CvSeq* seq;
         int level;
         seq = (CvSeq*)cvRead( fs, elem );
-        level = cvReadIntByName( fs, elem, "level", -1 );
+        level = icvReadIntByName( fs, elem, "level", -1 );
         if( level < 0 )
             CV_Error( CV_StsParseError, "All the sequence tree nodes should contain \"level\" field" );
         if( !root )
@@ -4599,11 +5534,11 @@ icvReadGraph( CvFileStorage* fs, CvFileNode* node )
     const char* edge_dt;
     char* endptr = 0;
 
-    flags_str = cvReadStringByName( fs, node, "flags", 0 );
-    vtx_dt = cvReadStringByName( fs, node, "vertex_dt", 0 );
-    edge_dt = cvReadStringByName( fs, node, "edge_dt", 0 );
-    vtx_count = cvReadIntByName( fs, node, "vertex_count", -1 );
-    edge_count = cvReadIntByName( fs, node, "edge_count", -1 );
+    flags_str = icvReadStringByName( fs, node, "flags", 0 );
+    vtx_dt = icvReadStringByName( fs, node, "vertex_dt", 0 );
+    edge_dt = icvReadStringByName( fs, node, "edge_dt", 0 );
+    vtx_count = icvReadIntByName( fs, node, "vertex_count", -1 );
+    edge_count = icvReadIntByName( fs, node, "edge_count", -1 );
 
     if( !flags_str || vtx_count == -1 || edge_count == -1 || !edge_dt )
         CV_Error( CV_StsError, "Some of essential graph attributes are absent" );
@@ -4629,8 +5564,8 @@ icvReadGraph( CvFileStorage* fs, CvFileNode* node )
             flags |= CV_GRAPH_FLAG_ORIENTED;
     }
 
-    header_dt = cvReadStringByName( fs, node, "header_dt", 0 );
-    header_node = cvGetFileNodeByName( fs, node, "header_user_data" );
+    header_dt = icvReadStringByName( fs, node, "header_dt", 0 );
+    header_node = icvGetFileNodeByName( fs, node, "header_user_data" );
 
     if( (header_dt != 0) ^ (header_node != 0) )
         CV_Error( CV_StsError,
@@ -4693,8 +5628,8 @@ icvReadGraph( CvFileStorage* fs, CvFileNode* node )
     read_buf = (char*)cvAlloc( read_buf_size );
     vtx_buf = (CvGraphVtx**)cvAlloc( vtx_count * sizeof(vtx_buf[0]) );
 
-    vtx_node = cvGetFileNodeByName( fs, node, "vertices" );
-    edge_node = cvGetFileNodeByName( fs, node, "edges" );
+    vtx_node = icvGetFileNodeByName( fs, node, "vertices" );
+    edge_node = icvGetFileNodeByName( fs, node, "edges" );
     if( !edge_node )
         CV_Error( CV_StsBadArg, "No edges data" );
     if( vtx_dt && !vtx_node )
@@ -5063,7 +5998,7 @@ cvLoad( const char* filename, CvMemStorage* memstorage,
 
     if( name )
     {
-        node = cvGetFileNodeByName( *fs, 0, name );
+        node = icvGetFileNodeByName( *fs, 0, name );
     }
     else
     {
@@ -5209,7 +6144,7 @@ string FileStorage::releaseAndGetString()
 
 FileNode FileStorage::root(int streamidx) const
 {
-    return isOpened() ? FileNode(fs, cvGetRootFileNode(fs, streamidx)) : FileNode();
+    return isOpened() ? FileNode(fs, icvGetRootFileNode(fs, streamidx)) : FileNode();
 }
 
 FileStorage& operator << (FileStorage& fs, const string& str)
@@ -5292,26 +6227,28 @@ void FileStorage::writeObj( const string& name, const void* obj )
 
 FileNode FileStorage::operator[](const string& nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, 0, nodename.c_str()));
+    return FileNode(fs, icvGetFileNodeByName(fs, 0, nodename.c_str()));
 }
 
 FileNode FileStorage::operator[](const char* nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, 0, nodename));
+    return FileNode(fs, icvGetFileNodeByName(fs, 0, nodename));
 }
 
 FileNode FileNode::operator[](const string& nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, node, nodename.c_str()));
+    return FileNode(fs, icvGetFileNodeByName(fs, node, nodename.c_str()));
 }
 
 FileNode FileNode::operator[](const char* nodename) const
 {
-    return FileNode(fs, cvGetFileNodeByName(fs, node, nodename));
+    return FileNode(fs, icvGetFileNodeByName(fs, node, nodename));
 }
 
 FileNode FileNode::operator[](int i) const
 {
+    if( isSeq() && CV_NODE_SEQ_IS_BINARY(node->data.seq) )
+        icvFSExpandRawSeq( (CvFileStorage*)fs, (CvFileNode*)node );
     return isSeq() ? FileNode(fs, (CvFileNode*)cvGetSeqElem(node->data.seq, i)) :
         i == 0 ? *this : FileNode();
 }
@@ -5345,7 +6282,15 @@ FileNodeIterator::FileNodeIterator(const CvFileStorage* _fs,
         int node_type = _node->tag & FileNode::TYPE_MASK;
         fs = _fs;
         container = _node;
-        if( !(_node->tag & FileNode::USER) && (node_type == FileNode::SEQ || node_type == FileNode::MAP) )
+        // the raw data block may be converted to file nodes by another thread, so the sequence is read once
+        CvSeq* seq = _node->data.seq;
+        if( !(_node->tag & FileNode::USER) && node_type == FileNode::SEQ && CV_NODE_SEQ_IS_BINARY(seq) )
+        {
+            memset( &reader, 0, sizeof(reader) );
+            reader.seq = seq;
+            remaining = FileNode(_fs, _node).size();
+        }
+        else if( !(_node->tag & FileNode::USER) && (node_type == FileNode::SEQ || node_type == FileNode::MAP) )
         {
             cvStartReadSeq( _node->data.seq, &reader );
             remaining = FileNode(_fs, _node).size();
@@ -5375,13 +6320,50 @@ FileNodeIterator::FileNodeIterator(const FileNodeIterator& it)
     remaining = it.remaining;
 }
 
+/* the iterator over a raw data block does not move the sequence reader, the position is defined by
+   the remaining counter. Once the block is converted to file nodes, the regular reader is used */
+static bool icvSyncRawSeqReader( FileNodeIterator& it )
+{
+    if( !it.reader.seq || !CV_NODE_SEQ_IS_BINARY(it.reader.seq) )
+        return false;
+
+    const CvSeq* seq = it.container->data.seq;
+    if( !CV_NODE_SEQ_IS_BINARY(seq) )
+    {
+        cvStartReadSeq( seq, &it.reader );
+        if( it.remaining < (size_t)seq->total )
+            cvSetSeqReaderPos( &it.reader, (int)(seq->total - it.remaining), 0 );
+    }
+    return true;
+}
+
+FileNode FileNodeIterator::operator *() const
+{
+    if( reader.seq && CV_NODE_SEQ_IS_BINARY(reader.seq) )
+    {
+        if( CV_NODE_SEQ_IS_BINARY(container->data.seq) )
+            icvFSExpandRawSeq( (CvFileStorage*)fs, (CvFileNode*)container );
+        const CvSeq* seq = container->data.seq;
+        return remaining > 0 ? FileNode(fs, (const CvFileNode*)cvGetSeqElem(seq, (int)(seq->total - remaining))) :
+                               FileNode();
+    }
+    return FileNode(fs, (const CvFileNode*)reader.ptr);
+}
+
+FileNode FileNodeIterator::operator ->() const
+{
+    return operator *();
+}
+
 FileNodeIterator& FileNodeIterator::operator ++()
 {
     if( remaining > 0 )
     {
+        remaining--;
+        if( icvSyncRawSeqReader(*this) )
+            return *this;
         if( reader.seq )
             CV_NEXT_SEQ_ELEM( reader.seq->elem_size, reader );
-        remaining--;
     }
     return *this;
 }
@@ -5397,9 +6379,11 @@ FileNodeIterator& FileNodeIterator::operator --()
 {
     if( remaining < FileNode(fs, container).size() )
     {
+        remaining++;
+        if( icvSyncRawSeqReader(*this) )
+            return *this;
         if( reader.seq )
             CV_PREV_SEQ_ELEM( reader.seq->elem_size, reader );
-        remaining++;
     }
     return *this;
 }
@@ -5423,7 +6407,7 @@ FileNodeIterator& FileNodeIterator::operator += (int ofs)
         ofs = (int)(remaining - std::min(remaining - ofs, count));
     }
     remaining -= ofs;
-    if( reader.seq )
+    if( !icvSyncRawSeqReader(*this) && reader.seq )
         cvSetSeqReaderPos( &reader, ofs, 1 );
     return *this;
 }
@@ -5445,6 +6429,8 @@ FileNodeIterator& FileNodeIterator::readRaw( const string& fmt, uchar* vec, size
 
         if( reader.seq )
         {
+            if( CV_NODE_SEQ_IS_BINARY(reader.seq) )
+                reader.delta_index = (int)(reader.seq->total - remaining);
             cvReadRawDataSlice( fs, &reader, (int)count, vec, fmt.c_str() );
             remaining -= count*cn;
         }
@@ -5515,6 +6501,111 @@ WriteStructContext::WriteStructContext(FileStorage& _fs, const string& name,
 WriteStructContext::~WriteStructContext() { cvEndWriteStruct(**fs); }
 
 
+/* the matrices read from the memory-mapped binary storage refer to the mapping. refcount is the first
+   field of the holder, so the holder is found by the refcount pointer passed to deallocate() */
+struct MappedMatHolder
+{
+    int refcount;
+    CvFileMapping* mapping;
+};
+
+class MappedMatAllocator : public MatAllocator
+{
+public:
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step)
+    {
+        // the matrix is re-created with a different size, so the regular buffer is allocated
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+                step[i] = total;
+            total *= sizes[i];
+        }
+        MappedMatHolder* holder = new MappedMatHolder;
+        holder->refcount = 1;
+        holder->mapping = 0;
+        data = datastart = (uchar*)fastMalloc(total);
+        refcount = &holder->refcount;
+    }
+
+    void deallocate(int* refcount, uchar* datastart, uchar*)
+    {
+        MappedMatHolder* holder = (MappedMatHolder*)refcount;
+        if( holder->mapping )
+            icvReleaseFileMapping(holder->mapping);
+        else
+            fastFree(datastart);
+        delete holder;
+    }
+};
+
+static MappedMatAllocator mappedMatAllocator;
+
+static bool readMappedMat( const FileNode& node, Mat& mat )
+{
+    CvFileStorage* fs = (CvFileStorage*)node.fs;
+    if( !fs || !fs->mapping || !node.isMap() || !node.node->info )
+        return false;
+
+    const char* type_name = node.node->info->type_name;
+    bool nd = strcmp(type_name, CV_TYPE_NAME_MATND) == 0;
+    if( !nd && strcmp(type_name, CV_TYPE_NAME_MAT) != 0 )
+        return false;
+
+    FileNode data = node["data"];
+    if( !data.isSeq() )
+        return false;
+    // the raw data block may be converted to file nodes by another thread, so the sequence is read once
+    const CvFileRawSeq* seq = (const CvFileRawSeq*)data.node->data.seq;
+    if( !CV_NODE_SEQ_IS_BINARY(seq) )
+        return false;
+
+    string dt = (string)node["dt"];
+    int sizes[CV_MAX_DIM], dims = 2, src_fmt_pairs[CV_FS_MAX_FMT_PAIRS*2];
+    int elem_type = icvDecodeSimpleFormat( dt.c_str() );
+    size_t total = CV_MAT_CN(elem_type);
+
+    if( icvDecodeFormat( seq->dt, src_fmt_pairs, CV_FS_MAX_FMT_PAIRS ) != 1 ||
+        src_fmt_pairs[1] != CV_MAT_DEPTH(elem_type) )
+        return false;
+
+    if( nd )
+    {
+        FileNode sizes_node = node["sizes"];
+        dims = (int)sizes_node.size();
+        if( dims <= 0 || dims > CV_MAX_DIM )
+            return false;
+        cvReadRawData( fs, sizes_node.node, sizes, "i" );
+    }
+    else
+    {
+        sizes[0] = (int)node["rows"];
+        sizes[1] = (int)node["cols"];
+    }
+
+    for( int i = 0; i < dims; i++ )
+    {
+        if( sizes[i] <= 0 )
+            return false;
+        total *= sizes[i];
+    }
+    if( total != (size_t)seq->total )
+        return false;
+
+    MappedMatHolder* holder = new MappedMatHolder;
+    holder->refcount = 1;
+    holder->mapping = fs->mapping;
+    CV_XADD(&fs->mapping->refcount, 1);
+
+    mat.release();
+    mat = Mat(dims, sizes, elem_type, (void*)seq->raw_data);
+    mat.refcount = &holder->refcount;
+    mat.allocator = &mappedMatAllocator;
+    return true;
+}
+
 void read( const FileNode& node, Mat& mat, const Mat& default_mat )
 {
     if( node.empty() )
@@ -5522,6 +6613,8 @@ void read( const FileNode& node, Mat& mat, const Mat& default_mat )
         default_mat.copyTo(mat);
         return;
     }
+    if( readMappedMat(node, mat) )
+        return;
     void* obj = cvRead((CvFileStorage*)node.fs, (CvFileNode*)*node);
     if(CV_IS_MAT_HDR_Z(obj))
     {
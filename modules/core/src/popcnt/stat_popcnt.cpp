@@ -0,0 +1,102 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "stat_popcnt.hpp"
+
+namespace cv
+{
+namespace popcnt
+{
+
+static inline uint64 loadHammingWord( const uchar* a, const uchar* b, int i )
+{
+    uint64 x, y;
+    memcpy(&x, a + i, sizeof(x));
+    if( !b )
+        return x;
+    memcpy(&y, b + i, sizeof(y));
+    return x ^ y;
+}
+
+// marks the non-zero 2- or 4-bit cells of the word by their lowest bit
+static inline uint64 foldHammingCells( uint64 x, int cellSize )
+{
+    if( cellSize == 2 )
+        return (x | (x >> 1)) & CV_BIG_UINT(0x5555555555555555);
+    if( cellSize == 4 )
+    {
+        x |= x >> 1;
+        return (x | (x >> 2)) & CV_BIG_UINT(0x1111111111111111);
+    }
+    return x;
+}
+
+static inline int popCount64( uint64 x )
+{
+#if defined _M_X64 || defined __x86_64__
+    return (int)_mm_popcnt_u64(x);
+#else
+    return _mm_popcnt_u32((unsigned)x) + _mm_popcnt_u32((unsigned)(x >> 32));
+#endif
+}
+
+template<int cellSize> static int
+normHamming_( const uchar* a, const uchar* b, int n )
+{
+    int i = 0, result = 0;
+    for( ; i <= n - 16; i += 16 )
+        result += popCount64(foldHammingCells(loadHammingWord(a, b, i), cellSize)) +
+                  popCount64(foldHammingCells(loadHammingWord(a, b, i + 8), cellSize));
+    for( ; i < n; i += 8 )
+        result += popCount64(foldHammingCells(loadHammingWord(a, b, i), cellSize));
+    return result;
+}
+
+int normHamming( const uchar* a, const uchar* b, int n, int cellSize )
+{
+    return cellSize == 1 ? normHamming_<1>(a, b, n) :
+           cellSize == 2 ? normHamming_<2>(a, b, n) : normHamming_<4>(a, b, n);
+}
+
+}
+}
@@ -89,6 +89,12 @@ void deleteThreadAllocData();
 void deleteThreadRNGData();
 #endif
 
+#if defined HAVE_PTHREADS_PF
+void parallel_for_pthreads(const Range& range, const ParallelLoopBody& body, int nthreads);
+void parallel_pthreads_set_threads_num(int nthreads);
+int parallel_pthreads_get_thread_num();
+#endif
+
 template<typename T1, typename T2=T1, typename T3=T1> struct OpAdd
 {
     typedef T1 type1;
@@ -172,6 +178,7 @@ struct NoVec
 extern volatile bool USE_SSE2;
 extern volatile bool USE_SSE4_2;
 extern volatile bool USE_AVX;
+extern volatile bool USE_AVX2;
 
 enum { BLOCK_SIZE = 1024 };
 
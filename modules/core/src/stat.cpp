@@ -42,6 +42,15 @@
 
 #include "precomp.hpp"
 #include <climits>
+#ifdef HAVE_DISPATCH_SSSE3
+#  include "ssse3/stat_ssse3.hpp"
+#endif
+#ifdef HAVE_DISPATCH_POPCNT
+#  include "popcnt/stat_popcnt.hpp"
+#endif
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/stat_avx2.hpp"
+#endif
 
 namespace cv
 {
@@ -995,46 +1004,74 @@ static const uchar popCountTable4[] =
     1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2
 };
 
-static int normHamming(const uchar* a, int n)
+/*
+   Hamming distance kernels. The fastest one built (the AVX2, POPCNT and SSSE3 variants live in the
+   per-ISA sources, see HAVE_DISPATCH_*) and supported by the CPU (see checkHardwareSupport()) is chosen
+   once by getHammingFunc() and cached, so normHamming() and the batch
+   functions do not check the hardware support for every pair of vectors. The generic version
+   counts the bits of 64-bit words in parallel instead of looking them up byte by byte in popCountTable.
+   b == 0 means the number of non-zero bits (cells) in a is computed.
+*/
+
+typedef int (*HammingFunc)(const uchar* a, const uchar* b, int n);
+
+static inline uint64 loadHammingWord(const uchar* a, const uchar* b, int i)
 {
-    int i = 0, result = 0;
-#if CV_NEON
-    if (CPU_HAS_NEON_FEATURE)
+    uint64 x, y;
+    memcpy(&x, a + i, sizeof(x));
+    if( !b )
+        return x;
+    memcpy(&y, b + i, sizeof(y));
+    return x ^ y;
+}
+
+// marks the non-zero 2- or 4-bit cells of the word by their lowest bit
+static inline uint64 foldHammingCells(uint64 x, int cellSize)
+{
+    if( cellSize == 2 )
+        return (x | (x >> 1)) & CV_BIG_UINT(0x5555555555555555);
+    if( cellSize == 4 )
     {
-        uint32x4_t bits = vmovq_n_u32(0);
-        for (; i <= n - 16; i += 16) {
-            uint8x16_t A_vec = vld1q_u8 (a + i);
-            uint8x16_t bitsSet = vcntq_u8 (A_vec);
-            uint16x8_t bitSet8 = vpaddlq_u8 (bitsSet);
-            uint32x4_t bitSet4 = vpaddlq_u16 (bitSet8);
-            bits = vaddq_u32(bits, bitSet4);
-        }
-        uint64x2_t bitSet2 = vpaddlq_u32 (bits);
-        result = vgetq_lane_s32 (vreinterpretq_s32_u64(bitSet2),0);
-        result += vgetq_lane_s32 (vreinterpretq_s32_u64(bitSet2),2);
+        x |= x >> 1;
+        return (x | (x >> 2)) & CV_BIG_UINT(0x1111111111111111);
     }
+    return x;
+}
+
+static inline int popCount64(uint64 x)
+{
+    x -= (x >> 1) & CV_BIG_UINT(0x5555555555555555);
+    x = (x & CV_BIG_UINT(0x3333333333333333)) + ((x >> 2) & CV_BIG_UINT(0x3333333333333333));
+    x = (x + (x >> 4)) & CV_BIG_UINT(0x0f0f0f0f0f0f0f0f);
+    return (int)((x * CV_BIG_UINT(0x0101010101010101)) >> 56);
+}
+
+static inline int hammingTail(const uchar* a, const uchar* b, int i, int n, const uchar* tab)
+{
+    int result = 0;
+    if( b )
+        for( ; i < n; i++ )
+            result += tab[a[i] ^ b[i]];
     else
-#endif
-        for( ; i <= n - 4; i += 4 )
-            result += popCountTable[a[i]] + popCountTable[a[i+1]] +
-            popCountTable[a[i+2]] + popCountTable[a[i+3]];
-    for( ; i < n; i++ )
-        result += popCountTable[a[i]];
+        for( ; i < n; i++ )
+            result += tab[a[i]];
     return result;
 }
 
-int normHamming(const uchar* a, const uchar* b, int n)
+template<int cellSize> static int
+hammingDist_(const uchar* a, const uchar* b, int n)
 {
+    const uchar* tab = cellSize == 1 ? popCountTable : cellSize == 2 ? popCountTable2 : popCountTable4;
     int i = 0, result = 0;
 #if CV_NEON
-    if (CPU_HAS_NEON_FEATURE)
+    if( cellSize == 1 && CPU_HAS_NEON_FEATURE )
     {
         uint32x4_t bits = vmovq_n_u32(0);
         for (; i <= n - 16; i += 16) {
             uint8x16_t A_vec = vld1q_u8 (a + i);
-            uint8x16_t B_vec = vld1q_u8 (b + i);
-            uint8x16_t AxorB = veorq_u8 (A_vec, B_vec);
-            uint8x16_t bitsSet = vcntq_u8 (AxorB);
+            if( b )
+                A_vec = veorq_u8 (A_vec, vld1q_u8 (b + i));
+            uint8x16_t bitsSet = vcntq_u8 (A_vec);
             uint16x8_t bitSet8 = vpaddlq_u8 (bitsSet);
             uint32x4_t bitSet4 = vpaddlq_u16 (bitSet8);
             bits = vaddq_u32(bits, bitSet4);
@@ -1043,57 +1080,128 @@ int normHamming(const uchar* a, const uchar* b, int n)
         result = vgetq_lane_s32 (vreinterpretq_s32_u64(bitSet2),0);
         result += vgetq_lane_s32 (vreinterpretq_s32_u64(bitSet2),2);
     }
-    else
 #endif
-        for( ; i <= n - 4; i += 4 )
-            result += popCountTable[a[i] ^ b[i]] + popCountTable[a[i+1] ^ b[i+1]] +
-                    popCountTable[a[i+2] ^ b[i+2]] + popCountTable[a[i+3] ^ b[i+3]];
-    for( ; i < n; i++ )
-        result += popCountTable[a[i] ^ b[i]];
-    return result;
+    for( ; i <= n - 8; i += 8 )
+        result += popCount64(foldHammingCells(loadHammingWord(a, b, i), cellSize));
+    return result + hammingTail(a, b, i, n, tab);
 }
 
-static int normHamming(const uchar* a, int n, int cellSize)
+#ifdef HAVE_DISPATCH_POPCNT
+template<int cellSize> static int
+hammingDistPOPCNT_(const uchar* a, const uchar* b, int n)
 {
-    if( cellSize == 1 )
-        return normHamming(a, n);
-    const uchar* tab = 0;
-    if( cellSize == 2 )
-        tab = popCountTable2;
-    else if( cellSize == 4 )
-        tab = popCountTable4;
-    else
-        CV_Error( CV_StsBadSize, "bad cell size (not 1, 2 or 4) in normHamming" );
-    int i = 0, result = 0;
-#if CV_ENABLE_UNROLLED
-    for( ; i <= n - 4; i += 4 )
-        result += tab[a[i]] + tab[a[i+1]] + tab[a[i+2]] + tab[a[i+3]];
+    int len = n & -8;
+    return popcnt::normHamming(a, b, len, cellSize) + hammingDist_<cellSize>(a + len, b ? b + len : 0, n - len);
+}
 #endif
-    for( ; i < n; i++ )
-        result += tab[a[i]];
-    return result;
+
+#if CV_SSE2
+static inline __m128i loadHammingVec(const uchar* a, const uchar* b, int i)
+{
+    __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+    return b ? _mm_xor_si128(x, _mm_loadu_si128((const __m128i*)(b + i))) : x;
 }
 
-int normHamming(const uchar* a, const uchar* b, int n, int cellSize)
+static inline int sumHammingVec(__m128i sum)
+{
+    return _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum));
+}
+
+// the bits are counted within each byte like in popCount64, then the bytes are summed by psadbw
+static int hammingDistSSE2(const uchar* a, const uchar* b, int n)
+{
+    int i = 0;
+    __m128i m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33), m4 = _mm_set1_epi8(0x0f);
+    __m128i z = _mm_setzero_si128(), sum = z;
+    for( ; i <= n - 16; i += 16 )
+    {
+        __m128i x = loadHammingVec(a, b, i);
+        x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), m1));
+        x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi16(x, 2), m2));
+        x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi16(x, 4)), m4);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(x, z));
+    }
+    return sumHammingVec(sum) + hammingDist_<1>(a + i, b ? b + i : 0, n - i);
+}
+#endif
+
+#ifdef HAVE_DISPATCH_SSSE3
+static int hammingDistSSSE3(const uchar* a, const uchar* b, int n)
+{
+    int len = n & -16;
+    return ssse3::normHamming(a, b, len) + hammingDist_<1>(a + len, b ? b + len : 0, n - len);
+}
+#endif
+
+#ifdef HAVE_DISPATCH_AVX2
+static int hammingDistAVX2(const uchar* a, const uchar* b, int n)
+{
+    int len = n & -32;
+    return avx2::normHamming(a, b, len) + hammingDist_<1>(a + len, b ? b + len : 0, n - len);
+}
+#endif
+
+static HammingFunc selectHammingFunc(int cellSize)
 {
     if( cellSize == 1 )
-        return normHamming(a, b, n);
-    const uchar* tab = 0;
-    if( cellSize == 2 )
-        tab = popCountTable2;
-    else if( cellSize == 4 )
-        tab = popCountTable4;
-    else
+    {
+#ifdef HAVE_DISPATCH_AVX2
+        if( checkHardwareSupport(CV_CPU_AVX2) )
+            return hammingDistAVX2;
+#endif
+#ifdef HAVE_DISPATCH_POPCNT
+        if( checkHardwareSupport(CV_CPU_POPCNT) )
+            return hammingDistPOPCNT_<1>;
+#endif
+#ifdef HAVE_DISPATCH_SSSE3
+        if( checkHardwareSupport(CV_CPU_SSSE3) )
+            return hammingDistSSSE3;
+#endif
+#if CV_SSE2
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+            return hammingDistSSE2;
+#endif
+        return hammingDist_<1>;
+    }
+#ifdef HAVE_DISPATCH_POPCNT
+    if( checkHardwareSupport(CV_CPU_POPCNT) )
+        return cellSize == 2 ? hammingDistPOPCNT_<2> : hammingDistPOPCNT_<4>;
+#endif
+    return cellSize == 2 ? hammingDist_<2> : hammingDist_<4>;
+}
+
+// the choice depends on setUseOptimized(), so it is cached for both modes
+static HammingFunc getHammingFunc(int cellSize)
+{
+    static HammingFunc funcs[2][3];
+
+    if( cellSize != 1 && cellSize != 2 && cellSize != 4 )
         CV_Error( CV_StsBadSize, "bad cell size (not 1, 2 or 4) in normHamming" );
-    int i = 0, result = 0;
-    #if CV_ENABLE_UNROLLED
-    for( ; i <= n - 4; i += 4 )
-        result += tab[a[i] ^ b[i]] + tab[a[i+1] ^ b[i+1]] +
-                tab[a[i+2] ^ b[i+2]] + tab[a[i+3] ^ b[i+3]];
-    #endif
-    for( ; i < n; i++ )
-        result += tab[a[i] ^ b[i]];
-    return result;
+
+    HammingFunc& func = funcs[useOptimized() ? 1 : 0][cellSize >> 1];
+    if( !func )
+        func = selectHammingFunc(cellSize);
+    return func;
+}
+
+static int normHamming(const uchar* a, int n)
+{
+    return getHammingFunc(1)(a, 0, n);
+}
+
+int normHamming(const uchar* a, const uchar* b, int n)
+{
+    return getHammingFunc(1)(a, b, n);
+}
+
+static int normHamming(const uchar* a, int n, int cellSize)
+{
+    return getHammingFunc(cellSize)(a, 0, n);
+}
+
+int normHamming(const uchar* a, const uchar* b, int n, int cellSize)
+{
+    return getHammingFunc(cellSize)(a, b, n);
 }
 
 
@@ -1640,38 +1748,34 @@ void batchDistL2_(const _Tp* src1, const _Tp* src2, size_t step2,
     }
 }
 
-static void batchDistHamming(const uchar* src1, const uchar* src2, size_t step2,
-                             int nvecs, int len, int* dist, const uchar* mask)
+static void batchDistHamming_(const uchar* src1, const uchar* src2, size_t step2,
+                              int nvecs, int len, int* dist, const uchar* mask, int cellSize)
 {
+    HammingFunc func = getHammingFunc(cellSize);
     step2 /= sizeof(src2[0]);
     if( !mask )
     {
         for( int i = 0; i < nvecs; i++ )
-            dist[i] = normHamming(src1, src2 + step2*i, len);
+            dist[i] = func(src1, src2 + step2*i, len);
     }
     else
     {
         int val0 = INT_MAX;
         for( int i = 0; i < nvecs; i++ )
-            dist[i] = mask[i] ? normHamming(src1, src2 + step2*i, len) : val0;
+            dist[i] = mask[i] ? func(src1, src2 + step2*i, len) : val0;
     }
 }
 
+static void batchDistHamming(const uchar* src1, const uchar* src2, size_t step2,
+                             int nvecs, int len, int* dist, const uchar* mask)
+{
+    batchDistHamming_(src1, src2, step2, nvecs, len, dist, mask, 1);
+}
+
 static void batchDistHamming2(const uchar* src1, const uchar* src2, size_t step2,
                               int nvecs, int len, int* dist, const uchar* mask)
 {
-    step2 /= sizeof(src2[0]);
-    if( !mask )
-    {
-        for( int i = 0; i < nvecs; i++ )
-            dist[i] = normHamming(src1, src2 + step2*i, len, 2);
-    }
-    else
-    {
-        int val0 = INT_MAX;
-        for( int i = 0; i < nvecs; i++ )
-            dist[i] = mask[i] ? normHamming(src1, src2 + step2*i, len, 2) : val0;
-    }
+    batchDistHamming_(src1, src2, step2, nvecs, len, dist, mask, 2);
 }
 
 static void batchDistL1_8u32s(const uchar* src1, const uchar* src2, size_t step2,
@@ -1726,8 +1830,18 @@ typedef void (*BatchDistFunc)(const uchar* src1, const uchar* src2, size_t step2
                               int nvecs, int len, uchar* dist, const uchar* mask);
 
 
-struct BatchDistInvoker
+/*
+   The queries (src1 rows) are processed by blocks of BATCH_DIST_QUERY_BLOCK rows and the train set (src2)
+   is scanned by tiles of about BATCH_DIST_TRAIN_BLOCK_SIZE bytes. Every tile is compared with all the queries
+   of the block while it is in cache, so the train set is read from memory once per block of queries
+   rather than once per query. The tiles are processed in the order of the train vectors,
+   so the K nearest neighbors are the same as with the plain row-by-row scan.
+*/
+enum { BATCH_DIST_QUERY_BLOCK = 16, BATCH_DIST_TRAIN_BLOCK_SIZE = 1 << 16 };
+
+class BatchDistInvoker : public ParallelLoopBody
 {
+public:
     BatchDistInvoker( const Mat& _src1, const Mat& _src2,
                       Mat& _dist, Mat& _nidx, int _K,
                       const Mat& _mask, int _update,
@@ -1743,37 +1857,51 @@ struct BatchDistInvoker
         func = _func;
     }
 
-    void operator()(const BlockedRange& range) const
+    void operator()(const Range& range) const
     {
-        AutoBuffer<int> buf(src2->rows);
+        int i0 = range.start*BATCH_DIST_QUERY_BLOCK;
+        int i1 = std::min(range.end*BATCH_DIST_QUERY_BLOCK, src1->rows);
+        int ntrain = src2->rows;
+        int tileSize = std::max((int)(BATCH_DIST_TRAIN_BLOCK_SIZE/std::max(src2->cols*src2->elemSize(), (size_t)1)), 1);
+        size_t dsz = dist->elemSize();
+
+        tileSize = std::min(tileSize, ntrain);
+        AutoBuffer<int> buf(std::max(tileSize, 1));
         int* bufptr = buf;
 
-        for( int i = range.begin(); i < range.end(); i++ )
+        for( int j0 = 0; j0 < ntrain; j0 += tileSize )
         {
-            func(src1->ptr(i), src2->ptr(), src2->step, src2->rows, src2->cols,
-                 K > 0 ? (uchar*)bufptr : dist->ptr(i), mask->data ? mask->ptr(i) : 0);
+            int nvecs = std::min(tileSize, ntrain - j0);
+            const uchar* tile = src2->ptr(j0);
 
-            if( K > 0 )
+            for( int i = i0; i < i1; i++ )
             {
-                int* nidxptr = nidx->ptr<int>(i);
-                // since positive float's can be compared just like int's,
-                // we handle both CV_32S and CV_32F cases with a single branch
-                int* distptr = (int*)dist->ptr(i);
+                func(src1->ptr(i), tile, src2->step, nvecs, src2->cols,
+                     K > 0 ? (uchar*)bufptr : dist->ptr(i) + j0*dsz,
+                     mask->data ? mask->ptr(i) + j0 : 0);
 
-                int j, k;
-
-                for( j = 0; j < src2->rows; j++ )
+                if( K > 0 )
                 {
-                    int d = bufptr[j];
-                    if( d < distptr[K-1] )
+                    int* nidxptr = nidx->ptr<int>(i);
+                    // since positive float's can be compared just like int's,
+                    // we handle both CV_32S and CV_32F cases with a single branch
+                    int* distptr = (int*)dist->ptr(i);
+
+                    int j, k;
+
+                    for( j = 0; j < nvecs; j++ )
                     {
-                        for( k = K-2; k >= 0 && distptr[k] > d; k-- )
+                        int d = bufptr[j];
+                        if( d < distptr[K-1] )
                         {
-                            nidxptr[k+1] = nidxptr[k];
-                            distptr[k+1] = distptr[k];
+                            for( k = K-2; k >= 0 && distptr[k] > d; k-- )
+                            {
+                                nidxptr[k+1] = nidxptr[k];
+                                distptr[k+1] = distptr[k];
+                            }
+                            nidxptr[k+1] = j + j0 + update;
+                            distptr[k+1] = d;
                         }
-                        nidxptr[k+1] = j + update;
-                        distptr[k+1] = d;
                     }
                 }
             }
@@ -1899,8 +2027,8 @@ void cv::batchDistance( InputArray _src1, InputArray _src2,
                   ("The combination of type=%d, dtype=%d and normType=%d is not supported",
                    type, dtype, normType));
 
-    parallel_for(BlockedRange(0, src1.rows),
-                 BatchDistInvoker(src1, src2, dist, nidx, K, mask, update, func));
+    parallel_for_(Range(0, (src1.rows + BATCH_DIST_QUERY_BLOCK - 1)/BATCH_DIST_QUERY_BLOCK),
+                  BatchDistInvoker(src1, src2, dist, nidx, K, mask, update, func));
 }
 
 
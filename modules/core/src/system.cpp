@@ -134,6 +134,50 @@ void Exception::formatMessage()
         msg = format("%s:%d: error: (%d) %s\n", file.c_str(), line, code, err.c_str());
 }
 
+#if (defined _MSC_FULL_VER && _MSC_FULL_VER >= 160040219 && (defined _M_IX86 || defined _M_X64)) || \
+    (defined __GNUC__ && (defined __i386__ || defined __x86_64__))
+#  define CV_HAVE_CPUIDEX 1
+
+// cpuid with the sub-leaf set, for the leaves above 1
+static void cpuidex(int* cpuid_data, int leaf, int subleaf)
+{
+#ifdef _MSC_VER
+    __cpuidex(cpuid_data, leaf, subleaf);
+#elif defined __x86_64__
+    asm __volatile__
+    (
+     "cpuid\n\t"
+     :[eax]"=a"(cpuid_data[0]),[ebx]"=b"(cpuid_data[1]),[ecx]"=c"(cpuid_data[2]),[edx]"=d"(cpuid_data[3])
+     : "a"(leaf), "c"(subleaf)
+     : "cc"
+    );
+#else
+    asm volatile
+    (
+     "movl %%ebx, %%esi\n\t"
+     "cpuid\n\t"
+     "xchgl %%ebx, %%esi\n\t"
+     : "=a"(cpuid_data[0]), "=S"(cpuid_data[1]), "=c"(cpuid_data[2]), "=d"(cpuid_data[3])
+     : "a"(leaf), "c"(subleaf)
+     : "cc"
+    );
+#endif
+}
+
+// the register state saved by the OS on context switches (XCR0)
+static unsigned getXCR0(void)
+{
+#ifdef _MSC_VER
+    return (unsigned)_xgetbv(0);
+#else
+    unsigned xcr0 = 0, xcr0_hi = 0;
+    // xgetbv, spelled out for the old assemblers
+    asm volatile(".byte 0x0f, 0x01, 0xd0" : "=a"(xcr0), "=d"(xcr0_hi) : "c"(0));
+    return xcr0;
+#endif
+}
+#endif
+
 struct HWFeatures
 {
     enum { MAX_FEATURE = CV_HARDWARE_MAX_FEATURE };
@@ -187,6 +231,21 @@ struct HWFeatures
             f.have[CV_CPU_SSE4_2] = (cpuid_data[2] & (1<<20)) != 0;
             f.have[CV_CPU_POPCNT] = (cpuid_data[2] & (1<<23)) != 0;
             f.have[CV_CPU_AVX]    = (((cpuid_data[2] & (1<<28)) != 0)&&((cpuid_data[2] & (1<<27)) != 0));//OS uses XSAVE_XRSTORE and CPU support AVX
+
+        #ifdef CV_HAVE_CPUIDEX
+            // the OS has to save the YMM registers as well
+            if( f.have[CV_CPU_AVX] && (getXCR0() & 6) != 6 )
+                f.have[CV_CPU_AVX] = false;
+
+            int maxLeaf[4] = { 0, 0, 0, 0 };
+            cpuidex(maxLeaf, 0, 0);
+            if( f.have[CV_CPU_AVX] && maxLeaf[0] >= 7 )
+            {
+                int cpuid_data7[4] = { 0, 0, 0, 0 };
+                cpuidex(cpuid_data7, 7, 0);
+                f.have[CV_CPU_AVX2] = (cpuid_data7[1] & (1<<5)) != 0;
+            }
+        #endif
         }
 
         return f;
@@ -219,12 +278,16 @@ IPPInitializer ippInitializer;
 volatile bool USE_SSE2 = featuresEnabled.have[CV_CPU_SSE2];
 volatile bool USE_SSE4_2 = featuresEnabled.have[CV_CPU_SSE4_2];
 volatile bool USE_AVX = featuresEnabled.have[CV_CPU_AVX];
+volatile bool USE_AVX2 = featuresEnabled.have[CV_CPU_AVX2];
 
 void setUseOptimized( bool flag )
 {
     useOptimizedFlag = flag;
     currentFeatures = flag ? &featuresEnabled : &featuresDisabled;
     USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+    USE_SSE4_2 = currentFeatures->have[CV_CPU_SSE4_2];
+    USE_AVX = currentFeatures->have[CV_CPU_AVX];
+    USE_AVX2 = currentFeatures->have[CV_CPU_AVX2];
 }
 
 bool useOptimized(void)
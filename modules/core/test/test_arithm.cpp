@@ -1530,4 +1530,99 @@ TEST(Multiply, FloatingPointRounding)
     cv::multiply(src, s, dst, 1, CV_16U);
     // with CV_32F this produce result 16202
     ASSERT_EQ(dst.at<ushort>(0,0), 16201);
-}
\ No newline at end of file
+}
+
+static int refHamming(const uchar* a, const uchar* b, int n, int cellSize)
+{
+    int result = 0, mask = (1 << cellSize) - 1;
+    for( int i = 0; i < n; i++ )
+        for( int k = 0; k < 8; k += cellSize )
+            result += ((a[i] ^ b[i]) >> k) & mask ? 1 : 0;
+    return result;
+}
+
+TEST(Core_BatchDistance, hamming)
+{
+    RNG& rng = theRNG();
+    const int lens[] = { 32, 37, 64, 100 };
+
+    for( int l = 0; l < (int)(sizeof(lens)/sizeof(lens[0])); l++ )
+        for( int normType = NORM_HAMMING; normType <= NORM_HAMMING2; normType++ )
+        {
+            int len = lens[l], cellSize = normType == NORM_HAMMING ? 1 : 2, K = 3;
+            Mat queries(37, len, CV_8U), train(2500, len, CV_8U), dist, knnDist, knnIdx;
+            rng.fill(queries, RNG::UNIFORM, 0, 256);
+            rng.fill(train, RNG::UNIFORM, 0, 256);
+            // make some of the distances equal to check the order of neighbors
+            train.row(7).copyTo(train.row(1500));
+
+            batchDistance(queries, train, dist, CV_32S, noArray(), normType);
+            batchDistance(queries, train, knnDist, CV_32S, knnIdx, normType, K);
+            ASSERT_EQ(Size(train.rows, queries.rows), dist.size());
+
+            // the kernel chosen at runtime gives the same result as the generic one
+            Mat dist0;
+            {
+                cvtest::ParallelSettingsGuard guard;
+                setUseOptimized(false);
+                batchDistance(queries, train, dist0, CV_32S, noArray(), normType);
+            }
+            ASSERT_EQ(0., norm(dist, dist0, NORM_INF)) << "len=" << len << ", normType=" << normType;
+
+            for( int i = 0; i < queries.rows; i++ )
+            {
+                vector<std::pair<int, int> > ref(train.rows);
+                for( int j = 0; j < train.rows; j++ )
+                {
+                    int d = refHamming(queries.ptr(i), train.ptr(j), len, cellSize);
+                    ASSERT_EQ(d, dist.at<int>(i, j)) << "len=" << len << ", normType=" << normType;
+                    ref[j] = std::make_pair(d, j);
+                }
+                std::sort(ref.begin(), ref.end());
+                for( int k = 0; k < K; k++ )
+                {
+                    ASSERT_EQ(ref[k].first, knnDist.at<int>(i, k));
+                    ASSERT_EQ(ref[k].second, knnIdx.at<int>(i, k));
+                }
+            }
+            EXPECT_EQ(refHamming(queries.ptr(0), train.ptr(0), len, cellSize),
+                      norm(queries.row(0), train.row(0), normType));
+        }
+}
+
+// the SIMD paths (including the runtime-dispatched AVX/AVX2 kernels) must give the same results as the plain C code
+TEST(Core_Arithm, optimized_equals_plain)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1, CV_32FC4 };
+    const Size sizes[] = { Size(640, 480), Size(77, 33), Size(1, 100) };
+    cvtest::ParallelSettingsGuard guard;
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+        for( size_t j = 0; j < sizeof(sizes)/sizeof(sizes[0]); j++ )
+        {
+            Mat a(sizes[j], types[i]), b(sizes[j], types[i]);
+            rng.fill(a, RNG::UNIFORM, 0, 256);
+            rng.fill(b, RNG::UNIFORM, 0, 256);
+
+            Mat dst[2][6];
+            double dot[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                add(a, b, dst[k][0]);
+                subtract(a, b, dst[k][1]);
+                min(a, b, dst[k][2]);
+                max(a, b, dst[k][3]);
+                absdiff(a, b, dst[k][4]);
+                if( a.depth() == CV_32F )
+                    scaleAdd(a, 0.75, b, dst[k][5]);
+                dot[k] = a.dot(b);
+            }
+
+            for( int op = 0; op < (a.depth() == CV_32F ? 6 : 5); op++ )
+                EXPECT_EQ(0, norm(dst[0][op], dst[1][op], NORM_INF)) << "type " << types[i] << ", size " << j << ", op " << op;
+            if( a.depth() == CV_8U )
+                EXPECT_EQ(dot[0], dot[1]) << "type " << types[i] << ", size " << j;
+        }
+}
@@ -91,7 +91,7 @@ protected:
             {-1000000, 1000000}, {-10, 10}, {-10, 10}};
         RNG& rng = ts->get_rng();
         RNG rng0;
-        test_case_count = 4;
+        test_case_count = 6;
         int progress = 0;
         MemStorage storage(cvCreateMemStorage(0));
 
@@ -102,10 +102,12 @@ protected:
 
             cvClearMemStorage(storage);
 
-            bool mem = (idx % 4) >= 2;
-            string filename = tempfile(idx % 2 ? ".yml" : ".xml");
+            bool mem = (idx % 4) >= 2 && idx < 4;
+            bool binary = idx >= 4;
+            string filename = tempfile(binary ? ".bin" : idx % 2 ? ".yml" : ".xml");
 
-            FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0));
+            FileStorage fs(filename, FileStorage::WRITE + (mem ? FileStorage::MEMORY : 0) +
+                           (binary ? FileStorage::FORMAT_BINARY : 0));
 
             int test_int = (int)cvtest::randInt(rng);
             double test_real = (cvtest::randInt(rng)%2?1:-1)*exp(cvtest::randReal(rng)*18-9);
@@ -454,3 +456,152 @@ protected:
 TEST(Core_InputOutput, huge) { CV_BigMatrixIOTest test; test.safe_run(); }
 */
 
+
+TEST(Core_InputOutput, binary)
+{
+    struct Rec { int i; uchar u; } recs[] = { {-7, 1}, {100000, 2}, {42, 255} }, recs2[3];
+    string fname = cv::tempfile(".bin");
+    Mat m(30, 20, CV_32FC3), roi = m(Rect(3, 5, 11, 7));
+    int sz[] = { 4, 5, 6 };
+    Mat nd(3, sz, CV_16S);
+    vector<int> vi, vi2;
+    randu(m, Scalar::all(-1), Scalar::all(1));
+    randu(nd, Scalar::all(-1000), Scalar::all(1000));
+    for( int i = 0; i < 100; i++ )
+        vi.push_back(i*i - 50);
+
+    {
+        FileStorage fs(fname, FileStorage::WRITE + FileStorage::FORMAT_BINARY);
+        ASSERT_TRUE(fs.isOpened());
+        fs << "int" << 5 << "real" << 0.25 << "str" << "binary storage";
+        fs << "m" << m << "roi" << roi << "nd" << nd << "vi" << vi;
+        fs << "nested" << "{" << "list" << "[" << 1 << 2.5 << "three" << "]" << "recs" << "[:";
+        cvWriteRawData(*fs, recs, 3, "iu");
+        fs << "]" << "}";
+    }
+
+    FileStorage fs(fname, FileStorage::READ);
+    ASSERT_TRUE(fs.isOpened());
+    EXPECT_EQ(5, (int)fs["int"]);
+    EXPECT_EQ(0.25, (double)fs["real"]);
+    EXPECT_EQ(string("binary storage"), (string)fs["str"]);
+
+    Mat m2, roi2, nd2;
+    fs["m"] >> m2;
+    fs["roi"] >> roi2;
+    fs["nd"] >> nd2;
+    ASSERT_EQ(m.type(), m2.type());
+    ASSERT_EQ(m.size(), m2.size());
+    EXPECT_EQ(0, (int)((size_t)m2.data & 63));
+    EXPECT_EQ(0, norm(m, m2, NORM_INF));
+    EXPECT_EQ(0, norm(roi, roi2, NORM_INF));
+    EXPECT_EQ(0, norm(nd, nd2, NORM_INF));
+
+    fs["vi"] >> vi2;
+    EXPECT_EQ(vi, vi2);
+    EXPECT_EQ(2450, (int)fs["vi"][50]);
+
+    FileNode nested = fs["nested"];
+    EXPECT_EQ(1, (int)nested["list"][0]);
+    EXPECT_EQ(2.5, (double)nested["list"][1]);
+    EXPECT_EQ(string("three"), (string)nested["list"][2]);
+    FileNode recsNode = nested["recs"];
+    cvReadRawData(*fs, *recsNode, recs2, "iu");
+    for( int i = 0; i < 3; i++ )
+    {
+        EXPECT_EQ(recs[i].i, recs2[i].i);
+        EXPECT_EQ(recs[i].u, recs2[i].u);
+    }
+    EXPECT_EQ(100000, (int)nested["recs"][2]);
+
+    // the matrices keep the mapped data after the storage is closed
+    fs.release();
+    EXPECT_EQ(0, norm(m, m2, NORM_INF));
+    m2.create(3, 3, CV_8U);
+    m2.setTo(Scalar::all(1));
+    roi2.release();
+    nd2.release();
+    remove(fname.c_str());
+}
+
+// reads the elements of the raw data blocks one by one, which converts the blocks to file nodes
+class BinaryStorageReadBody : public ParallelLoopBody
+{
+public:
+    BinaryStorageReadBody(const FileStorage& _fs, const vector<int>& _vi, vector<int>& _errors)
+        : fs(_fs), vi(_vi), errors(_errors) {}
+
+    void operator()(const Range& range) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+        {
+            FileNode node = fs[k % 2 ? "vi" : "vi2"];
+            FileNodeIterator it = node.begin();
+            for( int i = 0; i < (int)vi.size(); i++, ++it )
+                errors[k] += ((int)node[i] != vi[i]) + ((int)*it != vi[i]);
+        }
+    }
+
+private:
+    const FileStorage& fs;
+    const vector<int>& vi;
+    vector<int>& errors;
+};
+
+TEST(Core_InputOutput, binary_c_api_and_threads)
+{
+    string fname = cv::tempfile(".bin");
+    vector<int> vi;
+    for( int i = 0; i < 1000; i++ )
+        vi.push_back(i*3 - 7);
+    Mat m(10, 10, CV_8U, Scalar::all(7));
+
+    {
+        FileStorage fs(fname, FileStorage::WRITE + FileStorage::FORMAT_BINARY);
+        ASSERT_TRUE(fs.isOpened());
+        fs << "vi" << vi << "vi2" << vi << "m" << m;
+    }
+
+    {
+        FileStorage fs(fname, FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+        vector<int> errors(64, 0);
+        parallel_for_(Range(0, (int)errors.size()), BinaryStorageReadBody(fs, vi, errors));
+        EXPECT_EQ(0, countNonZero(errors));
+    }
+
+    // a C API lookup converts only the returned node, and the readers keep the raw data as it is
+    {
+        FileStorage fs2(fname, FileStorage::READ);
+        ASSERT_TRUE(fs2.isOpened());
+        FileNode vi2 = fs2["vi2"], mdata = fs2["m"]["data"];
+        ASSERT_TRUE(CV_NODE_SEQ_IS_BINARY((*vi2)->data.seq));
+        ASSERT_TRUE(CV_NODE_SEQ_IS_BINARY((*mdata)->data.seq));
+        ASSERT_TRUE(cvGetFileNodeByName(*fs2, 0, "vi") != 0);
+        EXPECT_TRUE(CV_NODE_SEQ_IS_BINARY((*vi2)->data.seq));
+        CvMat* m3 = (CvMat*)cvRead(*fs2, *fs2["m"]);
+        ASSERT_TRUE(m3 != 0);
+        EXPECT_EQ(0, norm(m, Mat(m3), NORM_INF));
+        EXPECT_TRUE(CV_NODE_SEQ_IS_BINARY((*mdata)->data.seq));
+        cvReleaseMat(&m3);
+    }
+
+    // the nodes returned by the C API hold the regular sequences of file nodes
+    CvFileStorage* fs =cvOpenFileStorage(fname.c_str(), 0, CV_STORAGE_READ);
+    ASSERT_TRUE(fs != 0);
+    CvFileNode* node = cvGetFileNodeByName(fs, 0, "vi");
+    ASSERT_TRUE(node != 0 && CV_NODE_IS_SEQ(node->tag));
+    ASSERT_FALSE(CV_NODE_SEQ_IS_BINARY(node->data.seq));
+    ASSERT_EQ((int)vi.size(), node->data.seq->total);
+    for( int i = 0; i < (int)vi.size(); i++ )
+        EXPECT_EQ(vi[i], ((CvFileNode*)cvGetSeqElem(node->data.seq, i))->data.i);
+    CvFileNode* data = cvGetFileNodeByName(fs, cvGetFileNodeByName(fs, 0, "m"), "data");
+    ASSERT_TRUE(data != 0 && CV_NODE_IS_SEQ(data->tag));
+    EXPECT_FALSE(CV_NODE_SEQ_IS_BINARY(data->data.seq));
+    CvMat* m2 = (CvMat*)cvReadByName(fs, 0, "m");
+    ASSERT_TRUE(m2 != 0);
+    EXPECT_EQ(0, norm(m, Mat(m2), NORM_INF));
+    cvReleaseMat(&m2);
+    cvReleaseFileStorage(&fs);
+    remove(fname.c_str());
+}
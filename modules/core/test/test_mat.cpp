@@ -1111,3 +1111,66 @@ TEST(Core_Mat, reshape_1942)
     );
     ASSERT_EQ(1, cn);
 }
+
+TEST(Core_Mat, poolAllocator)
+{
+    PoolMatAllocator pool;
+    const Size sizes[] = { Size(1, 1), Size(13, 7), Size(640, 480), Size(1920, 1080) };
+
+    for( int iter = 0; iter < 3; iter++ )
+        for( size_t i = 0; i < sizeof(sizes)/sizeof(sizes[0]); i++ )
+        {
+            Mat m;
+            m.allocator = &pool;
+            m.create(sizes[i], CV_8UC3);
+            ASSERT_EQ(&pool, m.allocator);
+            ASSERT_EQ(0, (int)((size_t)m.data & 63));
+            m.setTo(Scalar::all((double)i));
+            ASSERT_EQ(0, norm(m, Mat(m.size(), m.type(), Scalar::all((double)i)), NORM_INF));
+
+            PoolMatAllocator::Stats s = pool.getStats();
+            ASSERT_LE(m.total()*m.elemSize(), s.bytesInUse);
+        }
+
+    PoolMatAllocator::Stats s = pool.getStats();
+    EXPECT_EQ(4, s.misses);
+    EXPECT_EQ(8, s.hits);
+    EXPECT_EQ(0u, s.bytesInUse);
+    EXPECT_EQ(s.bytesReserved, s.bytesCached);
+
+    pool.releaseCachedMemory();
+    s = pool.getStats();
+    EXPECT_EQ(0u, s.bytesCached);
+    EXPECT_EQ(0u, s.bytesReserved);
+}
+
+TEST(Core_Mat, poolAllocatorAsDefault)
+{
+    MatAllocator* prevAllocator = getDefaultAllocator();
+    PoolMatAllocator pool;
+    setDefaultAllocator(&pool);
+
+    Mat a(480, 640, CV_32F, Scalar::all(1)), b;
+    a.copyTo(b);
+    setDefaultAllocator(prevAllocator);
+
+    EXPECT_EQ(&pool, a.allocator);
+    EXPECT_EQ(&pool, b.allocator);
+    EXPECT_EQ(0, norm(a, b, NORM_INF));
+    EXPECT_EQ(2u*alignSize(a.total()*a.elemSize() + sizeof(int), 4096), pool.getStats().bytesInUse);
+
+    // the matrices do not keep the default allocator after their data is released
+    Mat c = a;
+    a.release();
+    EXPECT_TRUE(a.allocator == 0);
+    EXPECT_EQ(&pool, c.allocator);
+    b.create(10, 10, CV_8U);
+    EXPECT_EQ(prevAllocator, b.allocator);
+
+    Mat d;
+    d.allocator = &pool;
+    d.create(10, 10, CV_8U);
+    d.release();
+    d.create(20, 20, CV_8U);
+    EXPECT_EQ(&pool, d.allocator);
+}
@@ -39,4 +39,70 @@ TEST(Core_OutputArraySreate, _1997)
     Size submatSize = Size(256, 256);
 
     ASSERT_NO_THROW(local::create( mat(Rect(Point(), submatSize)), submatSize, mat.type() ));
-}
\ No newline at end of file
+}
+
+class ParallelSumBody : public ParallelLoopBody
+{
+public:
+    ParallelSumBody(Mat& _counts, int _nested) : counts(&_counts), nested(_nested) {}
+
+    void operator()(const Range& range) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            if( nested > 0 )
+            {
+                Mat row = counts->row(i);
+                parallel_for_(Range(0, row.cols), ParallelSumBody(row, nested - 1));
+            }
+            else
+                CV_XADD(&counts->at<int>(i), 1);
+        }
+    }
+
+protected:
+    Mat* counts;
+    int nested;
+};
+
+class ParallelThrowBody : public ParallelLoopBody
+{
+public:
+    void operator()(const Range& range) const
+    {
+        if( range.start <= 50 && 50 < range.end )
+            CV_Error(CV_StsError, "stripe 50");
+    }
+};
+
+TEST(Core_Parallel, visitsEveryIndexOnce)
+{
+    cvtest::ParallelSettingsGuard guard;
+
+    int threads[] = { 0, 1, 2, 4, 16 };
+    double stripes[] = { -1., 1., 3., 1000. };
+
+    for( size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); t++ )
+    {
+        setNumThreads(threads[t]);
+        for( size_t s = 0; s < sizeof(stripes)/sizeof(stripes[0]); s++ )
+        {
+            Mat counts(1, 1000, CV_32S, Scalar(0));
+            parallel_for_(Range(0, counts.cols), ParallelSumBody(counts, 0), stripes[s]);
+            ASSERT_EQ(counts.cols, countNonZero(counts == 1)) << "threads=" << threads[t] << " nstripes=" << stripes[s];
+        }
+
+        Mat counts(32, 64, CV_32S, Scalar(0));
+        parallel_for_(Range(0, counts.rows), ParallelSumBody(counts, 1));
+        ASSERT_EQ((int)counts.total(), countNonZero(counts == 1)) << "threads=" << threads[t];
+    }
+}
+
+TEST(Core_Parallel, propagatesException)
+{
+    cvtest::ParallelSettingsGuard guard;
+    setNumThreads(4);
+
+    EXPECT_THROW(parallel_for_(Range(0, 100), ParallelThrowBody()), cv::Exception);
+    EXPECT_NO_THROW(parallel_for_(Range(51, 100), ParallelThrowBody()));
+}
@@ -1155,6 +1155,8 @@ protected:
 
         // Vector of matrices "descriptors" will be merged to one matrix "mergedDescriptors" here.
         void set( const vector<Mat>& descriptors );
+        // Appends the matrices to "mergedDescriptors" as the next images.
+        void add( const vector<Mat>& descriptors );
         virtual void clear();
 
         const Mat& getDescriptors() const;
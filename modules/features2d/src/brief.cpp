@@ -49,48 +49,218 @@
 
 using namespace cv;
 
-inline int smoothedSum(const Mat& sum, const KeyPoint& pt, int y, int x)
+/* The test pairs of the 64-byte descriptor as (y1,x1, y2,x2): bit k of the descriptor is set if the
+ * smoothed intensity at the first point is less than the one at the second point. The 16- and 32-byte
+ * descriptors use the first 128 and 256 pairs.
+ */
+static const int brief_test_pairs_[512*4] =
+{
+    -11,8, -15,5, -2,8, 2,4, -14,5, 5,-3, 13,2, -1,0,
+    1,6, -10,-7, 1,-2, 11,2, -14,-1, -3,3, -2,-1, 7,-1,
+    -1,14, -5,-14, 14,7, 8,5, 22,-2, -11,-8, -7,-6, 5,-5,
+    3,6, 5,6, -3,-1, 8,1, -12,6, -10,8, -6,-23, 8,-9,
+    -10,3, 4,9, 2,3, 9,10, 4,-5, 0,11, -3,-7, -10,-18,
+    -5,9, 7,-1, -6,6, -8,-5, 7,-3, 22,6, -14,9, 2,0,
+    0,8, 3,22, -12,1, -12,2, 13,-4, -3,-4, 0,-6, -10,17,
+    7,-23, -5,5, 14,-1, 7,8, 1,15, -11,-5, 0,12, -3,19,
+    11,-7, 7,1, 4,-11, 5,5, 8,3, 0,14, 3,-6, -4,-15,
+    2,-12, 19,-2, 7,15, -5,0, -16,17, 6,10, -13,13, 3,-1,
+    10,4, 4,-7, 5,-7, -6,5, -14,-2, 0,4, 6,8, 5,-10,
+    3,-17, -6,2, 5,1, -5,11, -3,2, 14,1, 6,12, 21,3,
+    -2,12, -4,-15, -5,-14, 7,5, 3,-10, -8,24, 19,-20, 17,-2,
+    1,-7, 2,-3, -4,22, -5,3, -1,-3, 0,18, 22,0, 7,-18,
+    5,10, 0,24, -7,-4, 15,-6, 15,4, 10,1, 6,-11, -3,-22,
+    -5,6, -7,-11, -8,-12, 5,0, 20,13, 3,5, 4,12, 0,-19,
+    2,-21, -3,2, -6,-1, -6,-5, 8,10, 13,-2, -19,-12, 4,3,
+    -1,-1, -7,3, -13,8, -18,-22, -13,14, 4,-4, 3,6, 22,-2,
+    7,-11, 18,12, 4,0, -20,4, -18,5, -4,5, 4,3, 19,-7,
+    -7,10, -11,6, 1,-1, 9,18, -6,-5, -12,-1, 4,-7, 0,16,
+    -8,-6, -1,12, 17,-9, -2,8, -7,2, 1,6, 17,3, 2,-8,
+    -4,1, -14,13, -18,6, -7,3, 2,15, 19,-11, -20,17, -18,7,
+    -8,-2, 9,-4, -7,-4, 17,-7, -14,-1, 3,-2, 0,22, -4,-15,
+    8,-9, 15,0, -8,-1, -7,-9, -2,7, 6,8, -2,4, -1,6,
+    -6,-3, 2,1, -6,-6, -15,7, -6,2, 6,10, 2,-6, 3,-20,
+    5,-11, -9,-6, 11,-4, 0,8, -5,13, -8,11, 5,-7, 7,7,
+    -8,10, -11,-2, -23,-14, -13,-19, 19,0, 5,-17, 22,11, 0,-3,
+    -16,0, 6,8, 0,-7, -1,-1, 7,-12, 14,5, 11,0, -3,2,
+    -7,-13, -13,10, 3,-6, 10,-18, -3,-1, 7,-10, -1,-5, 15,2,
+    4,7, 8,-1, -12,1, -5,-5, 1,-7, 14,0, -11,6, -10,13,
+    3,9, 8,2, 2,14, 8,7, -2,-2, 8,-10, 3,-5, 1,-5,
+    1,-2, 12,-7, -4,-13, 7,1, -19,14, 8,-14, 1,-1, 13,-10,
+    -23,10, 1,2, 11,6, -5,0, -3,-6, -16,-5, 1,5, 10,10,
+    -13,-9, -2,6, 0,9, -14,-10, 4,0, 1,12, -9,1, -18,0,
+    -23,-3, 17,-2, -14,-12, -10,-3, -14,10, 15,19, 4,-8, 0,-9,
+    19,20, -9,2, 10,13, -11,8, -4,-1, -13,-5, 13,-5, -3,9,
+    -13,-5, 1,-17, 8,13, 1,-16, -7,-2, 1,23, 17,4, 17,-11,
+    2,-2, -5,4, -5,5, 3,-13, 19,-2, -4,2, -3,-11, 6,-14,
+    1,1, -2,-8, 4,-1, 6,2, 2,-15, -2,12, -4,-16, 6,3,
+    5,0, 5,2, -9,0, -7,-2, -5,-9, -2,-10, 4,6, -8,-3,
+    -1,-10, 7,-18, -13,1, -7,2, -3,-8, 0,5, 6,12, 2,5,
+    -4,10, -9,4, 2,-10, 3,1, -8,8, -9,9, -2,12, -5,-2,
+    -17,-13, -3,2, -19,-12, 5,-11, -20,-8, -13,3, 15,2, -10,-3,
+    0,11, -4,-7, -5,-3, 3,2, -23,-1, 6,2, -1,8, -9,-10,
+    -3,5, -7,-12, 4,16, 3,-14, -12,24, -7,-4, 13,21, -11,6,
+    3,10, 7,-3, -4,11, 0,-4, 5,-1, -14,-6, 7,4, -12,0,
+    -7,-21, 6,-14, -13,1, -6,0, -3,-10, 8,3, 7,-10, -1,14,
+    2,-8, 23,-11, 22,-6, -11,5, -17,-9, 13,-7, 0,-4, 7,-5,
+    11,-19, -1,-18, -13,14, 17,-3, -3,-9, -5,10, 18,-3, -1,7,
+    -10,6, -11,-2, -1,21, 1,-5, 10,7, -1,-4, 18,19, -4,-6,
+    -10,-16, -7,7, -1,11, 3,11, -9,4, -15,-9, -3,0, -15,0,
+    14,6, -3,-6, -4,-11, 2,-8, 0,-5, -2,-9, 8,-2, -18,-23,
+    -7,7, -19,-7, -10,0, 8,11, 6,12, -16,24, -16,-3, -2,2,
+    -15,11, 6,-6, 13,-8, -15,-11, -5,-3, 5,-23, -2,-10, -10,-2,
+    19,0, 9,3, 11,-7, -8,-6, -8,12, 9,6, 7,0, 1,17,
+    21,1, 8,7, 3,2, -10,9, 9,7, -7,-16, 5,16, 9,-3,
+    -7,-5, 5,-12, -15,-10, -15,-14, -10,-9, -14,-7, 17,-4, -6,-7,
+    4,12, 0,-21, 12,-2, -15,-6, 0,8, -2,14, 1,-7, -5,-11,
+    1,12, 4,-14, -4,17, 13,-11, -4,19, -23,-4, 4,-3, -1,5,
+    -10,5, -15,6, -4,-21, -6,4, 5,2, -6,-23, -4,0, 15,-4,
+    -6,0, 2,-4, -14,-8, -3,9, 12,16, 8,7, 18,15, 11,-4,
+    -19,9, 9,-3, -8,-20, 3,1, 4,5, 3,20, -11,-6, -20,10,
+    6,2, -6,6, 9,9, 7,15, -1,-2, -7,2, -9,6, -12,-7,
+    8,-6, 5,2, 9,12, -7,-23, 8,-7, -6,18, 1,-10, -1,2,
+    -1,-11, -1,3, -1,3, -19,4, -11,2, 7,9, -12,-1, -11,0,
+    8,1, 3,1, -2,-1, 2,17, 4,3, 6,0, 16,12, 0,19,
+    2,-4, 6,-13, 2,-7, 9,-6, -13,-10, -7,-1, -3,-3, -18,-6,
+    24,-14, -2,-10, 3,7, -9,-8, -2,3, 6,11, 1,-10, -10,-4,
+    12,-11, -8,-16, -6,-4, 12,14, -5,-7, -3,-6, -19,0, -23,-5,
+    4,-2, 11,-9, -11,5, -6,-11, -4,2, 9,13, 4,-4, -2,3,
+    2,3, 11,7, 11,-11, -12,2, -7,0, 4,-8, 3,-4, -2,-2,
+    1,-1, -9,8, 6,-1, -8,-2, -2,-1, -8,16, -21,15, -12,6,
+    -15,9, 8,17, 8,4, -11,-3, 9,0, 1,16, 0,8, 5,1,
+    -3,-1, 8,-10, 3,-7, -10,-5, 3,-7, -5,0, -7,-4, -9,-6,
+    -5,7, -18,-3, 10,6, 8,9, 5,-7, 7,-5, -6,4, -6,-10,
+    -12,-13, -2,4, 1,1, 15,-8, -6,-11, -10,-3, 0,2, -9,17,
+    6,17, 9,17, 4,11, 10,-4, 4,9, 7,-3, -14,-14, -4,-4,
+    7,-21, -5,-13, -11,2, -16,0, -10,-13, -5,-3, -6,3, 5,4,
+    11,-7, -13,3, 8,5, 10,-2, 10,0, 4,-11, 13,-8, 0,-6,
+    3,2, 12,16, -13,5, 10,-5, -6,-16, -6,8, -10,8, 0,-11,
+    7,-6, 6,3, -11,-5, -8,-6, -13,6, -14,7, -3,8, 12,-12,
+    -3,15, 8,-10, 11,-6, 7,6, -14,-2, -11,16, 2,4, -7,-3,
+    -2,-8, -10,4, 3,-7, -10,0, 4,-9, -6,-3, -14,8, -5,2,
+    -5,1, 4,-4, -17,10, 2,8, 9,16, 10,13, -4,10, 5,1,
+    2,-1, 4,11, 9,-21, 10,2, -8,1, -3,4, 11,15, -6,5,
+    14,0, -9,9, -4,17, -5,2, 2,-8, 8,-9, -8,5, -9,24,
+    1,-4, -7,11, 3,-1, 8,-15, -12,-2, 5,6, 4,6, -10,6,
+    11,10, 0,-1, 6,5, -13,7, -8,17, -14,-10, 24,3, 2,-2,
+    3,-1, -5,-17, -13,-1, -16,2, 2,0, -9,2, 7,-8, -20,-18,
+    -2,-11, -1,12, -3,-2, -1,4, 6,-12, 10,1, 1,11, 5,0,
+    -6,7, -2,11, 6,7, -10,12, 13,-10, -6,6, -2,-7, -6,0,
+    6,22, -3,-23, 2,-8, 2,6, -13,-12, 6,15, 15,8, 3,-14,
+    -21,-10, 10,8, 6,12, 13,-11, 0,8, -3,23, 2,-2, -7,6,
+    12,-5, 7,-13, -2,-8, 7,12, -4,-1, -11,-14, 0,-22, -2,-17,
+    0,-5, -8,6, 11,-23, 21,-5, 8,-9, 7,-1, 5,0, -11,-1,
+    -5,-11, 8,-11, -21,-10, 12,-11, 7,-6, -5,-12, -3,0, 7,15,
+    0,15, -3,-16, -4,-13, 4,7, 2,12, 13,-12, 4,5, 13,11,
+    -6,12, -11,3, -5,-20, -12,9, -7,5, 3,-2, -6,8, 8,12,
+    11,-4, 0,-6, 14,0, -2,-5, 19,-13, -11,15, 5,3, 14,-7,
+    9,-19, 2,5, -13,3, 23,10, 4,-14, 16,-11, -3,2, -2,14,
+    13,4, 14,-6, 1,3, 4,-10, 2,-17, -7,-3, 0,-13, 23,-6,
+    -13,-10, 7,-12, 1,3, -10,-8, -11,-15, -7,-17, -2,5, -13,-8,
+    -1,7, 2,-2, 2,-1, -4,11, -11,1, -1,-11, 7,5, -4,-7,
+    9,-10, 19,0, 7,-1, 5,7, 9,-8, 10,-5, -19,-2, -1,5,
+    11,4, 0,-3, -8,2, -6,15, -4,-2, -1,9, 0,-16, 24,-5,
+    -3,-6, -1,-4, -16,-2, 7,-6, -4,-18, 8,-18, 1,-20, -9,-6,
+    -16,3, -7,-14, -2,-1, 4,-23, -2,13, -15,4, 17,-5, 11,-10,
+    15,-9, -3,-15, 24,15, -8,-1, -7,-9, 12,-6, 7,6, 2,-10,
+    8,-5, -15,2, -1,-8, 19,10, 5,4, 13,-6, -9,17, -3,0,
+    12,9, 9,-14, -1,4, 1,8, -5,3, -2,-1, -3,-5, -10,-9,
+    3,-7, 1,-6, 8,-2, -9,-2, -2,18, -5,17, 5,-1, -8,-4,
+    8,-4, -7,16, 8,-2, 14,4, 12,0, 24,4, -12,-9, -4,-5,
+    -5,-11, -22,-4, 12,-6, -2,3, -8,8, 24,8, -7,-21, 12,-19,
+    -4,-1, -1,0, -3,-13, 3,9, -8,-10, 14,1, -5,-22, -5,-2,
+    14,6, -12,3, 4,4, 2,-7, -7,17, 1,-6, 24,-6, -3,-11,
+    1,12, 17,21, -10,23, -9,18, -16,24, 7,-9, -3,5, -4,4,
+    4,-2, -4,7, 6,-9, -9,12, -3,-1, 6,6, 15,-5, 1,14,
+    7,0, -23,1, 5,2, 6,-3, -10,5, 7,12, -6,0, -16,13,
+    12,4, 6,10, 7,5, -1,-5, 5,11, 0,-13, 5,-14, 6,11,
+    16,0, -3,3, 2,-12, -6,-3, -13,0, 6,-10, -4,-5, 4,4,
+    -15,14, 10,-10, -8,-6, 0,9, 9,-14, -23,3, -1,3, -1,2,
+    2,8, 12,24, 11,-14, -13,0, 4,10, -14,5, -10,4, -1,-11,
+    1,2, -9,-12, -20,2, 1,6, -5,-1, -9,4, 9,0, 22,-4,
+    -11,-6, -4,-18, 1,0, 1,8, 11,5, -3,-15, -10,-6, -7,-5,
+    -5,13, -8,2, -7,-7, 1,-23, 9,22, -15,15, 11,9, 8,1,
+    -8,-12, 7,-3, 17,-4, -8,-1, 19,4, 4,11, 5,15, 4,-6,
+    -12,-2, 3,-19, -12,-16, 15,6, -6,-1, 14,-2, -17,-13, -3,2,
+    -2,-5, 6,0, -20,7, -10,-23, 3,-18, 14,-5, 3,-5, 11,-11
+};
+
+static void pixelTests(const Mat& sum, const std::vector<KeyPoint>& keypoints, Mat& descriptors, int bytes)
 {
     static const int HALF_KERNEL = BriefDescriptorExtractor::KERNEL_SIZE / 2;
 
-    int img_y = (int)(pt.pt.y + 0.5) + y;
-    int img_x = (int)(pt.pt.x + 0.5) + x;
-    return   sum.at<int>(img_y + HALF_KERNEL + 1, img_x + HALF_KERNEL + 1)
-           - sum.at<int>(img_y + HALF_KERNEL + 1, img_x - HALF_KERNEL)
-           - sum.at<int>(img_y - HALF_KERNEL, img_x + HALF_KERNEL + 1)
-           + sum.at<int>(img_y - HALF_KERNEL, img_x - HALF_KERNEL);
-}
+    int npoints = bytes*8*2;
+    int sstep = (int)(sum.step/sizeof(int));
+
+    // offsets of the test points from the keypoint location in the integral image
+    AutoBuffer<int> _ofs(npoints);
+    int* ofs = _ofs;
+    for (int k = 0; k < npoints; k++)
+        ofs[k] = brief_test_pairs_[k*2]*sstep + brief_test_pairs_[k*2 + 1];
+
+    // offsets of the box filter corners from a test point
+    int a = (HALF_KERNEL + 1)*sstep + HALF_KERNEL + 1, b = (HALF_KERNEL + 1)*sstep - HALF_KERNEL;
+    int c = -HALF_KERNEL*sstep + HALF_KERNEL + 1, d = -HALF_KERNEL*sstep - HALF_KERNEL;
+
+#if CV_SSE2
+    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
 
-static void pixelTests16(const Mat& sum, const std::vector<KeyPoint>& keypoints, Mat& descriptors)
-{
     for (int i = 0; i < (int)keypoints.size(); ++i)
     {
         uchar* desc = descriptors.ptr(i);
         const KeyPoint& pt = keypoints[i];
-#include "generated_16.i"
+        const int* center = sum.ptr<int>((int)(pt.pt.y + 0.5)) + (int)(pt.pt.x + 0.5);
+
+        // 16 tests at a time: gather the smoothed sums of the pairs, then compare them all at once
+        for (int j = 0; j < bytes; j += 2)
+        {
+            int CV_DECL_ALIGNED(16) A[16];
+            int CV_DECL_ALIGNED(16) B[16];
+            const int* pofs = ofs + j*16;
+            for (int k = 0; k < 16; k++)
+            {
+                const int* p0 = center + pofs[k*2];
+                const int* p1 = center + pofs[k*2 + 1];
+                A[k] = p0[a] - p0[b] - p0[c] + p0[d];
+                B[k] = p1[a] - p1[b] - p1[c] + p1[d];
+            }
+
+            int mask = 0;
+#if CV_SSE2
+            if (useSIMD)
+            {
+                __m128i m0 = _mm_cmplt_epi32(_mm_load_si128((const __m128i*)A), _mm_load_si128((const __m128i*)B));
+                __m128i m1 = _mm_cmplt_epi32(_mm_load_si128((const __m128i*)(A + 4)), _mm_load_si128((const __m128i*)(B + 4)));
+                __m128i m2 = _mm_cmplt_epi32(_mm_load_si128((const __m128i*)(A + 8)), _mm_load_si128((const __m128i*)(B + 8)));
+                __m128i m3 = _mm_cmplt_epi32(_mm_load_si128((const __m128i*)(A + 12)), _mm_load_si128((const __m128i*)(B + 12)));
+                mask = _mm_movemask_epi8(_mm_packs_epi16(_mm_packs_epi32(m0, m1), _mm_packs_epi32(m2, m3)));
+            }
+            else
+#endif
+            {
+                for (int k = 0; k < 16; k++)
+                    mask |= (A[k] < B[k]) << k;
+            }
+            desc[j] = (uchar)mask;
+            desc[j + 1] = (uchar)(mask >> 8);
+        }
     }
 }
 
-static void pixelTests32(const Mat& sum, const std::vector<KeyPoint>& keypoints, Mat& descriptors)
+static void pixelTests16(const Mat& sum, const std::vector<KeyPoint>& keypoints, Mat& descriptors)
 {
-    for (int i = 0; i < (int)keypoints.size(); ++i)
-    {
-        uchar* desc = descriptors.ptr(i);
-        const KeyPoint& pt = keypoints[i];
+    pixelTests(sum, keypoints, descriptors, 16);
+}
 
-#include "generated_32.i"
-    }
+static void pixelTests32(const Mat& sum, const std::vector<KeyPoint>& keypoints, Mat& descriptors)
+{
+    pixelTests(sum, keypoints, descriptors, 32);
 }
 
 static void pixelTests64(const Mat& sum, const std::vector<KeyPoint>& keypoints, Mat& descriptors)
 {
-    for (int i = 0; i < (int)keypoints.size(); ++i)
-    {
-        uchar* desc = descriptors.ptr(i);
-        const KeyPoint& pt = keypoints[i];
-
-#include "generated_64.i"
-    }
+    pixelTests(sum, keypoints, descriptors, 64);
 }
 
 namespace cv
@@ -132,6 +132,20 @@ void DescriptorMatcher::DescriptorCollection::set( const vector<Mat>& descriptor
     }
 }
 
+void DescriptorMatcher::DescriptorCollection::add( const vector<Mat>& descriptors )
+{
+    for( size_t i = 0; i < descriptors.size(); i++ )
+    {
+        startIdxs.push_back( mergedDescriptors.rows );
+        if( !descriptors[i].empty() )
+        {
+            CV_Assert( mergedDescriptors.empty() ||
+                       (descriptors[i].cols == mergedDescriptors.cols && descriptors[i].type() == mergedDescriptors.type()) );
+            mergedDescriptors.push_back( descriptors[i] );
+        }
+    }
+}
+
 void DescriptorMatcher::DescriptorCollection::clear()
 {
     startIdxs.clear();
@@ -504,10 +518,34 @@ FlannBasedMatcher::FlannBasedMatcher( const Ptr<flann::IndexParams>& _indexParam
 void FlannBasedMatcher::add( const vector<Mat>& descriptors )
 {
     DescriptorMatcher::add( descriptors );
+
+    int count = 0;
     for( size_t i = 0; i < descriptors.size(); i++ )
     {
-        addedDescCount += descriptors[i].rows;
+        count += descriptors[i].rows;
+    }
+
+    // Extend the trained KD-tree or LSH index instead of rebuilding it in train().
+    // The index keeps a copy of the added rows, but refers to the rows it was built on,
+    // so this is only possible while the new descriptors fit into the allocated buffer.
+    // Mat::push_back() leaves room for more rows when it grows, so after the index is
+    // rebuilt once on the grown buffer the next additions usually fit in place.
+    if( !flannIndex.empty() && mergedDescriptors.size() == addedDescCount && addedDescCount > 0 &&
+        (flannIndex->getAlgorithm() == cvflann::FLANN_INDEX_KDTREE ||
+         flannIndex->getAlgorithm() == cvflann::FLANN_INDEX_LSH) )
+    {
+        const uchar* data = mergedDescriptors.getDescriptors().data;
+        int start = mergedDescriptors.size();
+        mergedDescriptors.add( descriptors );
+
+        const Mat& merged = mergedDescriptors.getDescriptors();
+        if( merged.data != data )
+            flannIndex.release();
+        else if( merged.rows > start )
+            flannIndex->addPoints( merged.rowRange(start, merged.rows) );
     }
+
+    addedDescCount += count;
 }
 
 void FlannBasedMatcher::clear()
@@ -524,7 +562,9 @@ void FlannBasedMatcher::train()
 {
     if( flannIndex.empty() || mergedDescriptors.size() < addedDescCount )
     {
-        mergedDescriptors.set( trainDescCollection );
+        // mergedDescriptors may already hold all the descriptors if they were appended by add()
+        if( mergedDescriptors.size() < addedDescCount || addedDescCount == 0 )
+            mergedDescriptors.set( trainDescCollection );
         flannIndex = new flann::Index( mergedDescriptors.getDescriptors(), *indexParams );
     }
 }
@@ -126,32 +126,38 @@ static float IC_Angle(const Mat& image, const int half_k, Point2f pt,
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static void computeOrbDescriptor(const KeyPoint& kpt,
-                                 const Mat& img, const Point* pattern,
-                                 uchar* desc, int dsize, int WTA_K)
+/**
+ * Computes the descriptor at the pixel "center" of a pyramid level;
+ * pattern contains the offsets of the pattern points rotated to the keypoint orientation.
+ */
+static void computeOrbDescriptor(const uchar* center, const int* pattern,
+                                 uchar* desc, int dsize, int WTA_K, bool useSIMD)
 {
-    float angle = kpt.angle;
-    //angle = cvFloor(angle/12)*12.f;
-    angle *= (float)(CV_PI/180.f);
-    float a = (float)cos(angle), b = (float)sin(angle);
-
-    const uchar* center = &img.at<uchar>(cvRound(kpt.pt.y), cvRound(kpt.pt.x));
-    int step = (int)img.step;
-
-#if 1
-    #define GET_VALUE(idx) \
-        center[cvRound(pattern[idx].x*b + pattern[idx].y*a)*step + \
-               cvRound(pattern[idx].x*a - pattern[idx].y*b)]
+    #define GET_VALUE(idx) center[pattern[idx]]
+
+#if CV_SSE2
+    if( WTA_K == 2 && useSIMD && dsize % 2 == 0 && dsize <= DESCRIPTOR_SIZE )
+    {
+        // gather the pairs of the test points, then compare 16 pairs at once
+        uchar CV_DECL_ALIGNED(16) buf[DESCRIPTOR_SIZE*16];
+        for (int i = 0; i < dsize*16; i++)
+            buf[i] = GET_VALUE(i);
+
+        __m128i mask = _mm_set1_epi16(255), delta = _mm_set1_epi8((char)-128);
+        for (int i = 0; i < dsize; i += 2)
+        {
+            __m128i v0 = _mm_load_si128((const __m128i*)(buf + i*16));
+            __m128i v1 = _mm_load_si128((const __m128i*)(buf + i*16 + 16));
+            __m128i t0 = _mm_packus_epi16(_mm_and_si128(v0, mask), _mm_and_si128(v1, mask));
+            __m128i t1 = _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8));
+            int bits = _mm_movemask_epi8(_mm_cmplt_epi8(_mm_xor_si128(t0, delta), _mm_xor_si128(t1, delta)));
+            desc[i] = (uchar)bits;
+            desc[i+1] = (uchar)(bits >> 8);
+        }
+        return;
+    }
 #else
-    float x, y;
-    int ix, iy;
-    #define GET_VALUE(idx) \
-        (x = pattern[idx].x*a - pattern[idx].y*b, \
-        y = pattern[idx].x*b + pattern[idx].y*a, \
-        ix = cvFloor(x), iy = cvFloor(y), \
-        x -= ix, y -= iy, \
-        cvRound(center[iy*step + ix]*(1-x)*(1-y) + center[(iy+1)*step + ix]*(1-x)*y + \
-                center[iy*step + ix+1]*x*(1-y) + center[(iy+1)*step + ix+1]*x*y))
+    (void)useSIMD;
 #endif
 
     if( WTA_K == 2 )
@@ -583,22 +589,133 @@ void ORB::operator()(InputArray image, InputArray mask, vector<KeyPoint>& keypoi
 }
 
 
-/** Compute the ORB keypoint orientations
- * @param image the image to compute the features and descriptors on
- * @param integral_image the integral image of the iamge (can be empty, but the computation will be slower)
- * @param scale the scale at which we compute the orientation
- * @param keypoints the resulting keypoints
+// the orientations and the descriptors are computed in parallel batches of that many keypoints
+const int ORB_KEYPOINTS_BATCH = 64;
+
+// stores the index of the first keypoint of every level in the concatenated keypoint list to levelOfs,
+// levelOfs[nlevels] is the total number of keypoints
+static int getLevelOffsets(const vector<vector<KeyPoint> >& allKeypoints, vector<int>& levelOfs)
+{
+    int nlevels = (int)allKeypoints.size();
+    levelOfs.resize(nlevels + 1);
+    levelOfs[0] = 0;
+    for (int level = 0; level < nlevels; ++level)
+        levelOfs[level + 1] = levelOfs[level] + (int)allKeypoints[level].size();
+    return levelOfs[nlevels];
+}
+
+// returns the level of the idx-th keypoint of the concatenated list
+static inline int findLevel(const vector<int>& levelOfs, int idx)
+{
+    return (int)(std::upper_bound(levelOfs.begin(), levelOfs.end(), idx) - levelOfs.begin()) - 1;
+}
+
+/** Compute the ORB keypoint orientations of a range of keypoints taken from all the levels
  */
-static void computeOrientation(const Mat& image, vector<KeyPoint>& keypoints,
-                               int halfPatchSize, const vector<int>& umax)
+class ORBOrientationInvoker : public ParallelLoopBody
 {
-    // Process each keypoint
-    for (vector<KeyPoint>::iterator keypoint = keypoints.begin(),
-         keypointEnd = keypoints.end(); keypoint != keypointEnd; ++keypoint)
+public:
+    ORBOrientationInvoker(const vector<Mat>& _imagePyramid, vector<vector<KeyPoint> >& _allKeypoints,
+                          const vector<int>& _levelOfs, int _halfPatchSize, const vector<int>& _umax)
     {
-        keypoint->angle = IC_Angle(image, halfPatchSize, keypoint->pt, umax);
+        imagePyramid = &_imagePyramid;
+        allKeypoints = &_allKeypoints;
+        levelOfs = &_levelOfs;
+        halfPatchSize = _halfPatchSize;
+        umax = &_umax;
+    }
+
+    void operator()(const Range& range) const
+    {
+        int level = findLevel(*levelOfs, range.start);
+
+        for (int i = range.start; i < range.end; i++)
+        {
+            while (i >= (*levelOfs)[level + 1])
+                level++;
+            KeyPoint& keypoint = (*allKeypoints)[level][i - (*levelOfs)[level]];
+            keypoint.angle = IC_Angle((*imagePyramid)[level], halfPatchSize, keypoint.pt, *umax);
+        }
     }
-}
+
+private:
+    const vector<Mat>* imagePyramid;
+    vector<vector<KeyPoint> >* allKeypoints;
+    const vector<int>* levelOfs;
+    int halfPatchSize;
+    const vector<int>* umax;
+};
+
+
+/** Detect the ORB keypoints (without the orientation) on a range of the pyramid levels
+ */
+class ORBKeyPointsInvoker : public ParallelLoopBody
+{
+public:
+    ORBKeyPointsInvoker(const vector<Mat>& _imagePyramid, const vector<Mat>& _maskPyramid,
+                        vector<vector<KeyPoint> >& _allKeypoints, const vector<int>& _nfeaturesPerLevel,
+                        int _firstLevel, double _scaleFactor, int _edgeThreshold, int _patchSize, int _scoreType)
+    {
+        imagePyramid = &_imagePyramid;
+        maskPyramid = &_maskPyramid;
+        allKeypoints = &_allKeypoints;
+        nfeaturesPerLevel = &_nfeaturesPerLevel;
+        firstLevel = _firstLevel;
+        scaleFactor = _scaleFactor;
+        edgeThreshold = _edgeThreshold;
+        patchSize = _patchSize;
+        scoreType = _scoreType;
+    }
+
+    void operator()(const Range& range) const
+    {
+        for (int level = range.start; level < range.end; ++level)
+        {
+            int featuresNum = (*nfeaturesPerLevel)[level];
+            const Mat& image = (*imagePyramid)[level];
+            vector<KeyPoint> & keypoints = (*allKeypoints)[level];
+            keypoints.reserve(featuresNum*2);
+
+            // Detect FAST features, 20 is a good threshold
+            FastFeatureDetector fd(20, true);
+            fd.detect(image, keypoints, (*maskPyramid)[level]);
+
+            // Remove keypoints very close to the border
+            KeyPointsFilter::runByImageBorder(keypoints, image.size(), edgeThreshold);
+
+            if( scoreType == ORB::HARRIS_SCORE )
+            {
+                // Keep more points than necessary as FAST does not give amazing corners
+                KeyPointsFilter::retainBest(keypoints, 2 * featuresNum);
+
+                // Compute the Harris cornerness (better scoring than FAST)
+                HarrisResponses(image, keypoints, 7, HARRIS_K);
+            }
+
+            //cull to the final desired level, using the new Harris scores or the original FAST scores.
+            KeyPointsFilter::retainBest(keypoints, featuresNum);
+
+            float sf = getScale(level, firstLevel, scaleFactor);
+
+            // Set the level of the coordinates
+            for (vector<KeyPoint>::iterator keypoint = keypoints.begin(),
+                 keypointEnd = keypoints.end(); keypoint != keypointEnd; ++keypoint)
+            {
+                keypoint->octave = level;
+                keypoint->size = patchSize*sf;
+            }
+        }
+    }
+
+private:
+    const vector<Mat>* imagePyramid;
+    const vector<Mat>* maskPyramid;
+    vector<vector<KeyPoint> >* allKeypoints;
+    const vector<int>* nfeaturesPerLevel;
+    int firstLevel;
+    double scaleFactor;
+    int edgeThreshold, patchSize, scoreType;
+};
 
 
 /** Compute the ORB keypoints on an image
@@ -649,68 +766,135 @@ static void computeKeyPoints(const vector<Mat>& imagePyramid,
         ++v0;
     }
 
+    allKeypoints.clear();
     allKeypoints.resize(nlevels);
 
-    for (int level = 0; level < nlevels; ++level)
-    {
-        int featuresNum = nfeaturesPerLevel[level];
-        allKeypoints[level].reserve(featuresNum*2);
+    // the levels are independent, so they are processed in parallel
+    parallel_for_(Range(0, nlevels), ORBKeyPointsInvoker(imagePyramid, maskPyramid, allKeypoints, nfeaturesPerLevel,
+                                                         firstLevel, scaleFactor, edgeThreshold, patchSize, scoreType));
 
-        vector<KeyPoint> & keypoints = allKeypoints[level];
+    // the level sizes differ a lot, so the orientation is computed over all the levels at once
+    vector<int> levelOfs;
+    int nkeypoints = getLevelOffsets(allKeypoints, levelOfs);
+    parallel_for_(Range(0, nkeypoints), ORBOrientationInvoker(imagePyramid, allKeypoints, levelOfs, halfPatchSize, umax),
+                  (double)nkeypoints/ORB_KEYPOINTS_BATCH);
+}
 
-        // Detect FAST features, 20 is a good threshold
-        FastFeatureDetector fd(20, true);
-        fd.detect(imagePyramid[level], keypoints, maskPyramid[level]);
 
-        // Remove keypoints very close to the border
-        KeyPointsFilter::runByImageBorder(keypoints, imagePyramid[level].size(), edgeThreshold);
+/** Blur the pyramid levels that have keypoints before computing the descriptors
+ */
+class ORBBlurInvoker : public ParallelLoopBody
+{
+public:
+    ORBBlurInvoker(vector<Mat>& _imagePyramid, const vector<vector<KeyPoint> >& _allKeypoints)
+    {
+        imagePyramid = &_imagePyramid;
+        allKeypoints = &_allKeypoints;
+    }
 
-        if( scoreType == ORB::HARRIS_SCORE )
+    void operator()(const Range& range) const
+    {
+        for (int level = range.start; level < range.end; ++level)
         {
-            // Keep more points than necessary as FAST does not give amazing corners
-            KeyPointsFilter::retainBest(keypoints, 2 * featuresNum);
-
-            // Compute the Harris cornerness (better scoring than FAST)
-            HarrisResponses(imagePyramid[level], keypoints, 7, HARRIS_K);
+            if ((*allKeypoints)[level].empty())
+                continue;
+            // preprocess the resized image
+            Mat& workingMat = (*imagePyramid)[level];
+            //boxFilter(working_mat, working_mat, working_mat.depth(), Size(5,5), Point(-1,-1), true, BORDER_REFLECT_101);
+            GaussianBlur(workingMat, workingMat, Size(7, 7), 2, 2, BORDER_REFLECT_101);
         }
+    }
 
-        //cull to the final desired level, using the new Harris scores or the original FAST scores.
-        KeyPointsFilter::retainBest(keypoints, featuresNum);
+private:
+    vector<Mat>* imagePyramid;
+    const vector<vector<KeyPoint> >* allKeypoints;
+};
 
-        float sf = getScale(level, firstLevel, scaleFactor);
 
-        // Set the level of the coordinates
-        for (vector<KeyPoint>::iterator keypoint = keypoints.begin(),
-             keypointEnd = keypoints.end(); keypoint != keypointEnd; ++keypoint)
-        {
-            keypoint->octave = level;
-            keypoint->size = patchSize*sf;
-        }
+// the pattern is rotated to ORB_ANGLE_BINS orientations; the keypoint angle is rounded to the nearest of them
+const int ORB_ANGLE_BINS = 360;
 
-        computeOrientation(imagePyramid[level], keypoints, halfPatchSize, umax);
-    }
+static inline int getAngleBin(float angle)
+{
+    int bin = cvRound(angle*(ORB_ANGLE_BINS/360.f)) % ORB_ANGLE_BINS;
+    return bin >= 0 ? bin : bin + ORB_ANGLE_BINS;
 }
 
-
-/** Compute the ORB decriptors
- * @param image the image to compute the features and descriptors on
- * @param integral_image the integral image of the image (can be empty, but the computation will be slower)
- * @param level the scale at which we compute the orientation
- * @param keypoints the keypoints to use
- * @param descriptors the resulting descriptors
+/** Compute the offsets of the pattern points rotated to the orientations of the keypoints.
+ * The offsets for the k-th orientation bin are stored at rotatedPattern[k*pattern.size()];
+ * only the bins used by the keypoints are filled.
  */
-static void computeDescriptors(const Mat& image, vector<KeyPoint>& keypoints, Mat& descriptors,
-                               const vector<Point>& pattern, int dsize, int WTA_K)
+static void makeRotatedPatterns(const vector<Point>& pattern, const vector<vector<KeyPoint> >& allKeypoints,
+                                int step, vector<int>& rotatedPattern)
 {
-    //convert to grayscale if more than one color
-    CV_Assert(image.type() == CV_8UC1);
-    //create the descriptor mat, keypoints.size() rows, BYTES cols
-    descriptors = Mat::zeros((int)keypoints.size(), dsize, CV_8UC1);
+    int npoints = (int)pattern.size();
+    vector<uchar> used(ORB_ANGLE_BINS, (uchar)0);
+
+    for (size_t level = 0; level < allKeypoints.size(); ++level)
+        for (size_t i = 0; i < allKeypoints[level].size(); i++)
+            used[getAngleBin(allKeypoints[level][i].angle)] = 1;
+
+    rotatedPattern.resize(ORB_ANGLE_BINS*npoints);
+    for (int bin = 0; bin < ORB_ANGLE_BINS; bin++)
+    {
+        if (!used[bin])
+            continue;
+
+        double angle = bin*CV_PI*2/ORB_ANGLE_BINS;
+        float a = (float)cos(angle), b = (float)sin(angle);
+        int* ofs = &rotatedPattern[bin*npoints];
 
-    for (size_t i = 0; i < keypoints.size(); i++)
-        computeOrbDescriptor(keypoints[i], image, &pattern[0], descriptors.ptr((int)i), dsize, WTA_K);
+        for (int i = 0; i < npoints; i++)
+            ofs[i] = cvRound(pattern[i].x*b + pattern[i].y*a)*step + cvRound(pattern[i].x*a - pattern[i].y*b);
+    }
 }
 
+/** Compute the ORB decriptors of a range of keypoints taken from all the levels.
+ * The descriptor of the i-th keypoint of the concatenated list is written to the i-th row of descriptors.
+ */
+class ORBDescriptorsInvoker : public ParallelLoopBody
+{
+public:
+    ORBDescriptorsInvoker(const vector<Mat>& _imagePyramid, const vector<vector<KeyPoint> >& _allKeypoints,
+                          const vector<int>& _levelOfs, Mat& _descriptors, const vector<int>& _rotatedPattern,
+                          int _npoints, int _dsize, int _WTA_K)
+    {
+        imagePyramid = &_imagePyramid;
+        allKeypoints = &_allKeypoints;
+        levelOfs = &_levelOfs;
+        descriptors = &_descriptors;
+        rotatedPattern = &_rotatedPattern;
+        npoints = _npoints;
+        dsize = _dsize;
+        WTA_K = _WTA_K;
+        useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+    }
+
+    void operator()(const Range& range) const
+    {
+        int level = findLevel(*levelOfs, range.start);
+
+        for (int i = range.start; i < range.end; i++)
+        {
+            while (i >= (*levelOfs)[level + 1])
+                level++;
+            const KeyPoint& keypoint = (*allKeypoints)[level][i - (*levelOfs)[level]];
+            const uchar* center = &(*imagePyramid)[level].at<uchar>(cvRound(keypoint.pt.y), cvRound(keypoint.pt.x));
+            const int* pattern = &(*rotatedPattern)[getAngleBin(keypoint.angle)*npoints];
+            computeOrbDescriptor(center, pattern, descriptors->ptr(i), dsize, WTA_K, useSIMD);
+        }
+    }
+
+private:
+    const vector<Mat>* imagePyramid;
+    const vector<vector<KeyPoint> >* allKeypoints;
+    const vector<int>* levelOfs;
+    Mat* descriptors;
+    const vector<int>* rotatedPattern;
+    int npoints, dsize, WTA_K;
+    bool useSIMD;
+};
+
 
 /** Compute the ORB features and descriptors on an image
  * @param img the image to compute the features and descriptors on
@@ -759,6 +943,14 @@ void ORB::operator()( InputArray _image, InputArray _mask, vector<KeyPoint>& _ke
         levelsNum++;
     }
 
+    // all the levels get the same step, so that the rotated pattern offsets are valid for any of them
+    int maxWidth = 0;
+    for (int level = 0; level < levelsNum; ++level)
+    {
+        float scale = 1/getScale(level, firstLevel, scaleFactor);
+        maxWidth = std::max(maxWidth, cvRound(image.cols*scale) + border*2);
+    }
+
     // Pre-compute the scale pyramids
     vector<Mat> imagePyramid(levelsNum), maskPyramid(levelsNum);
     for (int level = 0; level < levelsNum; ++level)
@@ -766,7 +958,8 @@ void ORB::operator()( InputArray _image, InputArray _mask, vector<KeyPoint>& _ke
         float scale = 1/getScale(level, firstLevel, scaleFactor);
         Size sz(cvRound(image.cols*scale), cvRound(image.rows*scale));
         Size wholeSize(sz.width + border*2, sz.height + border*2);
-        Mat temp(wholeSize, image.type()), masktemp;
+        Mat temp = Mat(wholeSize.height, std::max(maxWidth, wholeSize.width), image.type()).colRange(0, wholeSize.width);
+        Mat masktemp;
         imagePyramid[level] = temp(Rect(border, border, sz.width, sz.height));
 
         if( !mask.empty() )
@@ -897,30 +1090,31 @@ void ORB::operator()( InputArray _image, InputArray _mask, vector<KeyPoint>& _ke
         }
     }
 
+    if( !descriptors.empty() )
+    {
+        CV_Assert( image.type() == CV_8UC1 );
+
+        vector<int> levelOfs;
+        int nkeypoints = getLevelOffsets(allKeypoints, levelOfs);
+
+        // the pattern offsets are computed once for the step of all the levels
+        for (int level = 1; level < levelsNum; ++level)
+            CV_Assert( imagePyramid[level].step == imagePyramid[0].step );
+
+        vector<int> rotatedPattern;
+        makeRotatedPatterns(pattern, allKeypoints, (int)imagePyramid[0].step, rotatedPattern);
+
+        parallel_for_(Range(0, levelsNum), ORBBlurInvoker(imagePyramid, allKeypoints));
+        parallel_for_(Range(0, nkeypoints), ORBDescriptorsInvoker(imagePyramid, allKeypoints, levelOfs, descriptors,
+                                                                  rotatedPattern, (int)pattern.size(),
+                                                                  descriptorSize(), WTA_K),
+                      (double)nkeypoints/ORB_KEYPOINTS_BATCH);
+    }
+
     _keypoints.clear();
-    int offset = 0;
     for (int level = 0; level < levelsNum; ++level)
     {
-        // Get the features and compute their orientation
         vector<KeyPoint>& keypoints = allKeypoints[level];
-        int nkeypoints = (int)keypoints.size();
-
-        // Compute the descriptors
-        if (do_descriptors)
-        {
-            Mat desc;
-            if (!descriptors.empty())
-            {
-                desc = descriptors.rowRange(offset, offset + nkeypoints);
-            }
-
-            offset += nkeypoints;
-            // preprocess the resized image
-            Mat& workingMat = imagePyramid[level];
-            //boxFilter(working_mat, working_mat, working_mat.depth(), Size(5,5), Point(-1,-1), true, BORDER_REFLECT_101);
-            GaussianBlur(workingMat, workingMat, Size(7, 7), 2, 2, BORDER_REFLECT_101);
-            computeDescriptors(workingMat, keypoints, desc, pattern, descriptorSize(), WTA_K);
-        }
 
         // Copy to the output data
         if (level != firstLevel)
@@ -331,6 +331,35 @@ TEST( Features2d_DescriptorExtractor_BRIEF, regression )
     test.safe_run();
 }
 
+TEST( Features2d_DescriptorExtractor_BRIEF, optimized )
+{
+    Mat image(240, 320, CV_8UC1);
+    RNG rng(0x1234);
+    rng.fill(image, RNG::UNIFORM, 0, 256);
+    GaussianBlur(image, image, Size(5, 5), 2);
+
+    std::vector<KeyPoint> keypoints;
+    FastFeatureDetector(10).detect(image, keypoints);
+    ASSERT_FALSE(keypoints.empty());
+    cvtest::ParallelSettingsGuard guard;
+
+    for( int bytes = 16; bytes <= 64; bytes *= 2 )
+    {
+        BriefDescriptorExtractor brief(bytes);
+        std::vector<KeyPoint> keypoints0 = keypoints, keypoints1 = keypoints;
+        Mat descriptors0, descriptors1;
+
+        setUseOptimized(false);
+        brief.compute(image, keypoints0, descriptors0);
+        setUseOptimized(true);
+        brief.compute(image, keypoints1, descriptors1);
+
+        ASSERT_EQ(bytes, descriptors1.cols);
+        ASSERT_EQ(keypoints0.size(), keypoints1.size());
+        EXPECT_EQ(0, norm(descriptors0, descriptors1, NORM_INF)) << "bytes=" << bytes;
+    }
+}
+
 TEST( Features2d_DescriptorExtractor_OpponentBRIEF, regression )
 {
     CV_DescriptorExtractorTest<Hamming> test( "descriptor-opponent-brief",  1,
@@ -41,6 +41,7 @@
 //M*/
 
 #include "test_precomp.hpp"
+#include "opencv2/flann/flann.hpp"
 
 #include <algorithm>
 #include <vector>
@@ -410,3 +411,223 @@ TEST(Features2d_FLANN_KDTree, regression) { CV_FlannKDTreeIndexTest test; test.s
 TEST(Features2d_FLANN_Composite, regression) { CV_FlannCompositeIndexTest test; test.safe_run(); }
 TEST(Features2d_FLANN_Auto, regression) { CV_FlannAutotunedIndexTest test; test.safe_run(); }
 TEST(Features2d_FLANN_Saved, regression) { CV_FlannSavedIndexTest test; test.safe_run(); }
+
+TEST(Features2d_FLANN, parallelSearch)
+{
+    RNG rng(0x2345);
+    Mat data(2000, 32, CV_32F), queries(500, 32, CV_32F);
+    rng.fill(data, RNG::UNIFORM, 0, 1);
+    rng.fill(queries, RNG::UNIFORM, 0, 1);
+    Mat bdata(2000, 32, CV_8U), bqueries(500, 32, CV_8U);
+    rng.fill(bdata, RNG::UNIFORM, 0, 256);
+    rng.fill(bqueries, RNG::UNIFORM, 0, 256);
+
+    const int K = 5;
+    cvtest::ParallelSettingsGuard guard;
+    setNumThreads(4);
+
+    for( int i = 0; i < 4; i++ )
+    {
+        Index index;
+        Mat q = i < 3 ? queries : bqueries;
+        if( i == 0 )
+            index.build(data, KDTreeIndexParams(4));
+        else if( i == 1 )
+            index.build(data, KMeansIndexParams());
+        else if( i == 2 )
+            index.build(data, LinearIndexParams());
+        else
+            index.build(bdata, LshIndexParams(6, 12, 1), cvflann::FLANN_DIST_HAMMING);
+
+        Mat indices1, dists1;
+        index.knnSearch(q, indices1, dists1, K, SearchParams(32, 0, true, 1));
+        for( int cores = 0; cores <= 4; cores += 2 )
+        {
+            Mat indices, dists;
+            index.knnSearch(q, indices, dists, K, SearchParams(32, 0, true, cores));
+            EXPECT_EQ(0, norm(indices1, indices, NORM_INF)) << "index " << i << ", cores " << cores;
+            EXPECT_EQ(0, norm(dists1, dists, NORM_INF)) << "index " << i << ", cores " << cores;
+        }
+
+        if( i == 3 )
+            continue; // LSH does not support radius search
+
+        // a batch radius search gives the same neighbors as searching the queries one by one
+        Mat indices(q.rows, 10, CV_32S, Scalar(-1)), dists(q.rows, 10, CV_32F, Scalar(-1));
+        int total = index.radiusSearch(q, indices, dists, 3., 10, SearchParams(32, 0, true, 0));
+        int total1 = 0;
+        for( int j = 0; j < q.rows; j++ )
+        {
+            Mat rowIndices(1, 10, CV_32S, Scalar(-1)), rowDists(1, 10, CV_32F, Scalar(-1));
+            total1 += index.radiusSearch(q.row(j), rowIndices, rowDists, 3., 10, SearchParams(32, 0, true, 1));
+            ASSERT_EQ(0, norm(rowIndices, indices.row(j), NORM_INF)) << "index " << i << ", query " << j;
+        }
+        EXPECT_EQ(total1, total);
+        EXPECT_GT(total, 0);
+    }
+}
+
+TEST(Features2d_FLANN, addRemovePoints)
+{
+    RNG rng(0x3456);
+    Mat data(1500, 16, CV_32F), bdata(1500, 32, CV_8U);
+    rng.fill(data, RNG::UNIFORM, 0, 1);
+    rng.fill(bdata, RNG::UNIFORM, 0, 256);
+    const int n0 = 1000, n = data.rows;
+
+    for( int i = 0; i < 3; i++ )
+    {
+        Index index;
+        Mat d = i < 2 ? data : bdata;
+        if( i < 2 )
+            index.build(d.rowRange(0, n0), KDTreeIndexParams(4));
+        else
+            index.build(d.rowRange(0, n0), LshIndexParams(6, 12, 1), cvflann::FLANN_DIST_HAMMING);
+
+        // the first kd-tree is extended in place, the second one is rebuilt on the last batch;
+        // the index copies the added points, so they are passed in temporary buffers
+        for( int j = n0; j < n; j += 100 )
+            index.addPoints(d.rowRange(j, j + 100).clone(), i == 0 ? 0.f : 1.4f);
+
+        for( int j = 1; j < n; j += 4 )
+            index.removePoint(j);
+
+        Mat indices, dists;
+        index.knnSearch(d, indices, dists, 1, SearchParams(64));
+        int found = 0;
+        for( int j = 0; j < n; j++ )
+        {
+            int idx = indices.at<int>(j, 0);
+            ASSERT_TRUE(idx < 0 || idx % 4 != 1) << "index " << i << ", removed point " << idx << " is found";
+            found += idx == j;
+        }
+        EXPECT_GE(found, n*3/4 - 5) << "index " << i;
+    }
+
+    // the descriptors added to a trained matcher are matched to the right images
+    FlannBasedMatcher matcher;
+    vector<Mat> descriptors(1, data.rowRange(0, n0));
+    matcher.add(descriptors);
+    matcher.train();
+    for( int j = n0; j < n; j += 100 )
+    {
+        descriptors[0] = data.rowRange(j, j + 100);
+        matcher.add(descriptors);
+        matcher.train();
+    }
+
+    vector<DMatch> matches;
+    matcher.match(data.rowRange(n0 - 50, n), matches);
+    ASSERT_EQ(n - n0 + 50, (int)matches.size());
+    for( size_t j = 0; j < matches.size(); j++ )
+    {
+        int row = n0 - 50 + (int)j;
+        int imgIdx = row < n0 ? 0 : (row - n0)/100 + 1;
+        int trainIdx = row < n0 ? row : (row - n0) % 100;
+        EXPECT_EQ(imgIdx, matches[j].imgIdx);
+        EXPECT_EQ(trainIdx, matches[j].trainIdx);
+    }
+}
+
+TEST(Features2d_FLANN, removePointsRebuild)
+{
+    RNG rng(0x3457);
+    Mat data(1000, 16, CV_32F);
+    rng.fill(data, RNG::UNIFORM, 0, 1);
+    const int n = data.rows;
+
+    cvflann::Matrix<float> dataset((float*)data.data, n, data.cols);
+    cvflann::Index< cvflann::L2<float> > index(dataset, cvflann::KDTreeIndexParams(4));
+    index.buildIndex();
+    int memory = index.usedMemory();
+
+    // the trees are kept until the removed points are more than half of their leaves
+    for( int j = 0; j < n; j += 2 )
+        index.removePoint(j);
+    EXPECT_EQ(memory, index.usedMemory());
+    index.removePoint(1);
+    EXPECT_LT(index.usedMemory(), memory);
+    EXPECT_EQ((size_t)(n/2 - 1), index.size());
+
+    // the rebuilt trees still hold all the remaining points
+    Mat indices(n, 1, CV_32S), dists(n, 1, CV_32F);
+    cvflann::Matrix<int> indicesMat((int*)indices.data, n, 1);
+    cvflann::Matrix<float> distsMat((float*)dists.data, n, 1);
+    index.knnSearch(dataset, indicesMat, distsMat, 1, cvflann::SearchParams(n));
+    for( int j = 0; j < n; j++ )
+    {
+        int idx = indices.at<int>(j, 0);
+        if( j % 2 == 1 && j != 1 )
+            EXPECT_EQ(j, idx);
+        else
+            EXPECT_TRUE(idx != 1 && idx % 2 == 1) << "removed point " << idx << " is found";
+    }
+}
+
+TEST(Features2d_FLANN, saveWithRemovedPoints)
+{
+    RNG rng(0x3458);
+    Mat data(200, 16, CV_32F), bdata(200, 32, CV_8U);
+    rng.fill(data, RNG::UNIFORM, 0, 1);
+    rng.fill(bdata, RNG::UNIFORM, 0, 256);
+    string filename = tempfile();
+
+    for( int i = 0; i < 2; i++ )
+    {
+        Index index;
+        if( i == 0 )
+            index.build(data, KDTreeIndexParams(4));
+        else
+            index.build(bdata, LshIndexParams(6, 12, 1), cvflann::FLANN_DIST_HAMMING);
+        index.removePoint(10);
+
+        EXPECT_ANY_THROW(index.save(filename)) << "index " << i;
+
+        // no truncated index file is left behind
+        FILE* f = fopen(filename.c_str(), "rb");
+        EXPECT_TRUE(f == 0) << "index " << i;
+        if( f )
+            fclose(f);
+    }
+    remove(filename.c_str());
+}
+
+class FlannBasedMatcherIndex : public FlannBasedMatcher
+{
+public:
+    Ptr<flann::Index> index() const { return flannIndex; }
+};
+
+TEST(Features2d_FLANN, matcherAddAfterTrain)
+{
+    RNG rng(0x3459);
+    Mat data(1200, 16, CV_32F);
+    rng.fill(data, RNG::UNIFORM, 0, 1);
+
+    // the first add() outgrows the trained descriptors, so the index is rebuilt on the grown buffer,
+    // which has room for the next add() to extend the trained index instead of replacing it
+    FlannBasedMatcherIndex matcher;
+    vector<Mat> descriptors(1, data.rowRange(0, 1000));
+    matcher.add(descriptors);
+    matcher.train();
+
+    descriptors[0] = data.rowRange(1000, 1100);
+    matcher.add(descriptors);
+    matcher.train();
+    Ptr<flann::Index> index = matcher.index();
+    ASSERT_FALSE(index.empty());
+
+    descriptors[0] = data.rowRange(1100, 1200);
+    matcher.add(descriptors);
+    matcher.train();
+    EXPECT_TRUE((flann::Index*)index == (flann::Index*)matcher.index());
+
+    vector<DMatch> matches;
+    matcher.match(data.rowRange(1000, 1200), matches);
+    ASSERT_EQ(200, (int)matches.size());
+    for( size_t j = 0; j < matches.size(); j++ )
+    {
+        EXPECT_EQ(1 + (int)j/100, matches[j].imgIdx);
+        EXPECT_EQ((int)j % 100, matches[j].trainIdx);
+    }
+}
@@ -90,3 +90,91 @@ TEST(Features2D_ORB, _1996)
 
     ASSERT_EQ(0, roiViolations);
 }
+
+static Mat makeShapesImage()
+{
+    Mat image(480, 640, CV_8UC1, Scalar(128));
+    RNG rng(0x1996);
+    for( int i = 0; i < 200; i++ )
+    {
+        Point pt(rng.uniform(0, image.cols), rng.uniform(0, image.rows));
+        if( i % 2 )
+            rectangle(image, pt, pt + Point(rng.uniform(5, 60), rng.uniform(5, 60)), Scalar(rng.uniform(0, 256)), -1);
+        else
+            circle(image, pt, rng.uniform(3, 30), Scalar(rng.uniform(0, 256)), -1);
+    }
+    return image;
+}
+
+TEST(Features2D_ORB, parallel)
+{
+    Mat image = makeShapesImage();
+
+    ORB orb(1000);
+    cvtest::ParallelSettingsGuard guard;
+    std::vector<KeyPoint> keypoints1, keypoints4;
+    Mat descriptors1, descriptors4;
+
+    setNumThreads(1);
+    orb(image, Mat(), keypoints1, descriptors1);
+    setNumThreads(4);
+    orb(image, Mat(), keypoints4, descriptors4);
+
+    ASSERT_FALSE(keypoints1.empty());
+    ASSERT_EQ(keypoints1.size(), keypoints4.size());
+    for( size_t i = 0; i < keypoints1.size(); i++ )
+    {
+        ASSERT_EQ(keypoints1[i].pt, keypoints4[i].pt);
+        ASSERT_EQ(keypoints1[i].angle, keypoints4[i].angle);
+        ASSERT_EQ(keypoints1[i].response, keypoints4[i].response);
+        ASSERT_EQ(keypoints1[i].octave, keypoints4[i].octave);
+    }
+    ASSERT_EQ((int)keypoints1.size(), descriptors4.rows);
+    EXPECT_EQ(0, norm(descriptors1, descriptors4, NORM_INF));
+}
+
+TEST(Features2D_ORB, optimized)
+{
+    Mat image = makeShapesImage();
+    cvtest::ParallelSettingsGuard guard;
+
+    for( int WTA_K = 2; WTA_K <= 4; WTA_K++ )
+    {
+        ORB orb(500, 1.2f, 8, 31, 0, WTA_K);
+        std::vector<KeyPoint> keypoints0, keypoints1;
+        Mat descriptors0, descriptors1;
+
+        setUseOptimized(false);
+        orb(image, Mat(), keypoints0, descriptors0);
+        setUseOptimized(true);
+        orb(image, Mat(), keypoints1, descriptors1);
+
+        ASSERT_FALSE(keypoints0.empty());
+        ASSERT_EQ(keypoints0.size(), keypoints1.size());
+        EXPECT_EQ(0, norm(descriptors0, descriptors1, NORM_INF)) << "WTA_K=" << WTA_K;
+    }
+
+    // rotating the image by 90 degrees must not change the descriptors much
+    ORB orb(500);
+    std::vector<KeyPoint> keypoints0, keypoints1;
+    Mat descriptors0, descriptors1, rotated;
+    transpose(image, rotated);
+    flip(rotated, rotated, 1);
+    orb(image, Mat(), keypoints0, descriptors0);
+    orb(rotated, Mat(), keypoints1, descriptors1);
+
+    int matched = 0, good = 0;
+    for( size_t i = 0; i < keypoints0.size(); i++ )
+    {
+        Point2f pt(image.rows - 1 - keypoints0[i].pt.y, keypoints0[i].pt.x);
+        for( size_t j = 0; j < keypoints1.size(); j++ )
+            if( keypoints0[i].octave == 0 && keypoints1[j].octave == 0 && norm(keypoints1[j].pt - pt) < 0.5 )
+            {
+                matched++;
+                good += norm(descriptors0.row((int)i), descriptors1.row((int)j), NORM_HAMMING) <= 40;
+                break;
+            }
+    }
+    ASSERT_GT(matched, 20);
+    EXPECT_GT(good, matched*8/10);
+}
@@ -106,6 +106,14 @@ public:
      * Destructor. Frees all the memory allocated in this pool.
      */
     ~PooledAllocator()
+    {
+        free();
+    }
+
+    /**
+     * Frees all the memory allocated in this pool.
+     */
+    void free()
     {
         void* prev;
 
@@ -114,6 +122,9 @@ public:
             ::free(base);
             base = prev;
         }
+        remaining = 0;
+        usedMemory = 0;
+        wastedMemory = 0;
     }
 
     /**
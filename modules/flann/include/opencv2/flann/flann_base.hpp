@@ -145,6 +145,25 @@ public:
         fclose(fout);
     }
 
+    /**
+     * \brief Adds points to the index
+     * \param[in] points The points to add
+     * \param[in] rebuild_threshold The index is rebuilt when the number of points grows by this factor
+     */
+    void addPoints(const Matrix<ElementType>& points, float rebuild_threshold = 2)
+    {
+        nnIndex_->addPoints(points, rebuild_threshold);
+    }
+
+    /**
+     * \brief Removes a point from the index
+     * \param[in] id The index of the point
+     */
+    void removePoint(size_t id)
+    {
+        nnIndex_->removePoint(id);
+    }
+
     /**
      * \brief Saves the index to a stream
      * \param stream The stream to save the index to
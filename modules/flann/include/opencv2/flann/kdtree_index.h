@@ -32,6 +32,7 @@
 #define OPENCV_FLANN_KDTREE_INDEX_H_
 
 #include <algorithm>
+#include <list>
 #include <map>
 #include <cassert>
 #include <cstring>
@@ -91,11 +92,16 @@ public:
         trees_ = get_param(index_params_,"trees",4);
         tree_roots_ = new NodePtr[trees_];
 
-        // Create a permutable array of indices to the input vectors.
-        vind_.resize(size_);
+        points_.resize(size_);
         for (size_t i = 0; i < size_; ++i) {
-            vind_[i] = int(i);
+            points_[i] = dataset_[i];
         }
+        removed_points_.resize(size_);
+        removed_points_.reset();
+        removed_count_ = 0;
+        size_at_build_ = size_;
+        indexed_count_ = size_;
+        indexed_removed_ = 0;
 
         mean_ = new DistanceType[veclen_];
         var_ = new DistanceType[veclen_];
@@ -122,11 +128,73 @@ public:
      */
     void buildIndex()
     {
+        // Create a permutable array of indices to the input vectors.
+        vind_.clear();
+        for (size_t i = 0; i < size_; ++i) {
+            if (!removed_points_.test(i)) vind_.push_back(int(i));
+        }
+        pool_.free();
+
         /* Construct the randomized trees. */
         for (int i = 0; i < trees_; i++) {
             /* Randomize the order of vectors to allow for unbiased sampling. */
             std::random_shuffle(vind_.begin(), vind_.end());
-            tree_roots_[i] = divideTree(&vind_[0], int(size_) );
+            tree_roots_[i] = divideTree(&vind_[0], int(vind_.size()) );
+        }
+
+        size_at_build_ = vind_.size();
+        indexed_count_ = vind_.size();
+        indexed_removed_ = 0;
+    }
+
+    /**
+     * Adds a copy of the points to the trees, or rebuilds them when the number of points
+     * has grown by rebuild_threshold since the last build.
+     */
+    void addPoints(const Matrix<ElementType>& points, float rebuild_threshold = 2)
+    {
+        assert(points.cols == veclen_);
+        size_t old_size = size_;
+
+        added_points_.push_back(std::vector<ElementType>(points.rows*veclen_));
+        ElementType* data = &added_points_.back()[0];
+        for (size_t i = 0; i < points.rows; ++i, data += veclen_) {
+            std::copy(points[i], points[i] + veclen_, data);
+            points_.push_back(data);
+        }
+        size_ = points_.size();
+        removed_points_.resize(size_);
+
+        if (rebuild_threshold > 1 && size_at_build_*rebuild_threshold < size_ - removed_count_) {
+            buildIndex();
+        }
+        else {
+            for (size_t i = old_size; i < size_; ++i) {
+                for (int j = 0; j < trees_; ++j) {
+                    addPointToTree(tree_roots_[j], int(i));
+                }
+            }
+            indexed_count_ += size_ - old_size;
+        }
+    }
+
+    /**
+     * Marks the point as removed, so that it is skipped by the search. The trees
+     * are rebuilt without the removed points once they are the majority of their leaves.
+     */
+    void removePoint(size_t id)
+    {
+        if (id >= size_) {
+            throw FLANNException("Invalid point index");
+        }
+        if (removed_points_.test(id)) return;
+
+        removed_points_.set(id);
+        removed_count_++;
+        indexed_removed_++;
+
+        if (indexed_removed_*2 > indexed_count_ && removed_count_ < size_) {
+            buildIndex();
         }
     }
 
@@ -139,6 +207,9 @@ public:
 
     void saveIndex(FILE* stream)
     {
+        if (removed_count_ > 0) {
+            throw FLANNException("Cannot save an index with removed points");
+        }
         save_value(stream, trees_);
         for (int i=0; i<trees_; ++i) {
             save_tree(stream, tree_roots_[i]);
@@ -154,9 +225,13 @@ public:
             delete[] tree_roots_;
         }
         tree_roots_ = new NodePtr[trees_];
+        pool_.free();
         for (int i=0; i<trees_; ++i) {
             load_tree(stream,tree_roots_[i]);
         }
+        size_at_build_ = size_;
+        indexed_count_ = size_;
+        indexed_removed_ = 0;
 
         index_params_["algorithm"] = getType();
         index_params_["trees"] = tree_roots_;
@@ -167,7 +242,7 @@ public:
      */
     size_t size() const
     {
-        return size_;
+        return size_ - removed_count_;
     }
 
     /**
@@ -184,7 +259,7 @@ public:
      */
     int usedMemory() const
     {
-        return int(pool_.usedMemory+pool_.wastedMemory+dataset_.rows*sizeof(int));  // pool memory and vind array memory
+        return int(pool_.usedMemory+pool_.wastedMemory+size_*sizeof(int));  // pool memory and vind array memory
     }
 
     /**
@@ -298,6 +373,49 @@ private:
     }
 
 
+    /**
+     * Inserts the point ind into the tree: the leaf it falls into is split
+     * on the dimension where the two points differ the most.
+     */
+    void addPointToTree(NodePtr node, int ind)
+    {
+        const ElementType* point = points_[ind];
+
+        while ((node->child1 != NULL) || (node->child2 != NULL)) {
+            node = (point[node->divfeat] < node->divval) ? node->child1 : node->child2;
+        }
+
+        const ElementType* leaf_point = points_[node->divfeat];
+        DistanceType max_span = 0;
+        int div_feat = 0;
+        for (size_t i = 0; i < veclen_; ++i) {
+            DistanceType span = (DistanceType)point[i] - (DistanceType)leaf_point[i];
+            if (span < 0) span = -span;
+            if (span > max_span) {
+                max_span = span;
+                div_feat = (int)i;
+            }
+        }
+
+        NodePtr left = pool_.allocate<Node>();
+        NodePtr right = pool_.allocate<Node>();
+        left->child1 = left->child2 = right->child1 = right->child2 = NULL;
+        if (point[div_feat] < leaf_point[div_feat]) {
+            left->divfeat = ind;
+            right->divfeat = node->divfeat;
+        }
+        else {
+            left->divfeat = node->divfeat;
+            right->divfeat = ind;
+        }
+
+        node->divfeat = div_feat;
+        node->divval = ((DistanceType)point[div_feat] + (DistanceType)leaf_point[div_feat])/2;
+        node->child1 = left;
+        node->child2 = right;
+    }
+
+
     /**
      * Choose which feature to use in order to subdivide this set of vectors.
      * Make a random choice among those with the highest variance, and use
@@ -313,7 +431,7 @@ private:
          */
         int cnt = std::min((int)SAMPLE_MEAN+1, count);
         for (int j = 0; j < cnt; ++j) {
-            ElementType* v = dataset_[ind[j]];
+            ElementType* v = points_[ind[j]];
             for (size_t k=0; k<veclen_; ++k) {
                 mean_[k] += v[k];
             }
@@ -324,7 +442,7 @@ private:
 
         /* Compute variances (no need to divide by count). */
         for (int j = 0; j < cnt; ++j) {
-            ElementType* v = dataset_[ind[j]];
+            ElementType* v = points_[ind[j]];
             for (size_t k=0; k<veclen_; ++k) {
                 DistanceType dist = v[k] - mean_[k];
                 var_[k] += dist * dist;
@@ -396,16 +514,16 @@ private:
         int left = 0;
         int right = count-1;
         for (;; ) {
-            while (left<=right && dataset_[ind[left]][cutfeat]<cutval) ++left;
-            while (left<=right && dataset_[ind[right]][cutfeat]>=cutval) --right;
+            while (left<=right && points_[ind[left]][cutfeat]<cutval) ++left;
+            while (left<=right && points_[ind[right]][cutfeat]>=cutval) --right;
             if (left>right) break;
             std::swap(ind[left], ind[right]); ++left; --right;
         }
         lim1 = left;
         right = count-1;
         for (;; ) {
-            while (left<=right && dataset_[ind[left]][cutfeat]<=cutval) ++left;
-            while (left<=right && dataset_[ind[right]][cutfeat]>cutval) --right;
+            while (left<=right && points_[ind[left]][cutfeat]<=cutval) ++left;
+            while (left<=right && points_[ind[right]][cutfeat]>cutval) --right;
             if (left>right) break;
             std::swap(ind[left], ind[right]); ++left; --right;
         }
@@ -479,11 +597,12 @@ private:
                 current checkID.
              */
             int index = node->divfeat;
+            if (removed_count_ > 0 && removed_points_.test(index)) return;
             if ( checked.test(index) || ((checkCount>=maxCheck)&& result_set.full()) ) return;
             checked.set(index);
             checkCount++;
 
-            DistanceType dist = distance_(dataset_[index], vec, veclen_);
+            DistanceType dist = distance_(points_[index], vec, veclen_);
             result_set.addPoint(dist,index);
 
             return;
@@ -521,7 +640,8 @@ private:
         /* If this is a leaf node, then do check and return. */
         if ((node->child1 == NULL)&&(node->child2 == NULL)) {
             int index = node->divfeat;
-            DistanceType dist = distance_(dataset_[index], vec, veclen_);
+            if (removed_count_ > 0 && removed_points_.test(index)) return;
+            DistanceType dist = distance_(points_[index], vec, veclen_);
             result_set.addPoint(dist,index);
             return;
         }
@@ -587,6 +707,33 @@ private:
      */
     const Matrix<ElementType> dataset_;
 
+    /**
+     * Pointers to the points of the dataset followed by the added points
+     */
+    std::vector<ElementType*> points_;
+
+    /**
+     * The copies of the added points, a block per addPoints() call
+     */
+    std::list<std::vector<ElementType> > added_points_;
+
+    /**
+     * The points removed from the index and their number
+     */
+    DynamicBitset removed_points_;
+    size_t removed_count_;
+
+    /**
+     * Number of points when the trees were last built
+     */
+    size_t size_at_build_;
+
+    /**
+     * Number of leaves of each tree, and how many of them are removed points
+     */
+    size_t indexed_count_;
+    size_t indexed_removed_;
+
     IndexParams index_params_;
 
     size_t size_;
@@ -202,23 +202,18 @@ public:
 
 
     /**
-     * \brief Perform k-nearest neighbor search
+     * \brief Perform k-nearest neighbor search for the queries [start, end)
      * \param[in] queries The query points for which to find the nearest neighbors
      * \param[out] indices The indices of the nearest neighbors found
      * \param[out] dists Distances to the nearest neighbors found
      * \param[in] knn Number of nearest neighbors to return
      * \param[in] params Search parameters
      */
-    void knnSearch(const Matrix<ElementType>& queries, Matrix<int>& indices, Matrix<DistanceType>& dists, int knn, const SearchParams& params)
+    void knnSearchRows(const Matrix<ElementType>& queries, Matrix<int>& indices, Matrix<DistanceType>& dists, int knn, const SearchParams& params,
+                       size_t start, size_t end)
     {
-        assert(queries.cols == veclen());
-        assert(indices.rows >= queries.rows);
-        assert(dists.rows >= queries.rows);
-        assert(int(indices.cols) >= knn);
-        assert(int(dists.cols) >= knn);
-
         KNNSimpleResultSet<DistanceType> resultSet(knn);
-        for (size_t i = 0; i < queries.rows; i++) {
+        for (size_t i = start; i < end; i++) {
             resultSet.init(indices[i], dists[i]);
             findNeighbors(resultSet, queries[i], params);
         }
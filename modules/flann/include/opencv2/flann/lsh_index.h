@@ -38,6 +38,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <list>
 #include <map>
 #include <vector>
 
@@ -48,6 +49,7 @@
 #include "heap.h"
 #include "lsh_table.h"
 #include "allocator.h"
+#include "dynamic_bitset.h"
 #include "random.h"
 #include "saving.h"
 
@@ -98,6 +100,7 @@ public:
 
         feature_size_ = (unsigned)dataset_.cols;
         fill_xor_mask(0, key_size_, multi_probe_level_, xor_masks_);
+        initPoints();
     }
 
 
@@ -115,7 +118,59 @@ public:
             table = lsh::LshTable<ElementType>(feature_size_, key_size_);
 
             // Add the features to the table
-            table.add(dataset_);
+            for (size_t j = 0; j < points_.size(); ++j) {
+                if (!removed_points_.test(j)) table.add((unsigned int)j, points_[j]);
+            }
+            table.optimize();
+        }
+        indexed_count_ = points_.size() - removed_count_;
+        indexed_removed_ = 0;
+    }
+
+    /**
+     * Adds a copy of the points to the hash tables. The tables do not degrade when growing,
+     * so rebuild_threshold is not used.
+     */
+    void addPoints(const Matrix<ElementType>& points, float /*rebuild_threshold*/ = 2)
+    {
+        assert(points.cols == feature_size_);
+        size_t old_size = points_.size();
+
+        added_points_.push_back(std::vector<ElementType>(points.rows*feature_size_));
+        ElementType* data = &added_points_.back()[0];
+        for (size_t i = 0; i < points.rows; ++i, data += feature_size_) {
+            std::copy(points[i], points[i] + feature_size_, data);
+            points_.push_back(data);
+        }
+        removed_points_.resize(points_.size());
+
+        for (unsigned int i = 0; i < tables_.size(); ++i) {
+            lsh::LshTable<ElementType>& table = tables_[i];
+            for (size_t j = old_size; j < points_.size(); ++j) {
+                table.add((unsigned int)j, points_[j]);
+            }
+            table.optimize();
+        }
+        indexed_count_ += points_.size() - old_size;
+    }
+
+    /**
+     * Marks the point as removed, so that it is skipped by the search. The tables
+     * are rebuilt without the removed points once they are the majority of their entries.
+     */
+    void removePoint(size_t id)
+    {
+        if (id >= points_.size()) {
+            throw FLANNException("Invalid point index");
+        }
+        if (removed_points_.test(id)) return;
+
+        removed_points_.set(id);
+        removed_count_++;
+        indexed_removed_++;
+
+        if (indexed_removed_*2 > indexed_count_ && removed_count_ < points_.size()) {
+            buildIndex();
         }
     }
 
@@ -127,10 +182,23 @@ public:
 
     void saveIndex(FILE* stream)
     {
+        if (removed_count_ > 0) {
+            throw FLANNException("Cannot save an index with removed points");
+        }
         save_value(stream,table_number_);
         save_value(stream,key_size_);
         save_value(stream,multi_probe_level_);
-        save_value(stream, dataset_);
+        if (points_.size() == dataset_.rows) {
+            save_value(stream, dataset_);
+        }
+        else {
+            // the added points are saved as if they were appended to the dataset
+            Matrix<ElementType> dataset(NULL, points_.size(), feature_size_);
+            fwrite(&dataset, sizeof(dataset), 1, stream);
+            for (size_t i = 0; i < points_.size(); ++i) {
+                fwrite(points_[i], sizeof(ElementType), feature_size_, stream);
+            }
+        }
     }
 
     void loadIndex(FILE* stream)
@@ -139,6 +207,7 @@ public:
         load_value(stream, key_size_);
         load_value(stream, multi_probe_level_);
         load_value(stream, dataset_);
+        initPoints();
         // Building the index is so fast we can afford not storing it
         buildIndex();
 
@@ -153,7 +222,7 @@ public:
      */
     size_t size() const
     {
-        return dataset_.rows;
+        return points_.size() - removed_count_;
     }
 
     /**
@@ -170,7 +239,7 @@ public:
      */
     int usedMemory() const
     {
-        return (int)(dataset_.rows * sizeof(int));
+        return (int)(points_.size() * sizeof(int));
     }
 
 
@@ -180,29 +249,24 @@ public:
     }
 
     /**
-     * \brief Perform k-nearest neighbor search
+     * \brief Perform k-nearest neighbor search for the queries [start, end)
      * \param[in] queries The query points for which to find the nearest neighbors
      * \param[out] indices The indices of the nearest neighbors found
      * \param[out] dists Distances to the nearest neighbors found
      * \param[in] knn Number of nearest neighbors to return
      * \param[in] params Search parameters
      */
-    virtual void knnSearch(const Matrix<ElementType>& queries, Matrix<int>& indices, Matrix<DistanceType>& dists, int knn, const SearchParams& params)
+    virtual void knnSearchRows(const Matrix<ElementType>& queries, Matrix<int>& indices, Matrix<DistanceType>& dists, int knn, const SearchParams& params,
+                               size_t start, size_t end)
     {
-        assert(queries.cols == veclen());
-        assert(indices.rows >= queries.rows);
-        assert(dists.rows >= queries.rows);
-        assert(int(indices.cols) >= knn);
-        assert(int(dists.cols) >= knn);
-
-
         KNNUniqueResultSet<DistanceType> resultSet(knn);
-        for (size_t i = 0; i < queries.rows; i++) {
+        bool sorted = get_param(params,"sorted",true);
+        for (size_t i = start; i < end; i++) {
             resultSet.clear();
             std::fill_n(indices[i], knn, -1);
             std::fill_n(dists[i], knn, std::numeric_limits<DistanceType>::max());
             findNeighbors(resultSet, queries[i], params);
-            if (get_param(params,"sorted",true)) resultSet.sortAndCopy(indices[i], dists[i], knn);
+            if (sorted) resultSet.sortAndCopy(indices[i], dists[i], knn);
             else resultSet.copy(indices[i], dists[i], knn);
         }
     }
@@ -223,6 +287,21 @@ public:
     }
 
 private:
+    /** Points to the rows of the dataset, the removed points are marked in removed_points_
+     */
+    void initPoints()
+    {
+        points_.resize(dataset_.rows);
+        for (size_t i = 0; i < dataset_.rows; ++i) {
+            points_[i] = dataset_[i];
+        }
+        removed_points_.resize(points_.size());
+        removed_points_.reset();
+        removed_count_ = 0;
+        indexed_count_ = points_.size();
+        indexed_removed_ = 0;
+    }
+
     /** Defines the comparator on score and index
      */
     typedef std::pair<float, unsigned int> ScoreIndexPair;
@@ -285,7 +364,8 @@ private:
 
                     // Process the rest of the candidates
                     for (; training_index < last_training_index; ++training_index) {
-                        hamming_distance = distance_(vec, dataset_[*training_index], dataset_.cols);
+                        if (removed_count_ > 0 && removed_points_.test(*training_index)) continue;
+                        hamming_distance = distance_(vec, points_[*training_index], feature_size_);
 
                         if (hamming_distance < worst_score) {
                             // Insert the new element
@@ -323,8 +403,9 @@ private:
 
                     // Process the rest of the candidates
                     for (; training_index < last_training_index; ++training_index) {
+                        if (removed_count_ > 0 && removed_points_.test(*training_index)) continue;
                         // Compute the Hamming distance
-                        hamming_distance = distance_(vec, dataset_[*training_index], dataset_.cols);
+                        hamming_distance = distance_(vec, points_[*training_index], feature_size_);
                         if (hamming_distance < radius) score_index_heap.push_back(ScoreIndexPair(hamming_distance, training_index));
                     }
                 }
@@ -356,8 +437,9 @@ private:
 
                 // Process the rest of the candidates
                 for (; training_index < last_training_index; ++training_index) {
+                    if (removed_count_ > 0 && removed_points_.test(*training_index)) continue;
                     // Compute the Hamming distance
-                    hamming_distance = distance_(vec, dataset_[*training_index], (int)dataset_.cols);
+                    hamming_distance = distance_(vec, points_[*training_index], (int)feature_size_);
                     result.addPoint(hamming_distance, *training_index);
                 }
             }
@@ -370,6 +452,20 @@ private:
     /** The data the LSH tables where built from */
     Matrix<ElementType> dataset_;
 
+    /** Pointers to the points of the dataset followed by the added points */
+    std::vector<ElementType*> points_;
+
+    /** The copies of the added points, a block per addPoints() call */
+    std::list<std::vector<ElementType> > added_points_;
+
+    /** The points removed from the index and their number */
+    DynamicBitset removed_points_;
+    size_t removed_count_;
+
+    /** Number of points in the tables, and how many of them are removed points */
+    size_t indexed_count_;
+    size_t indexed_removed_;
+
     /** The size of the features (as ElementType[]) */
     unsigned int feature_size_;
 
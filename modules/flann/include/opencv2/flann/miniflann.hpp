@@ -125,6 +125,7 @@ struct CV_EXPORTS SavedIndexParams : public IndexParams
 struct CV_EXPORTS SearchParams : public IndexParams
 {
     SearchParams( int checks = 32, float eps = 0, bool sorted = true );
+    SearchParams( int checks, float eps, bool sorted, int cores );
 };
 
 class CV_EXPORTS_W Index
@@ -145,6 +146,8 @@ public:
     CV_WRAP virtual void save(const std::string& filename) const;
     CV_WRAP virtual bool load(InputArray features, const std::string& filename);
     CV_WRAP virtual void release();
+    CV_WRAP void addPoints(InputArray points, float rebuildThreshold=2.f);
+    CV_WRAP void removePoint(int pointIdx);
     CV_WRAP cvflann::flann_distance_t getDistance() const;
     CV_WRAP cvflann::flann_algorithm_t getAlgorithm() const;
 
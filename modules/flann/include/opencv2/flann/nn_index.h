@@ -33,6 +33,7 @@
 
 #include <string>
 
+#include "opencv2/core/core.hpp"
 #include "general.h"
 #include "matrix.h"
 #include "result_set.h"
@@ -66,6 +67,10 @@ public:
      * \param[out] dists Distances to the nearest neighbors found
      * \param[in] knn Number of nearest neighbors to return
      * \param[in] params Search parameters
+     *
+     * The queries are split into batches searched in parallel when the "cores" search
+     * parameter is not 1. Each query writes only its own rows of indices and dists,
+     * so the result does not depend on the number of threads.
      */
     virtual void knnSearch(const Matrix<ElementType>& queries, Matrix<int>& indices, Matrix<DistanceType>& dists, int knn, const SearchParams& params)
     {
@@ -75,18 +80,32 @@ public:
         assert(int(indices.cols) >= knn);
         assert(int(dists.cols) >= knn);
 
+        KnnSearchInvoker invoker(this, queries, indices, dists, knn, params);
+        runSearch(invoker, queries.rows, params);
+    }
+
+    /**
+     * \brief Perform k-nearest neighbor search for the queries [start, end)
+     *
+     * Called by knnSearch for each batch of queries, possibly from several threads at once;
+     * the result set is local to the call.
+     */
+    virtual void knnSearchRows(const Matrix<ElementType>& queries, Matrix<int>& indices, Matrix<DistanceType>& dists, int knn, const SearchParams& params,
+                               size_t start, size_t end)
+    {
 #if 0
         KNNResultSet<DistanceType> resultSet(knn);
-        for (size_t i = 0; i < queries.rows; i++) {
+        for (size_t i = start; i < end; i++) {
             resultSet.init(indices[i], dists[i]);
             findNeighbors(resultSet, queries[i], params);
         }
 #else
         KNNUniqueResultSet<DistanceType> resultSet(knn);
-        for (size_t i = 0; i < queries.rows; i++) {
+        bool sorted = get_param(params,"sorted",true);
+        for (size_t i = start; i < end; i++) {
             resultSet.clear();
             findNeighbors(resultSet, queries[i], params);
-            if (get_param(params,"sorted",true)) resultSet.sortAndCopy(indices[i], dists[i], knn);
+            if (sorted) resultSet.sortAndCopy(indices[i], dists[i], knn);
             else resultSet.copy(indices[i], dists[i], knn);
         }
 #endif
@@ -94,40 +113,49 @@ public:
 
     /**
      * \brief Perform radius search
-     * \param[in] query The query point
-     * \param[out] indices The indinces of the neighbors found within the given radius
+     * \param[in] query The query points
+     * \param[out] indices The indinces of the neighbors found within the given radius, one row per query
      * \param[out] dists The distances to the nearest neighbors found
      * \param[in] radius The radius used for search
      * \param[in] params Search parameters
-     * \returns Number of neighbors found
+     * \returns Number of neighbors found, summed over all the queries
      */
     virtual int radiusSearch(const Matrix<ElementType>& query, Matrix<int>& indices, Matrix<DistanceType>& dists, float radius, const SearchParams& params)
     {
-        if (query.rows != 1) {
-            fprintf(stderr, "I can only search one feature at a time for range search\n");
-            return -1;
-        }
         assert(query.cols == veclen());
         assert(indices.cols == dists.cols);
+        assert(indices.cols == 0 || (indices.rows >= query.rows && dists.rows >= query.rows));
 
-        int n = 0;
-        int* indices_ptr = NULL;
-        DistanceType* dists_ptr = NULL;
-        if (indices.cols > 0) {
-            n = (int)indices.cols;
-            indices_ptr = indices[0];
-            dists_ptr = dists[0];
-        }
+        std::vector<int> counts(query.rows, 0);
+        RadiusSearchInvoker invoker(this, query, indices, dists, radius, params, counts);
+        runSearch(invoker, query.rows, params);
 
-        RadiusUniqueResultSet<DistanceType> resultSet((DistanceType)radius);
-        resultSet.clear();
-        findNeighbors(resultSet, query[0], params);
-        if (n>0) {
-            if (get_param(params,"sorted",true)) resultSet.sortAndCopy(indices_ptr, dists_ptr, n);
-            else resultSet.copy(indices_ptr, dists_ptr, n);
+        int count = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            count += counts[i];
         }
+        return count;
+    }
+
+    /**
+     * \brief Adds points to the index
+     * \param[in] points The points to add. They are copied into the index and get the indices
+     * following the ones of the points already added.
+     * \param[in] rebuild_threshold The index is rebuilt from scratch when the number of points
+     * grows by this factor since the last build (values <= 1 disable the rebuild)
+     */
+    virtual void addPoints(const Matrix<ElementType>& /*points*/, float /*rebuild_threshold*/ = 2)
+    {
+        throw FLANNException("This index type does not support adding points");
+    }
 
-        return (int)resultSet.size();
+    /**
+     * \brief Removes a point from the index
+     * \param[in] id The index of the point; the indices of the other points do not change
+     */
+    virtual void removePoint(size_t /*id*/)
+    {
+        throw FLANNException("This index type does not support removing points");
     }
 
     /**
@@ -172,6 +200,83 @@ public:
      * \brief Method that searches for nearest-neighbours
      */
     virtual void findNeighbors(ResultSet<DistanceType>& result, const ElementType* vec, const SearchParams& searchParams) = 0;
+
+private:
+    /**
+     * Runs the search body over the query rows: in the calling thread when "cores" is 1 (default),
+     * otherwise in parallel batches, using at most "cores" threads or all of them when "cores" is 0.
+     */
+    static void runSearch(const cv::ParallelLoopBody& body, size_t rows, const SearchParams& params)
+    {
+        int cores = get_param(params,"cores",1);
+        if (cores == 1 || rows < 2) {
+            body(cv::Range(0, (int)rows));
+        }
+        else {
+            cv::parallel_for_(cv::Range(0, (int)rows), body, cores > 1 ? (double)cores : -1.);
+        }
+    }
+
+    class KnnSearchInvoker : public cv::ParallelLoopBody
+    {
+    public:
+        KnnSearchInvoker(NNIndex* _index, const Matrix<ElementType>& _queries, Matrix<int>& _indices,
+                         Matrix<DistanceType>& _dists, int _knn, const SearchParams& _params) :
+            index(_index), queries(&_queries), indices(&_indices), dists(&_dists), knn(_knn), params(&_params)
+        {
+        }
+
+        void operator()(const cv::Range& range) const
+        {
+            index->knnSearchRows(*queries, *indices, *dists, knn, *params, range.start, range.end);
+        }
+
+    private:
+        NNIndex* index;
+        const Matrix<ElementType>* queries;
+        Matrix<int>* indices;
+        Matrix<DistanceType>* dists;
+        int knn;
+        const SearchParams* params;
+    };
+
+    class RadiusSearchInvoker : public cv::ParallelLoopBody
+    {
+    public:
+        RadiusSearchInvoker(NNIndex* _index, const Matrix<ElementType>& _queries, Matrix<int>& _indices,
+                            Matrix<DistanceType>& _dists, float _radius, const SearchParams& _params,
+                            std::vector<int>& _counts) :
+            index(_index), queries(&_queries), indices(&_indices), dists(&_dists), radius(_radius),
+            params(&_params), counts(&_counts)
+        {
+        }
+
+        void operator()(const cv::Range& range) const
+        {
+            int n = (int)indices->cols;
+            bool sorted = get_param(*params,"sorted",true);
+
+            RadiusUniqueResultSet<DistanceType> resultSet((DistanceType)radius);
+            for (int i = range.start; i < range.end; i++) {
+                resultSet.clear();
+                index->findNeighbors(resultSet, (*queries)[i], *params);
+                if (n>0) {
+                    if (sorted) resultSet.sortAndCopy((*indices)[i], (*dists)[i], n);
+                    else resultSet.copy((*indices)[i], (*dists)[i], n);
+                }
+                (*counts)[i] = (int)resultSet.size();
+            }
+        }
+
+    private:
+        NNIndex* index;
+        const Matrix<ElementType>* queries;
+        Matrix<int>* indices;
+        Matrix<DistanceType>* dists;
+        float radius;
+        const SearchParams* params;
+        std::vector<int>* counts;
+    };
 };
 
 }
@@ -52,6 +52,18 @@ struct SearchParams : public IndexParams
         // only for radius search, require neighbours sorted by distance (default: true)
         (*this)["sorted"] = sorted;
     }
+
+    SearchParams(int checks, float eps, bool sorted, int cores )
+    {
+        // how many leafs to visit when searching for neighbours (-1 for unlimited)
+        (*this)["checks"] = checks;
+        // search for eps-approximate neighbours (default: 0)
+        (*this)["eps"] = eps;
+        // only for radius search, require neighbours sorted by distance (default: true)
+        (*this)["sorted"] = sorted;
+        // number of threads used to search a batch of queries (1 - the calling thread only, 0 - all available)
+        (*this)["cores"] = cores;
+    }
 };
 
 
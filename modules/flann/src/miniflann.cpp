@@ -306,6 +306,20 @@ SearchParams::SearchParams( int checks, float eps, bool sorted )
     p["sorted"] = sorted;
 }
 
+SearchParams::SearchParams( int checks, float eps, bool sorted, int cores )
+{
+    ::cvflann::IndexParams& p = get_params(*this);
+
+    // how many leafs to visit when searching for neighbours (-1 for unlimited)
+    p["checks"] = checks;
+    // search for eps-approximate neighbours (default: 0)
+    p["eps"] = eps;
+    // only for radius search, require neighbours sorted by distance (default: true)
+    p["sorted"] = sorted;
+    // number of threads used to search a batch of queries (1 - the calling thread only, 0 - all available)
+    p["cores"] = cores;
+}
+
 
 template<typename Distance, typename IndexType> void
 buildIndex_(void*& index, const Mat& data, const IndexParams& params, const Distance& dist = Distance())
@@ -628,71 +642,196 @@ int Index::radiusSearch(InputArray _query, OutputArray _indices,
     return -1;
 }
 
-flann_distance_t Index::getDistance() const
+template<typename Distance, typename IndexType>
+void runAddPoints_(void* index, const Mat& points, float rebuildThreshold)
 {
-    return distType;
+    typedef typename Distance::ElementType ElementType;
+    int type = DataType<ElementType>::type;
+    IndexType* _index = (IndexType*)index;
+    CV_Assert(points.type() == type && (size_t)points.cols == _index->veclen() &&
+              points.step % sizeof(ElementType) == 0);
+
+    ::cvflann::Matrix<ElementType> _points((ElementType*)points.data, points.rows, points.cols,
+                                           points.step/sizeof(ElementType));
+    _index->addPoints(_points, rebuildThreshold);
 }
 
-flann_algorithm_t Index::getAlgorithm() const
+template<typename Distance>
+void runAddPoints(void* index, const Mat& points, float rebuildThreshold)
 {
-    return algo;
+    runAddPoints_<Distance, ::cvflann::Index<Distance> >(index, points, rebuildThreshold);
 }
 
-template<typename IndexType> void saveIndex_(const Index* index0, const void* index, FILE* fout)
+template<typename Distance, typename IndexType>
+void runRemovePoint_(void* index, int pointIdx)
 {
-    IndexType* _index = (IndexType*)index;
-    ::cvflann::save_header(fout, *_index);
-    // some compilers may store short enumerations as bytes,
-    // so make sure we always write integers (which are 4-byte values in any modern C compiler)
-    int idistType = (int)index0->getDistance();
-    ::cvflann::save_value<int>(fout, idistType);
-    _index->saveIndex(fout);
+    ((IndexType*)index)->removePoint((size_t)pointIdx);
 }
 
-template<typename Distance> void saveIndex(const Index* index0, const void* index, FILE* fout)
+template<typename Distance>
+void runRemovePoint(void* index, int pointIdx)
 {
-    saveIndex_< ::cvflann::Index<Distance> >(index0, index, fout);
+    runRemovePoint_<Distance, ::cvflann::Index<Distance> >(index, pointIdx);
 }
 
-void Index::save(const std::string& filename) const
+void Index::addPoints(InputArray _points, float rebuildThreshold)
 {
-    FILE* fout = fopen(filename.c_str(), "wb");
-    if (fout == NULL)
-        CV_Error_( CV_StsError, ("Can not open file %s for writing FLANN index\n", filename.c_str()) );
+    if( algo != FLANN_INDEX_KDTREE && algo != FLANN_INDEX_LSH )
+        CV_Error( CV_StsNotImplemented, "Only KD-tree and LSH indexes support addPoints operation" );
+    CV_Assert( index != 0 );
+
+    Mat points = _points.getMat();
+    if( points.empty() )
+        return;
 
     switch( distType )
     {
     case FLANN_DIST_HAMMING:
-        saveIndex< HammingDistance >(this, index, fout);
+        runAddPoints< HammingDistance >(index, points, rebuildThreshold);
         break;
     case FLANN_DIST_L2:
-        saveIndex< ::cvflann::L2<float> >(this, index, fout);
+        runAddPoints< ::cvflann::L2<float> >(index, points, rebuildThreshold);
         break;
     case FLANN_DIST_L1:
-        saveIndex< ::cvflann::L1<float> >(this, index, fout);
+        runAddPoints< ::cvflann::L1<float> >(index, points, rebuildThreshold);
         break;
 #if MINIFLANN_SUPPORT_EXOTIC_DISTANCE_TYPES
     case FLANN_DIST_MAX:
-        saveIndex< ::cvflann::MaxDistance<float> >(this, index, fout);
+        runAddPoints< ::cvflann::MaxDistance<float> >(index, points, rebuildThreshold);
         break;
     case FLANN_DIST_HIST_INTERSECT:
-        saveIndex< ::cvflann::HistIntersectionDistance<float> >(this, index, fout);
+        runAddPoints< ::cvflann::HistIntersectionDistance<float> >(index, points, rebuildThreshold);
         break;
     case FLANN_DIST_HELLINGER:
-        saveIndex< ::cvflann::HellingerDistance<float> >(this, index, fout);
+        runAddPoints< ::cvflann::HellingerDistance<float> >(index, points, rebuildThreshold);
         break;
     case FLANN_DIST_CHI_SQUARE:
-        saveIndex< ::cvflann::ChiSquareDistance<float> >(this, index, fout);
+        runAddPoints< ::cvflann::ChiSquareDistance<float> >(index, points, rebuildThreshold);
         break;
     case FLANN_DIST_KL:
-        saveIndex< ::cvflann::KL_Divergence<float> >(this, index, fout);
+        runAddPoints< ::cvflann::KL_Divergence<float> >(index, points, rebuildThreshold);
         break;
 #endif
     default:
-        fclose(fout);
-        fout = 0;
         CV_Error(CV_StsBadArg, "Unknown/unsupported distance type");
     }
+}
+
+void Index::removePoint(int pointIdx)
+{
+    if( algo != FLANN_INDEX_KDTREE && algo != FLANN_INDEX_LSH )
+        CV_Error( CV_StsNotImplemented, "Only KD-tree and LSH indexes support removePoint operation" );
+    CV_Assert( index != 0 && pointIdx >= 0 );
+
+    switch( distType )
+    {
+    case FLANN_DIST_HAMMING:
+        runRemovePoint< HammingDistance >(index, pointIdx);
+        break;
+    case FLANN_DIST_L2:
+        runRemovePoint< ::cvflann::L2<float> >(index, pointIdx);
+        break;
+    case FLANN_DIST_L1:
+        runRemovePoint< ::cvflann::L1<float> >(index, pointIdx);
+        break;
+#if MINIFLANN_SUPPORT_EXOTIC_DISTANCE_TYPES
+    case FLANN_DIST_MAX:
+        runRemovePoint< ::cvflann::MaxDistance<float> >(index, pointIdx);
+        break;
+    case FLANN_DIST_HIST_INTERSECT:
+        runRemovePoint< ::cvflann::HistIntersectionDistance<float> >(index, pointIdx);
+        break;
+    case FLANN_DIST_HELLINGER:
+        runRemovePoint< ::cvflann::HellingerDistance<float> >(index, pointIdx);
+        break;
+    case FLANN_DIST_CHI_SQUARE:
+        runRemovePoint< ::cvflann::ChiSquareDistance<float> >(index, pointIdx);
+        break;
+    case FLANN_DIST_KL:
+        runRemovePoint< ::cvflann::KL_Divergence<float> >(index, pointIdx);
+        break;
+#endif
+    default:
+        CV_Error(CV_StsBadArg, "Unknown/unsupported distance type");
+    }
+}
+
+flann_distance_t Index::getDistance() const
+{
+    return distType;
+}
+
+flann_algorithm_t Index::getAlgorithm() const
+{
+    return algo;
+}
+
+template<typename IndexType> void saveIndex_(const Index* index0, const void* index, FILE* fout)
+{
+    IndexType* _index = (IndexType*)index;
+    ::cvflann::save_header(fout, *_index);
+    // some compilers may store short enumerations as bytes,
+    // so make sure we always write integers (which are 4-byte values in any modern C compiler)
+    int idistType = (int)index0->getDistance();
+    ::cvflann::save_value<int>(fout, idistType);
+    _index->saveIndex(fout);
+}
+
+template<typename Distance> void saveIndex(const Index* index0, const void* index, FILE* fout)
+{
+    saveIndex_< ::cvflann::Index<Distance> >(index0, index, fout);
+}
+
+void Index::save(const std::string& filename) const
+{
+    FILE* fout = fopen(filename.c_str(), "wb");
+    if (fout == NULL)
+        CV_Error_( CV_StsError, ("Can not open file %s for writing FLANN index\n", filename.c_str()) );
+
+    try
+    {
+        switch( distType )
+        {
+        case FLANN_DIST_HAMMING:
+            saveIndex< HammingDistance >(this, index, fout);
+            break;
+        case FLANN_DIST_L2:
+            saveIndex< ::cvflann::L2<float> >(this, index, fout);
+            break;
+        case FLANN_DIST_L1:
+            saveIndex< ::cvflann::L1<float> >(this, index, fout);
+            break;
+#if MINIFLANN_SUPPORT_EXOTIC_DISTANCE_TYPES
+        case FLANN_DIST_MAX:
+            saveIndex< ::cvflann::MaxDistance<float> >(this, index, fout);
+            break;
+        case FLANN_DIST_HIST_INTERSECT:
+            saveIndex< ::cvflann::HistIntersectionDistance<float> >(this, index, fout);
+            break;
+        case FLANN_DIST_HELLINGER:
+            saveIndex< ::cvflann::HellingerDistance<float> >(this, index, fout);
+            break;
+        case FLANN_DIST_CHI_SQUARE:
+            saveIndex< ::cvflann::ChiSquareDistance<float> >(this, index, fout);
+            break;
+        case FLANN_DIST_KL:
+            saveIndex< ::cvflann::KL_Divergence<float> >(this, index, fout);
+            break;
+#endif
+        default:
+            fclose(fout);
+            fout = 0;
+            CV_Error(CV_StsBadArg, "Unknown/unsupported distance type");
+        }
+    }
+    catch(...)
+    {
+        // do not leave a truncated index file behind, e.g. when the index refuses to be saved
+        if( fout )
+            fclose(fout);
+        remove(filename.c_str());
+        throw;
+    }
     if( fout )
         fclose(fout);
 }
@@ -417,6 +417,9 @@ enum
     CV_CAP_GSTREAMER_QUEUE_LENGTH   = 200, // default is 1
     CV_CAP_PROP_PVAPI_MULTICASTIP   = 300, // ip for anable multicast master mode. 0 for disable multicast
 
+    // Properties of video files opened through FFMPEG interface
+    CV_CAP_PROP_FFMPEG_PREFETCH     = 500, // number of frames decoded ahead on a background thread, 0 (default) disables read-ahead
+
     // Properties of cameras available through XIMEA SDK interface
     CV_CAP_PROP_XI_DOWNSAMPLING  = 400,      // Change image resolution by binning or skipping.
     CV_CAP_PROP_XI_DATA_FORMAT   = 401,       // Output data format.
@@ -481,6 +484,17 @@ enum
     CV_CAP_OPENNI_GRAY_IMAGE                = 6
 };
 
+// Channels of the frames read from video files through FFMPEG.
+// The planes are the decoder output itself, they are returned without any conversion
+// or copying and stay valid until the next grab.
+enum
+{
+    CV_CAP_FFMPEG_BGR_IMAGE = 0, // BGR frame (CV_8UC3)
+    CV_CAP_FFMPEG_PLANE_Y   = 1, // luma plane (CV_8UC1)
+    CV_CAP_FFMPEG_PLANE_U   = 2, // Cb plane (CV_8UC1), or the interleaved chroma plane of NV12/NV21 (CV_8UC2)
+    CV_CAP_FFMPEG_PLANE_V   = 3  // Cr plane (CV_8UC1), not available for NV12/NV21
+};
+
 // Supported output modes of OpenNI image generator
 enum
 {
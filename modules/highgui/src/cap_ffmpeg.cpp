@@ -51,6 +51,7 @@ static CvCreateFileCapture_Plugin icvCreateFileCapture_FFMPEG_p = 0;
 static CvReleaseCapture_Plugin icvReleaseCapture_FFMPEG_p = 0;
 static CvGrabFrame_Plugin icvGrabFrame_FFMPEG_p = 0;
 static CvRetrieveFrame_Plugin icvRetrieveFrame_FFMPEG_p = 0;
+static CvRetrieveFrameChannel_Plugin icvRetrieveFrameChannel_FFMPEG_p = 0;
 static CvSetCaptureProperty_Plugin icvSetCaptureProperty_FFMPEG_p = 0;
 static CvGetCaptureProperty_Plugin icvGetCaptureProperty_FFMPEG_p = 0;
 static CvCreateVideoWriter_Plugin icvCreateVideoWriter_FFMPEG_p = 0;
@@ -103,6 +104,9 @@ private:
                 (CvGrabFrame_Plugin)GetProcAddress(icvFFOpenCV, "cvGrabFrame_FFMPEG");
             icvRetrieveFrame_FFMPEG_p =
                 (CvRetrieveFrame_Plugin)GetProcAddress(icvFFOpenCV, "cvRetrieveFrame_FFMPEG");
+            // may be missing in the plugins built from older sources
+            icvRetrieveFrameChannel_FFMPEG_p =
+                (CvRetrieveFrameChannel_Plugin)GetProcAddress(icvFFOpenCV, "cvRetrieveFrameChannel_FFMPEG");
             icvSetCaptureProperty_FFMPEG_p =
                 (CvSetCaptureProperty_Plugin)GetProcAddress(icvFFOpenCV, "cvSetCaptureProperty_FFMPEG");
             icvGetCaptureProperty_FFMPEG_p =
@@ -138,6 +142,7 @@ private:
         icvReleaseCapture_FFMPEG_p = (CvReleaseCapture_Plugin)cvReleaseCapture_FFMPEG;
         icvGrabFrame_FFMPEG_p = (CvGrabFrame_Plugin)cvGrabFrame_FFMPEG;
         icvRetrieveFrame_FFMPEG_p = (CvRetrieveFrame_Plugin)cvRetrieveFrame_FFMPEG;
+        icvRetrieveFrameChannel_FFMPEG_p = (CvRetrieveFrameChannel_Plugin)cvRetrieveFrameChannel_FFMPEG;
         icvSetCaptureProperty_FFMPEG_p = (CvSetCaptureProperty_Plugin)cvSetCaptureProperty_FFMPEG;
         icvGetCaptureProperty_FFMPEG_p = (CvGetCaptureProperty_Plugin)cvGetCaptureProperty_FFMPEG;
         icvCreateVideoWriter_FFMPEG_p = (CvCreateVideoWriter_Plugin)cvCreateVideoWriter_FFMPEG;
@@ -166,13 +171,21 @@ public:
     {
         return ffmpegCapture ? icvGrabFrame_FFMPEG_p(ffmpegCapture)!=0 : false;
     }
-    virtual IplImage* retrieveFrame(int)
+    virtual IplImage* retrieveFrame(int channel)
     {
         unsigned char* data = 0;
         int step=0, width=0, height=0, cn=0;
 
-        if(!ffmpegCapture ||
-           !icvRetrieveFrame_FFMPEG_p(ffmpegCapture,&data,&step,&width,&height,&cn))
+        if(!ffmpegCapture)
+            return 0;
+        if(channel != CV_CAP_FFMPEG_BGR_IMAGE)
+        {
+            // the decoded planes are wrapped as they are, without conversion
+            if(!icvRetrieveFrameChannel_FFMPEG_p ||
+               !icvRetrieveFrameChannel_FFMPEG_p(ffmpegCapture,channel,&data,&step,&width,&height,&cn))
+                return 0;
+        }
+        else if(!icvRetrieveFrame_FFMPEG_p(ffmpegCapture,&data,&step,&width,&height,&cn))
            return 0;
         cvInitImageHeader(&frame, cvSize(width, height), 8, cn);
         cvSetData(&frame, data, step);
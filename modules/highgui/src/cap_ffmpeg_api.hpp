@@ -21,7 +21,16 @@ enum
     CV_FFMPEG_CAP_PROP_FRAME_HEIGHT=4,
     CV_FFMPEG_CAP_PROP_FPS=5,
     CV_FFMPEG_CAP_PROP_FOURCC=6,
-    CV_FFMPEG_CAP_PROP_FRAME_COUNT=7
+    CV_FFMPEG_CAP_PROP_FRAME_COUNT=7,
+    CV_FFMPEG_CAP_PROP_PREFETCH=500
+};
+
+enum
+{
+    CV_FFMPEG_CAP_BGR_IMAGE=0,
+    CV_FFMPEG_CAP_PLANE_Y=1,
+    CV_FFMPEG_CAP_PLANE_U=2,
+    CV_FFMPEG_CAP_PLANE_V=3
 };
 
 
@@ -39,6 +48,8 @@ OPENCV_FFMPEG_API int cvRetrieveFrame_FFMPEG(struct CvCapture_FFMPEG* capture, u
                                              int* step, int* width, int* height, int* cn);
 OPENCV_FFMPEG_API int cvRetrieveFrame_FFMPEG_2(struct CvCapture_FFMPEG_2* capture, unsigned char** data,
                                              int* step, int* width, int* height, int* cn);
+OPENCV_FFMPEG_API int cvRetrieveFrameChannel_FFMPEG(struct CvCapture_FFMPEG* capture, int channel,
+                                                    unsigned char** data, int* step, int* width, int* height, int* cn);
 OPENCV_FFMPEG_API void cvReleaseCapture_FFMPEG(struct CvCapture_FFMPEG** cap);
 OPENCV_FFMPEG_API void cvReleaseCapture_FFMPEG_2(struct CvCapture_FFMPEG_2** cap);
 OPENCV_FFMPEG_API struct CvVideoWriter_FFMPEG* cvCreateVideoWriter_FFMPEG(const char* filename,
@@ -56,6 +67,8 @@ typedef void* (*CvCreateCameraCapture_Plugin)( int index );
 typedef int (*CvGrabFrame_Plugin)( void* capture_handle );
 typedef int (*CvRetrieveFrame_Plugin)( void* capture_handle, unsigned char** data, int* step,
                                        int* width, int* height, int* cn );
+typedef int (*CvRetrieveFrameChannel_Plugin)( void* capture_handle, int channel, unsigned char** data,
+                                              int* step, int* width, int* height, int* cn );
 typedef int (*CvSetCaptureProperty_Plugin)( void* capture_handle, int prop_id, double value );
 typedef double (*CvGetCaptureProperty_Plugin)( void* capture_handle, int prop_id );
 typedef void (*CvReleaseCapture_Plugin)( void** capture_handle );
@@ -130,6 +130,10 @@ extern "C" {
     #include <sys/sysctl.h>
 #endif
 
+#if !defined WIN32 && !defined _WIN32
+    #include <pthread.h>
+#endif
+
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
@@ -200,6 +204,9 @@ inline void _opencv_ffmpeg_free(void** ptr)
 }
 
 
+struct FramePrefetcher_FFMPEG;
+
+
 struct CvCapture_FFMPEG
 {
     bool open( const char* filename );
@@ -209,9 +216,15 @@ struct CvCapture_FFMPEG
     bool setProperty(int, double);
     bool grabFrame();
     bool retrieveFrame(int, unsigned char** data, int* step, int* width, int* height, int* cn);
+    bool retrievePlane(int plane, unsigned char** data, int* step, int* width, int* height, int* cn);
 
     void init();
 
+    bool    grabFrameInternal();
+    bool    convertFrame(unsigned char* data, int step);
+    void    startPrefetch(int depth);
+    void    stopPrefetch();
+
     void    seek(int64_t frame_number);
     void    seek(double sec);
     bool    slowSeek( int framenumber );
@@ -240,6 +253,9 @@ struct CvCapture_FFMPEG
     int64_t frame_number, first_frame_number;
 
     double eps_zero;
+
+    // background read-ahead queue, enabled with CV_FFMPEG_CAP_PROP_PREFETCH
+    FramePrefetcher_FFMPEG* prefetcher;
 /*
    'filename' contains the filename of the videosource,
    'filename==NULL' indicates that ffmpeg's seek support works
@@ -268,11 +284,15 @@ void CvCapture_FFMPEG::init()
     avcodec = 0;
     frame_number = 0;
     eps_zero = 0.000025;
+    prefetcher = 0;
 }
 
 
 void CvCapture_FFMPEG::close()
 {
+    // the worker thread uses the decoder and the conversion context, so stop it first
+    stopPrefetch();
+
     if( img_convert_ctx )
     {
         sws_freeContext(img_convert_ctx);
@@ -437,6 +457,265 @@ void ImplMutex::lock() { impl->lock(); }
 void ImplMutex::unlock() { impl->unlock(); }
 bool ImplMutex::trylock() { return impl->trylock(); }
 
+/* Counting semaphore and thread wrappers used by the frame prefetcher.
+   Like ImplMutex, they only rely on Win32 or pthreads, so that this file
+   can still be compiled standalone into the opencv_ffmpeg plugin. */
+class ImplSemaphore
+{
+public:
+    explicit ImplSemaphore(int count = 0);
+    ~ImplSemaphore();
+
+    void wait();
+    void post();
+
+private:
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    HANDLE sem;
+#else
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int count;
+#endif
+
+    ImplSemaphore(const ImplSemaphore&);
+    ImplSemaphore& operator = (const ImplSemaphore&);
+};
+
+class ImplThread
+{
+public:
+    typedef void (*Func)(void* arg);
+
+    ImplThread() : func(0), arg(0), started(false) {}
+    ~ImplThread() { join(); }
+
+    bool start(Func _func, void* _arg);
+    void join();
+
+private:
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    static DWORD WINAPI run(LPVOID self) { ((ImplThread*)self)->func(((ImplThread*)self)->arg); return 0; }
+    HANDLE handle;
+#else
+    static void* run(void* self) { ((ImplThread*)self)->func(((ImplThread*)self)->arg); return 0; }
+    pthread_t handle;
+#endif
+    Func func;
+    void* arg;
+    bool started;
+
+    ImplThread(const ImplThread&);
+    ImplThread& operator = (const ImplThread&);
+};
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+
+ImplSemaphore::ImplSemaphore(int _count) { sem = CreateSemaphore(NULL, _count, 0x7fffffff, NULL); }
+ImplSemaphore::~ImplSemaphore() { CloseHandle(sem); }
+void ImplSemaphore::wait() { WaitForSingleObject(sem, INFINITE); }
+void ImplSemaphore::post() { ReleaseSemaphore(sem, 1, NULL); }
+
+bool ImplThread::start(Func _func, void* _arg)
+{
+    func = _func; arg = _arg;
+    handle = CreateThread(NULL, 0, run, this, 0, NULL);
+    started = handle != NULL;
+    return started;
+}
+
+void ImplThread::join()
+{
+    if( !started )
+        return;
+    WaitForSingleObject(handle, INFINITE);
+    CloseHandle(handle);
+    started = false;
+}
+
+#else
+
+ImplSemaphore::ImplSemaphore(int _count)
+{
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&cond, 0);
+    count = _count;
+}
+
+ImplSemaphore::~ImplSemaphore()
+{
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+}
+
+void ImplSemaphore::wait()
+{
+    pthread_mutex_lock(&mutex);
+    while( count == 0 )
+        pthread_cond_wait(&cond, &mutex);
+    count--;
+    pthread_mutex_unlock(&mutex);
+}
+
+void ImplSemaphore::post()
+{
+    pthread_mutex_lock(&mutex);
+    count++;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+bool ImplThread::start(Func _func, void* _arg)
+{
+    func = _func; arg = _arg;
+    started = pthread_create(&handle, 0, run, this) == 0;
+    return started;
+}
+
+void ImplThread::join()
+{
+    if( !started )
+        return;
+    pthread_join(handle, 0);
+    started = false;
+}
+
+#endif
+
+/*
+   Bounded read-ahead queue for CvCapture_FFMPEG.
+
+   A worker thread runs the ordinary demux -> decode -> sws_scale sequence
+   and stores the BGR result in one of depth+1 ring slots; the caller's
+   grabFrame() only pops the next filled slot and retrieveFrame() returns it
+   without further work. The slot being read by the caller stays valid until
+   the next grabFrame(), so the worker can be at most 'depth' frames ahead.
+   While the prefetcher is active, the decoder state and the conversion
+   context belong to the worker thread; the capture stops it before seeking
+   or closing.
+*/
+struct FramePrefetcher_FFMPEG
+{
+    struct Slot
+    {
+        unsigned char* data;
+        int step, width, height;
+        int64_t frame_number;
+        int64_t pts;
+        bool eof;
+    };
+
+    FramePrefetcher_FFMPEG(CvCapture_FFMPEG* _cap, int _depth);
+    ~FramePrefetcher_FFMPEG();
+
+    bool grab();
+    bool produce(Slot& slot);
+    static void run(void* self);
+
+    CvCapture_FFMPEG* cap;
+    int depth, nslots;
+    Slot* slots;
+    int rpos, wpos;
+    Slot* cur;
+    // position of the next frame as seen by the caller
+    int64_t frame_number;
+    bool finished;
+    volatile bool stop;
+
+    ImplSemaphore free_slots, filled_slots;
+    ImplThread thread;
+};
+
+FramePrefetcher_FFMPEG::FramePrefetcher_FFMPEG(CvCapture_FFMPEG* _cap, int _depth)
+    : cap(_cap), depth(_depth), nslots(_depth + 1), rpos(0), wpos(0), cur(0),
+      frame_number(_cap->frame_number), finished(false), stop(false),
+      free_slots(_depth + 1), filled_slots(0)
+{
+    slots = new Slot[nslots];
+    memset(slots, 0, nslots*sizeof(slots[0]));
+    if( !thread.start(run, this) )
+        finished = true;
+}
+
+FramePrefetcher_FFMPEG::~FramePrefetcher_FFMPEG()
+{
+    stop = true;
+    free_slots.post();
+    thread.join();
+
+    for( int i = 0; i < nslots; i++ )
+        free(slots[i].data);
+    delete[] slots;
+}
+
+bool FramePrefetcher_FFMPEG::produce(Slot& slot)
+{
+    if( !cap->grabFrameInternal() )
+        return false;
+
+    int width = cap->video_st->codec->width, height = cap->video_st->codec->height;
+    if( slot.width != width || slot.height != height )
+    {
+        free(slot.data);
+        slot.step = (width*3 + 15) & -16;
+        slot.data = (unsigned char*)malloc((size_t)slot.step*height);
+        slot.width = width;
+        slot.height = height;
+    }
+
+    slot.frame_number = cap->frame_number;
+    slot.pts = cap->picture_pts;
+    return slot.data != 0 && cap->convertFrame(slot.data, slot.step);
+}
+
+void FramePrefetcher_FFMPEG::run(void* self)
+{
+    FramePrefetcher_FFMPEG* p = (FramePrefetcher_FFMPEG*)self;
+
+    for(;;)
+    {
+        p->free_slots.wait();
+        if( p->stop )
+            break;
+
+        Slot& slot = p->slots[p->wpos];
+        slot.eof = !p->produce(slot);
+        p->wpos = (p->wpos + 1) % p->nslots;
+        p->filled_slots.post();
+
+        if( slot.eof )
+            break;
+    }
+}
+
+bool FramePrefetcher_FFMPEG::grab()
+{
+    if( finished )
+        return false;
+
+    // the previously returned frame is not referenced anymore; hand it back to the worker
+    if( cur )
+    {
+        cur = 0;
+        free_slots.post();
+    }
+
+    filled_slots.wait();
+    Slot* slot = &slots[rpos];
+    rpos = (rpos + 1) % nslots;
+
+    if( slot->eof )
+    {
+        finished = true;
+        return false;
+    }
+
+    cur = slot;
+    frame_number = slot->frame_number;
+    return true;
+}
+
+
 static int LockCallBack(void **mutex, AVLockOp op)
 {
     switch (op)
@@ -536,18 +815,24 @@ bool CvCapture_FFMPEG::open( const char* _filename )
         AVCodecContext *enc = &ic->streams[i]->codec;
 #endif
 
-#ifdef FF_API_THREAD_INIT
-        avcodec_thread_init(enc, get_number_of_cpus());
-#else
-        enc->thread_count = get_number_of_cpus();
-#endif
-
 #if LIBAVFORMAT_BUILD < CALC_FFMPEG_VERSION(53, 2, 0)
 #define AVMEDIA_TYPE_VIDEO CODEC_TYPE_VIDEO
 #endif
 
         if( AVMEDIA_TYPE_VIDEO == enc->codec_type && video_stream < 0)
         {
+            // the threading parameters must be set before the decoder is opened;
+            // frame threading gives the largest gain on H.264, slice threading
+            // is used by the codecs that do not support it
+#ifdef FF_API_THREAD_INIT
+            avcodec_thread_init(enc, get_number_of_cpus());
+#else
+            enc->thread_count = get_number_of_cpus();
+#endif
+#if defined FF_THREAD_FRAME && defined FF_THREAD_SLICE
+            enc->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
+
             AVCodec *codec = avcodec_find_decoder(enc->codec_id);
             if (!codec ||
 #if LIBAVCODEC_VERSION_INT >= ((53<<16)+(8<<8)+0)
@@ -589,6 +874,15 @@ exit_func:
 
 
 bool CvCapture_FFMPEG::grabFrame()
+{
+    if( prefetcher )
+        return prefetcher->grab();
+
+    return grabFrameInternal();
+}
+
+
+bool CvCapture_FFMPEG::grabFrameInternal()
 {
     bool valid = false;
     int got_picture;
@@ -614,6 +908,19 @@ bool CvCapture_FFMPEG::grabFrame()
 
         /* else if (ret < 0) break; */
 
+        if( ret == (int)AVERROR_EOF )
+        {
+            // decoders with frame threading (and B-frame reordering) keep
+            // a few pictures back; drain them with empty packets
+            memset(&packet, 0, sizeof(packet));
+            av_init_packet(&packet);
+            packet.data = NULL;
+            packet.size = 0;
+            packet.stream_index = video_stream;
+            if( ++count_errs > max_number_of_attempts )
+                break;
+        }
+
         if( packet.stream_index != video_stream )
         {
             av_free_packet (&packet);
@@ -648,7 +955,7 @@ bool CvCapture_FFMPEG::grabFrame()
         else
         {
             count_errs++;
-            if (count_errs > max_number_of_attempts)
+            if (count_errs > max_number_of_attempts || ret == (int)AVERROR_EOF)
                 break;
         }
 
@@ -663,14 +970,110 @@ bool CvCapture_FFMPEG::grabFrame()
 }
 
 
-bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int* width, int* height, int* cn)
+bool CvCapture_FFMPEG::retrieveFrame(int channel, unsigned char** data, int* step, int* width, int* height, int* cn)
 {
+    if( channel >= CV_FFMPEG_CAP_PLANE_Y )
+        return retrievePlane(channel - CV_FFMPEG_CAP_PLANE_Y, data, step, width, height, cn);
+    if( channel != CV_FFMPEG_CAP_BGR_IMAGE )
+        return false;
+
+    if( prefetcher )
+    {
+        const FramePrefetcher_FFMPEG::Slot* slot = prefetcher->cur;
+        if( !slot )
+            return false;
+
+        *data = slot->data;
+        *step = slot->step;
+        *width = slot->width;
+        *height = slot->height;
+        *cn = 3;
+        return true;
+    }
+
     if( !video_st || !picture->data[0] )
         return false;
 
     avpicture_fill((AVPicture*)&rgb_picture, rgb_picture.data[0], PIX_FMT_RGB24,
                    video_st->codec->width, video_st->codec->height);
 
+    if( !convertFrame(rgb_picture.data[0], rgb_picture.linesize[0]) )
+        return false;
+
+    *data = frame.data;
+    *step = frame.step;
+    *width = frame.width;
+    *height = frame.height;
+    *cn = frame.cn;
+
+    return true;
+}
+
+
+/*
+   Returns one plane of the decoded picture as it is, without color conversion or copying.
+   The data belongs to the decoder and is valid until the next grabFrame(). The planes are
+   only available for the common 8-bit planar and semi-planar YUV formats, and not while the
+   prefetcher is running, since the worker thread keeps decoding into the same picture.
+*/
+bool CvCapture_FFMPEG::retrievePlane(int plane, unsigned char** data, int* step, int* width, int* height, int* cn)
+{
+    if( prefetcher || !video_st || !picture || !picture->data[0] )
+        return false;
+
+    int shift_x = 0, shift_y = 0, nplanes = 3, chroma_cn = 1;
+
+    switch( video_st->codec->pix_fmt )
+    {
+    case PIX_FMT_YUV420P:
+    case PIX_FMT_YUVJ420P:
+        shift_x = shift_y = 1;
+        break;
+    case PIX_FMT_YUV422P:
+    case PIX_FMT_YUVJ422P:
+        shift_x = 1;
+        break;
+    case PIX_FMT_YUV444P:
+    case PIX_FMT_YUVJ444P:
+        break;
+    case PIX_FMT_NV12:
+    case PIX_FMT_NV21:
+        shift_x = shift_y = 1;
+        nplanes = 2;
+        chroma_cn = 2;
+        break;
+    case PIX_FMT_GRAY8:
+        nplanes = 1;
+        break;
+    default:
+        return false;
+    }
+
+    if( plane < 0 || plane >= nplanes || !picture->data[plane] )
+        return false;
+
+    *data = picture->data[plane];
+    *step = picture->linesize[plane];
+    *width = video_st->codec->width;
+    *height = video_st->codec->height;
+    *cn = 1;
+
+    if( plane > 0 )
+    {
+        *width = (*width + (1 << shift_x) - 1) >> shift_x;
+        *height = (*height + (1 << shift_y) - 1) >> shift_y;
+        *cn = chroma_cn;
+    }
+
+    return true;
+}
+
+
+bool CvCapture_FFMPEG::convertFrame(unsigned char* data, int step)
+{
+    if( !video_st || !picture->data[0] )
+        return false;
+
     if( img_convert_ctx == NULL ||
         frame.width != video_st->codec->width ||
         frame.height != video_st->codec->height )
@@ -695,35 +1098,54 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
             return false;//CV_Error(0, "Cannot initialize the conversion context!");
     }
 
+    uint8_t* dst_data[4] = { data, 0, 0, 0 };
+    int dst_linesize[4] = { step, 0, 0, 0 };
+
     sws_scale(
             img_convert_ctx,
             picture->data,
             picture->linesize,
             0, video_st->codec->height,
-            rgb_picture.data,
-            rgb_picture.linesize
+            dst_data,
+            dst_linesize
             );
 
-    *data = frame.data;
-    *step = frame.step;
-    *width = frame.width;
-    *height = frame.height;
-    *cn = frame.cn;
-
     return true;
 }
 
 
+void CvCapture_FFMPEG::startPrefetch(int depth)
+{
+    stopPrefetch();
+    if( depth > 0 && video_st )
+    {
+        prefetcher = new FramePrefetcher_FFMPEG(this, depth);
+        // could not start the worker thread; keep decoding synchronously
+        if( prefetcher->finished )
+            stopPrefetch();
+    }
+}
+
+
+void CvCapture_FFMPEG::stopPrefetch()
+{
+    delete prefetcher;
+    prefetcher = 0;
+}
+
+
 double CvCapture_FFMPEG::getProperty( int property_id )
 {
     if( !video_st ) return 0;
 
+    int64_t pos = prefetcher ? prefetcher->frame_number : frame_number;
+
     switch( property_id )
     {
     case CV_FFMPEG_CAP_PROP_POS_MSEC:
-        return 1000.0*(double)frame_number/get_fps();
+        return 1000.0*(double)pos/get_fps();
     case CV_FFMPEG_CAP_PROP_POS_FRAMES:
-        return (double)frame_number;
+        return (double)pos;
     case CV_FFMPEG_CAP_PROP_POS_AVI_RATIO:
         return r2d(ic->streams[video_stream]->time_base);
     case CV_FFMPEG_CAP_PROP_FRAME_COUNT:
@@ -745,6 +1167,8 @@ double CvCapture_FFMPEG::getProperty( int property_id )
 #else
         return (double)video_st->codec.codec_tag;
 #endif
+    case CV_FFMPEG_CAP_PROP_PREFETCH:
+        return prefetcher ? (double)prefetcher->depth : 0.;
     default:
         break;
     }
@@ -894,6 +1318,9 @@ bool CvCapture_FFMPEG::setProperty( int property_id, double value )
     case CV_FFMPEG_CAP_PROP_POS_FRAMES:
     case CV_FFMPEG_CAP_PROP_POS_AVI_RATIO:
         {
+            int depth = prefetcher ? prefetcher->depth : 0;
+            stopPrefetch();
+
             switch( property_id )
             {
             case CV_FFMPEG_CAP_PROP_POS_FRAMES:
@@ -910,6 +1337,23 @@ bool CvCapture_FFMPEG::setProperty( int property_id, double value )
             }
 
             picture_pts=(int64_t)value;
+            startPrefetch(depth);
+        }
+        break;
+    case CV_FFMPEG_CAP_PROP_PREFETCH:
+        {
+            const int max_prefetch_depth = 64;
+            int depth = std::min(std::max((int)(value + 0.5), 0), max_prefetch_depth);
+            if( prefetcher && prefetcher->depth == depth )
+                break;
+
+            // the worker may have decoded frames that the caller has not seen yet;
+            // rewind the decoder to the caller's position
+            int64_t pos = prefetcher ? prefetcher->frame_number : frame_number;
+            stopPrefetch();
+            if( pos != frame_number )
+                seek(pos);
+            startPrefetch(depth);
         }
         break;
     default:
@@ -1699,6 +2143,11 @@ int cvRetrieveFrame_FFMPEG(CvCapture_FFMPEG* capture, unsigned char** data, int*
     return capture->retrieveFrame(0, data, step, width, height, cn);
 }
 
+int cvRetrieveFrameChannel_FFMPEG(CvCapture_FFMPEG* capture, int channel, unsigned char** data, int* step, int* width, int* height, int* cn)
+{
+    return capture->retrieveFrame(channel, data, step, width, height, cn);
+}
+
 CvVideoWriter_FFMPEG* cvCreateVideoWriter_FFMPEG( const char* filename, int fourcc, double fps,
                                                   int width, int height, int isColor )
 {
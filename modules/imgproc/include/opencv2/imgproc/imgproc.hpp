@@ -250,6 +250,8 @@ public:
     virtual int proceed(const uchar* src, int srcStep, int srcCount,
                         uchar* dst, int dstStep);
     //! applies filter to the specified ROI of the image. if srcRoi=(0,0,-1,-1), the whole image is filtered.
+    //! When the column (or 2D) filter is one of OpenCV's own filters and src and dst do not overlap,
+    //! horizontal stripes of the image are processed in parallel, each by its own copy of the engine.
     virtual void apply( const Mat& src, Mat& dst,
                         const Rect& srcRoi=Rect(0,0,-1,-1),
                         Point dstOfs=Point(0,0),
@@ -382,6 +384,86 @@ CV_EXPORTS_W Mat getStructuringElement(int shape, Size ksize, Point anchor=Point
 
 template<> CV_EXPORTS void Ptr<IplConvKernel>::delete_obj();
 
+/*!
+ The Base Class for Point-wise Row Operations
+
+ The operations transform rows of one or two (e.g. the horizontal and the vertical derivatives)
+ input images into the rows of the output image, pixel by pixel. They are used as stages
+ of cv::FilterPipeline, e.g. to convert colors of the source image or to combine outputs of two filters.
+*/
+class CV_EXPORTS BaseRowOp
+{
+public:
+    //! the default constructor
+    BaseRowOp();
+    //! the destructor
+    virtual ~BaseRowOp();
+    //! processes a single row of width pixels. src[i] points to the row of the i-th input, i < nsrc.
+    virtual void operator()(const uchar** src, uchar* dst, int width) = 0;
+    int srcType, dstType;
+    int nsrc;
+};
+
+//! returns the row operation that converts colors as cv::cvtColor does. Bayer and YUV 4:2:0 conversions are not supported.
+CV_EXPORTS Ptr<BaseRowOp> getColorConversionRowOp(int srcType, int code, int dcn=0);
+//! returns the binary row operation that computes the CV_32F magnitude of the two derivatives (CV_16S or CV_32F)
+CV_EXPORTS Ptr<BaseRowOp> getMagnitudeRowOp(int srcType, bool L2gradient=true);
+//! returns the row operation that scales and converts the rows as Mat::convertTo does
+CV_EXPORTS Ptr<BaseRowOp> getConvertRowOp(int srcType, int dstType, double alpha=1, double beta=0);
+
+/*!
+ The Pipeline of Row-wise Processing Stages
+
+ The class applies a chain of filters and point-wise operations to an image without
+ storing the intermediate images. The source image is pushed through the stages by strips
+ of a few rows, so the intermediate rows stay in cache, and only the last stage writes
+ to the destination image. Here is how the gradient magnitude of the smoothed image is computed:
+
+ \code
+ FilterPipeline p;
+ p.addFilter(createGaussianFilter(CV_8UC1, Size(5,5), 1.5));
+ p.addFilterPair(createDerivFilter(CV_8UC1, CV_16SC1, 1, 0, 3),
+                 createDerivFilter(CV_8UC1, CV_16SC1, 0, 1, 3),
+                 getMagnitudeRowOp(CV_16SC1));
+ p.apply(src, mag);
+ \endcode
+
+ The filters must not change the image size. The source image is processed as a whole,
+ i.e. the pixels outside of it are extrapolated as specified by the border modes of the filters.
+*/
+class CV_EXPORTS FilterPipeline
+{
+public:
+    //! the default constructor
+    FilterPipeline();
+    //! the destructor
+    virtual ~FilterPipeline();
+    //! appends the filter that processes the output of the previous stage
+    void addFilter(const Ptr<FilterEngine>& f);
+    //! appends two filters processing the same input and the binary operation combining their outputs
+    void addFilterPair(const Ptr<FilterEngine>& f1, const Ptr<FilterEngine>& f2, const Ptr<BaseRowOp>& op);
+    //! appends the point-wise row operation
+    void addRowOp(const Ptr<BaseRowOp>& op);
+    //! removes all the stages
+    void clear();
+    //! returns true if there are no stages
+    bool empty() const;
+    //! returns the type of the source image
+    int srcType() const;
+    //! returns the type of the destination image
+    int dstType() const;
+    //! processes the image. stripRows is the number of the source rows pushed through the stages at once
+    virtual void apply(InputArray src, OutputArray dst, int stripRows=0);
+
+    struct CV_EXPORTS Stage
+    {
+        Ptr<FilterEngine> filter[2];
+        Ptr<BaseRowOp> op;
+        int srcType, dstType;
+    };
+    vector<Stage> stages;
+};
+
 //! copies 2D array to a larger destination array with extrapolation of the outer part of src using the specified border mode
 CV_EXPORTS_W void copyMakeBorder( InputArray src, OutputArray dst,
                                 int top, int bottom, int left, int right,
@@ -821,6 +903,26 @@ CV_EXPORTS_W int floodFill( InputOutputArray image, InputOutputArray mask,
                             Scalar loDiff=Scalar(), Scalar upDiff=Scalar(),
                             int flags=4 );
 
+//! columns of the statistics matrix computed by connectedComponentsWithStats
+enum
+{
+    CC_STAT_LEFT   = 0, //!< the leftmost (x) coordinate of the bounding box
+    CC_STAT_TOP    = 1, //!< the topmost (y) coordinate of the bounding box
+    CC_STAT_WIDTH  = 2, //!< the width of the bounding box
+    CC_STAT_HEIGHT = 3, //!< the height of the bounding box
+    CC_STAT_AREA   = 4, //!< the number of pixels of the component
+    CC_STAT_MAX    = 5
+};
+
+//! labels the connected components of the binary image; returns the number of labels including the background label 0
+CV_EXPORTS_W int connectedComponents( InputArray image, OutputArray labels,
+                                      int connectivity=8, int ltype=CV_32S );
+
+//! labels the connected components and computes their bounding boxes, areas and centroids
+CV_EXPORTS_W int connectedComponentsWithStats( InputArray image, OutputArray labels,
+                                               OutputArray stats, OutputArray centroids,
+                                               int connectivity=8, int ltype=CV_32S );
+
 
 enum
 {
@@ -1091,6 +1193,39 @@ enum { TM_SQDIFF=0, TM_SQDIFF_NORMED=1, TM_CCORR=2, TM_CCORR_NORMED=3, TM_CCOEFF
 CV_EXPORTS_W void matchTemplate( InputArray image, InputArray templ,
                                  OutputArray result, int method );
 
+/*!
+ Matches a set of templates of the same type against images.
+
+ The correlation is computed via DFT by blocks that are processed in parallel. The spectra of
+ the templates are computed once and reused by the subsequent match() calls as long as
+ the block layout does not change, and the DFT of each image block is computed once for all
+ the templates. The results are the same as the ones of matchTemplate() up to rounding errors.
+*/
+class CV_EXPORTS TemplateMatcher
+{
+public:
+    //! the default constructor
+    TemplateMatcher();
+    //! the full constructor that calls setTemplates()
+    TemplateMatcher(InputArrayOfArrays templs, int method);
+    //! the destructor
+    virtual ~TemplateMatcher();
+    //! sets the templates (copied) and the comparison method, TM_*
+    void setTemplates(InputArrayOfArrays templs, int method);
+    //! returns the comparison method
+    int getMethod() const;
+    //! returns the templates
+    const vector<Mat>& getTemplates() const;
+    //! computes the proximity map of the image for each template; the templates must not be larger than the image
+    virtual void match(InputArray image, OutputArrayOfArrays results);
+
+protected:
+    int method;
+    vector<Mat> templs;
+    vector<Mat> spectra;
+    Size dftsize;
+};
+
 //! mode of the contour retrieval algorithm
 enum
 {
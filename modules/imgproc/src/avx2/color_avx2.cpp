@@ -0,0 +1,106 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "color_avx2.hpp"
+
+namespace cv
+{
+namespace avx2
+{
+
+// 8 pixels, one per 32-bit element, from 8 BGRx (4-channel) pixels
+static inline __m256i rgb2gray8( __m256i v, __m256i c, __m256i delta, int shift )
+{
+    __m256i z = _mm256_setzero_si256();
+    __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(v, z), c);
+    __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(v, z), c);
+    return _mm256_srai_epi32(_mm256_add_epi32(_mm256_hadd_epi32(lo, hi), delta), shift);
+}
+
+int RGB2Gray_8u( const uchar* src, uchar* dst, int n, int scn, const int* coeffs, int shift )
+{
+    int i = 0;
+    __m256i c = _mm256_setr_epi16((short)coeffs[0], (short)coeffs[1], (short)coeffs[2], 0,
+                                  (short)coeffs[0], (short)coeffs[1], (short)coeffs[2], 0,
+                                  (short)coeffs[0], (short)coeffs[1], (short)coeffs[2], 0,
+                                  (short)coeffs[0], (short)coeffs[1], (short)coeffs[2], 0);
+    __m256i delta = _mm256_set1_epi32(1 << (shift - 1));
+    // restores the pixel order after the in-lane packing
+    __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    if( scn == 3 )
+    {
+        // BGR -> BGR0 within each 128-bit lane, 4 pixels per lane
+        __m256i expand = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                          0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        // each load reads 4 bytes past the 4 pixels it uses
+        for( ; i <= n - 18; i += 16, src += 48 )
+        {
+            __m256i v0 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)src)),
+                                                 _mm_loadu_si128((const __m128i*)(src + 12)), 1);
+            __m256i v1 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + 24))),
+                                                 _mm_loadu_si128((const __m128i*)(src + 36)), 1);
+            __m256i s0 = rgb2gray8(_mm256_shuffle_epi8(v0, expand), c, delta, shift);
+            __m256i s1 = rgb2gray8(_mm256_shuffle_epi8(v1, expand), c, delta, shift);
+            __m256i r = _mm256_packs_epi32(s0, s1);
+            r = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(r, r), perm);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm256_castsi256_si128(r));
+        }
+    }
+    else if( scn == 4 )
+    {
+        for( ; i <= n - 16; i += 16, src += 64 )
+        {
+            __m256i s0 = rgb2gray8(_mm256_loadu_si256((const __m256i*)src), c, delta, shift);
+            __m256i s1 = rgb2gray8(_mm256_loadu_si256((const __m256i*)(src + 32)), c, delta, shift);
+            __m256i r = _mm256_packs_epi32(s0, s1);
+            r = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(r, r), perm);
+            _mm_storeu_si128((__m128i*)(dst + i), _mm256_castsi256_si128(r));
+        }
+    }
+
+    return i;
+}
+
+}
+}
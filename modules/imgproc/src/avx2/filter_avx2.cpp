@@ -0,0 +1,143 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "filter_avx2.hpp"
+
+namespace cv
+{
+namespace avx2
+{
+
+int RowVec_8u32s( const uchar* _src, int* dst, int width, int cn, const int* kx, int ksize )
+{
+    int i = 0, k;
+
+    for( ; i <= width - 16; i += 16 )
+    {
+        const uchar* src = _src + i;
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0;
+
+        for( k = 0; k < ksize; k++, src += cn )
+        {
+            __m256i f = _mm256_set1_epi16((short)kx[k]);
+            __m256i x0 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)src));
+            __m256i x1 = _mm256_mulhi_epi16(x0, f);
+            x0 = _mm256_mullo_epi16(x0, f);
+
+            // s0 = [0..3 | 8..11], s1 = [4..7 | 12..15]
+            s0 = _mm256_add_epi32(s0, _mm256_unpacklo_epi16(x0, x1));
+            s1 = _mm256_add_epi32(s1, _mm256_unpackhi_epi16(x0, x1));
+        }
+
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute2x128_si256(s0, s1, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), _mm256_permute2x128_si256(s0, s1, 0x31));
+    }
+
+    return i;
+}
+
+// converts 16 sums to 8u; packs_epi32 works within 128-bit lanes, so the order is restored before packus
+static inline void storeSums( uchar* dst, __m256 s0, __m256 s1 )
+{
+    __m256i x = _mm256_packs_epi32(_mm256_cvtps_epi32(s0), _mm256_cvtps_epi32(s1));
+    x = _mm256_permute4x64_epi64(x, 0xD8);
+    _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(_mm256_castsi256_si128(x),
+                                                     _mm256_extracti128_si256(x, 1)));
+}
+
+int SymmColumnVec_32s8u( const int** src, uchar* dst, int width, const float* ky,
+                         int ksize2, float delta, bool symmetrical )
+{
+    int i = 0, k;
+    const __m256i *S, *S2;
+    __m256 d8 = _mm256_set1_ps(delta);
+
+    if( symmetrical )
+    {
+        for( ; i <= width - 16; i += 16 )
+        {
+            __m256 f = _mm256_set1_ps(ky[0]);
+            S = (const __m256i*)(src[0] + i);
+            __m256 s0 = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(S)), f), d8);
+            __m256 s1 = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256(S+1)), f), d8);
+
+            for( k = 1; k <= ksize2; k++ )
+            {
+                S = (const __m256i*)(src[k] + i);
+                S2 = (const __m256i*)(src[-k] + i);
+                f = _mm256_set1_ps(ky[k]);
+                __m256i x0 = _mm256_add_epi32(_mm256_loadu_si256(S), _mm256_loadu_si256(S2));
+                __m256i x1 = _mm256_add_epi32(_mm256_loadu_si256(S+1), _mm256_loadu_si256(S2+1));
+                s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_cvtepi32_ps(x0), f));
+                s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_cvtepi32_ps(x1), f));
+            }
+
+            storeSums(dst + i, s0, s1);
+        }
+    }
+    else
+    {
+        for( ; i <= width - 16; i += 16 )
+        {
+            __m256 s0 = d8, s1 = d8;
+
+            for( k = 1; k <= ksize2; k++ )
+            {
+                S = (const __m256i*)(src[k] + i);
+                S2 = (const __m256i*)(src[-k] + i);
+                __m256 f = _mm256_set1_ps(ky[k]);
+                __m256i x0 = _mm256_sub_epi32(_mm256_loadu_si256(S), _mm256_loadu_si256(S2));
+                __m256i x1 = _mm256_sub_epi32(_mm256_loadu_si256(S+1), _mm256_loadu_si256(S2+1));
+                s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_cvtepi32_ps(x0), f));
+                s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_cvtepi32_ps(x1), f));
+            }
+
+            storeSums(dst + i, s0, s1);
+        }
+    }
+
+    return i;
+}
+
+}
+}
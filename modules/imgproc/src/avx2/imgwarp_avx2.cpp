@@ -0,0 +1,82 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "imgwarp_avx2.hpp"
+
+namespace cv
+{
+namespace avx2
+{
+
+// 16 elements scaled down to 16 bits, in the [0..3, 8..11 | 4..7, 12..15] order of packs_epi32
+static inline __m256i load16( const int* S )
+{
+    return _mm256_packs_epi32(_mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)S), 4),
+                              _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(S + 8)), 4));
+}
+
+int VResizeLinearVec_32s8u( const int** src, uchar* dst, const short* beta, int width )
+{
+    const int *S0 = src[0], *S1 = src[1];
+    int x = 0;
+    __m256i b0 = _mm256_set1_epi16(beta[0]), b1 = _mm256_set1_epi16(beta[1]);
+    __m256i delta = _mm256_set1_epi16(2);
+    __m256i perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    for( ; x <= width - 32; x += 32 )
+    {
+        __m256i x0 = _mm256_adds_epi16(_mm256_mulhi_epi16(load16(S0 + x), b0),
+                                       _mm256_mulhi_epi16(load16(S1 + x), b1));
+        __m256i x1 = _mm256_adds_epi16(_mm256_mulhi_epi16(load16(S0 + x + 16), b0),
+                                       _mm256_mulhi_epi16(load16(S1 + x + 16), b1));
+        x0 = _mm256_srai_epi16(_mm256_adds_epi16(x0, delta), 2);
+        x1 = _mm256_srai_epi16(_mm256_adds_epi16(x1, delta), 2);
+        x0 = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(x0, x1), perm);
+        _mm256_storeu_si256((__m256i*)(dst + x), x0);
+    }
+
+    return x;
+}
+
+}
+}
@@ -41,219 +41,399 @@
 
 #include "precomp.hpp"
 
-void cv::Canny( InputArray _src, OutputArray _dst,
-                double low_thresh, double high_thresh,
-                int aperture_size, bool L2gradient )
+namespace cv
 {
-    Mat src = _src.getMat();
-    CV_Assert( src.depth() == CV_8U );
 
-    _dst.create(src.size(), CV_8U);
-    Mat dst = _dst.getMat();
-
-    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
+/* sector numbers
+   (Top-Left Origin)
+
+    1   2   3
+     *  *  *
+      * * *
+    0*******0
+      * * *
+     *  *  *
+    3   2   1
+*/
+
+#define CANNY_PUSH(d)    *(d) = uchar(2), stack.push_back(d)
+#define CANNY_SHIFT 15
+
+// Processes horizontal bands of the image. Every band computes its own Sobel derivatives
+// (plus one row above and below for the non-maxima suppression), fills its rows of the map with
+//   0 - the pixel might belong to an edge
+//   1 - the pixel can not belong to an edge
+//   2 - the pixel does belong to an edge
+// and tracks the edges within the band. The band never touches the map rows of the other bands:
+// the neighbours of its top and bottom rows are collected into a list of seeds instead,
+// the edges are continued from them after all the bands are processed.
+class CannyInvoker : public ParallelLoopBody
+{
+public:
+    CannyInvoker(const Mat& _src, uchar* _map, ptrdiff_t _mapstep, int _low, int _high,
+                 int _aperture_size, bool _L2gradient, int _nbands, vector<vector<uchar*> >& _seeds) :
+        src(_src), map(_map), mapstep(_mapstep), low(_low), high(_high),
+        aperture_size(_aperture_size), L2gradient(_L2gradient), nbands(_nbands), seeds(_seeds)
     {
-        //backward compatibility
-        aperture_size &= ~CV_CANNY_L2_GRADIENT;
-        L2gradient = true;
     }
 
-    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
-        CV_Error(CV_StsBadFlag, "");
-
-#ifdef HAVE_TEGRA_OPTIMIZATION
-    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
-        return;
-#endif
-
-    const int cn = src.channels();
-    cv::Mat dx(src.rows, src.cols, CV_16SC(cn));
-    cv::Mat dy(src.rows, src.cols, CV_16SC(cn));
-
-    cv::Sobel(src, dx, CV_16S, 1, 0, aperture_size, 1, 0, cv::BORDER_REPLICATE);
-    cv::Sobel(src, dy, CV_16S, 0, 1, aperture_size, 1, 0, cv::BORDER_REPLICATE);
-
-    if (low_thresh > high_thresh)
-        std::swap(low_thresh, high_thresh);
-
-    if (L2gradient)
+    void operator()(const Range& range) const
     {
-        low_thresh = std::min(32767.0, low_thresh);
-        high_thresh = std::min(32767.0, high_thresh);
-
-        if (low_thresh > 0) low_thresh *= low_thresh;
-        if (high_thresh > 0) high_thresh *= high_thresh;
+        for( int b = range.start; b < range.end; b++ )
+            processBand(b);
     }
-    int low = cvFloor(low_thresh);
-    int high = cvFloor(high_thresh);
 
-    ptrdiff_t mapstep = src.cols + 2;
-    cv::AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2) + cn * mapstep * 3 * sizeof(int));
+private:
+    void computeMagnitude(short* _dx, short* _dy, int* _norm) const
+    {
+        int j = 0, cn = src.channels(), width = src.cols*cn;
 
-    int* mag_buf[3];
-    mag_buf[0] = (int*)(uchar*)buffer;
-    mag_buf[1] = mag_buf[0] + mapstep*cn;
-    mag_buf[2] = mag_buf[1] + mapstep*cn;
-    memset(mag_buf[0], 0, /* cn* */mapstep*sizeof(int));
+#if CV_SSE2
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+        {
+            __m128i z = _mm_setzero_si128();
+            if( !L2gradient )
+                for( ; j <= width - 8; j += 8 )
+                {
+                    __m128i x = _mm_loadu_si128((const __m128i*)(_dx + j));
+                    __m128i y = _mm_loadu_si128((const __m128i*)(_dy + j));
+                    // |v| as an unsigned 16-bit value, so that |-32768| is computed correctly
+                    __m128i sx = _mm_srai_epi16(x, 15), sy = _mm_srai_epi16(y, 15);
+                    x = _mm_sub_epi16(_mm_xor_si128(x, sx), sx);
+                    y = _mm_sub_epi16(_mm_xor_si128(y, sy), sy);
+                    _mm_storeu_si128((__m128i*)(_norm + j), _mm_add_epi32(_mm_unpacklo_epi16(x, z),
+                                                                          _mm_unpacklo_epi16(y, z)));
+                    _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_add_epi32(_mm_unpackhi_epi16(x, z),
+                                                                              _mm_unpackhi_epi16(y, z)));
+                }
+            else
+                for( ; j <= width - 8; j += 8 )
+                {
+                    __m128i x = _mm_loadu_si128((const __m128i*)(_dx + j));
+                    __m128i y = _mm_loadu_si128((const __m128i*)(_dy + j));
+                    __m128i v0 = _mm_unpacklo_epi16(x, y), v1 = _mm_unpackhi_epi16(x, y);
+                    _mm_storeu_si128((__m128i*)(_norm + j), _mm_madd_epi16(v0, v0));
+                    _mm_storeu_si128((__m128i*)(_norm + j + 4), _mm_madd_epi16(v1, v1));
+                }
+        }
+#endif
 
-    uchar* map = (uchar*)(mag_buf[2] + mapstep*cn);
-    memset(map, 1, mapstep);
-    memset(map + mapstep*(src.rows + 1), 1, mapstep);
+        if( !L2gradient )
+            for( ; j < width; j++ )
+                _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
+        else
+            for( ; j < width; j++ )
+                _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
 
-    int maxsize = std::max(1 << 10, src.cols * src.rows / 10);
-    std::vector<uchar*> stack(maxsize);
-    uchar **stack_top = &stack[0];
-    uchar **stack_bottom = &stack[0];
-
-    /* sector numbers
-       (Top-Left Origin)
-
-        1   2   3
-         *  *  *
-          * * *
-        0*******0
-          * * *
-         *  *  *
-        3   2   1
-    */
-
-    #define CANNY_PUSH(d)    *(d) = uchar(2), *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-    // calculate magnitude and angle of gradient, perform non-maxima supression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for (int i = 0; i <= src.rows; i++)
-    {
-        int* _norm = mag_buf[(i > 0) + 1] + 1;
-        if (i < src.rows)
+        if( cn > 1 )
         {
-            short* _dx = dx.ptr<short>(i);
-            short* _dy = dy.ptr<short>(i);
-
-            if (!L2gradient)
-            {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = std::abs(int(_dx[j])) + std::abs(int(_dy[j]));
-            }
-            else
+            j = 0;
+            for( int jn = 0; j < src.cols; ++j, jn += cn )
             {
-                for (int j = 0; j < src.cols*cn; j++)
-                    _norm[j] = int(_dx[j])*_dx[j] + int(_dy[j])*_dy[j];
+                int maxIdx = jn;
+                for( int k = 1; k < cn; ++k )
+                    if( _norm[jn + k] > _norm[maxIdx] ) maxIdx = jn + k;
+                _norm[j] = _norm[maxIdx];
+                _dx[j] = _dx[maxIdx];
+                _dy[j] = _dy[maxIdx];
             }
+        }
+        _norm[-1] = _norm[src.cols] = 0;
+    }
 
-            if (cn > 1)
-            {
-                for(int j = 0, jn = 0; j < src.cols; ++j, jn += cn)
-                {
-                    int maxIdx = jn;
-                    for(int k = 1; k < cn; ++k)
-                        if(_norm[jn + k] > _norm[maxIdx]) maxIdx = jn + k;
-                    _norm[j] = _norm[maxIdx];
-                    _dx[j] = _dx[maxIdx];
-                    _dy[j] = _dy[maxIdx];
-                }
-            }
-            _norm[-1] = _norm[src.cols] = 0;
+    void processBand(int b) const
+    {
+        int rows = src.rows, cols = src.cols, cn = src.channels();
+        int r0 = (int)((int64)rows*b/nbands), r1 = (int)((int64)rows*(b+1)/nbands);
+        int s0 = std::max(r0 - 1, 0), s1 = std::min(r1 + 1, rows);
+
+        // derivatives of the band rows and of their neighbours, the pixels outside of
+        // the band are taken from the image (or replicated at the image border) as in cv::Sobel
+        Mat dx(s1 - s0, cols, CV_16SC(cn)), dy(s1 - s0, cols, CV_16SC(cn));
+        for( int k = 0; k < 2; k++ )
+        {
+            Mat& d = k == 0 ? dx : dy;
+            Ptr<FilterEngine> f = createDerivFilter(src.type(), d.type(), k == 0, k == 1,
+                                                    aperture_size, BORDER_REPLICATE);
+            int y = f->start(src, Rect(0, s0, cols, s1 - s0));
+            f->proceed(src.ptr(y), (int)src.step, f->endY - f->startY, d.data, (int)d.step);
         }
-        else
-            memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
 
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if (i == 0)
-            continue;
+        AutoBuffer<int> buffer(cn*mapstep*3);
+        int* mag_buf[3];
+        mag_buf[0] = buffer;
+        mag_buf[1] = mag_buf[0] + mapstep*cn;
+        mag_buf[2] = mag_buf[1] + mapstep*cn;
 
-        uchar* _map = map + mapstep*i + 1;
-        _map[-1] = _map[src.cols] = 1;
+        if( r0 > 0 )
+            computeMagnitude(dx.ptr<short>(0), dy.ptr<short>(0), mag_buf[0] + 1);
+        else
+            memset(mag_buf[0], 0, /* cn* */mapstep*sizeof(int));
 
-        int* _mag = mag_buf[1] + 1; // take the central row
-        ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
-        ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
+        vector<uchar*> stack;
+        stack.reserve(std::max(1 << 10, (r1 - r0)*cols/10));
+        const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
 
-        const short* _x = dx.ptr<short>(i-1);
-        const short* _y = dy.ptr<short>(i-1);
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        __m128i v_low = _mm_set1_epi32(low), v_one = _mm_set1_epi8(1);
+#endif
 
-        if ((stack_top - stack_bottom) + src.cols > maxsize)
+        // calculate magnitude and angle of gradient, perform non-maxima supression
+        for( int i = r0; i <= r1; i++ )
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
-        }
+            int* _norm = mag_buf[(i > r0) + 1] + 1;
+            if( i < rows )
+                computeMagnitude(dx.ptr<short>(i - s0), dy.ptr<short>(i - s0), _norm);
+            else
+                memset(_norm-1, 0, /* cn* */mapstep*sizeof(int));
 
-        int prev_flag = 0;
-        for (int j = 0; j < src.cols; j++)
-        {
-            #define CANNY_SHIFT 15
-            const int TG22 = (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5);
+            // at the very beginning we do not have a complete ring
+            // buffer of 3 magnitude rows for non-maxima suppression
+            if( i == r0 )
+                continue;
 
-            int m = _mag[j];
+            uchar* _map = map + mapstep*i + 1;
+            _map[-1] = _map[cols] = 1;
 
-            if (m > low)
-            {
-                int xs = _x[j];
-                int ys = _y[j];
-                int x = std::abs(xs);
-                int y = std::abs(ys) << CANNY_SHIFT;
+            int* _mag = mag_buf[1] + 1; // take the central row
+            ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
+            ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
+
+            const short* _x = dx.ptr<short>(i - 1 - s0);
+            const short* _y = dy.ptr<short>(i - 1 - s0);
 
-                int tg22x = x * TG22;
+            // the row above may belong to the other band
+            bool checkAbove = i - 1 > r0;
 
-                if (y < tg22x)
+            int prev_flag = 0;
+            for( int j = 0; j < cols; j++ )
+            {
+#if CV_SSE2
+                // skip the blocks of pixels below the low threshold
+                if( haveSSE2 && (j & 7) == 0 && j <= cols - 8 )
                 {
-                    if (m > _mag[j-1] && m >= _mag[j+1]) goto __ocv_canny_push;
+                    __m128i v = _mm_or_si128(_mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(_mag + j)), v_low),
+                                             _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(_mag + j + 4)), v_low));
+                    if( !_mm_movemask_epi8(v) )
+                    {
+                        _mm_storel_epi64((__m128i*)(_map + j), v_one);
+                        prev_flag = 0;
+                        j += 7;
+                        continue;
+                    }
                 }
-                else
+#endif
+                int m = _mag[j];
+
+                if( m > low )
                 {
-                    int tg67x = tg22x + (x << (CANNY_SHIFT+1));
-                    if (y > tg67x)
+                    int xs = _x[j];
+                    int ys = _y[j];
+                    int x = std::abs(xs);
+                    int y = std::abs(ys) << CANNY_SHIFT;
+
+                    int tg22x = x * TG22;
+
+                    if( y < tg22x )
                     {
-                        if (m > _mag[j+magstep2] && m >= _mag[j+magstep1]) goto __ocv_canny_push;
+                        if( m > _mag[j-1] && m >= _mag[j+1] ) goto __ocv_canny_push;
                     }
                     else
                     {
-                        int s = (xs ^ ys) < 0 ? -1 : 1;
-                        if (m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s]) goto __ocv_canny_push;
+                        int tg67x = tg22x + (x << (CANNY_SHIFT+1));
+                        if( y > tg67x )
+                        {
+                            if( m > _mag[j+magstep2] && m >= _mag[j+magstep1] ) goto __ocv_canny_push;
+                        }
+                        else
+                        {
+                            int s = (xs ^ ys) < 0 ? -1 : 1;
+                            if( m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s] ) goto __ocv_canny_push;
+                        }
                     }
                 }
-            }
-            prev_flag = 0;
-            _map[j] = uchar(1);
-            continue;
+                prev_flag = 0;
+                _map[j] = uchar(1);
+                continue;
 __ocv_canny_push:
-            if (!prev_flag && m > high && _map[j-mapstep] != 2)
+                if( !prev_flag && m > high && (!checkAbove || _map[j-mapstep] != 2) )
+                {
+                    CANNY_PUSH(_map + j);
+                    prev_flag = 1;
+                }
+                else
+                    _map[j] = 0;
+            }
+
+            // scroll the ring buffer
+            _mag = mag_buf[0];
+            mag_buf[0] = mag_buf[1];
+            mag_buf[1] = mag_buf[2];
+            mag_buf[2] = _mag;
+        }
+
+        // now track the edges (hysteresis thresholding) within the band
+        const uchar* top = map + mapstep*(r0 + 2);
+        const uchar* bottom = map + mapstep*r1;
+        vector<uchar*>& bseeds = seeds[b];
+
+        while( !stack.empty() )
+        {
+            uchar* m = stack.back();
+            stack.pop_back();
+
+            if (!m[-1])         CANNY_PUSH(m - 1);
+            if (!m[1])          CANNY_PUSH(m + 1);
+            if( m < top )
+            {
+                bseeds.push_back(m - mapstep - 1);
+                bseeds.push_back(m - mapstep);
+                bseeds.push_back(m - mapstep + 1);
+            }
+            else
+            {
+                if (!m[-mapstep-1]) CANNY_PUSH(m - mapstep - 1);
+                if (!m[-mapstep])   CANNY_PUSH(m - mapstep);
+                if (!m[-mapstep+1]) CANNY_PUSH(m - mapstep + 1);
+            }
+            if( m >= bottom )
             {
-                CANNY_PUSH(_map + j);
-                prev_flag = 1;
+                bseeds.push_back(m + mapstep - 1);
+                bseeds.push_back(m + mapstep);
+                bseeds.push_back(m + mapstep + 1);
             }
             else
-                _map[j] = 0;
+            {
+                if (!m[mapstep-1])  CANNY_PUSH(m + mapstep - 1);
+                if (!m[mapstep])    CANNY_PUSH(m + mapstep);
+                if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
+            }
         }
+    }
+
+    const Mat& src;
+    uchar* map;
+    ptrdiff_t mapstep;
+    int low, high;
+    int aperture_size;
+    bool L2gradient;
+    int nbands;
+    vector<vector<uchar*> >& seeds;
+
+    CannyInvoker& operator=(const CannyInvoker&);
+};
 
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
+// the final pass, form the final image
+class CannyFinalizeInvoker : public ParallelLoopBody
+{
+public:
+    CannyFinalizeInvoker(const uchar* _map, ptrdiff_t _mapstep, Mat& _dst) :
+        map(_map), mapstep(_mapstep), dst(_dst)
+    {
     }
 
-    // now track the edges (hysteresis thresholding)
-    while (stack_top > stack_bottom)
+    void operator()(const Range& range) const
     {
-        uchar* m;
-        if ((stack_top - stack_bottom) + 8 > maxsize)
+        int cols = dst.cols;
+#if CV_SSE2
+        bool haveSSE2 = checkHardwareSupport(CV_CPU_SSE2);
+        __m128i v_two = _mm_set1_epi8(2);
+#endif
+
+        for( int i = range.start; i < range.end; i++ )
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = maxsize * 3/2;
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
+            const uchar* pmap = map + mapstep*(i + 1) + 1;
+            uchar* pdst = dst.ptr(i);
+            int j = 0;
+#if CV_SSE2
+            if( haveSSE2 )
+                for( ; j <= cols - 16; j += 16 )
+                    _mm_storeu_si128((__m128i*)(pdst + j),
+                        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(pmap + j)), v_two));
+#endif
+            for( ; j < cols; j++ )
+                pdst[j] = (uchar)-(pmap[j] >> 1);
         }
+    }
+
+private:
+    const uchar* map;
+    ptrdiff_t mapstep;
+    Mat& dst;
+
+    CannyFinalizeInvoker& operator=(const CannyFinalizeInvoker&);
+};
+
+}
+
+void cv::Canny( InputArray _src, OutputArray _dst,
+                double low_thresh, double high_thresh,
+                int aperture_size, bool L2gradient )
+{
+    Mat src = _src.getMat();
+    CV_Assert( src.depth() == CV_8U );
 
-        CANNY_POP(m);
+    _dst.create(src.size(), CV_8U);
+    Mat dst = _dst.getMat();
+
+    if (!L2gradient && (aperture_size & CV_CANNY_L2_GRADIENT) == CV_CANNY_L2_GRADIENT)
+    {
+        //backward compatibility
+        aperture_size &= ~CV_CANNY_L2_GRADIENT;
+        L2gradient = true;
+    }
+
+    if ((aperture_size & 1) == 0 || (aperture_size != -1 && (aperture_size < 3 || aperture_size > 7)))
+        CV_Error(CV_StsBadFlag, "");
+
+#ifdef HAVE_TEGRA_OPTIMIZATION
+    if (tegra::canny(src, dst, low_thresh, high_thresh, aperture_size, L2gradient))
+        return;
+#endif
+
+    if (low_thresh > high_thresh)
+        std::swap(low_thresh, high_thresh);
+
+    if (L2gradient)
+    {
+        low_thresh = std::min(32767.0, low_thresh);
+        high_thresh = std::min(32767.0, high_thresh);
+
+        if (low_thresh > 0) low_thresh *= low_thresh;
+        if (high_thresh > 0) high_thresh *= high_thresh;
+    }
+    int low = cvFloor(low_thresh);
+    int high = cvFloor(high_thresh);
+
+    if( src.empty() )
+        return;
+
+    // the map has one extra row and column on each side, those are marked as "not an edge"
+    ptrdiff_t mapstep = src.cols + 2;
+    AutoBuffer<uchar> buffer((src.cols+2)*(src.rows+2));
+    uchar* map = (uchar*)buffer;
+    memset(map, 1, mapstep);
+    memset(map + mapstep*(src.rows + 1), 1, mapstep);
+
+    // the bands should be much thicker than the 3 rows the neighbours share
+    int nbands = getNumThreads() > 1 ? std::max(std::min(src.rows/32, getNumThreads()*2), 1) : 1;
+    vector<vector<uchar*> > seeds(nbands);
+
+    parallel_for_(Range(0, nbands), CannyInvoker(src, map, mapstep, low, high,
+                                                 aperture_size, L2gradient, nbands, seeds));
+
+    // continue the edges that cross the band boundaries
+    vector<uchar*> stack;
+    for( int b = 0; b < nbands; b++ )
+        for( size_t k = 0; k < seeds[b].size(); k++ )
+            if( !*seeds[b][k] )
+                CANNY_PUSH(seeds[b][k]);
+
+    while( !stack.empty() )
+    {
+        uchar* m = stack.back();
+        stack.pop_back();
 
         if (!m[-1])         CANNY_PUSH(m - 1);
         if (!m[1])          CANNY_PUSH(m + 1);
@@ -265,14 +445,7 @@ __ocv_canny_push:
         if (!m[mapstep+1])  CANNY_PUSH(m + mapstep + 1);
     }
 
-    // the final pass, form the final image
-    const uchar* pmap = map + mapstep + 1;
-    uchar* pdst = dst.ptr();
-    for (int i = 0; i < src.rows; i++, pmap += mapstep, pdst += dst.step)
-    {
-        for (int j = 0; j < src.cols; j++)
-            pdst[j] = (uchar)-(pmap[j] >> 1);
-    }
+    parallel_for_(Range(0, src.rows), CannyFinalizeInvoker(map, mapstep, dst), src.total()/(double)(1<<16));
 }
 
 void cvCanny( const CvArr* image, CvArr* edges, double threshold1,
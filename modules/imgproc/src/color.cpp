@@ -92,6 +92,9 @@
 #include "precomp.hpp"
 #include <limits>
 #include <iostream>
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/color_avx2.hpp"
+#endif
 
 namespace cv
 {
@@ -185,8 +188,30 @@ private:
 };
 
 template <typename Cvt>
-void CvtColorLoop(const Mat& src, Mat& dst, const Cvt& cvt)
+struct CvtColorRowOp : public BaseRowOp
 {
+    typedef typename Cvt::channel_type _Tp;
+
+    CvtColorRowOp(const Cvt& _cvt) : cvt(_cvt) {}
+
+    void operator()(const uchar** src, uchar* dst, int width)
+    {
+        cvt((const _Tp*)src[0], (_Tp*)dst, width);
+    }
+
+    Cvt cvt;
+};
+
+// converts the whole image or, when rowOp is given, only keeps the converter
+// in *rowOp to be applied to the rows of a FilterPipeline later
+template <typename Cvt>
+void CvtColorLoop(const Mat& src, Mat& dst, const Cvt& cvt, Ptr<BaseRowOp>* rowOp)
+{
+    if( rowOp )
+    {
+        *rowOp = new CvtColorRowOp<Cvt>(cvt);
+        return;
+    }
     parallel_for_(Range(0, src.rows), CvtColorLoop_Invoker<Cvt>(src, dst, cvt), src.total()/(double)(1<<16) );
 }
 
@@ -441,16 +466,32 @@ template<> struct RGB2Gray<uchar>
             tab[i+256] = g;
             tab[i+512] = r;
         }
+
+        icoeffs[0] = db; icoeffs[1] = dg; icoeffs[2] = dr;
+        haveAVX2 = false;
+#ifdef HAVE_DISPATCH_AVX2
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2) &&
+            std::abs(db) <= SHRT_MAX && std::abs(dg) <= SHRT_MAX && std::abs(dr) <= SHRT_MAX;
+#endif
     }
     void operator()(const uchar* src, uchar* dst, int n) const
     {
-        int scn = srccn;
+        int scn = srccn, i = 0;
         const int* _tab = tab;
-        for(int i = 0; i < n; i++, src += scn)
+#ifdef HAVE_DISPATCH_AVX2
+        if( haveAVX2 )
+        {
+            i = avx2::RGB2Gray_8u(src, dst, n, scn, icoeffs, yuv_shift);
+            src += i*scn;
+        }
+#endif
+        for( ; i < n; i++, src += scn)
             dst[i] = (uchar)((_tab[src[0]] + _tab[src[1]+256] + _tab[src[2]+512]) >> yuv_shift);
     }
     int srccn;
     int tab[256*3];
+    int icoeffs[3];
+    bool haveAVX2;
 };
 
 
@@ -2745,7 +2786,7 @@ const int ITUR_BT_601_CVR = 1673527;
 const int ITUR_BT_601_SHIFT = 20;
 
 template<int bIdx, int uIdx>
-struct YUV420sp2RGB888Invoker
+struct YUV420sp2RGB888Invoker : ParallelLoopBody
 {
     Mat* dst;
     const uchar* my1, *muv;
@@ -2754,10 +2795,10 @@ struct YUV420sp2RGB888Invoker
     YUV420sp2RGB888Invoker(Mat* _dst, int _stride, const uchar* _y1, const uchar* _uv)
         : dst(_dst), my1(_y1), muv(_uv), width(_dst->cols), stride(_stride) {}
 
-    void operator()(const BlockedRange& range) const
+    void operator()(const Range& range) const
     {
-        int rangeBegin = range.begin() * 2;
-        int rangeEnd = range.end() * 2;
+        int rangeBegin = range.start * 2;
+        int rangeEnd = range.end * 2;
 
         //R = 1.164(Y - 16) + 1.596(V - 128)
         //G = 1.164(Y - 16) - 0.813(V - 128) - 0.391(U - 128)
@@ -2814,7 +2855,7 @@ struct YUV420sp2RGB888Invoker
 };
 
 template<int bIdx, int uIdx>
-struct YUV420sp2RGBA8888Invoker
+struct YUV420sp2RGBA8888Invoker : ParallelLoopBody
 {
     Mat* dst;
     const uchar* my1, *muv;
@@ -2823,10 +2864,10 @@ struct YUV420sp2RGBA8888Invoker
     YUV420sp2RGBA8888Invoker(Mat* _dst, int _stride, const uchar* _y1, const uchar* _uv)
         : dst(_dst), my1(_y1), muv(_uv), width(_dst->cols), stride(_stride) {}
 
-    void operator()(const BlockedRange& range) const
+    void operator()(const Range& range) const
     {
-        int rangeBegin = range.begin() * 2;
-        int rangeEnd = range.end() * 2;
+        int rangeBegin = range.start * 2;
+        int rangeEnd = range.end * 2;
 
         //R = 1.164(Y - 16) + 1.596(V - 128)
         //G = 1.164(Y - 16) - 0.813(V - 128) - 0.391(U - 128)
@@ -2887,7 +2928,7 @@ struct YUV420sp2RGBA8888Invoker
 };
 
 template<int bIdx>
-struct YUV420p2RGB888Invoker
+struct YUV420p2RGB888Invoker : ParallelLoopBody
 {
     Mat* dst;
     const uchar* my1, *mu, *mv;
@@ -2897,19 +2938,19 @@ struct YUV420p2RGB888Invoker
     YUV420p2RGB888Invoker(Mat* _dst, int _stride, const uchar* _y1, const uchar* _u, const uchar* _v, int _ustepIdx, int _vstepIdx)
         : dst(_dst), my1(_y1), mu(_u), mv(_v), width(_dst->cols), stride(_stride), ustepIdx(_ustepIdx), vstepIdx(_vstepIdx) {}
 
-    void operator()(const BlockedRange& range) const
+    void operator()(const Range& range) const
     {
-        const int rangeBegin = range.begin() * 2;
-        const int rangeEnd = range.end() * 2;
+        const int rangeBegin = range.start * 2;
+        const int rangeEnd = range.end * 2;
 
         size_t uvsteps[2] = {width/2, stride - width/2};
         int usIdx = ustepIdx, vsIdx = vstepIdx;
 
         const uchar* y1 = my1 + rangeBegin * stride;
-        const uchar* u1 = mu + (range.begin() / 2) * stride;
-        const uchar* v1 = mv + (range.begin() / 2) * stride;
+        const uchar* u1 = mu + (range.start / 2) * stride;
+        const uchar* v1 = mv + (range.start / 2) * stride;
 
-        if(range.begin() % 2 == 1)
+        if(range.start % 2 == 1)
         {
             u1 += uvsteps[(usIdx++) & 1];
             v1 += uvsteps[(vsIdx++) & 1];
@@ -2955,7 +2996,7 @@ struct YUV420p2RGB888Invoker
 };
 
 template<int bIdx>
-struct YUV420p2RGBA8888Invoker
+struct YUV420p2RGBA8888Invoker : ParallelLoopBody
 {
     Mat* dst;
     const uchar* my1, *mu, *mv;
@@ -2965,19 +3006,19 @@ struct YUV420p2RGBA8888Invoker
     YUV420p2RGBA8888Invoker(Mat* _dst, int _stride, const uchar* _y1, const uchar* _u, const uchar* _v, int _ustepIdx, int _vstepIdx)
         : dst(_dst), my1(_y1), mu(_u), mv(_v), width(_dst->cols), stride(_stride), ustepIdx(_ustepIdx), vstepIdx(_vstepIdx) {}
 
-    void operator()(const BlockedRange& range) const
+    void operator()(const Range& range) const
     {
-        int rangeBegin = range.begin() * 2;
-        int rangeEnd = range.end() * 2;
+        int rangeBegin = range.start * 2;
+        int rangeEnd = range.end * 2;
 
         size_t uvsteps[2] = {width/2, stride - width/2};
         int usIdx = ustepIdx, vsIdx = vstepIdx;
 
         const uchar* y1 = my1 + rangeBegin * stride;
-        const uchar* u1 = mu + (range.begin() / 2) * stride;
-        const uchar* v1 = mv + (range.begin() / 2) * stride;
+        const uchar* u1 = mu + (range.start / 2) * stride;
+        const uchar* v1 = mv + (range.start / 2) * stride;
 
-        if(range.begin() % 2 == 1)
+        if(range.start % 2 == 1)
         {
             u1 += uvsteps[(usIdx++) & 1];
             v1 += uvsteps[(vsIdx++) & 1];
@@ -3032,54 +3073,46 @@ template<int bIdx, int uIdx>
 inline void cvtYUV420sp2RGB(Mat& _dst, int _stride, const uchar* _y1, const uchar* _uv)
 {
     YUV420sp2RGB888Invoker<bIdx, uIdx> converter(&_dst, _stride, _y1,  _uv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
-        parallel_for(BlockedRange(0, _dst.rows/2), converter);
+        parallel_for_(Range(0, _dst.rows/2), converter);
     else
-#endif
-        converter(BlockedRange(0, _dst.rows/2));
+        converter(Range(0, _dst.rows/2));
 }
 
 template<int bIdx, int uIdx>
 inline void cvtYUV420sp2RGBA(Mat& _dst, int _stride, const uchar* _y1, const uchar* _uv)
 {
     YUV420sp2RGBA8888Invoker<bIdx, uIdx> converter(&_dst, _stride, _y1,  _uv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
-        parallel_for(BlockedRange(0, _dst.rows/2), converter);
+        parallel_for_(Range(0, _dst.rows/2), converter);
     else
-#endif
-        converter(BlockedRange(0, _dst.rows/2));
+        converter(Range(0, _dst.rows/2));
 }
 
 template<int bIdx>
 inline void cvtYUV420p2RGB(Mat& _dst, int _stride, const uchar* _y1, const uchar* _u, const uchar* _v, int ustepIdx, int vstepIdx)
 {
     YUV420p2RGB888Invoker<bIdx> converter(&_dst, _stride, _y1,  _u, _v, ustepIdx, vstepIdx);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
-        parallel_for(BlockedRange(0, _dst.rows/2), converter);
+        parallel_for_(Range(0, _dst.rows/2), converter);
     else
-#endif
-        converter(BlockedRange(0, _dst.rows/2));
+        converter(Range(0, _dst.rows/2));
 }
 
 template<int bIdx>
 inline void cvtYUV420p2RGBA(Mat& _dst, int _stride, const uchar* _y1, const uchar* _u, const uchar* _v, int ustepIdx, int vstepIdx)
 {
     YUV420p2RGBA8888Invoker<bIdx> converter(&_dst, _stride, _y1,  _u, _v, ustepIdx, vstepIdx);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV420_CONVERSION)
-        parallel_for(BlockedRange(0, _dst.rows/2), converter);
+        parallel_for_(Range(0, _dst.rows/2), converter);
     else
-#endif
-        converter(BlockedRange(0, _dst.rows/2));
+        converter(Range(0, _dst.rows/2));
 }
 
 ///////////////////////////////////// YUV422 -> RGB /////////////////////////////////////
 
 template<int bIdx, int uIdx, int yIdx>
-struct YUV422toRGB888Invoker
+struct YUV422toRGB888Invoker : ParallelLoopBody
 {
     Mat* dst;
     const uchar* src;
@@ -3088,10 +3121,10 @@ struct YUV422toRGB888Invoker
     YUV422toRGB888Invoker(Mat* _dst, int _stride, const uchar* _yuv)
         : dst(_dst), src(_yuv), width(_dst->cols), stride(_stride) {}
 
-    void operator()(const BlockedRange& range) const
+    void operator()(const Range& range) const
     {
-        int rangeBegin = range.begin();
-        int rangeEnd = range.end();
+        int rangeBegin = range.start;
+        int rangeEnd = range.end;
 
         const int uidx = 1 - yIdx + uIdx * 2;
         const int vidx = (2 + uidx) % 4;
@@ -3125,7 +3158,7 @@ struct YUV422toRGB888Invoker
 };
 
 template<int bIdx, int uIdx, int yIdx>
-struct YUV422toRGBA8888Invoker
+struct YUV422toRGBA8888Invoker : ParallelLoopBody
 {
     Mat* dst;
     const uchar* src;
@@ -3134,10 +3167,10 @@ struct YUV422toRGBA8888Invoker
     YUV422toRGBA8888Invoker(Mat* _dst, int _stride, const uchar* _yuv)
         : dst(_dst), src(_yuv), width(_dst->cols), stride(_stride) {}
 
-    void operator()(const BlockedRange& range) const
+    void operator()(const Range& range) const
     {
-        int rangeBegin = range.begin();
-        int rangeEnd = range.end();
+        int rangeBegin = range.start;
+        int rangeEnd = range.end;
 
         const int uidx = 1 - yIdx + uIdx * 2;
         const int vidx = (2 + uidx) % 4;
@@ -3178,24 +3211,20 @@ template<int bIdx, int uIdx, int yIdx>
 inline void cvtYUV422toRGB(Mat& _dst, int _stride, const uchar* _yuv)
 {
     YUV422toRGB888Invoker<bIdx, uIdx, yIdx> converter(&_dst, _stride, _yuv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV422_CONVERSION)
-        parallel_for(BlockedRange(0, _dst.rows), converter);
+        parallel_for_(Range(0, _dst.rows), converter);
     else
-#endif
-        converter(BlockedRange(0, _dst.rows));
+        converter(Range(0, _dst.rows));
 }
 
 template<int bIdx, int uIdx, int yIdx>
 inline void cvtYUV422toRGBA(Mat& _dst, int _stride, const uchar* _yuv)
 {
     YUV422toRGBA8888Invoker<bIdx, uIdx, yIdx> converter(&_dst, _stride, _yuv);
-#ifdef HAVE_TBB
     if (_dst.total() >= MIN_SIZE_FOR_PARALLEL_YUV422_CONVERSION)
-        parallel_for(BlockedRange(0, _dst.rows), converter);
+        parallel_for_(Range(0, _dst.rows), converter);
     else
-#endif
-        converter(BlockedRange(0, _dst.rows));
+        converter(Range(0, _dst.rows));
 }
 
 /////////////////////////// RGBA <-> mRGBA (alpha premultiplied) //////////////
@@ -3255,7 +3284,10 @@ struct mRGBA2RGBA
 //                                   The main function                                  //
 //////////////////////////////////////////////////////////////////////////////////////////
 
-void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
+namespace cv
+{
+
+static void cvtColor_( InputArray _src, OutputArray _dst, int code, int dcn, Ptr<BaseRowOp>* rowOp )
 {
     Mat src = _src.getMat(), dst;
     Size sz = src.size();
@@ -3279,12 +3311,12 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
 #ifdef HAVE_TEGRA_OPTIMIZATION
                 if(!tegra::cvtBGR2RGB(src, dst, bidx))
 #endif
-                    CvtColorLoop(src, dst, RGB2RGB<uchar>(scn, dcn, bidx));
+                    CvtColorLoop(src, dst, RGB2RGB<uchar>(scn, dcn, bidx), rowOp);
             }
             else if( depth == CV_16U )
-                CvtColorLoop(src, dst, RGB2RGB<ushort>(scn, dcn, bidx));
+                CvtColorLoop(src, dst, RGB2RGB<ushort>(scn, dcn, bidx), rowOp);
             else
-                CvtColorLoop(src, dst, RGB2RGB<float>(scn, dcn, bidx));
+                CvtColorLoop(src, dst, RGB2RGB<float>(scn, dcn, bidx), rowOp);
             break;
 
         case CV_BGR2BGR565: case CV_BGR2BGR555: case CV_RGB2BGR565: case CV_RGB2BGR555:
@@ -3304,7 +3336,7 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                       code == CV_BGRA2BGR565 || code == CV_BGRA2BGR555 ? 0 : 2,
                       code == CV_BGR2BGR565 || code == CV_RGB2BGR565 ||
                       code == CV_BGRA2BGR565 || code == CV_RGBA2BGR565 ? 6 : 5 // green bits
-                                              ));
+                                              ), rowOp);
             break;
 
         case CV_BGR5652BGR: case CV_BGR5552BGR: case CV_BGR5652RGB: case CV_BGR5552RGB:
@@ -3319,7 +3351,7 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                       code == CV_BGR5652BGRA || code == CV_BGR5552BGRA ? 0 : 2, // blue idx
                       code == CV_BGR5652BGR || code == CV_BGR5652RGB ||
                       code == CV_BGR5652BGRA || code == CV_BGR5652RGBA ? 6 : 5 // green bits
-                      ));
+                      ), rowOp);
             break;
 
         case CV_BGR2GRAY: case CV_BGRA2GRAY: case CV_RGB2GRAY: case CV_RGBA2GRAY:
@@ -3334,12 +3366,12 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
 #ifdef HAVE_TEGRA_OPTIMIZATION
                 if(!tegra::cvtRGB2Gray(src, dst, bidx))
 #endif
-                CvtColorLoop(src, dst, RGB2Gray<uchar>(scn, bidx, 0));
+                CvtColorLoop(src, dst, RGB2Gray<uchar>(scn, bidx, 0), rowOp);
             }
             else if( depth == CV_16U )
-                CvtColorLoop(src, dst, RGB2Gray<ushort>(scn, bidx, 0));
+                CvtColorLoop(src, dst, RGB2Gray<ushort>(scn, bidx, 0), rowOp);
             else
-                CvtColorLoop(src, dst, RGB2Gray<float>(scn, bidx, 0));
+                CvtColorLoop(src, dst, RGB2Gray<float>(scn, bidx, 0), rowOp);
             break;
 
         case CV_BGR5652GRAY: case CV_BGR5552GRAY:
@@ -3347,7 +3379,7 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
             _dst.create(sz, CV_8UC1);
             dst = _dst.getMat();
 
-            CvtColorLoop(src, dst, RGB5x52Gray(code == CV_BGR5652GRAY ? 6 : 5));
+            CvtColorLoop(src, dst, RGB5x52Gray(code == CV_BGR5652GRAY ? 6 : 5), rowOp);
             break;
 
         case CV_GRAY2BGR: case CV_GRAY2BGRA:
@@ -3361,12 +3393,12 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
 #ifdef HAVE_TEGRA_OPTIMIZATION
                 if(!tegra::cvtGray2RGB(src, dst))
 #endif
-                CvtColorLoop(src, dst, Gray2RGB<uchar>(dcn));
+                CvtColorLoop(src, dst, Gray2RGB<uchar>(dcn), rowOp);
             }
             else if( depth == CV_16U )
-                CvtColorLoop(src, dst, Gray2RGB<ushort>(dcn));
+                CvtColorLoop(src, dst, Gray2RGB<ushort>(dcn), rowOp);
             else
-                CvtColorLoop(src, dst, Gray2RGB<float>(dcn));
+                CvtColorLoop(src, dst, Gray2RGB<float>(dcn), rowOp);
             break;
 
         case CV_GRAY2BGR565: case CV_GRAY2BGR555:
@@ -3374,7 +3406,7 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
             _dst.create(sz, CV_8UC2);
             dst = _dst.getMat();
 
-            CvtColorLoop(src, dst, Gray2RGB5x5(code == CV_GRAY2BGR565 ? 6 : 5));
+            CvtColorLoop(src, dst, Gray2RGB5x5(code == CV_GRAY2BGR565 ? 6 : 5), rowOp);
             break;
 
         case CV_BGR2YCrCb: case CV_RGB2YCrCb:
@@ -3396,12 +3428,12 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                 if((code == CV_RGB2YCrCb || code == CV_BGR2YCrCb) && tegra::cvtRGB2YCrCb(src, dst, bidx))
                     break;
 #endif
-                CvtColorLoop(src, dst, RGB2YCrCb_i<uchar>(scn, bidx, coeffs_i));
+                CvtColorLoop(src, dst, RGB2YCrCb_i<uchar>(scn, bidx, coeffs_i), rowOp);
             }
             else if( depth == CV_16U )
-                CvtColorLoop(src, dst, RGB2YCrCb_i<ushort>(scn, bidx, coeffs_i));
+                CvtColorLoop(src, dst, RGB2YCrCb_i<ushort>(scn, bidx, coeffs_i), rowOp);
             else
-                CvtColorLoop(src, dst, RGB2YCrCb_f<float>(scn, bidx, coeffs_f));
+                CvtColorLoop(src, dst, RGB2YCrCb_f<float>(scn, bidx, coeffs_f), rowOp);
             }
             break;
 
@@ -3420,11 +3452,11 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
             dst = _dst.getMat();
 
             if( depth == CV_8U )
-                CvtColorLoop(src, dst, YCrCb2RGB_i<uchar>(dcn, bidx, coeffs_i));
+                CvtColorLoop(src, dst, YCrCb2RGB_i<uchar>(dcn, bidx, coeffs_i), rowOp);
             else if( depth == CV_16U )
-                CvtColorLoop(src, dst, YCrCb2RGB_i<ushort>(dcn, bidx, coeffs_i));
+                CvtColorLoop(src, dst, YCrCb2RGB_i<ushort>(dcn, bidx, coeffs_i), rowOp);
             else
-                CvtColorLoop(src, dst, YCrCb2RGB_f<float>(dcn, bidx, coeffs_f));
+                CvtColorLoop(src, dst, YCrCb2RGB_f<float>(dcn, bidx, coeffs_f), rowOp);
             }
             break;
 
@@ -3436,11 +3468,11 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
             dst = _dst.getMat();
 
             if( depth == CV_8U )
-                CvtColorLoop(src, dst, RGB2XYZ_i<uchar>(scn, bidx, 0));
+                CvtColorLoop(src, dst, RGB2XYZ_i<uchar>(scn, bidx, 0), rowOp);
             else if( depth == CV_16U )
-                CvtColorLoop(src, dst, RGB2XYZ_i<ushort>(scn, bidx, 0));
+                CvtColorLoop(src, dst, RGB2XYZ_i<ushort>(scn, bidx, 0), rowOp);
             else
-                CvtColorLoop(src, dst, RGB2XYZ_f<float>(scn, bidx, 0));
+                CvtColorLoop(src, dst, RGB2XYZ_f<float>(scn, bidx, 0), rowOp);
             break;
 
         case CV_XYZ2BGR: case CV_XYZ2RGB:
@@ -3452,11 +3484,11 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
             dst = _dst.getMat();
 
             if( depth == CV_8U )
-                CvtColorLoop(src, dst, XYZ2RGB_i<uchar>(dcn, bidx, 0));
+                CvtColorLoop(src, dst, XYZ2RGB_i<uchar>(dcn, bidx, 0), rowOp);
             else if( depth == CV_16U )
-                CvtColorLoop(src, dst, XYZ2RGB_i<ushort>(dcn, bidx, 0));
+                CvtColorLoop(src, dst, XYZ2RGB_i<ushort>(dcn, bidx, 0), rowOp);
             else
-                CvtColorLoop(src, dst, XYZ2RGB_f<float>(dcn, bidx, 0));
+                CvtColorLoop(src, dst, XYZ2RGB_f<float>(dcn, bidx, 0), rowOp);
             break;
 
         case CV_BGR2HSV: case CV_RGB2HSV: case CV_BGR2HSV_FULL: case CV_RGB2HSV_FULL:
@@ -3479,16 +3511,16 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                     break;
 #endif
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, RGB2HSV_b(scn, bidx, hrange));
+                    CvtColorLoop(src, dst, RGB2HSV_b(scn, bidx, hrange), rowOp);
                 else
-                    CvtColorLoop(src, dst, RGB2HSV_f(scn, bidx, (float)hrange));
+                    CvtColorLoop(src, dst, RGB2HSV_f(scn, bidx, (float)hrange), rowOp);
             }
             else
             {
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, RGB2HLS_b(scn, bidx, hrange));
+                    CvtColorLoop(src, dst, RGB2HLS_b(scn, bidx, hrange), rowOp);
                 else
-                    CvtColorLoop(src, dst, RGB2HLS_f(scn, bidx, (float)hrange));
+                    CvtColorLoop(src, dst, RGB2HLS_f(scn, bidx, (float)hrange), rowOp);
             }
             }
             break;
@@ -3510,16 +3542,16 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                 code == CV_HSV2BGR_FULL || code == CV_HSV2RGB_FULL )
             {
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, HSV2RGB_b(dcn, bidx, hrange));
+                    CvtColorLoop(src, dst, HSV2RGB_b(dcn, bidx, hrange), rowOp);
                 else
-                    CvtColorLoop(src, dst, HSV2RGB_f(dcn, bidx, (float)hrange));
+                    CvtColorLoop(src, dst, HSV2RGB_f(dcn, bidx, (float)hrange), rowOp);
             }
             else
             {
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, HLS2RGB_b(dcn, bidx, hrange));
+                    CvtColorLoop(src, dst, HLS2RGB_b(dcn, bidx, hrange), rowOp);
                 else
-                    CvtColorLoop(src, dst, HLS2RGB_f(dcn, bidx, (float)hrange));
+                    CvtColorLoop(src, dst, HLS2RGB_f(dcn, bidx, (float)hrange), rowOp);
             }
             }
             break;
@@ -3540,16 +3572,16 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                 code == CV_LBGR2Lab || code == CV_LRGB2Lab )
             {
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, RGB2Lab_b(scn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, RGB2Lab_b(scn, bidx, 0, 0, srgb), rowOp);
                 else
-                    CvtColorLoop(src, dst, RGB2Lab_f(scn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, RGB2Lab_f(scn, bidx, 0, 0, srgb), rowOp);
             }
             else
             {
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, RGB2Luv_b(scn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, RGB2Luv_b(scn, bidx, 0, 0, srgb), rowOp);
                 else
-                    CvtColorLoop(src, dst, RGB2Luv_f(scn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, RGB2Luv_f(scn, bidx, 0, 0, srgb), rowOp);
             }
             }
             break;
@@ -3571,16 +3603,16 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                 code == CV_Lab2LBGR || code == CV_Lab2LRGB )
             {
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, Lab2RGB_b(dcn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, Lab2RGB_b(dcn, bidx, 0, 0, srgb), rowOp);
                 else
-                    CvtColorLoop(src, dst, Lab2RGB_f(dcn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, Lab2RGB_f(dcn, bidx, 0, 0, srgb), rowOp);
             }
             else
             {
                 if( depth == CV_8U )
-                    CvtColorLoop(src, dst, Luv2RGB_b(dcn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, Luv2RGB_b(dcn, bidx, 0, 0, srgb), rowOp);
                 else
-                    CvtColorLoop(src, dst, Luv2RGB_f(dcn, bidx, 0, 0, srgb));
+                    CvtColorLoop(src, dst, Luv2RGB_f(dcn, bidx, 0, 0, srgb), rowOp);
             }
             }
             break;
@@ -3774,7 +3806,7 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
 
                 if( depth == CV_8U )
                 {
-                    CvtColorLoop(src, dst, RGBA2mRGBA<uchar>());
+                    CvtColorLoop(src, dst, RGBA2mRGBA<uchar>(), rowOp);
                 } else {
                     CV_Error( CV_StsBadArg, "Unsupported image depth" );
                 }
@@ -3790,7 +3822,7 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
 
                 if( depth == CV_8U )
                 {
-                    CvtColorLoop(src, dst, mRGBA2RGBA<uchar>());
+                    CvtColorLoop(src, dst, mRGBA2RGBA<uchar>(), rowOp);
                 } else {
                     CV_Error( CV_StsBadArg, "Unsupported image depth" );
                 }
@@ -3801,6 +3833,50 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
     }
 }
 
+// applies cvtColor() to a single row, for the conversions that are not done by CvtColorLoop
+struct ColorConversionRowOp : public BaseRowOp
+{
+    ColorConversionRowOp( int _code, int _dcn ) : code(_code), dcn(_dcn) {}
+
+    void operator()(const uchar** src, uchar* dst, int width)
+    {
+        Mat s(1, width, srcType, (void*)src[0]), d(1, width, dstType, dst);
+        cvtColor(s, d, code, dcn);
+        CV_DbgAssert( d.data == dst );
+    }
+
+    int code, dcn;
+};
+
+}
+
+void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
+{
+    cvtColor_(_src, _dst, code, dcn, 0);
+}
+
+cv::Ptr<cv::BaseRowOp> cv::getColorConversionRowOp(int srcType, int code, int dcn)
+{
+    // Bayer demosaicing and 4:2:0 formats mix the neighbour rows
+    CV_Assert( !(code >= CV_BayerBG2BGR && code <= CV_BayerGR2BGR) &&
+               !(code >= CV_BayerBG2BGR_VNG && code <= CV_BayerGR2BGR_VNG) &&
+               !(code >= CV_BayerBG2GRAY && code <= CV_YUV2GRAY_420) );
+
+    // check the parameters on a tiny image, which also tells the destination type
+    // and picks the row converter once for all the rows
+    Mat s(1, 2, srcType, Scalar::all(0)), d;
+    Ptr<BaseRowOp> op;
+    cvtColor_(s, d, code, dcn, &op);
+    if( op.empty() )
+    {
+        op = new ColorConversionRowOp(code, dcn);
+        cvtColor(s, d, code, dcn);
+    }
+    op->srcType = srcType;
+    op->dstType = d.type();
+    return op;
+}
+
 CV_IMPL void
 cvCvtColor( const CvArr* srcarr, CvArr* dstarr, int code )
 {
@@ -0,0 +1,424 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+#include "precomp.hpp"
+
+/*
+   Connected component labeling of binary images.
+
+   The image is split into horizontal stripes that are labeled independently
+   (the first scan of the classical two-pass algorithm with union-find over the
+   provisional labels). Then the equivalences along the stripe boundaries are merged,
+   the provisional labels are flattened into the consecutive final labels and the second
+   scan, which writes the final labels and optionally collects the statistics, runs
+   over the stripes in parallel again.
+
+   The parent of every provisional label is always smaller than the label itself, so
+   the final labels are numbered in the raster order of the first pixel of every component,
+   independently of the number of stripes.
+*/
+
+namespace cv
+{
+
+static const int CC_PARALLEL_MIN_PIXELS = 1 << 16;
+
+static inline int ccFindRoot( int* P, int i )
+{
+    int root = i;
+    while( P[root] < root )
+        root = P[root];
+
+    // path compression
+    while( P[i] < i )
+    {
+        int j = P[i];
+        P[i] = root;
+        i = j;
+    }
+    return root;
+}
+
+static inline void ccMerge( int* P, int i, int j )
+{
+    int ri = ccFindRoot(P, i), rj = ccFindRoot(P, j);
+    if( ri < rj )
+        P[rj] = ri;
+    else
+        P[ri] = rj;
+}
+
+static inline int ccStripeRow( int rows, int nstripes, int s )
+{
+    return (int)((int64)rows*s/nstripes);
+}
+
+
+// the first scan: provisional labels of every stripe and their equivalences
+struct CCFirstScanInvoker : ParallelLoopBody
+{
+    CCFirstScanInvoker( const Mat& _src, Mat& _labels, int _connectivity,
+                        int _nstripes, std::vector<std::vector<int> >& _parents )
+        : src(&_src), labels(&_labels), connectivity(_connectivity),
+          nstripes(_nstripes), parents(&_parents)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int rows = src->rows, cols = src->cols;
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            int y0 = ccStripeRow(rows, nstripes, s), y1 = ccStripeRow(rows, nstripes, s+1);
+            std::vector<int>& _P = (*parents)[s];
+
+            // a new label is started only by a pixel whose left neighbour is background
+            _P.resize((size_t)((cols + 1)/2)*(y1 - y0) + 1);
+            int* P = &_P[0];
+            int k = 1;
+            P[0] = 0;
+
+            for( int y = y0; y < y1; y++ )
+            {
+                const uchar* sptr = src->ptr(y);
+                int* L = labels->ptr<int>(y);
+                const int* Lp = y > y0 ? labels->ptr<int>(y-1) : 0;
+
+                for( int x = 0; x < cols; x++ )
+                {
+                    if( !sptr[x] )
+                    {
+                        L[x] = 0;
+                        continue;
+                    }
+
+                    int d = x > 0 ? L[x-1] : 0, l;
+
+                    if( !Lp )
+                        l = d;
+                    else if( connectivity == 8 )
+                    {
+                        int a = x > 0 ? Lp[x-1] : 0, b = Lp[x], c = x < cols-1 ? Lp[x+1] : 0;
+
+                        // b is adjacent to a, c and d, so they are all in the same set already
+                        if( b )
+                            l = b;
+                        else if( c )
+                        {
+                            l = c;
+                            if( a )
+                                ccMerge(P, c, a);
+                            else if( d )
+                                ccMerge(P, c, d);
+                        }
+                        else
+                            l = a ? a : d;
+                    }
+                    else
+                    {
+                        int b = Lp[x];
+                        l = b ? b : d;
+                        if( b && d && b != d )
+                            ccMerge(P, b, d);
+                    }
+
+                    if( !l )
+                    {
+                        l = k++;
+                        P[l] = l;
+                    }
+                    L[x] = l;
+                }
+            }
+
+            _P.resize(k);
+        }
+    }
+
+    const Mat* src;
+    Mat* labels;
+    int connectivity, nstripes;
+    std::vector<std::vector<int> >* parents;
+};
+
+
+// the second scan: final labels and the per-stripe statistics.
+// The statistics of a stripe are collected per its provisional labels,
+// so all the stripes together need memory proportional to the number of the provisional labels.
+template<typename LabelT> struct CCSecondScanInvoker : ParallelLoopBody
+{
+    CCSecondScanInvoker( const Mat& _labels, Mat& _dst, const int* _P, const int* _offsets,
+                         int _nstripes, std::vector<int>* _stats, std::vector<int64>* _integrals )
+        : labels(&_labels), dst(&_dst), P(_P), offsets(_offsets), nstripes(_nstripes),
+          stats(_stats), integrals(_integrals)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int rows = labels->rows, cols = labels->cols;
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            int y0 = ccStripeRow(rows, nstripes, s), y1 = ccStripeRow(rows, nstripes, s+1);
+            const int* Ps = P + offsets[s];
+            int* st = 0;
+            int64* sums = 0;
+
+            if( stats )
+            {
+                size_t nlocal = (size_t)(offsets[s+1] - offsets[s] + 1);
+                stats[s].assign(nlocal*CC_STAT_MAX, 0);
+                integrals[s].assign(nlocal*2, 0);
+                st = &stats[s][0];
+                sums = &integrals[s][0];
+            }
+
+            for( int y = y0; y < y1; y++ )
+            {
+                const int* L = labels->ptr<int>(y);
+                LabelT* D = dst->ptr<LabelT>(y);
+
+                for( int x = 0; x < cols; x++ )
+                {
+                    int l = L[x];
+                    D[x] = (LabelT)(l ? Ps[l] : 0);
+
+                    if( st )
+                    {
+                        // CC_STAT_WIDTH and CC_STAT_HEIGHT keep the right and bottom
+                        // coordinates until the statistics are merged
+                        int* row = st + l*CC_STAT_MAX;
+                        if( row[CC_STAT_AREA]++ == 0 )
+                        {
+                            row[CC_STAT_LEFT] = row[CC_STAT_WIDTH] = x;
+                            row[CC_STAT_TOP] = y;
+                        }
+                        else
+                        {
+                            row[CC_STAT_LEFT] = std::min(row[CC_STAT_LEFT], x);
+                            row[CC_STAT_WIDTH] = std::max(row[CC_STAT_WIDTH], x);
+                        }
+                        row[CC_STAT_HEIGHT] = y;
+                        sums[l*2] += x;
+                        sums[l*2+1] += y;
+                    }
+                }
+            }
+        }
+    }
+
+    const Mat* labels;
+    Mat* dst;
+    const int* P;
+    const int* offsets;
+    int nstripes;
+    std::vector<int>* stats;
+    std::vector<int64>* integrals;
+};
+
+
+static int connectedComponents_( const Mat& src, Mat& dst, int connectivity,
+                                 Mat* statsv, Mat* centroids )
+{
+    CV_Assert( src.type() == CV_8UC1 );
+    CV_Assert( connectivity == 8 || connectivity == 4 );
+    CV_Assert( dst.type() == CV_32S || dst.type() == CV_16U );
+
+    int rows = src.rows, cols = src.cols;
+    int nthreads = getNumThreads();
+    int nstripes = nthreads > 1 && rows*cols >= CC_PARALLEL_MIN_PIXELS ?
+        std::max(std::min(rows/16, nthreads*2), 1) : 1;
+
+    // the provisional labels are kept in the output array when it is wide enough
+    Mat labels = dst.type() == CV_32S ? dst : Mat(src.size(), CV_32S);
+    std::vector<std::vector<int> > parents(nstripes);
+
+    parallel_for_(Range(0, nstripes), CCFirstScanInvoker(src, labels, connectivity, nstripes, parents));
+
+    // provisional label l of stripe s has the global index offsets[s] + l
+    std::vector<int> offsets(nstripes + 1);
+    int s, total = 0;
+    for( s = 0; s < nstripes; s++ )
+    {
+        offsets[s] = total;
+        total += (int)parents[s].size() - 1;
+    }
+    offsets[nstripes] = total;
+
+    std::vector<int> _P(total + 1);
+    int* P = &_P[0];
+    P[0] = 0;
+    for( s = 0; s < nstripes; s++ )
+    {
+        const std::vector<int>& Ps = parents[s];
+        for( size_t l = 1; l < Ps.size(); l++ )
+            P[offsets[s] + l] = offsets[s] + Ps[l];
+        std::vector<int>().swap(parents[s]);
+    }
+
+    // merge the components across the stripe boundaries
+    for( s = 1; s < nstripes; s++ )
+    {
+        int y = ccStripeRow(rows, nstripes, s);
+        const int* L = labels.ptr<int>(y);
+        const int* Lp = labels.ptr<int>(y-1);
+        int ofs = offsets[s], ofsp = offsets[s-1];
+
+        for( int x = 0; x < cols; x++ )
+        {
+            if( !L[x] )
+                continue;
+            int x0 = connectivity == 8 ? std::max(x-1, 0) : x;
+            int x1 = connectivity == 8 ? std::min(x+1, cols-1) : x;
+            for( int xp = x0; xp <= x1; xp++ )
+                if( Lp[xp] )
+                    ccMerge(P, ofs + L[x], ofsp + Lp[xp]);
+        }
+    }
+
+    // flatten the equivalence trees into the consecutive final labels
+    int nlabels = 1;
+    for( int i = 1; i <= total; i++ )
+        P[i] = P[i] < i ? P[P[i]] : nlabels++;
+
+    if( dst.type() == CV_16U && nlabels > USHRT_MAX + 1 )
+        CV_Error( CV_StsOutOfRange, "The number of labels exceeds the range of CV_16U labels" );
+
+    std::vector<std::vector<int> > stats(statsv ? nstripes : 0);
+    std::vector<std::vector<int64> > integrals(statsv ? nstripes : 0);
+    std::vector<int>* pstats = statsv ? &stats[0] : 0;
+    std::vector<int64>* pintegrals = statsv ? &integrals[0] : 0;
+
+    if( dst.type() == CV_32S )
+        parallel_for_(Range(0, nstripes), CCSecondScanInvoker<int>(labels, dst, P, &offsets[0],
+                      nstripes, pstats, pintegrals));
+    else
+        parallel_for_(Range(0, nstripes), CCSecondScanInvoker<ushort>(labels, dst, P, &offsets[0],
+                      nstripes, pstats, pintegrals));
+
+    if( statsv )
+    {
+        statsv->create(nlabels, CC_STAT_MAX, CV_32S);
+        centroids->create(nlabels, 2, CV_64F);
+
+        // CC_STAT_WIDTH and CC_STAT_HEIGHT keep the right and bottom coordinates while merging
+        for( int l = 0; l < nlabels; l++ )
+        {
+            int* row = statsv->ptr<int>(l);
+            row[CC_STAT_LEFT] = row[CC_STAT_TOP] = INT_MAX;
+            row[CC_STAT_WIDTH] = row[CC_STAT_HEIGHT] = -1;
+            row[CC_STAT_AREA] = 0;
+        }
+        std::vector<int64> sums((size_t)nlabels*2, 0);
+
+        for( s = 0; s < nstripes; s++ )
+        {
+            int nlocal = offsets[s+1] - offsets[s] + 1;
+            for( int l = 0; l < nlocal; l++ )
+            {
+                const int* st = &stats[s][l*CC_STAT_MAX];
+                if( st[CC_STAT_AREA] == 0 )
+                    continue;
+                int f = l ? P[offsets[s] + l] : 0;
+                int* row = statsv->ptr<int>(f);
+                row[CC_STAT_LEFT] = std::min(row[CC_STAT_LEFT], st[CC_STAT_LEFT]);
+                row[CC_STAT_WIDTH] = std::max(row[CC_STAT_WIDTH], st[CC_STAT_WIDTH]);
+                row[CC_STAT_TOP] = std::min(row[CC_STAT_TOP], st[CC_STAT_TOP]);
+                row[CC_STAT_HEIGHT] = std::max(row[CC_STAT_HEIGHT], st[CC_STAT_HEIGHT]);
+                row[CC_STAT_AREA] += st[CC_STAT_AREA];
+                sums[f*2] += integrals[s][l*2];
+                sums[f*2+1] += integrals[s][l*2+1];
+            }
+            std::vector<int>().swap(stats[s]);
+            std::vector<int64>().swap(integrals[s]);
+        }
+
+        for( int l = 0; l < nlabels; l++ )
+        {
+            int* row = statsv->ptr<int>(l);
+            double* c = centroids->ptr<double>(l);
+            int area = row[CC_STAT_AREA];
+            if( area > 0 )
+            {
+                row[CC_STAT_WIDTH] -= row[CC_STAT_LEFT] - 1;
+                row[CC_STAT_HEIGHT] -= row[CC_STAT_TOP] - 1;
+                c[0] = (double)sums[l*2]/area;
+                c[1] = (double)sums[l*2+1]/area;
+            }
+            else
+            {
+                // only the background label can be empty
+                for( int k = 0; k < CC_STAT_MAX; k++ )
+                    row[k] = 0;
+                c[0] = c[1] = 0;
+            }
+        }
+    }
+
+    return nlabels;
+}
+
+}
+
+int cv::connectedComponents( InputArray _image, OutputArray _labels, int connectivity, int ltype )
+{
+    Mat image = _image.getMat();
+    CV_Assert( ltype == CV_32S || ltype == CV_16U );
+    _labels.create(image.size(), ltype);
+    Mat labels = _labels.getMat();
+    return connectedComponents_(image, labels, connectivity, 0, 0);
+}
+
+int cv::connectedComponentsWithStats( InputArray _image, OutputArray _labels, OutputArray _stats,
+                                      OutputArray _centroids, int connectivity, int ltype )
+{
+    Mat image = _image.getMat();
+    CV_Assert( ltype == CV_32S || ltype == CV_16U );
+    _labels.create(image.size(), ltype);
+    Mat labels = _labels.getMat(), stats, centroids;
+    int nlabels = connectedComponents_(image, labels, connectivity, &stats, &centroids);
+    stats.copyTo(_stats);
+    centroids.copyTo(_centroids);
+    return nlabels;
+}
+
+/* End of file. */
@@ -443,7 +443,7 @@ icvGetDistanceTransformMask( int maskType, float *metrics )
 namespace cv
 {
 
-struct DTColumnInvoker
+struct DTColumnInvoker : ParallelLoopBody
 {
     DTColumnInvoker( const CvMat* _src, CvMat* _dst, const int* _sat_tab, const float* _sqr_tab)
     {
@@ -453,9 +453,9 @@ struct DTColumnInvoker
         sqr_tab = _sqr_tab;
     }
 
-    void operator()( const BlockedRange& range ) const
+    void operator()( const Range& range ) const
     {
-        int i, i1 = range.begin(), i2 = range.end();
+        int i, i1 = range.start, i2 = range.end;
         int m = src->rows;
         size_t sstep = src->step, dstep = dst->step/sizeof(float);
         AutoBuffer<int> _d(m);
@@ -490,7 +490,7 @@ struct DTColumnInvoker
 };
 
 
-struct DTRowInvoker
+struct DTRowInvoker : ParallelLoopBody
 {
     DTRowInvoker( CvMat* _dst, const float* _sqr_tab, const float* _inv_tab )
     {
@@ -499,10 +499,10 @@ struct DTRowInvoker
         inv_tab = _inv_tab;
     }
 
-    void operator()( const BlockedRange& range ) const
+    void operator()( const Range& range ) const
     {
         const float inf = 1e15f;
-        int i, i1 = range.begin(), i2 = range.end();
+        int i, i1 = range.start, i2 = range.end;
         int n = dst->cols;
         AutoBuffer<uchar> _buf((n+2)*2*sizeof(float) + (n+2)*sizeof(int));
         float* f = (float*)(uchar*)_buf;
@@ -554,6 +554,250 @@ struct DTRowInvoker
     const float* inv_tab;
 };
 
+
+/*
+   Chamfer distance transform computed as a sequence of 1D min-plus passes, one per
+   mask direction (horizontal, vertical, diagonal and knight's moves). For the built-in
+   masks it gives exactly the same distances as the two-pass raster scan, but every
+   pass is split into independent bands of parallel lines.
+*/
+static const int DT_PARALLEL_MIN_PIXELS = 1 << 16;
+
+// initializes the distance map and runs the horizontal pass; one row per iteration
+template<typename T> struct DTChamferRowInvoker : ParallelLoopBody
+{
+    DTChamferRowInvoker( const CvMat* _src, CvMat* _temp, CvMat* _labels, int _hv_dist, int _max_dist )
+    {
+        src = _src;
+        temp = _temp;
+        labels = _labels;
+        hv_dist = _hv_dist;
+        max_dist = _max_dist;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int i, j, n = src->cols;
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            const uchar* s = src->data.ptr + i*src->step;
+            T* t = (T*)(temp->data.ptr + i*temp->step);
+            int a = max_dist;
+
+            if( !labels )
+            {
+                for( j = 0; j < n; j++ )
+                {
+                    a = s[j] == 0 ? 0 : std::min(a + hv_dist, max_dist);
+                    t[j] = (T)a;
+                }
+
+                for( j = n - 2; j >= 0; j-- )
+                {
+                    a = std::min(a + hv_dist, (int)t[j]);
+                    t[j] = (T)a;
+                }
+            }
+            else
+            {
+                int* lls = (int*)(labels->data.ptr + i*labels->step);
+                int l = 0;
+
+                for( j = 0; j < n; j++ )
+                {
+                    if( s[j] == 0 )
+                        a = 0, l = lls[j];
+                    else if( a + hv_dist < max_dist )
+                        a += hv_dist;
+                    else
+                        a = max_dist, l = 0;
+                    t[j] = (T)a;
+                    lls[j] = l;
+                }
+
+                for( j = n - 2; j >= 0; j-- )
+                {
+                    if( a + hv_dist < (int)t[j] )
+                        a += hv_dist;
+                    else
+                        a = t[j], l = lls[j];
+                    t[j] = (T)a;
+                    lls[j] = l;
+                }
+            }
+        }
+    }
+
+    const CvMat* src;
+    CvMat* temp;
+    CvMat* labels;
+    int hv_dist, max_dist;
+};
+
+
+static inline int dtCeilDiv( int a, int b )
+{
+    return a >= 0 ? (a + b - 1)/b : -((-a)/b);
+}
+
+// forward and backward pass along the lines parallel to (dx, dy), dy > 0.
+// A line is identified by k = dy*x - dx*y; the range is split into bands of lines
+// that cover a parallelogram of the image and are processed independently.
+template<typename T> struct DTChamferLineInvoker : ParallelLoopBody
+{
+    DTChamferLineInvoker( CvMat* _temp, CvMat* _labels, int _dx, int _dy, int _dist, int _nstripes )
+    {
+        temp = _temp;
+        labels = _labels;
+        dx = _dx;
+        dy = _dy;
+        dist = _dist;
+        nstripes = _nstripes;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int i, j, m = temp->rows, n = temp->cols;
+        int kmin = -std::max(dx, 0)*(m-1), kmax = dy*(n-1) - std::min(dx, 0)*(m-1) + 1;
+        int k0 = kmin + (int)((int64)(kmax - kmin)*range.start/nstripes);
+        int k1 = kmin + (int)((int64)(kmax - kmin)*range.end/nstripes);
+        size_t tstep = temp->step, lstep = labels ? labels->step : 0;
+
+        // forward pass: (y, x) <- (y - dy, x - dx)
+        for( i = dy; i < m; i++ )
+        {
+            int j0 = std::max(dtCeilDiv(k0 + dx*i, dy), std::max(dx, 0));
+            int j1 = std::min(dtCeilDiv(k1 + dx*i, dy), n + std::min(dx, 0));
+            T* t = (T*)(temp->data.ptr + i*tstep);
+            const T* tp = (const T*)(temp->data.ptr + (i - dy)*tstep) - dx;
+
+            if( !labels )
+            {
+                for( j = j0; j < j1; j++ )
+                    t[j] = (T)std::min((int)t[j], tp[j] + dist);
+            }
+            else
+            {
+                int* lls = (int*)(labels->data.ptr + i*lstep);
+                const int* lp = (const int*)(labels->data.ptr + (i - dy)*lstep) - dx;
+                for( j = j0; j < j1; j++ )
+                {
+                    int a = tp[j] + dist;
+                    if( a < (int)t[j] )
+                        t[j] = (T)a, lls[j] = lp[j];
+                }
+            }
+        }
+
+        // backward pass: (y, x) <- (y + dy, x + dx)
+        for( i = m - dy - 1; i >= 0; i-- )
+        {
+            int j0 = std::max(dtCeilDiv(k0 + dx*i, dy), std::max(-dx, 0));
+            int j1 = std::min(dtCeilDiv(k1 + dx*i, dy), n - std::max(dx, 0));
+            T* t = (T*)(temp->data.ptr + i*tstep);
+            const T* tn = (const T*)(temp->data.ptr + (i + dy)*tstep) + dx;
+
+            if( !labels )
+            {
+                for( j = j0; j < j1; j++ )
+                    t[j] = (T)std::min((int)t[j], tn[j] + dist);
+            }
+            else
+            {
+                int* lls = (int*)(labels->data.ptr + i*lstep);
+                const int* ln = (const int*)(labels->data.ptr + (i + dy)*lstep) + dx;
+                for( j = j0; j < j1; j++ )
+                {
+                    int a = tn[j] + dist;
+                    if( a < (int)t[j] )
+                        t[j] = (T)a, lls[j] = ln[j];
+                }
+            }
+        }
+    }
+
+    CvMat* temp;
+    CvMat* labels;
+    int dx, dy, dist, nstripes;
+};
+
+
+struct DTChamferScaleInvoker : ParallelLoopBody
+{
+    DTChamferScaleInvoker( CvMat* _dst, float _scale )
+    {
+        dst = _dst;
+        scale = _scale;
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int n = dst->cols;
+        for( int i = range.start; i < range.end; i++ )
+        {
+            float* d = (float*)(dst->data.ptr + i*dst->step);
+            const int* t = (const int*)d;
+            for( int j = 0; j < n; j++ )
+                d[j] = (float)(t[j] * scale);
+        }
+    }
+
+    CvMat* dst;
+    float scale;
+};
+
+
+template<typename T> static void
+dtChamferLinePass( CvMat* temp, CvMat* labels, int dx, int dy, int dist )
+{
+    int len = dy*temp->cols + std::abs(dx)*temp->rows;
+    int nstripes = std::max(std::min(len/64, getNumThreads()*2), 1);
+    parallel_for_(Range(0, nstripes), DTChamferLineInvoker<T>(temp, labels, dx, dy, dist, nstripes));
+}
+
+/*
+   Parallel counterpart of icvDistanceTransform_3x3_C1R, icvDistanceTransform_5x5_C1R and
+   icvDistanceTransformEx_5x5_C1R for the built-in masks. The distances are computed in-place
+   in dst, which is reinterpreted as the fixed-point map. The passes that can not improve the
+   distances (e.g. diagonal moves for CV_DIST_L1) are skipped.
+*/
+static void
+dtChamferParallel( const CvMat* src, CvMat* dst, CvMat* labels, int maskSize, const float* metrics )
+{
+    const int HV_DIST = CV_FLT_TO_FIX( metrics[0], ICV_DIST_SHIFT );
+    const int DIAG_DIST = CV_FLT_TO_FIX( metrics[1], ICV_DIST_SHIFT );
+    const int LONG_DIST = maskSize == CV_DIST_MASK_5 ? CV_FLT_TO_FIX( metrics[2], ICV_DIST_SHIFT ) : INT_MAX;
+    const float scale = 1.f/(1 << ICV_DIST_SHIFT);
+
+    parallel_for_(Range(0, src->rows), DTChamferRowInvoker<int>(src, dst, labels, HV_DIST, ICV_INIT_DIST0));
+    dtChamferLinePass<int>(dst, labels, 0, 1, HV_DIST);
+
+    if( DIAG_DIST < HV_DIST*2 )
+    {
+        dtChamferLinePass<int>(dst, labels, 1, 1, DIAG_DIST);
+        dtChamferLinePass<int>(dst, labels, -1, 1, DIAG_DIST);
+    }
+
+    if( LONG_DIST < HV_DIST + DIAG_DIST )
+    {
+        dtChamferLinePass<int>(dst, labels, 2, 1, LONG_DIST);
+        dtChamferLinePass<int>(dst, labels, -2, 1, LONG_DIST);
+        dtChamferLinePass<int>(dst, labels, 1, 2, LONG_DIST);
+        dtChamferLinePass<int>(dst, labels, -1, 2, LONG_DIST);
+    }
+
+    parallel_for_(Range(0, dst->rows), DTChamferScaleInvoker(dst, scale));
+}
+
+// parallel counterpart of icvDistanceATS_L1_8u
+static void
+dtL1Parallel_8u( const CvMat* src, CvMat* dst )
+{
+    parallel_for_(Range(0, src->rows), DTChamferRowInvoker<uchar>(src, dst, 0, 1, 255));
+    dtChamferLinePass<uchar>(dst, 0, 0, 1, 1);
+}
+
 }
 
 static void
@@ -586,7 +830,7 @@ icvTrueDistTrans( const CvMat* src, CvMat* dst )
     for( ; i <= m*3; i++ )
         sat_tab[i] = i - shift;
 
-    cv::parallel_for(cv::BlockedRange(0, n), cv::DTColumnInvoker(src, dst, sat_tab, sqr_tab));
+    cv::parallel_for_(cv::Range(0, n), cv::DTColumnInvoker(src, dst, sat_tab, sqr_tab));
 
     // stage 2: compute modified distance transform for each row
     float* inv_tab = sqr_tab + n;
@@ -598,7 +842,7 @@ icvTrueDistTrans( const CvMat* src, CvMat* dst )
         sqr_tab[i] = (float)(i*i);
     }
 
-    cv::parallel_for(cv::BlockedRange(0, m), cv::DTRowInvoker(dst, sqr_tab, inv_tab));
+    cv::parallel_for_(cv::Range(0, m), cv::DTRowInvoker(dst, sqr_tab, inv_tab));
 }
 
 
@@ -678,7 +922,8 @@ icvDistanceATS_L1_8u( const CvMat* src, CvMat* dst )
     for( x = width - 2; x >= 0; x-- )
     {
         a = lut[a];
-        dbase[x] = (uchar)(CV_CALC_MIN_8U(a, dbase[x]));
+        a = MIN(a, dbase[x]);
+        dbase[x] = (uchar)a;
     }
 
     // right edge is the only error case
@@ -688,19 +933,61 @@ icvDistanceATS_L1_8u( const CvMat* src, CvMat* dst )
 
         // do right edge
         a = lut[dbase[width-1+dststep]];
-        dbase[width-1] = (uchar)(MIN(a, dbase[width-1]));
+        a = MIN(a, dbase[width-1]);
+        dbase[width-1] = (uchar)a;
 
         for( x = width - 2; x >= 0; x-- )
         {
             int b = dbase[x+dststep];
             a = lut[MIN(a, b)];
-            dbase[x] = (uchar)(MIN(a, dbase[x]));
+            a = MIN(a, dbase[x]);
+            dbase[x] = (uchar)a;
         }
     }
 }
 //END ATS ADDITION
 
 
+/* Marks the zero pixels with the component (CV_DIST_LABEL_CCOMP) or pixel indices */
+static void
+icvInitDistanceLabels( const CvMat* src, CvMat* labels, int labelType, int border )
+{
+    CvSize size = cvGetMatSize(src);
+
+    cvZero( labels );
+
+    if( labelType == CV_DIST_LABEL_CCOMP )
+    {
+        CvSeq *contours = 0;
+        cv::Ptr<CvMemStorage> st = cvCreateMemStorage();
+        cv::Ptr<CvMat> src_copy = cvCreateMat( size.height+border*2, size.width+border*2, src->type );
+        cvCopyMakeBorder(src, src_copy, cvPoint(border, border), IPL_BORDER_CONSTANT, cvScalarAll(255));
+        cvCmpS( src_copy, 0, src_copy, CV_CMP_EQ );
+        cvFindContours( src_copy, st, &contours, sizeof(CvContour),
+                       CV_RETR_CCOMP, CV_CHAIN_APPROX_SIMPLE, cvPoint(-border, -border));
+
+        for( int label = 1; contours != 0; contours = contours->h_next, label++ )
+        {
+            CvScalar area_color = cvScalarAll(label);
+            cvDrawContours( labels, contours, area_color, area_color, -255, -1, 8 );
+        }
+    }
+    else
+    {
+        int k = 1;
+        for( int i = 0; i < src->rows; i++ )
+        {
+            const uchar* srcptr = src->data.ptr + src->step*i;
+            int* labelptr = (int*)(labels->data.ptr + labels->step*i);
+
+            for( int j = 0; j < src->cols; j++ )
+                if( srcptr[j] == 0 )
+                    labelptr[j] = k++;
+        }
+    }
+}
+
+
 /* Wrapper function for distance transform group */
 CV_IMPL void
 cvDistTransform( const void* srcarr, void* dstarr,
@@ -768,9 +1055,24 @@ cvDistTransform( const void* srcarr, void* dstarr,
 
     CvSize size = cvGetMatSize(src);
 
+    // the separable passes reproduce the raster scan results only for the built-in masks
+    // and only when there is at least one zero pixel (otherwise the distances are undefined)
+    bool useParallel = cv::getNumThreads() > 1 && size.width*size.height >= cv::DT_PARALLEL_MIN_PIXELS &&
+        (CV_MAT_TYPE(dst->type) == CV_8UC1 ||
+        (distType != CV_DIST_USER && cvCountNonZero(src) < size.width*size.height));
+
     if( CV_MAT_TYPE(dst->type) == CV_8UC1 )
     {
-        icvDistanceATS_L1_8u( src, dst );
+        if( useParallel )
+            cv::dtL1Parallel_8u( src, dst );
+        else
+            icvDistanceATS_L1_8u( src, dst );
+    }
+    else if( useParallel )
+    {
+        if( labels )
+            icvInitDistanceLabels( src, labels, labelType, 2 );
+        cv::dtChamferParallel( src, dst, labels, maskSize, _mask );
     }
     else
     {
@@ -788,38 +1090,7 @@ cvDistTransform( const void* srcarr, void* dstarr,
         }
         else
         {
-            cvZero( labels );
-
-            if( labelType == CV_DIST_LABEL_CCOMP )
-            {
-                CvSeq *contours = 0;
-                cv::Ptr<CvMemStorage> st = cvCreateMemStorage();
-                cv::Ptr<CvMat> src_copy = cvCreateMat( size.height+border*2, size.width+border*2, src->type );
-                cvCopyMakeBorder(src, src_copy, cvPoint(border, border), IPL_BORDER_CONSTANT, cvScalarAll(255));
-                cvCmpS( src_copy, 0, src_copy, CV_CMP_EQ );
-                cvFindContours( src_copy, st, &contours, sizeof(CvContour),
-                               CV_RETR_CCOMP, CV_CHAIN_APPROX_SIMPLE, cvPoint(-border, -border));
-
-                for( int label = 1; contours != 0; contours = contours->h_next, label++ )
-                {
-                    CvScalar area_color = cvScalarAll(label);
-                    cvDrawContours( labels, contours, area_color, area_color, -255, -1, 8 );
-                }
-            }
-            else
-            {
-                int k = 1;
-                for( int i = 0; i < src->rows; i++ )
-                {
-                    const uchar* srcptr = src->data.ptr + src->step*i;
-                    int* labelptr = (int*)(labels->data.ptr + labels->step*i);
-
-                    for( int j = 0; j < src->cols; j++ )
-                        if( srcptr[j] == 0 )
-                            labelptr[j] = k++;
-                }
-            }
-
+            icvInitDistanceLabels( src, labels, labelType, border );
             icvDistanceTransformEx_5x5_C1R( src->data.ptr, src->step, temp->data.i, temp->step,
                         dst->data.fl, dst->step, labels->data.i, labels->step, size, _mask );
         }
@@ -41,6 +41,9 @@
 //M*/
 
 #include "precomp.hpp"
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/filter_avx2.hpp"
+#endif
 
 /****************************************************************************************\
                                     Base Image Filter
@@ -430,6 +433,46 @@ int FilterEngine::proceed( const uchar* src, int srcstep, int count,
 }
 
 
+// Filters a range of rows of srcRoi with a private copy of the engine.
+// The stripe is started as a sub-ROI of the same source, so the rows above and below it
+// are read from the image (or extrapolated at the image border) exactly as in the serial case.
+class FilterStripeInvoker : public ParallelLoopBody
+{
+public:
+    FilterStripeInvoker(const FilterEngine& _engine, const Mat& _src, Mat& _dst,
+                        const Rect& _srcRoi, Point _dstOfs, bool _isolated) :
+        engine(&_engine), src(&_src), dst(&_dst), srcRoi(_srcRoi),
+        dstOfs(_dstOfs), isolated(_isolated)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        const FilterEngine& e = *engine;
+        FilterEngine f;
+
+        f.init(e.isSeparable() ? Ptr<BaseFilter>() : cloneFilter(e.filter2D),
+               isClonableFilter(e.rowFilter) ? cloneFilter(e.rowFilter) : e.rowFilter,
+               e.isSeparable() ? cloneFilter(e.columnFilter) : Ptr<BaseColumnFilter>(),
+               e.srcType, e.dstType, e.bufType, e.rowBorderType, e.columnBorderType);
+        f.constBorderValue = e.constBorderValue;
+
+        Rect roi(srcRoi.x, srcRoi.y + range.start, srcRoi.width, range.end - range.start);
+        int y = f.start(*src, roi, isolated);
+        f.proceed( src->data + y*src->step, (int)src->step, f.endY - f.startY,
+                   dst->data + (dstOfs.y + range.start)*dst->step + dstOfs.x*dst->elemSize(),
+                   (int)dst->step );
+    }
+
+private:
+    const FilterEngine* engine;
+    const Mat* src;
+    Mat* dst;
+    Rect srcRoi;
+    Point dstOfs;
+    bool isolated;
+};
+
 void FilterEngine::apply(const Mat& src, Mat& dst,
     const Rect& _srcRoi, Point dstOfs, bool isolated)
 {
@@ -446,6 +489,19 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
         dstOfs.x + srcRoi.width <= dst.cols &&
         dstOfs.y + srcRoi.height <= dst.rows );
 
+    // every stripe re-filters ksize.height-1 rows of its neighbours, so the stripes should not be too thin
+    double nstripes = std::min((double)srcRoi.area()/(1 << 16),
+                               (double)srcRoi.height/std::max(ksize.height*4, 32));
+    bool inplace = src.dataend > dst.datastart && dst.dataend > src.datastart;
+
+    if( nstripes > 1 && !inplace && getNumThreads() > 1 &&
+        (isSeparable() ? isClonableFilter(columnFilter) : isClonableFilter(filter2D)) )
+    {
+        parallel_for_(Range(0, srcRoi.height),
+                      FilterStripeInvoker(*this, src, dst, srcRoi, dstOfs, isolated), nstripes);
+        return;
+    }
+
     int y = start(src, srcRoi, isolated);
     proceed( src.data + y*src.step, (int)src.step, endY - startY,
              dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
@@ -539,10 +595,11 @@ struct FilterNoVec
 
 struct RowVec_8u32s
 {
-    RowVec_8u32s() { smallValues = false; }
+    RowVec_8u32s() { smallValues = false; haveAVX2 = false; }
     RowVec_8u32s( const Mat& _kernel )
     {
         kernel = _kernel;
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2);
         smallValues = true;
         int k, ksize = kernel.rows + kernel.cols - 1;
         for( k = 0; k < ksize; k++ )
@@ -568,6 +625,10 @@ struct RowVec_8u32s
 
         if( smallValues )
         {
+#ifdef HAVE_DISPATCH_AVX2
+            if( haveAVX2 )
+                i = avx2::RowVec_8u32s(_src, dst, width, cn, _kx, _ksize);
+#endif
             for( ; i <= width - 16; i += 16 )
             {
                 const uchar* src = _src + i;
@@ -625,6 +686,7 @@ struct RowVec_8u32s
 
     Mat kernel;
     bool smallValues;
+    bool haveAVX2;
 };
 
 
@@ -960,10 +1022,11 @@ struct SymmRowSmallVec_8u32s
 
 struct SymmColumnVec_32s8u
 {
-    SymmColumnVec_32s8u() { symmetryType=0; }
+    SymmColumnVec_32s8u() { symmetryType=0; haveAVX2 = false; }
     SymmColumnVec_32s8u(const Mat& _kernel, int _symmetryType, int _bits, double _delta)
     {
         symmetryType = _symmetryType;
+        haveAVX2 = checkHardwareSupport(CV_CPU_AVX2);
         _kernel.convertTo(kernel, CV_32F, 1./(1 << _bits), 0);
         delta = (float)(_delta/(1 << _bits));
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
@@ -982,6 +1045,11 @@ struct SymmColumnVec_32s8u
         const __m128i *S, *S2;
         __m128 d4 = _mm_set1_ps(delta);
 
+#ifdef HAVE_DISPATCH_AVX2
+        if( haveAVX2 )
+            i = avx2::SymmColumnVec_32s8u(src, dst, width, ky, ksize2, delta, symmetrical);
+#endif
+
         if( symmetrical )
         {
             for( ; i <= width - 16; i += 16 )
@@ -1103,6 +1171,7 @@ struct SymmColumnVec_32s8u
     int symmetryType;
     float delta;
     Mat kernel;
+    bool haveAVX2;
 };
 
 
@@ -2393,7 +2462,7 @@ template<typename ST, typename DT, class VecOp> struct SymmRowSmallFilter :
 };
 
 
-template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilter
+template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     typedef typename CastOp::type1 ST;
     typedef typename CastOp::rtype DT;
@@ -2415,6 +2484,8 @@ template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilte
                    (kernel.rows == 1 || kernel.cols == 1));
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         const ST* ky = (const ST*)kernel.data;
@@ -2478,6 +2549,8 @@ template<class CastOp, class VecOp> struct SymmColumnFilter : public ColumnFilte
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new SymmColumnFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -2584,6 +2657,8 @@ struct SymmColumnSmallFilter : public SymmColumnFilter<CastOp, VecOp>
         CV_Assert( this->ksize == 3 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new SymmColumnSmallFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -3041,7 +3116,7 @@ void preprocess2DKernel( const Mat& kernel, vector<Point>& coords, vector<uchar>
 }
 
 
-template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFilter
+template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFilter, public ClonableFilter<BaseFilter>
 {
     typedef typename CastOp::type1 KT;
     typedef typename CastOp::rtype DT;
@@ -3060,6 +3135,8 @@ template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFi
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return Ptr<BaseFilter>(new Filter2D(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         KT _delta = delta;
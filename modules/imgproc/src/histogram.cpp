@@ -206,6 +206,31 @@ static void histPrepareImages( const Mat* images, int nimages, const int* channe
 }
 
 
+
+// Moves the pointers prepared by histPrepareImages() to the rows [start, end) of the images
+// (or to the elements [start, end) of the single row, when the images are continuous).
+// extraEsz is the element size of the optional plane (mask or back projection) following the image planes.
+static void histStripePointers( const vector<uchar*>& ptrs, const vector<int>& deltas, int dims,
+                                int esz1, int extraEsz, Size imsize, int start, int end,
+                                vector<uchar*>& sptrs, Size& ssize )
+{
+    sptrs = ptrs;
+    for( int i = 0; i <= dims; i++ )
+    {
+        if( !ptrs[i] )
+            continue;
+        size_t ofs = imsize.height == 1 ? (size_t)start*deltas[i*2] :
+            i < dims ? (size_t)start*(imsize.width*deltas[i*2] + deltas[i*2+1]) :
+                       (size_t)start*deltas[i*2+1];
+        sptrs[i] = ptrs[i] + ofs*(i < dims ? esz1 : extraEsz);
+    }
+
+    ssize = imsize.height == 1 ? Size(end - start, 1) : Size(imsize.width, end - start);
+}
+
+// the minimal number of pixels for which the histograms are computed in parallel
+static const int HIST_PARALLEL_MIN_PIXELS = 1 << 16;
+
 ////////////////////////////////// C A L C U L A T E    H I S T O G R A M ////////////////////////////////////
 
 template<typename T> static void
@@ -423,6 +448,29 @@ calcHist_( vector<uchar*>& _ptrs, const vector<int>& _deltas,
 }
 
 
+// Adds n values taken with the step d to the histogram. The neighbour values go to four
+// different partial histograms, so that the increments of the same bin do not wait for each other.
+static void calcHistRow_8u( const uchar* p, int n, int d, int (*H)[256] )
+{
+    int x = 0;
+    if( d == 1 )
+        for( ; x <= n - 4; x += 4 )
+        {
+            int t0 = p[x], t1 = p[x+1], t2 = p[x+2], t3 = p[x+3];
+            H[0][t0]++; H[1][t1]++; H[2][t2]++; H[3][t3]++;
+        }
+    else
+        for( ; x <= n - 4; x += 4 )
+        {
+            int t0 = p[x*d], t1 = p[(x+1)*d], t2 = p[(x+2)*d], t3 = p[(x+3)*d];
+            H[0][t0]++; H[1][t1]++; H[2][t2]++; H[3][t3]++;
+        }
+
+    for( ; x < n; x++ )
+        H[0][p[x*d]]++;
+}
+
+
 static void
 calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
              Size imsize, Mat& hist, int dims, const float** _ranges,
@@ -442,49 +490,29 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     if( dims == 1 )
     {
         int d0 = deltas[0], step0 = deltas[1];
-        int matH[256] = {0};
+        int matH[4][256];
         const uchar* p0 = (const uchar*)ptrs[0];
 
+        memset( matH, 0, sizeof(matH) );
+
         for( ; imsize.height--; p0 += step0, mask += mstep )
         {
             if( !mask )
             {
-                if( d0 == 1 )
-                {
-                    for( x = 0; x <= imsize.width - 4; x += 4 )
-                    {
-                        int t0 = p0[x], t1 = p0[x+1];
-                        matH[t0]++; matH[t1]++;
-                        t0 = p0[x+2]; t1 = p0[x+3];
-                        matH[t0]++; matH[t1]++;
-                    }
-                    p0 += x;
-                }
-                else
-                    for( x = 0; x <= imsize.width - 4; x += 4 )
-                    {
-                        int t0 = p0[0], t1 = p0[d0];
-                        matH[t0]++; matH[t1]++;
-                        p0 += d0*2;
-                        t0 = p0[0]; t1 = p0[d0];
-                        matH[t0]++; matH[t1]++;
-                        p0 += d0*2;
-                    }
-
-                for( ; x < imsize.width; x++, p0 += d0 )
-                    matH[*p0]++;
+                calcHistRow_8u( p0, imsize.width, d0, matH );
+                p0 += imsize.width*d0;
             }
             else
                 for( x = 0; x < imsize.width; x++, p0 += d0 )
                     if( mask[x] )
-                        matH[*p0]++;
+                        matH[0][*p0]++;
         }
 
         for(int i = 0; i < 256; i++ )
         {
             size_t hidx = tab[i];
             if( hidx < OUT_OF_RANGE )
-                *(int*)(H + hidx) += matH[i];
+                *(int*)(H + hidx) += matH[0][i] + matH[1][i] + matH[2][i] + matH[3][i];
         }
     }
     else if( dims == 2 )
@@ -591,6 +619,57 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     }
 }
 
+
+typedef void (*CalcHistFunc)( vector<uchar*>& ptrs, const vector<int>& deltas,
+                              Size imsize, Mat& hist, int dims, const float** ranges,
+                              const double* uniranges, bool uniform );
+
+// Accumulates the histogram of the image stripes; the bodies created by the splitting constructor
+// collect their own partial histograms that are then added to the original one by join().
+class CalcHistBody
+{
+public:
+    CalcHistBody( CalcHistFunc _func, const vector<uchar*>& _ptrs, const vector<int>& _deltas,
+                  Size _imsize, int _esz1, Mat& _hist, int _dims, const float** _ranges,
+                  const double* _uniranges, bool _uniform )
+        : func(_func), ptrs(&_ptrs), deltas(&_deltas), imsize(_imsize), esz1(_esz1), hist(_hist),
+          dims(_dims), ranges(_ranges), uniranges(_uniranges), uniform(_uniform)
+    {
+    }
+
+    CalcHistBody( const CalcHistBody& b, Split )
+        : func(b.func), ptrs(b.ptrs), deltas(b.deltas), imsize(b.imsize), esz1(b.esz1),
+          hist(b.hist.dims, b.hist.size, b.hist.type(), Scalar::all(0)),
+          dims(b.dims), ranges(b.ranges), uniranges(b.uniranges), uniform(b.uniform)
+    {
+    }
+
+    void operator()( const BlockedRange& range )
+    {
+        vector<uchar*> sptrs;
+        Size ssize;
+        histStripePointers( *ptrs, *deltas, dims, esz1, 1, imsize, range.begin(), range.end(), sptrs, ssize );
+        func( sptrs, *deltas, ssize, hist, dims, ranges, uniranges, uniform );
+    }
+
+    void join( CalcHistBody& b )
+    {
+        add( hist, b.hist, hist );
+    }
+
+private:
+    CalcHistFunc func;
+    const vector<uchar*>* ptrs;
+    const vector<int>* deltas;
+    Size imsize;
+    int esz1;
+    Mat hist;
+    int dims;
+    const float** ranges;
+    const double* uniranges;
+    bool uniform;
+};
+
 }
 
 void cv::calcHist( const Mat* images, int nimages, const int* channels,
@@ -622,16 +701,27 @@ void cv::calcHist( const Mat* images, int nimages, const int* channels,
     const double* _uniranges = uniform ? &uniranges[0] : 0;
 
     int depth = images[0].depth();
+    CalcHistFunc func = 0;
 
     if( depth == CV_8U )
-        calcHist_8u(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        func = calcHist_8u;
     else if( depth == CV_16U )
-        calcHist_<ushort>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        func = calcHist_<ushort>;
     else if( depth == CV_32F )
-        calcHist_<float>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
+        func = calcHist_<float>;
     else
         CV_Error(CV_StsUnsupportedFormat, "");
 
+    CalcHistBody body( func, ptrs, deltas, imsize, (int)images[0].elemSize1(), ihist, dims,
+                       ranges, _uniranges, uniform );
+    BlockedRange range( 0, imsize.height == 1 ? imsize.width : imsize.height );
+
+    // the partial histograms must be small compared to the image
+    if( imsize.area() >= HIST_PARALLEL_MIN_PIXELS && ihist.total() <= (size_t)imsize.area()/16 )
+        parallel_reduce( range, body );
+    else
+        body( range );
+
     ihist.convertTo(hist, CV_32F);
 }
 
@@ -1148,6 +1238,44 @@ calcBackProj_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     }
 }
 
+
+typedef void (*CalcBackProjFunc)( vector<uchar*>& ptrs, const vector<int>& deltas,
+                                  Size imsize, const Mat& hist, int dims, const float** ranges,
+                                  const double* uniranges, float scale, bool uniform );
+
+class CalcBackProjInvoker : public ParallelLoopBody
+{
+public:
+    CalcBackProjInvoker( CalcBackProjFunc _func, const vector<uchar*>& _ptrs, const vector<int>& _deltas,
+                         Size _imsize, int _esz1, const Mat& _hist, int _dims, const float** _ranges,
+                         const double* _uniranges, float _scale, bool _uniform )
+        : func(_func), ptrs(_ptrs), deltas(_deltas), imsize(_imsize), esz1(_esz1), hist(_hist),
+          dims(_dims), ranges(_ranges), uniranges(_uniranges), scale(_scale), uniform(_uniform)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        vector<uchar*> sptrs;
+        Size ssize;
+        histStripePointers( ptrs, deltas, dims, esz1, esz1, imsize, range.start, range.end, sptrs, ssize );
+        func( sptrs, deltas, ssize, hist, dims, ranges, uniranges, scale, uniform );
+    }
+
+private:
+    CalcBackProjFunc func;
+    const vector<uchar*>& ptrs;
+    const vector<int>& deltas;
+    Size imsize;
+    int esz1;
+    const Mat& hist;
+    int dims;
+    const float** ranges;
+    const double* uniranges;
+    float scale;
+    bool uniform;
+};
+
 }
 
 void cv::calcBackProject( const Mat* images, int nimages, const int* channels,
@@ -1169,14 +1297,20 @@ void cv::calcBackProject( const Mat* images, int nimages, const int* channels,
     const double* _uniranges = uniform ? &uniranges[0] : 0;
 
     int depth = images[0].depth();
+    CalcBackProjFunc func = 0;
     if( depth == CV_8U )
-        calcBackProj_8u(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform);
+        func = calcBackProj_8u;
     else if( depth == CV_16U )
-        calcBackProj_<ushort, ushort>(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform );
+        func = calcBackProj_<ushort, ushort>;
     else if( depth == CV_32F )
-        calcBackProj_<float, float>(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform );
+        func = calcBackProj_<float, float>;
     else
         CV_Error(CV_StsUnsupportedFormat, "");
+
+    parallel_for_( Range(0, imsize.height == 1 ? imsize.width : imsize.height),
+                   CalcBackProjInvoker(func, ptrs, deltas, imsize, (int)images[0].elemSize1(), hist, dims,
+                                       ranges, _uniranges, (float)scale, uniform),
+                   (double)imsize.area()/HIST_PARALLEL_MIN_PIXELS );
 }
 
 
@@ -2405,60 +2539,119 @@ cvCalcProbDensity( const CvHistogram* hist, const CvHistogram* hist_mask,
 }
 
 
-CV_IMPL void cvEqualizeHist( const CvArr* srcarr, CvArr* dstarr )
+namespace cv
 {
-    CvMat sstub, *src = cvGetMat(srcarr, &sstub);
-    CvMat dstub, *dst = cvGetMat(dstarr, &dstub);
 
-    CV_Assert( CV_ARE_SIZES_EQ(src, dst) && CV_ARE_TYPES_EQ(src, dst) &&
-               CV_MAT_TYPE(src->type) == CV_8UC1 );
-    CvSize size = cvGetMatSize(src);
-    if( CV_IS_MAT_CONT(src->type & dst->type) )
+class EqualizeHistCalcHistBody
+{
+public:
+    EqualizeHistCalcHistBody( const Mat& _src ) : src(_src)
     {
-        size.width *= size.height;
-        size.height = 1;
+        memset( hist, 0, sizeof(hist) );
     }
-    int x, y;
-    const int hist_sz = 256;
-    int hist[hist_sz];
-    memset(hist, 0, sizeof(hist));
 
-    for( y = 0; y < size.height; y++ )
+    EqualizeHistCalcHistBody( const EqualizeHistCalcHistBody& b, Split ) : src(b.src)
     {
-        const uchar* sptr = src->data.ptr + src->step*y;
-        for( x = 0; x < size.width; x++ )
-            hist[sptr[x]]++;
+        memset( hist, 0, sizeof(hist) );
     }
 
-    float scale = 255.f/(size.width*size.height);
-    int sum = 0;
-    uchar lut[hist_sz+1];
+    void operator()( const BlockedRange& range )
+    {
+        for( int y = range.begin(); y < range.end(); y++ )
+            calcHistRow_8u( src.ptr(y), src.cols, 1, hist );
+    }
 
-    for( int i = 0; i < hist_sz; i++ )
+    void join( EqualizeHistCalcHistBody& b )
     {
-        sum += hist[i];
-        int val = cvRound(sum*scale);
-        lut[i] = CV_CAST_8U(val);
+        for( int k = 0; k < 4; k++ )
+            for( int i = 0; i < 256; i++ )
+                hist[k][i] += b.hist[k][i];
     }
 
-    lut[0] = 0;
-    for( y = 0; y < size.height; y++ )
+    const Mat& src;
+    int hist[4][256];
+};
+
+class EqualizeHistLutInvoker : public ParallelLoopBody
+{
+public:
+    EqualizeHistLutInvoker( const Mat& _src, Mat& _dst, const uchar* _lut )
+        : src(_src), dst(_dst), lut(_lut)
     {
-        const uchar* sptr = src->data.ptr + src->step*y;
-        uchar* dptr = dst->data.ptr + dst->step*y;
-        for( x = 0; x < size.width; x++ )
-            dptr[x] = lut[sptr[x]];
     }
-}
 
+    void operator()( const Range& range ) const
+    {
+        int x, width = src.cols;
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const uchar* sptr = src.ptr(y);
+            uchar* dptr = dst.ptr(y);
+
+            for( x = 0; x <= width - 4; x += 4 )
+            {
+                uchar t0 = lut[sptr[x]], t1 = lut[sptr[x+1]];
+                dptr[x] = t0; dptr[x+1] = t1;
+                t0 = lut[sptr[x+2]]; t1 = lut[sptr[x+3]];
+                dptr[x+2] = t0; dptr[x+3] = t1;
+            }
+            for( ; x < width; x++ )
+                dptr[x] = lut[sptr[x]];
+        }
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    const uchar* lut;
+};
+
+}
 
 void cv::equalizeHist( InputArray _src, OutputArray _dst )
 {
     Mat src = _src.getMat();
+    CV_Assert( src.type() == CV_8UC1 );
+
     _dst.create( src.size(), src.type() );
     Mat dst = _dst.getMat();
-    CvMat _csrc = src, _cdst = dst;
-    cvEqualizeHist( &_csrc, &_cdst );
+
+    if( src.empty() )
+        return;
+
+    const int hist_sz = 256;
+    EqualizeHistCalcHistBody body(src);
+    BlockedRange range(0, src.rows);
+
+    if( (int)src.total() >= HIST_PARALLEL_MIN_PIXELS )
+        parallel_reduce( range, body );
+    else
+        body( range );
+
+    float scale = 255.f/src.total();
+    int sum = 0;
+    uchar lut[hist_sz+1];
+
+    for( int i = 0; i < hist_sz; i++ )
+    {
+        sum += body.hist[0][i] + body.hist[1][i] + body.hist[2][i] + body.hist[3][i];
+        int val = cvRound(sum*scale);
+        lut[i] = saturate_cast<uchar>(val);
+    }
+
+    lut[0] = 0;
+    parallel_for_( Range(0, src.rows), EqualizeHistLutInvoker(src, dst, lut),
+                   (double)src.total()/HIST_PARALLEL_MIN_PIXELS );
+}
+
+
+CV_IMPL void cvEqualizeHist( const CvArr* srcarr, CvArr* dstarr )
+{
+    cv::Mat src = cv::cvarrToMat(srcarr), dst = cv::cvarrToMat(dstarr);
+
+    CV_Assert( src.size() == dst.size() && src.type() == dst.type() );
+    cv::equalizeHist( src, dst );
 }
 
 /* Implementation of RTTI and Generic Functions for CvHistogram */
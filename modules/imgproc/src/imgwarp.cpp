@@ -49,6 +49,12 @@
 #include "precomp.hpp"
 #include <iostream>
 #include <vector>
+#ifdef HAVE_DISPATCH_AVX
+#  include "avx/imgwarp_avx.hpp"
+#endif
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/imgwarp_avx2.hpp"
+#endif
 
 namespace cv
 {
@@ -389,6 +395,9 @@ struct HResizeNoVec
 
 struct VResizeLinearVec_32s8u
 {
+    // the operator is called for every row, so the CPU features are checked once
+    VResizeLinearVec_32s8u() : useAVX2(checkHardwareSupport(CV_CPU_AVX2)) {}
+
     int operator()(const uchar** _src, uchar* dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE2) )
@@ -401,6 +410,11 @@ struct VResizeLinearVec_32s8u
         __m128i b0 = _mm_set1_epi16(beta[0]), b1 = _mm_set1_epi16(beta[1]);
         __m128i delta = _mm_set1_epi16(2);
 
+#ifdef HAVE_DISPATCH_AVX2
+        if( useAVX2 )
+            x = avx2::VResizeLinearVec_32s8u(src, dst, beta, width);
+#endif
+
         if( (((size_t)S0|(size_t)S1)&15) == 0 )
             for( ; x <= width - 16; x += 16 )
             {
@@ -467,6 +481,8 @@ struct VResizeLinearVec_32s8u
 
         return x;
     }
+
+    bool useAVX2;
 };
 
 
@@ -570,6 +586,9 @@ typedef VResizeLinearVec_32f16<0> VResizeLinearVec_32f16s;
 
 struct VResizeLinearVec_32f
 {
+    // the operator is called for every row, so the CPU features are checked once
+    VResizeLinearVec_32f() : useAVX(checkHardwareSupport(CV_CPU_AVX)) {}
+
     int operator()(const uchar** _src, uchar* _dst, const uchar* _beta, int width ) const
     {
         if( !checkHardwareSupport(CV_CPU_SSE) )
@@ -583,6 +602,11 @@ struct VResizeLinearVec_32f
 
         __m128 b0 = _mm_set1_ps(beta[0]), b1 = _mm_set1_ps(beta[1]);
 
+#ifdef HAVE_DISPATCH_AVX
+        if( useAVX )
+            x = avx::VResizeLinearVec_32f(src, dst, beta, width);
+#endif
+
         if( (((size_t)S0|(size_t)S1)&15) == 0 )
             for( ; x <= width - 8; x += 8 )
             {
@@ -616,6 +640,8 @@ struct VResizeLinearVec_32f
 
         return x;
     }
+
+    bool useAVX;
 };
 
 
@@ -914,7 +940,6 @@ struct VResizeLinear
         WT b0 = beta[0], b1 = beta[1];
         const WT *S0 = src[0], *S1 = src[1];
         CastOp castOp;
-        VecOp vecOp;
 
         int x = vecOp((const uchar**)src, (uchar*)dst, (const uchar*)beta, width);
         #if CV_ENABLE_UNROLLED
@@ -932,6 +957,9 @@ struct VResizeLinear
         for( ; x < width; x++ )
             dst[x] = castOp(S0[x]*b0 + S1[x]*b1);
     }
+
+    // it is created once per stripe of the image, not for every row
+    VecOp vecOp;
 };
 
 template<>
@@ -945,7 +973,6 @@ struct VResizeLinear<uchar, int, short, FixedPtCast<int, uchar, INTER_RESIZE_COE
     {
         alpha_type b0 = beta[0], b1 = beta[1];
         const buf_type *S0 = src[0], *S1 = src[1];
-        VResizeLinearVec_32s8u vecOp;
 
         int x = vecOp((const uchar**)src, (uchar*)dst, (const uchar*)beta, width);
         #if CV_ENABLE_UNROLLED
@@ -960,6 +987,8 @@ struct VResizeLinear<uchar, int, short, FixedPtCast<int, uchar, INTER_RESIZE_COE
         for( ; x < width; x++ )
             dst[x] = uchar(( ((b0 * (S0[x] >> 4)) >> 16) + ((b1 * (S1[x] >> 4)) >> 16) + 2)>>2);
     }
+
+    VResizeLinearVec_32s8u vecOp;
 };
 
 
@@ -92,6 +92,11 @@ struct MorphNoVec
     int operator()(uchar**, int, uchar*, int) const { return 0; }
 };
 
+struct MorphUpdateNoVec
+{
+    int operator()(const uchar*, const uchar*, uchar*, int) const { return 0; }
+};
+
 #if CV_SSE2
 
 template<class VecUpdate> struct MorphRowIVec
@@ -402,6 +407,67 @@ template<class VecUpdate> struct MorphColumnFVec
 };
 
 
+template<class VecUpdate> struct MorphUpdateIVec
+{
+    enum { ESZ = VecUpdate::ESZ };
+
+    int operator()(const uchar* src1, const uchar* src2, uchar* dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int i;
+        width *= ESZ;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 32; i += 32 )
+        {
+            __m128i s0 = _mm_loadu_si128((const __m128i*)(src1 + i));
+            __m128i s1 = _mm_loadu_si128((const __m128i*)(src1 + i + 16));
+            __m128i x0 = _mm_loadu_si128((const __m128i*)(src2 + i));
+            __m128i x1 = _mm_loadu_si128((const __m128i*)(src2 + i + 16));
+            _mm_storeu_si128((__m128i*)(dst + i), updateOp(s0, x0));
+            _mm_storeu_si128((__m128i*)(dst + i + 16), updateOp(s1, x1));
+        }
+
+        for( ; i <= width - 8; i += 8 )
+        {
+            __m128i s0 = _mm_loadl_epi64((const __m128i*)(src1 + i));
+            __m128i x0 = _mm_loadl_epi64((const __m128i*)(src2 + i));
+            _mm_storel_epi64((__m128i*)(dst + i), updateOp(s0, x0));
+        }
+
+        return i/ESZ;
+    }
+};
+
+
+template<class VecUpdate> struct MorphUpdateFVec
+{
+    int operator()(const uchar* _src1, const uchar* _src2, uchar* _dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return 0;
+
+        int i;
+        const float* src1 = (const float*)_src1;
+        const float* src2 = (const float*)_src2;
+        float* dst = (float*)_dst;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 8; i += 8 )
+        {
+            __m128 s0 = _mm_loadu_ps(src1 + i), s1 = _mm_loadu_ps(src1 + i + 4);
+            __m128 x0 = _mm_loadu_ps(src2 + i), x1 = _mm_loadu_ps(src2 + i + 4);
+            _mm_storeu_ps(dst + i, updateOp(s0, x0));
+            _mm_storeu_ps(dst + i + 4, updateOp(s1, x1));
+        }
+
+        return i;
+    }
+};
+
+
 template<class VecUpdate> struct MorphIVec
 {
     enum { ESZ = VecUpdate::ESZ };
@@ -573,6 +639,15 @@ typedef MorphColumnIVec<VMax16s> DilateColumnVec16s;
 typedef MorphColumnFVec<VMin32f> ErodeColumnVec32f;
 typedef MorphColumnFVec<VMax32f> DilateColumnVec32f;
 
+typedef MorphUpdateIVec<VMin8u> ErodeUpdateVec8u;
+typedef MorphUpdateIVec<VMax8u> DilateUpdateVec8u;
+typedef MorphUpdateIVec<VMin16u> ErodeUpdateVec16u;
+typedef MorphUpdateIVec<VMax16u> DilateUpdateVec16u;
+typedef MorphUpdateIVec<VMin16s> ErodeUpdateVec16s;
+typedef MorphUpdateIVec<VMax16s> DilateUpdateVec16s;
+typedef MorphUpdateFVec<VMin32f> ErodeUpdateVec32f;
+typedef MorphUpdateFVec<VMax32f> DilateUpdateVec32f;
+
 typedef MorphIVec<VMin8u> ErodeVec8u;
 typedef MorphIVec<VMax8u> DilateVec8u;
 typedef MorphIVec<VMin16u> ErodeVec16u;
@@ -612,6 +687,15 @@ typedef MorphColumnNoVec DilateColumnVec16s;
 typedef MorphColumnNoVec ErodeColumnVec32f;
 typedef MorphColumnNoVec DilateColumnVec32f;
 
+typedef MorphUpdateNoVec ErodeUpdateVec8u;
+typedef MorphUpdateNoVec DilateUpdateVec8u;
+typedef MorphUpdateNoVec ErodeUpdateVec16u;
+typedef MorphUpdateNoVec DilateUpdateVec16u;
+typedef MorphUpdateNoVec ErodeUpdateVec16s;
+typedef MorphUpdateNoVec DilateUpdateVec16s;
+typedef MorphUpdateNoVec ErodeUpdateVec32f;
+typedef MorphUpdateNoVec DilateUpdateVec32f;
+
 typedef MorphNoVec ErodeVec8u;
 typedef MorphNoVec DilateVec8u;
 typedef MorphNoVec ErodeVec16u;
@@ -629,6 +713,8 @@ typedef MorphColumnNoVec ErodeColumnVec64f;
 typedef MorphColumnNoVec DilateColumnVec64f;
 typedef MorphNoVec ErodeVec64f;
 typedef MorphNoVec DilateVec64f;
+typedef MorphUpdateNoVec ErodeUpdateVec64f;
+typedef MorphUpdateNoVec DilateUpdateVec64f;
 
 
 template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
@@ -685,7 +771,7 @@ template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
 };
 
 
-template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilter
+template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     typedef typename Op::rtype T;
 
@@ -695,6 +781,8 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
         anchor = _anchor;
     }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new MorphColumnFilter(*this)); }
+
     void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
     {
         int i, k, _ksize = ksize;
@@ -780,7 +868,139 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
 };
 
 
-template<class Op, class VecOp> struct MorphFilter : BaseFilter
+/*
+   van Herk/Gil-Werman algorithm for the long 1D kernels. The source is split into blocks
+   of ksize elements (rows), so every window covers the suffix of one block and the prefix
+   of the next one. Their running extrema are computed once, and each output element takes
+   about 3 operations, independently of the kernel size.
+   The extrema buffer is kept between the calls, so every parallel stripe needs its own copy.
+*/
+template<class Op, class UpdateVec> struct MorphRowVHGWFilter : public BaseRowFilter, public ClonableFilter<BaseRowFilter>
+{
+    typedef typename Op::rtype T;
+
+    MorphRowVHGWFilter( int _ksize, int _anchor )
+    {
+        ksize = _ksize;
+        anchor = _anchor;
+    }
+
+    Ptr<BaseRowFilter> clone() const { return Ptr<BaseRowFilter>(new MorphRowVHGWFilter(ksize, anchor)); }
+
+    void operator()(const uchar* src, uchar* dst, int width, int cn)
+    {
+        int i, j, i1, kcn = ksize*cn, len = (width + ksize - 1)*cn;
+        const T* S = (const T*)src;
+        T* D = (T*)dst;
+        Op op;
+
+        if( buf.size() < (size_t)len*2 )
+            buf.resize(len*2);
+        T* G = &buf[0];
+        T* H = G + len;
+
+        for( i = 0; i < len; i = i1 )
+        {
+            i1 = std::min(i + kcn, len);
+
+            // prefix extrema
+            for( j = i; j < i + cn; j++ )
+                G[j] = S[j];
+            for( ; j < i1; j++ )
+                G[j] = op(G[j-cn], S[j]);
+
+            // suffix extrema
+            for( j = i1 - 1; j >= i1 - cn; j-- )
+                H[j] = S[j];
+            for( ; j >= i; j-- )
+                H[j] = op(H[j+cn], S[j]);
+        }
+
+        width *= cn;
+        G += kcn - cn;
+        i = updateVec((const uchar*)H, (const uchar*)G, dst, width);
+        for( ; i < width; i++ )
+            D[i] = op(H[i], G[i]);
+    }
+
+    vector<T> buf;
+    UpdateVec updateVec;
+};
+
+
+// The column filter keeps its state between the calls, because FilterEngine passes
+// just a few rows at a time: the suffix extrema of the current block and the running prefix
+// extremum of the next one.
+template<class Op, class UpdateVec> struct MorphColumnVHGWFilter : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
+{
+    typedef typename Op::rtype T;
+
+    MorphColumnVHGWFilter( int _ksize, int _anchor )
+    {
+        ksize = _ksize;
+        anchor = _anchor;
+        pos = 0;
+    }
+
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter(*this)); }
+
+    void reset() { pos = 0; }
+
+    void update(const T* src1, const T* src2, T* dst, int width) const
+    {
+        Op op;
+        int i = updateVec((const uchar*)src1, (const uchar*)src2, (uchar*)dst, width);
+        for( ; i < width; i++ )
+            dst[i] = op(src1[i], src2[i]);
+    }
+
+    void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
+    {
+        const T** src = (const T**)_src;
+        int k, _ksize = ksize;
+        size_t bufstep = alignSize(width*sizeof(T), 16)/sizeof(T);
+
+        if( buf.size() < (_ksize + 1)*bufstep + 16/sizeof(T) )
+        {
+            CV_Assert( pos == 0 );
+            buf.resize((_ksize + 1)*bufstep + 16/sizeof(T));
+        }
+        T* H = alignPtr(&buf[0], 16);
+        T* G = H + _ksize*bufstep;
+
+        // the output row pos of a block uses the suffix extremum H[pos] of the rows
+        // src[0..ksize-1-pos] and the prefix extremum G of the rows src[ksize-pos..ksize-1]
+        for( ; count > 0; count--, src++, dst += dststep )
+        {
+            if( pos == 0 )
+            {
+                T* h = H + (_ksize - 1)*bufstep;
+                memcpy( h, src[_ksize - 1], width*sizeof(T) );
+                for( k = _ksize - 2; k >= 0; k--, h -= bufstep )
+                    update( src[k], h, h - bufstep, width );
+                memcpy( dst, H, width*sizeof(T) );
+            }
+            else
+            {
+                if( pos == 1 )
+                    memcpy( G, src[_ksize - 1], width*sizeof(T) );
+                else
+                    update( G, src[_ksize - 1], G, width );
+                update( H + pos*bufstep, G, (T*)dst, width );
+            }
+
+            if( ++pos == _ksize )
+                pos = 0;
+        }
+    }
+
+    vector<T> buf;
+    int pos;
+    UpdateVec updateVec;
+};
+
+
+template<class Op, class VecOp> struct MorphFilter : BaseFilter, public ClonableFilter<BaseFilter>
 {
     typedef typename Op::rtype T;
 
@@ -796,6 +1016,8 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return Ptr<BaseFilter>(new MorphFilter(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         const Point* pt = &coords[0];
@@ -844,8 +1066,112 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
     VecOp vecOp;
 };
 
+// the minimal kernel size starting from which the van Herk/Gil-Werman filters are faster.
+// The horizontal pass is inherently sequential, so the vectorized direct row filters win for
+// the integer types; the vertical pass is vectorized along the rows in both cases.
+static int getMorphVHGWMinKSize( int depth, bool columns )
+{
+    if( columns )
+        return depth == CV_64F ? 9 : 15;
+#if CV_SSE2
+    if( depth == CV_8U || depth == CV_16U || depth == CV_16S )
+        return INT_MAX;
+#elif defined HAVE_TEGRA_OPTIMIZATION
+    if( depth == CV_8U )
+        return INT_MAX;
+#endif
+    return depth == CV_32F ? 21 : depth == CV_64F ? 11 : 15;
+}
+
+static Ptr<BaseRowFilter> getMorphRowVHGWFilter( int op, int depth, int ksize, int anchor )
+{
+    if( op == MORPH_ERODE )
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<uchar>,
+                                      ErodeUpdateVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<ushort>,
+                                      ErodeUpdateVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<short>,
+                                      ErodeUpdateVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<float>,
+                                      ErodeUpdateVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MinOp<double>,
+                                      ErodeUpdateVec64f>(ksize, anchor));
+    }
+    else
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<uchar>,
+                                      DilateUpdateVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<ushort>,
+                                      DilateUpdateVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<short>,
+                                      DilateUpdateVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<float>,
+                                      DilateUpdateVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseRowFilter>(new MorphRowVHGWFilter<MaxOp<double>,
+                                      DilateUpdateVec64f>(ksize, anchor));
+    }
+
+    CV_Error_( CV_StsNotImplemented, ("Unsupported data type (=%d)", depth));
+    return Ptr<BaseRowFilter>(0);
 }
 
+static Ptr<BaseColumnFilter> getMorphColumnVHGWFilter( int op, int depth, int ksize, int anchor )
+{
+    if( op == MORPH_ERODE )
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<uchar>,
+                                         ErodeUpdateVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<ushort>,
+                                         ErodeUpdateVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<short>,
+                                         ErodeUpdateVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<float>,
+                                         ErodeUpdateVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MinOp<double>,
+                                         ErodeUpdateVec64f>(ksize, anchor));
+    }
+    else
+    {
+        if( depth == CV_8U )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<uchar>,
+                                         DilateUpdateVec8u>(ksize, anchor));
+        if( depth == CV_16U )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<ushort>,
+                                         DilateUpdateVec16u>(ksize, anchor));
+        if( depth == CV_16S )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<short>,
+                                         DilateUpdateVec16s>(ksize, anchor));
+        if( depth == CV_32F )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<float>,
+                                         DilateUpdateVec32f>(ksize, anchor));
+        if( depth == CV_64F )
+            return Ptr<BaseColumnFilter>(new MorphColumnVHGWFilter<MaxOp<double>,
+                                         DilateUpdateVec64f>(ksize, anchor));
+    }
+
+    CV_Error_( CV_StsNotImplemented, ("Unsupported data type (=%d)", depth));
+    return Ptr<BaseColumnFilter>(0);
+}
+
+}
+
+
 /////////////////////////////////// External Interface /////////////////////////////////////
 
 cv::Ptr<cv::BaseRowFilter> cv::getMorphologyRowFilter(int op, int type, int ksize, int anchor)
@@ -854,6 +1180,8 @@ cv::Ptr<cv::BaseRowFilter> cv::getMorphologyRowFilter(int op, int type, int ksiz
     if( anchor < 0 )
         anchor = ksize/2;
     CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
+    if( ksize >= getMorphVHGWMinKSize(depth, false) )
+        return getMorphRowVHGWFilter(op, depth, ksize, anchor);
     if( op == MORPH_ERODE )
     {
         if( depth == CV_8U )
@@ -901,6 +1229,8 @@ cv::Ptr<cv::BaseColumnFilter> cv::getMorphologyColumnFilter(int op, int type, in
     if( anchor < 0 )
         anchor = ksize/2;
     CV_Assert( op == MORPH_ERODE || op == MORPH_DILATE );
+    if( ksize >= getMorphVHGWMinKSize(depth, true) )
+        return getMorphColumnVHGWFilter(op, depth, ksize, anchor);
     if( op == MORPH_ERODE )
     {
         if( depth == CV_8U )
@@ -1081,61 +1411,6 @@ cv::Mat cv::getStructuringElement(int shape, Size ksize, Point anchor)
 namespace cv
 {
 
-class MorphologyRunner
-{
-public:
-    MorphologyRunner(Mat _src, Mat _dst, int _nStripes, int _iterations,
-                     int _op, Mat _kernel, Point _anchor,
-                     int _rowBorderType, int _columnBorderType, const Scalar& _borderValue) :
-        borderValue(_borderValue)
-    {
-        src = _src;
-        dst = _dst;
-
-        nStripes = _nStripes;
-        iterations = _iterations;
-
-        op = _op;
-        kernel = _kernel;
-        anchor = _anchor;
-        rowBorderType = _rowBorderType;
-        columnBorderType = _columnBorderType;
-    }
-
-    void operator () ( const BlockedRange& range ) const
-    {
-        int row0 = min(cvRound(range.begin() * src.rows / nStripes), src.rows);
-        int row1 = min(cvRound(range.end() * src.rows / nStripes), src.rows);
-
-        /*if(0)
-            printf("Size = (%d, %d), range[%d,%d), row0 = %d, row1 = %d\n",
-                   src.rows, src.cols, range.begin(), range.end(), row0, row1);*/
-
-        Mat srcStripe = src.rowRange(row0, row1);
-        Mat dstStripe = dst.rowRange(row0, row1);
-
-        Ptr<FilterEngine> f = createMorphologyFilter(op, src.type(), kernel, anchor,
-                                                     rowBorderType, columnBorderType, borderValue );
-
-        f->apply( srcStripe, dstStripe );
-        for( int i = 1; i < iterations; i++ )
-            f->apply( dstStripe, dstStripe );
-    }
-
-private:
-    Mat src;
-    Mat dst;
-    int nStripes;
-    int iterations;
-
-    int op;
-    Mat kernel;
-    Point anchor;
-    int rowBorderType;
-    int columnBorderType;
-    Scalar borderValue;
-};
-
 static void morphOp( int op, InputArray _src, OutputArray _dst,
                      InputArray _kernel,
                      Point anchor, int iterations,
@@ -1172,23 +1447,52 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
         iterations = 1;
     }
 
-    int nStripes = 1;
-#if defined HAVE_TBB && defined HAVE_TEGRA_OPTIMIZATION
-    if (src.data != dst.data && iterations == 1 &&  //NOTE: threads are not used for inplace processing
-        (borderType & BORDER_ISOLATED) == 0 && //TODO: check border types
-        src.rows >= 64 ) //NOTE: just heuristics
-        nStripes = 4;
-#endif
+    Ptr<FilterEngine> f = createMorphologyFilter(op, src.type(), kernel, anchor,
+                                                 borderType, borderType, borderValue );
 
-    parallel_for(BlockedRange(0, nStripes),
-                 MorphologyRunner(src, dst, nStripes, iterations, op, kernel, anchor, borderType, borderType, borderValue));
+    // FilterEngine::apply processes large images by parallel bands, but only when the source
+    // and the destination do not overlap, so the in-place passes are run from a copy
+    bool parallel = getNumThreads() > 1 && (double)src.rows*src.cols >= (1 << 16);
+    Mat temp;
 
-    //Ptr<FilterEngine> f = createMorphologyFilter(op, src.type(),
-    //                                             kernel, anchor, borderType, borderType, borderValue );
+    for( int i = 0; i < iterations; i++ )
+    {
+        const Mat& s = i == 0 ? src : dst;
+        if( parallel && s.dataend > dst.datastart && dst.dataend > s.datastart )
+        {
+            s.copyTo(temp);
+            f->apply( temp, dst );
+        }
+        else
+            f->apply( s, dst );
+    }
+}
 
-    //f->apply( src, dst );
-    //for( int i = 1; i < iterations; i++ )
-    //    f->apply( dst, dst );
+// dst = src1 - src2, computed by horizontal bands
+class MorphSubtractInvoker : public ParallelLoopBody
+{
+public:
+    MorphSubtractInvoker(const Mat& _src1, const Mat& _src2, Mat& _dst) :
+        src1(&_src1), src2(&_src2), dst(&_dst)
+    {
+    }
+
+    void operator () ( const Range& range ) const
+    {
+        Mat d = dst->rowRange(range.start, range.end);
+        subtract( src1->rowRange(range.start, range.end), src2->rowRange(range.start, range.end), d );
+    }
+
+private:
+    const Mat* src1;
+    const Mat* src2;
+    Mat* dst;
+};
+
+static void morphSubtract( const Mat& src1, const Mat& src2, Mat& dst )
+{
+    parallel_for_(Range(0, dst.rows), MorphSubtractInvoker(src1, src2, dst),
+                  (double)dst.rows*dst.cols/(1 << 16));
 }
 
 template<> void Ptr<IplConvKernel>::delete_obj()
@@ -1239,21 +1543,21 @@ void cv::morphologyEx( InputArray _src, OutputArray _dst, int op,
     case CV_MOP_GRADIENT:
         erode( src, temp, kernel, anchor, iterations, borderType, borderValue );
         dilate( src, dst, kernel, anchor, iterations, borderType, borderValue );
-        dst -= temp;
+        morphSubtract( dst, temp, dst );
         break;
     case CV_MOP_TOPHAT:
         if( src.data != dst.data )
             temp = dst;
         erode( src, temp, kernel, anchor, iterations, borderType, borderValue );
         dilate( temp, temp, kernel, anchor, iterations, borderType, borderValue );
-        dst = src - temp;
+        morphSubtract( src, temp, dst );
         break;
     case CV_MOP_BLACKHAT:
         if( src.data != dst.data )
             temp = dst;
         dilate( src, temp, kernel, anchor, iterations, borderType, borderValue );
         erode( temp, temp, kernel, anchor, iterations, borderType, borderValue );
-        dst = temp - src;
+        morphSubtract( temp, src, dst );
         break;
     default:
         CV_Error( CV_StsBadArg, "unknown morphological operation" );
@@ -0,0 +1,318 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "precomp.hpp"
+
+/****************************************************************************************\
+*                              Point-wise row operations                                *
+\****************************************************************************************/
+
+namespace cv
+{
+
+BaseRowOp::BaseRowOp() { srcType = dstType = -1; nsrc = 1; }
+BaseRowOp::~BaseRowOp() {}
+
+struct MagnitudeRowOp : public BaseRowOp
+{
+    MagnitudeRowOp( int _srcType, bool _L2gradient )
+    {
+        CV_Assert( CV_MAT_DEPTH(_srcType) == CV_16S || CV_MAT_DEPTH(_srcType) == CV_32F );
+        srcType = _srcType;
+        dstType = CV_MAKETYPE(CV_32F, CV_MAT_CN(_srcType));
+        nsrc = 2;
+        L2gradient = _L2gradient;
+    }
+
+    void operator()(const uchar** src, uchar* _dst, int width)
+    {
+        int i, len = width*CV_MAT_CN(srcType);
+        float* dst = (float*)_dst;
+
+        if( CV_MAT_DEPTH(srcType) == CV_32F )
+        {
+            const float* dx = (const float*)src[0];
+            const float* dy = (const float*)src[1];
+            if( L2gradient )
+            {
+                Mat m(1, len, CV_32F, dst);
+                magnitude(Mat(1, len, CV_32F, (void*)dx), Mat(1, len, CV_32F, (void*)dy), m);
+            }
+            else
+                for( i = 0; i < len; i++ )
+                    dst[i] = std::abs(dx[i]) + std::abs(dy[i]);
+        }
+        else
+        {
+            const short* dx = (const short*)src[0];
+            const short* dy = (const short*)src[1];
+            if( L2gradient )
+                for( i = 0; i < len; i++ )
+                {
+                    float x = dx[i], y = dy[i];
+                    dst[i] = std::sqrt(x*x + y*y);
+                }
+            else
+                for( i = 0; i < len; i++ )
+                    dst[i] = (float)(std::abs(dx[i]) + std::abs(dy[i]));
+        }
+    }
+
+    bool L2gradient;
+};
+
+struct ConvertRowOp : public BaseRowOp
+{
+    ConvertRowOp( int _srcType, int _dstType, double _alpha, double _beta )
+    {
+        CV_Assert( CV_MAT_CN(_srcType) == CV_MAT_CN(_dstType) );
+        srcType = _srcType;
+        dstType = _dstType;
+        alpha = _alpha;
+        beta = _beta;
+    }
+
+    void operator()(const uchar** src, uchar* dst, int width)
+    {
+        Mat d(1, width, dstType, dst);
+        Mat(1, width, srcType, (void*)src[0]).convertTo(d, dstType, alpha, beta);
+        CV_DbgAssert( d.data == dst );
+    }
+
+    double alpha, beta;
+};
+
+}
+
+cv::Ptr<cv::BaseRowOp> cv::getMagnitudeRowOp(int srcType, bool L2gradient)
+{
+    return Ptr<BaseRowOp>(new MagnitudeRowOp(srcType, L2gradient));
+}
+
+cv::Ptr<cv::BaseRowOp> cv::getConvertRowOp(int srcType, int dstType, double alpha, double beta)
+{
+    return Ptr<BaseRowOp>(new ConvertRowOp(srcType, dstType, alpha, beta));
+}
+
+/****************************************************************************************\
+*                                    Filter pipeline                                     *
+\****************************************************************************************/
+
+namespace cv
+{
+
+FilterPipeline::FilterPipeline() {}
+FilterPipeline::~FilterPipeline() {}
+
+void FilterPipeline::addFilter(const Ptr<FilterEngine>& f)
+{
+    CV_Assert( !f.empty() && (stages.empty() || f->srcType == dstType()) );
+    Stage s;
+    s.filter[0] = f;
+    s.srcType = f->srcType;
+    s.dstType = f->dstType;
+    stages.push_back(s);
+}
+
+void FilterPipeline::addFilterPair(const Ptr<FilterEngine>& f1, const Ptr<FilterEngine>& f2,
+                                   const Ptr<BaseRowOp>& op)
+{
+    CV_Assert( !f1.empty() && !f2.empty() && !op.empty() && op->nsrc == 2 &&
+               f1->srcType == f2->srcType && f1->dstType == op->srcType &&
+               f2->dstType == op->srcType && (stages.empty() || f1->srcType == dstType()) );
+    Stage s;
+    s.filter[0] = f1;
+    s.filter[1] = f2;
+    s.op = op;
+    s.srcType = f1->srcType;
+    s.dstType = op->dstType;
+    stages.push_back(s);
+}
+
+void FilterPipeline::addRowOp(const Ptr<BaseRowOp>& op)
+{
+    CV_Assert( !op.empty() && op->nsrc == 1 && (stages.empty() || op->srcType == dstType()) );
+    Stage s;
+    s.op = op;
+    s.srcType = op->srcType;
+    s.dstType = op->dstType;
+    stages.push_back(s);
+}
+
+void FilterPipeline::clear() { stages.clear(); }
+bool FilterPipeline::empty() const { return stages.empty(); }
+int FilterPipeline::srcType() const { return stages.empty() ? -1 : stages[0].srcType; }
+int FilterPipeline::dstType() const { return stages.empty() ? -1 : stages.back().dstType; }
+
+// Pushes the rows through the stages. Every stage outputs as many rows as it can
+// and immediately passes them to the next one, so the stage buffers need to hold
+// only the rows produced from a single strip (plus the rows delayed by the filters).
+class FilterPipelineRunner
+{
+public:
+    FilterPipelineRunner( vector<FilterPipeline::Stage>& _stages, Mat& _dst, int stripRows )
+        : stages(_stages), dst(_dst)
+    {
+        int k, nstages = (int)stages.size(), maxDelay = 0;
+        Size size = dst.size();
+
+        for( k = 0; k < nstages; k++ )
+            for( int j = 0; j < 2; j++ )
+                if( !stages[k].filter[j].empty() )
+                {
+                    FilterEngine& f = *stages[k].filter[j];
+                    f.start(size, Rect(0, 0, size.width, size.height));
+                    maxDelay += f.ksize.height - 1;
+                }
+
+        // a filter outputs at most as many rows as it gets plus the rows it delayed before
+        int maxRows = stripRows + maxDelay;
+        buf.resize(nstages);
+        pairBuf.resize(nstages*2);
+        pairCount.resize(nstages*2, 0);
+        for( k = 0; k < nstages; k++ )
+        {
+            const FilterPipeline::Stage& s = stages[k];
+            if( k < nstages - 1 )
+                buf[k].create(maxRows, size.width, s.dstType);
+            if( !s.op.empty() && !s.filter[0].empty() )
+                for( int j = 0; j < 2; j++ )
+                    pairBuf[k*2+j].create(maxRows + maxDelay, size.width, s.filter[j]->dstType);
+        }
+        dstY = 0;
+    }
+
+    void push( int k, const uchar* src, size_t srcstep, int count )
+    {
+        if( count <= 0 )
+            return;
+
+        FilterPipeline::Stage& s = stages[k];
+        bool last = k == (int)stages.size() - 1;
+        uchar* out = last ? dst.ptr(dstY) : buf[k].data;
+        size_t outstep = last ? dst.step : buf[k].step;
+        int i, j, width = dst.cols, dy;
+
+        if( s.op.empty() )
+            dy = s.filter[0]->proceed(src, (int)srcstep, count, out, (int)outstep);
+        else if( s.filter[0].empty() )
+        {
+            for( i = 0; i < count; i++ )
+            {
+                const uchar* row = src + srcstep*i;
+                (*s.op)(&row, out + outstep*i, width);
+            }
+            dy = count;
+        }
+        else
+        {
+            // the two filters may have different delays, so their outputs are queued
+            // and combined when both are available
+            Mat* pb = &pairBuf[k*2];
+            int* pc = &pairCount[k*2];
+            for( j = 0; j < 2; j++ )
+                pc[j] += s.filter[j]->proceed(src, (int)srcstep, count, pb[j].ptr(pc[j]), (int)pb[j].step);
+
+            dy = std::min(pc[0], pc[1]);
+            for( i = 0; i < dy; i++ )
+            {
+                const uchar* rows[] = { pb[0].ptr(i), pb[1].ptr(i) };
+                (*s.op)(rows, out + outstep*i, width);
+            }
+
+            for( j = 0; j < 2; j++ )
+            {
+                pc[j] -= dy;
+                if( pc[j] > 0 )
+                    memmove(pb[j].data, pb[j].ptr(dy), pb[j].step*pc[j]);
+            }
+        }
+
+        if( last )
+            dstY += dy;
+        else
+            push(k + 1, out, outstep, dy);
+    }
+
+    int dstY;
+
+private:
+    vector<FilterPipeline::Stage>& stages;
+    Mat& dst;
+    vector<Mat> buf;
+    vector<Mat> pairBuf;
+    vector<int> pairCount;
+};
+
+void FilterPipeline::apply(InputArray _src, OutputArray _dst, int stripRows)
+{
+    Mat src = _src.getMat();
+    CV_Assert( !stages.empty() && src.type() == srcType() );
+
+    _dst.create(src.size(), dstType());
+    Mat dst = _dst.getMat();
+    if( src.empty() )
+        return;
+
+    // the stages read the source rows after the previous strips are written
+    if( src.data == dst.data )
+        src = src.clone();
+
+    if( stripRows <= 0 )
+    {
+        // keep the intermediate strips within a typical L2 cache
+        size_t rowSize = 0;
+        for( size_t k = 0; k < stages.size(); k++ )
+            rowSize += (stages[k].op.empty() || stages[k].filter[0].empty() ? 1 : 3)*
+                dst.cols*CV_ELEM_SIZE(stages[k].dstType);
+        stripRows = std::max((int)((1 << 18)/std::max(rowSize, (size_t)1)), 4);
+    }
+    stripRows = std::min(stripRows, src.rows);
+
+    FilterPipelineRunner runner(stages, dst, stripRows);
+    for( int y = 0; y < src.rows; y += stripRows )
+        runner.push(0, src.ptr(y), src.step, std::min(stripRows, src.rows - y));
+
+    CV_Assert( runner.dstY == dst.rows );
+}
+
+}
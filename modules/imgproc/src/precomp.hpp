@@ -97,6 +97,29 @@ void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Point anchor=Point(0,0), double delta=0,
                 int borderType=BORDER_REFLECT_101 );
 
+/*
+   Implemented by the filters that can be copied, so that FilterEngine::apply() can process
+   horizontal stripes of the image in parallel, each with its own copy of the filter state.
+   It is a separate interface, so that the vtables of the public filter classes are unchanged.
+*/
+template<typename FilterType> struct ClonableFilter
+{
+    virtual ~ClonableFilter() {}
+    virtual Ptr<FilterType> clone() const = 0;
+};
+
+template<typename FilterType> static inline bool isClonableFilter( const Ptr<FilterType>& f )
+{
+    return dynamic_cast<const ClonableFilter<FilterType>*>((const FilterType*)f) != 0;
+}
+
+// returns a copy of the filter, or an empty pointer if the filter can not be copied
+template<typename FilterType> static inline Ptr<FilterType> cloneFilter( const Ptr<FilterType>& f )
+{
+    const ClonableFilter<FilterType>* c = dynamic_cast<const ClonableFilter<FilterType>*>((const FilterType*)f);
+    return c ? c->clone() : Ptr<FilterType>();
+}
+
 }
 
 typedef struct CvPyramid
@@ -177,227 +177,470 @@ struct PyrDownVec_32f
     }
 };
 
+struct PyrUpVec_32s8u
+{
+    int operator()(int** src, uchar** dst, int, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        uchar *dst0 = dst[0], *dst1 = dst[1];
+        const int *row0 = src[0], *row1 = src[1], *row2 = src[2];
+        __m128i delta = _mm_set1_epi16(32), z = _mm_setzero_si128();
+
+        // the horizontal sums do not exceed 255*8, so the vertical ones fit into 16 bits
+        for( ; x <= width - 16; x += 16 )
+        {
+            __m128i r0, r1, r2, t0, t1, t2, t3;
+            r0 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row0 + x)),
+                                 _mm_load_si128((const __m128i*)(row0 + x + 4)));
+            r1 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row1 + x)),
+                                 _mm_load_si128((const __m128i*)(row1 + x + 4)));
+            r2 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row2 + x)),
+                                 _mm_load_si128((const __m128i*)(row2 + x + 4)));
+            t0 = _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_add_epi16(_mm_slli_epi16(r1, 2), _mm_slli_epi16(r1, 1)));
+            t1 = _mm_slli_epi16(_mm_add_epi16(r1, r2), 2);
+
+            r0 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row0 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row0 + x + 12)));
+            r1 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row1 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row1 + x + 12)));
+            r2 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row2 + x + 8)),
+                                 _mm_load_si128((const __m128i*)(row2 + x + 12)));
+            t2 = _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_add_epi16(_mm_slli_epi16(r1, 2), _mm_slli_epi16(r1, 1)));
+            t3 = _mm_slli_epi16(_mm_add_epi16(r1, r2), 2);
+
+            t0 = _mm_srli_epi16(_mm_add_epi16(t0, delta), 6);
+            t1 = _mm_srli_epi16(_mm_add_epi16(t1, delta), 6);
+            t2 = _mm_srli_epi16(_mm_add_epi16(t2, delta), 6);
+            t3 = _mm_srli_epi16(_mm_add_epi16(t3, delta), 6);
+            // dst1 may be the same row as dst0, and then dst0 must win
+            _mm_storeu_si128((__m128i*)(dst1 + x), _mm_packus_epi16(t1, t3));
+            _mm_storeu_si128((__m128i*)(dst0 + x), _mm_packus_epi16(t0, t2));
+        }
+
+        for( ; x <= width - 4; x += 4 )
+        {
+            __m128i r0, r1, r2, t0, t1;
+            r0 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row0 + x)), z);
+            r1 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row1 + x)), z);
+            r2 = _mm_packs_epi32(_mm_load_si128((const __m128i*)(row2 + x)), z);
+            t0 = _mm_add_epi16(_mm_add_epi16(r0, r2), _mm_add_epi16(_mm_slli_epi16(r1, 2), _mm_slli_epi16(r1, 1)));
+            t1 = _mm_slli_epi16(_mm_add_epi16(r1, r2), 2);
+            t0 = _mm_srli_epi16(_mm_add_epi16(t0, delta), 6);
+            t1 = _mm_srli_epi16(_mm_add_epi16(t1, delta), 6);
+            *(int*)(dst1 + x) = _mm_cvtsi128_si32(_mm_packus_epi16(t1, t1));
+            *(int*)(dst0 + x) = _mm_cvtsi128_si32(_mm_packus_epi16(t0, t0));
+        }
+
+        return x;
+    }
+};
+
+struct PyrUpVec_32f
+{
+    int operator()(float** src, float** dst, int, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return 0;
+
+        int x = 0;
+        float *dst0 = dst[0], *dst1 = dst[1];
+        const float *row0 = src[0], *row1 = src[1], *row2 = src[2];
+        __m128 _4 = _mm_set1_ps(4.f), _6 = _mm_set1_ps(6.f), _scale = _mm_set1_ps(1.f/64);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128 r0, r1, r2, t0, t1, t2, t3;
+            r0 = _mm_load_ps(row0 + x);
+            r1 = _mm_load_ps(row1 + x);
+            r2 = _mm_load_ps(row2 + x);
+            t0 = _mm_add_ps(_mm_add_ps(r0, _mm_mul_ps(r1, _6)), r2);
+            t1 = _mm_mul_ps(_mm_add_ps(r1, r2), _4);
+
+            r0 = _mm_load_ps(row0 + x + 4);
+            r1 = _mm_load_ps(row1 + x + 4);
+            r2 = _mm_load_ps(row2 + x + 4);
+            t2 = _mm_add_ps(_mm_add_ps(r0, _mm_mul_ps(r1, _6)), r2);
+            t3 = _mm_mul_ps(_mm_add_ps(r1, r2), _4);
+
+            _mm_storeu_ps(dst1 + x, _mm_mul_ps(t1, _scale));
+            _mm_storeu_ps(dst1 + x + 4, _mm_mul_ps(t3, _scale));
+            _mm_storeu_ps(dst0 + x, _mm_mul_ps(t0, _scale));
+            _mm_storeu_ps(dst0 + x + 4, _mm_mul_ps(t2, _scale));
+        }
+
+        return x;
+    }
+};
+
 #else
 
 typedef NoVec<int, uchar> PyrDownVec_32s8u;
 typedef NoVec<float, float> PyrDownVec_32f;
+typedef NoVec<int, uchar*> PyrUpVec_32s8u;
+typedef NoVec<float, float*> PyrUpVec_32f;
 
 #endif
 
-template<class CastOp, class VecOp> void
-pyrDown_( const Mat& _src, Mat& _dst, int borderType )
+/*
+   Computes the rows of pyrDown() result one by one, starting from the specified row.
+   The horizontally filtered and decimated source rows are kept in a ring buffer,
+   so every source row is processed once within a sequence of operator() calls.
+*/
+template<class CastOp, class VecOp> class PyrDownRows
 {
-    const int PD_SZ = 5;
+public:
     typedef typename CastOp::type1 WT;
     typedef typename CastOp::rtype T;
+    enum { PD_SZ = 5 };
 
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
-    int bufstep = (int)alignSize(dsize.width*cn, 16);
-    AutoBuffer<WT> _buf(bufstep*PD_SZ + 16);
-    WT* buf = alignPtr((WT*)_buf, 16);
-    int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
-    AutoBuffer<int> _tabM(dsize.width*cn);
-    int* tabM = _tabM;
-    WT* rows[PD_SZ];
-    CastOp castOp;
-    VecOp vecOp;
-
-    CV_Assert( std::abs(dsize.width*2 - ssize.width) <= 2 &&
-               std::abs(dsize.height*2 - ssize.height) <= 2 );
-    int k, x, sy0 = -PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
-
-    for( x = 0; x <= PD_SZ+1; x++ )
+    PyrDownRows( const Mat& _src, Mat& _dst, int _borderType, int _y )
+        : src(_src), dst(_dst), borderType(_borderType), y(_y)
     {
-        int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, borderType)*cn;
-        int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, borderType)*cn;
-        for( k = 0; k < cn; k++ )
+        Size ssize = src.size(), dsize = dst.size();
+        cn = src.channels();
+        bufstep = (int)alignSize(dsize.width*cn, 16);
+        _buf.allocate(bufstep*PD_SZ + 16);
+        buf = alignPtr((WT*)_buf, 16);
+        _tabM.allocate(dsize.width*cn);
+
+        CV_Assert( std::abs(dsize.width*2 - ssize.width) <= 2 &&
+                   std::abs(dsize.height*2 - ssize.height) <= 2 );
+        int k, x;
+        width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
+
+        for( x = 0; x <= PD_SZ+1; x++ )
         {
-            tabL[x*cn + k] = sx0 + k;
-            tabR[x*cn + k] = sx1 + k;
+            int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, borderType)*cn;
+            int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, borderType)*cn;
+            for( k = 0; k < cn; k++ )
+            {
+                tabL[x*cn + k] = sx0 + k;
+                tabR[x*cn + k] = sx1 + k;
+            }
         }
-    }
 
-    ssize.width *= cn;
-    dsize.width *= cn;
-    width0 *= cn;
+        width0 *= cn;
+        for( x = 0; x < dsize.width*cn; x++ )
+            _tabM[x] = (x/cn)*2*cn + x % cn;
 
-    for( x = 0; x < dsize.width; x++ )
-        tabM[x] = (x/cn)*2*cn + x % cn;
+        sy0 = sy = y*2 - PD_SZ/2;
+    }
 
-    for( int y = 0; y < dsize.height; y++ )
+    // computes the destination rows up to y1 (exclusive); the source rows
+    // up to y1*2 (or their border extrapolations) are read
+    void operator()( int y1 )
     {
-        T* dst = (T*)(_dst.data + _dst.step*y);
-        WT *row0, *row1, *row2, *row3, *row4;
+        int k, x, ssheight = src.rows, dwidth = dst.cols*cn;
+        const int* tabM = _tabM;
+        WT* rows[PD_SZ];
+        CastOp castOp;
+        VecOp vecOp;
 
-        // fill the ring buffer (horizontal convolution and decimation)
-        for( ; sy <= y*2 + 2; sy++ )
+        for( ; y < y1; y++ )
         {
-            WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
-            int _sy = borderInterpolate(sy, ssize.height, borderType);
-            const T* src = (const T*)(_src.data + _src.step*_sy);
-            int limit = cn;
-            const int* tab = tabL;
+            T* dstrow = (T*)(dst.data + dst.step*y);
+            WT *row0, *row1, *row2, *row3, *row4;
 
-            for( x = 0;;)
+            // fill the ring buffer (horizontal convolution and decimation)
+            for( ; sy <= y*2 + 2; sy++ )
             {
-                for( ; x < limit; x++ )
+                WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
+                int _sy = borderInterpolate(sy, ssheight, borderType);
+                const T* srow = (const T*)(src.data + src.step*_sy);
+                int limit = cn;
+                const int* tab = tabL;
+
+                for( x = 0;;)
                 {
-                    row[x] = src[tab[x+cn*2]]*6 + (src[tab[x+cn]] + src[tab[x+cn*3]])*4 +
-                        src[tab[x]] + src[tab[x+cn*4]];
-                }
+                    for( ; x < limit; x++ )
+                    {
+                        row[x] = srow[tab[x+cn*2]]*6 + (srow[tab[x+cn]] + srow[tab[x+cn*3]])*4 +
+                            srow[tab[x]] + srow[tab[x+cn*4]];
+                    }
 
-                if( x == dsize.width )
-                    break;
+                    if( x == dwidth )
+                        break;
 
-                if( cn == 1 )
-                {
-                    for( ; x < width0; x++ )
-                        row[x] = src[x*2]*6 + (src[x*2 - 1] + src[x*2 + 1])*4 +
-                            src[x*2 - 2] + src[x*2 + 2];
-                }
-                else if( cn == 3 )
-                {
-                    for( ; x < width0; x += 3 )
+                    if( cn == 1 )
                     {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
-                        WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
-                        WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
-                        row[x] = t0; row[x+1] = t1; row[x+2] = t2;
+                        for( ; x < width0; x++ )
+                            row[x] = srow[x*2]*6 + (srow[x*2 - 1] + srow[x*2 + 1])*4 +
+                                srow[x*2 - 2] + srow[x*2 + 2];
                     }
-                }
-                else if( cn == 4 )
-                {
-                    for( ; x < width0; x += 4 )
+                    else if( cn == 3 )
                     {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
-                        WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
-                        row[x] = t0; row[x+1] = t1;
-                        t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
-                        t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
-                        row[x+2] = t0; row[x+3] = t1;
+                        for( ; x < width0; x += 3 )
+                        {
+                            const T* s = srow + x*2;
+                            WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
+                            WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
+                            WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
+                            row[x] = t0; row[x+1] = t1; row[x+2] = t2;
+                        }
                     }
-                }
-                else
-                {
-                    for( ; x < width0; x++ )
+                    else if( cn == 4 )
                     {
-                        int sx = tabM[x];
-                        row[x] = src[sx]*6 + (src[sx - cn] + src[sx + cn])*4 +
-                            src[sx - cn*2] + src[sx + cn*2];
+                        for( ; x < width0; x += 4 )
+                        {
+                            const T* s = srow + x*2;
+                            WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
+                            WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
+                            row[x] = t0; row[x+1] = t1;
+                            t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
+                            t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
+                            row[x+2] = t0; row[x+3] = t1;
+                        }
+                    }
+                    else
+                    {
+                        for( ; x < width0; x++ )
+                        {
+                            int sx = tabM[x];
+                            row[x] = srow[sx]*6 + (srow[sx - cn] + srow[sx + cn])*4 +
+                                srow[sx - cn*2] + srow[sx + cn*2];
+                        }
                     }
-                }
 
-                limit = dsize.width;
-                tab = tabR - x;
+                    limit = dwidth;
+                    tab = tabR - x;
+                }
             }
-        }
 
-        // do vertical convolution and decimation and write the result to the destination image
-        for( k = 0; k < PD_SZ; k++ )
-            rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
-        row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
+            // do vertical convolution and decimation and write the result to the destination image
+            for( k = 0; k < PD_SZ; k++ )
+                rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
+            row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
+
+            x = vecOp(rows, dstrow, (int)dst.step, dwidth);
+            for( ; x < dwidth; x++ )
+                dstrow[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
+        }
+    }
 
-        x = vecOp(rows, dst, (int)_dst.step, dsize.width);
-        for( ; x < dsize.width; x++ )
-            dst[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
+    // the number of the destination rows that can be computed when the first n source rows are ready
+    static int readyRows( int n, int srows, int drows )
+    {
+        return n >= srows ? drows : std::min(std::max((n - 1)/2, 0), drows);
     }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    int borderType;
+    int cn, bufstep, width0, sy0, sy;
+    AutoBuffer<WT> _buf;
+    WT* buf;
+    AutoBuffer<int> _tabM;
+    int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
+
+public:
+    //! the next destination row
+    int y;
+};
+
+// the number of horizontal bands the pyramid level of the given size is split into
+static int getPyrStripes( const Mat& dst )
+{
+    int nthreads = getNumThreads();
+    return nthreads > 1 ? std::max(std::min(dst.rows/16, nthreads*2), 1) : 1;
 }
 
+template<class CastOp, class VecOp> class PyrDownInvoker : public ParallelLoopBody
+{
+public:
+    PyrDownInvoker( const Mat& _src, Mat& _dst, int _borderType )
+        : src(_src), dst(_dst), borderType(_borderType)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        PyrDownRows<CastOp, VecOp> rows(src, dst, borderType, range.start);
+        rows(range.end);
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+    int borderType;
+};
+
+template<class CastOp, class VecOp> void
+pyrDown_( const Mat& _src, Mat& _dst, int borderType )
+{
+    parallel_for_(Range(0, _dst.rows), PyrDownInvoker<CastOp, VecOp>(_src, _dst, borderType),
+                  getPyrStripes(_dst));
+}
 
+/*
+   Computes all the pyramid levels in a single pass over the source image: as soon as
+   a few more rows of a level are ready, the rows of the next level that depend on them are
+   computed, while the data is still in cache.
+*/
 template<class CastOp, class VecOp> void
-pyrUp_( const Mat& _src, Mat& _dst, int)
+buildPyramid_( const Mat* levels, int maxlevel, int borderType )
+{
+    std::vector<Ptr<PyrDownRows<CastOp, VecOp> > > rows(maxlevel + 1);
+    int i;
+
+    for( i = 1; i <= maxlevel; i++ )
+        rows[i] = new PyrDownRows<CastOp, VecOp>(levels[i-1], (Mat&)levels[i], borderType, 0);
+
+    while( rows[1]->y < levels[1].rows )
+    {
+        (*rows[1])(rows[1]->y + 1);
+        for( i = 2; i <= maxlevel; i++ )
+        {
+            int y1 = PyrDownRows<CastOp, VecOp>::readyRows(rows[i-1]->y, levels[i-1].rows, levels[i].rows);
+            if( y1 <= rows[i]->y )
+                break;
+            (*rows[i])(y1);
+        }
+    }
+}
+
+/*
+   Computes the pairs of pyrUp() result rows that correspond to the source rows
+   starting from the specified one.
+*/
+template<class CastOp, class VecOp> class PyrUpRows
 {
-    const int PU_SZ = 3;
+public:
     typedef typename CastOp::type1 WT;
     typedef typename CastOp::rtype T;
+    enum { PU_SZ = 3 };
 
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
-    int bufstep = (int)alignSize((dsize.width+1)*cn, 16);
-    AutoBuffer<WT> _buf(bufstep*PU_SZ + 16);
-    WT* buf = alignPtr((WT*)_buf, 16);
-    AutoBuffer<int> _dtab(ssize.width*cn);
-    int* dtab = _dtab;
-    WT* rows[PU_SZ];
-    CastOp castOp;
-    VecOp vecOp;
-
-    CV_Assert( std::abs(dsize.width - ssize.width*2) == dsize.width % 2 &&
-               std::abs(dsize.height - ssize.height*2) == dsize.height % 2);
-    int k, x, sy0 = -PU_SZ/2, sy = sy0, width0 = ssize.width - 1;
-
-    ssize.width *= cn;
-    dsize.width *= cn;
-    width0 *= cn;
-
-    for( x = 0; x < ssize.width; x++ )
-        dtab[x] = (x/cn)*2*cn + x % cn;
-
-    for( int y = 0; y < ssize.height; y++ )
+    PyrUpRows( const Mat& _src, Mat& _dst, int _y ) : src(_src), dst(_dst), y(_y)
     {
-        T* dst0 = (T*)(_dst.data + _dst.step*y*2);
-        T* dst1 = (T*)(_dst.data + _dst.step*(y*2+1));
-        WT *row0, *row1, *row2;
+        Size ssize = src.size(), dsize = dst.size();
+        cn = src.channels();
+        bufstep = (int)alignSize((dsize.width+1)*cn, 16);
+        _buf.allocate(bufstep*PU_SZ + 16);
+        buf = alignPtr((WT*)_buf, 16);
+        _dtab.allocate(ssize.width*cn);
 
-        if( y*2+1 >= dsize.height )
-            dst1 = dst0;
+        CV_Assert( std::abs(dsize.width - ssize.width*2) == dsize.width % 2 &&
+                   std::abs(dsize.height - ssize.height*2) == dsize.height % 2);
+
+        for( int x = 0; x < ssize.width*cn; x++ )
+            _dtab[x] = (x/cn)*2*cn + x % cn;
+
+        sy0 = sy = y - PU_SZ/2;
+    }
+
+    // processes the source rows up to y1 (exclusive)
+    void operator()( int y1 )
+    {
+        int k, x, swidth = src.cols*cn, dwidth = dst.cols*cn, dheight = dst.rows;
+        const int* dtab = _dtab;
+        WT* rows[PU_SZ];
+        CastOp castOp;
+        VecOp vecOp;
 
-        // fill the ring buffer (horizontal convolution and decimation)
-        for( ; sy <= y + 1; sy++ )
+        for( ; y < y1; y++ )
         {
-            WT* row = buf + ((sy - sy0) % PU_SZ)*bufstep;
-            int _sy = borderInterpolate(sy*2, dsize.height, BORDER_REFLECT_101)/2;
-            const T* src = (const T*)(_src.data + _src.step*_sy);
+            T* dsts[2];
+            T* dst0 = dsts[0] = (T*)(dst.data + dst.step*y*2);
+            T* dst1 = dsts[1] = (T*)(dst.data + dst.step*(y*2+1));
+            WT *row0, *row1, *row2;
 
-            if( ssize.width == cn )
+            if( y*2+1 >= dheight )
+                dst1 = dsts[1] = dst0;
+
+            // fill the ring buffer (horizontal convolution and decimation)
+            for( ; sy <= y + 1; sy++ )
             {
+                WT* row = buf + ((sy - sy0) % PU_SZ)*bufstep;
+                int _sy = borderInterpolate(sy*2, dheight, BORDER_REFLECT_101)/2;
+                const T* srow = (const T*)(src.data + src.step*_sy);
+
+                if( swidth == cn )
+                {
+                    for( x = 0; x < cn; x++ )
+                        row[x] = row[x + cn] = srow[x]*8;
+                    continue;
+                }
+
                 for( x = 0; x < cn; x++ )
-                    row[x] = row[x + cn] = src[x]*8;
-                continue;
-            }
+                {
+                    int dx = dtab[x];
+                    WT t0 = srow[x]*6 + srow[x + cn]*2;
+                    WT t1 = (srow[x] + srow[x + cn])*4;
+                    row[dx] = t0; row[dx + cn] = t1;
+                    dx = dtab[swidth - cn + x];
+                    int sx = swidth - cn + x;
+                    t0 = srow[sx - cn] + srow[sx]*7;
+                    t1 = srow[sx]*8;
+                    row[dx] = t0; row[dx + cn] = t1;
+                }
 
-            for( x = 0; x < cn; x++ )
-            {
-                int dx = dtab[x];
-                WT t0 = src[x]*6 + src[x + cn]*2;
-                WT t1 = (src[x] + src[x + cn])*4;
-                row[dx] = t0; row[dx + cn] = t1;
-                dx = dtab[ssize.width - cn + x];
-                int sx = ssize.width - cn + x;
-                t0 = src[sx - cn] + src[sx]*7;
-                t1 = src[sx]*8;
-                row[dx] = t0; row[dx + cn] = t1;
+                for( x = cn; x < swidth - cn; x++ )
+                {
+                    int dx = dtab[x];
+                    WT t0 = srow[x-cn] + srow[x]*6 + srow[x+cn];
+                    WT t1 = (srow[x] + srow[x+cn])*4;
+                    row[dx] = t0;
+                    row[dx+cn] = t1;
+                }
             }
 
-            for( x = cn; x < ssize.width - cn; x++ )
+            // do vertical convolution and decimation and write the result to the destination image
+            for( k = 0; k < PU_SZ; k++ )
+                rows[k] = buf + ((y - PU_SZ/2 + k - sy0) % PU_SZ)*bufstep;
+            row0 = rows[0]; row1 = rows[1]; row2 = rows[2];
+
+            x = vecOp(rows, dsts, (int)dst.step, dwidth);
+            for( ; x < dwidth; x++ )
             {
-                int dx = dtab[x];
-                WT t0 = src[x-cn] + src[x]*6 + src[x+cn];
-                WT t1 = (src[x] + src[x+cn])*4;
-                row[dx] = t0;
-                row[dx+cn] = t1;
+                T t1 = castOp((row1[x] + row2[x])*4);
+                T t0 = castOp(row0[x] + row1[x]*6 + row2[x]);
+                dst1[x] = t1; dst0[x] = t0;
             }
         }
+    }
 
-        // do vertical convolution and decimation and write the result to the destination image
-        for( k = 0; k < PU_SZ; k++ )
-            rows[k] = buf + ((y - PU_SZ/2 + k - sy0) % PU_SZ)*bufstep;
-        row0 = rows[0]; row1 = rows[1]; row2 = rows[2];
+private:
+    const Mat& src;
+    Mat& dst;
+    int cn, bufstep, sy0, sy;
+    AutoBuffer<WT> _buf;
+    WT* buf;
+    AutoBuffer<int> _dtab;
+
+public:
+    //! the next source row
+    int y;
+};
 
-        x = vecOp(rows, dst0, (int)_dst.step, dsize.width);
-        for( ; x < dsize.width; x++ )
-        {
-            T t1 = castOp((row1[x] + row2[x])*4);
-            T t0 = castOp(row0[x] + row1[x]*6 + row2[x]);
-            dst1[x] = t1; dst0[x] = t0;
-        }
+template<class CastOp, class VecOp> class PyrUpInvoker : public ParallelLoopBody
+{
+public:
+    PyrUpInvoker( const Mat& _src, Mat& _dst ) : src(_src), dst(_dst)
+    {
     }
+
+    void operator()( const Range& range ) const
+    {
+        PyrUpRows<CastOp, VecOp> rows(src, dst, range.start);
+        rows(range.end);
+    }
+
+private:
+    const Mat& src;
+    Mat& dst;
+};
+
+template<class CastOp, class VecOp> void
+pyrUp_( const Mat& _src, Mat& _dst, int )
+{
+    parallel_for_(Range(0, _src.rows), PyrUpInvoker<CastOp, VecOp>(_src, _dst), getPyrStripes(_src));
 }
 
 typedef void (*PyrFunc)(const Mat&, Mat&, int);
+typedef void (*BuildPyramidFunc)(const Mat*, int, int);
 
 }
 
@@ -446,15 +689,15 @@ void cv::pyrUp( InputArray _src, OutputArray _dst, const Size& _dsz, int borderT
     int depth = src.depth();
     PyrFunc func = 0;
     if( depth == CV_8U )
-        func = pyrUp_<FixPtCast<uchar, 6>, NoVec<int, uchar> >;
+        func = pyrUp_<FixPtCast<uchar, 6>, PyrUpVec_32s8u>;
     else if( depth == CV_16S )
-        func = pyrUp_<FixPtCast<short, 6>, NoVec<int, short> >;
+        func = pyrUp_<FixPtCast<short, 6>, NoVec<int, short*> >;
     else if( depth == CV_16U )
-        func = pyrUp_<FixPtCast<ushort, 6>, NoVec<int, ushort> >;
+        func = pyrUp_<FixPtCast<ushort, 6>, NoVec<int, ushort*> >;
     else if( depth == CV_32F )
-        func = pyrUp_<FltCast<float, 6>, NoVec<float, float> >;
+        func = pyrUp_<FltCast<float, 6>, PyrUpVec_32f>;
     else if( depth == CV_64F )
-        func = pyrUp_<FltCast<double, 6>, NoVec<double, double> >;
+        func = pyrUp_<FltCast<double, 6>, NoVec<double, double*> >;
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
@@ -466,8 +709,45 @@ void cv::buildPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel,
     Mat src = _src.getMat();
     _dst.create( maxlevel + 1, 1, 0 );
     _dst.getMatRef(0) = src;
-    for( int i = 1; i <= maxlevel; i++ )
-        pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
+
+    int i, depth = src.depth();
+    BuildPyramidFunc func = 0;
+
+#ifndef HAVE_TEGRA_OPTIMIZATION
+    // with a single thread all the levels are computed in one pass over the source rows,
+    // otherwise every level is split into bands processed in parallel
+    if( getNumThreads() == 1 && maxlevel > 1 )
+    {
+        if( depth == CV_8U )
+            func = buildPyramid_<FixPtCast<uchar, 8>, PyrDownVec_32s8u>;
+        else if( depth == CV_16S )
+            func = buildPyramid_<FixPtCast<short, 8>, NoVec<int, short> >;
+        else if( depth == CV_16U )
+            func = buildPyramid_<FixPtCast<ushort, 8>, NoVec<int, ushort> >;
+        else if( depth == CV_32F )
+            func = buildPyramid_<FltCast<float, 8>, PyrDownVec_32f>;
+        else if( depth == CV_64F )
+            func = buildPyramid_<FltCast<double, 8>, NoVec<double, double> >;
+    }
+#endif
+
+    if( !func )
+    {
+        for( i = 1; i <= maxlevel; i++ )
+            pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i), Size(), borderType );
+        return;
+    }
+
+    vector<Mat> levels(maxlevel + 1);
+    levels[0] = src;
+    for( i = 1; i <= maxlevel; i++ )
+    {
+        Mat& prev = levels[i-1];
+        _dst.create( Size((prev.cols + 1)/2, (prev.rows + 1)/2), src.type(), i );
+        levels[i] = _dst.getMatRef(i);
+    }
+
+    func( &levels[0], maxlevel, borderType );
 }
 
 CV_IMPL void cvPyrDown( const void* srcarr, void* dstarr, int _filter )
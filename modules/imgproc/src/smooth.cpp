@@ -97,7 +97,7 @@ template<typename T, typename ST> struct RowSum : public BaseRowFilter
 };
 
 
-template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter
+template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale )
     {
@@ -109,6 +109,8 @@ template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnSum(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -197,7 +199,7 @@ template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter
 };
 
 
-template<> struct ColumnSum<int, uchar> : public BaseColumnFilter
+template<> struct ColumnSum<int, uchar> : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale )
     {
@@ -209,6 +211,8 @@ template<> struct ColumnSum<int, uchar> : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnSum(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -338,7 +342,7 @@ template<> struct ColumnSum<int, uchar> : public BaseColumnFilter
     vector<int> sum;
 };
 
-template<> struct ColumnSum<int, short> : public BaseColumnFilter
+template<> struct ColumnSum<int, short> : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale )
     {
@@ -350,6 +354,8 @@ template<> struct ColumnSum<int, short> : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnSum(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -476,7 +482,7 @@ template<> struct ColumnSum<int, short> : public BaseColumnFilter
 };
 
 
-template<> struct ColumnSum<int, ushort> : public BaseColumnFilter
+template<> struct ColumnSum<int, ushort> : public BaseColumnFilter, public ClonableFilter<BaseColumnFilter>
 {
     ColumnSum( int _ksize, int _anchor, double _scale )
     {
@@ -488,6 +494,8 @@ template<> struct ColumnSum<int, ushort> : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
 
+    Ptr<BaseColumnFilter> clone() const { return Ptr<BaseColumnFilter>(new ColumnSum(*this)); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
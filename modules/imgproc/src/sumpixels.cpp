@@ -45,182 +45,442 @@
 namespace cv
 {
 
-template<typename T, typename ST, typename QT>
-void integral_( const T* src, size_t _srcstep, ST* sum, size_t _sumstep,
-                QT* sqsum, size_t _sqsumstep, ST* tilted, size_t _tiltedstep,
-                Size size, int cn )
+/*
+   When no tilted sum is needed, the integral is computed in two passes:
+   every output row is first filled with the horizontal prefix sums of the
+   corresponding source row, then each row gets the row above it added.
+   Both passes perform exactly the same additions as the fused loop in integral_(),
+   so the results are identical, but the first pass is independent per row and
+   the second one per column, so both are vectorized and split between threads.
+*/
+
+template<typename T, typename ST> static inline int
+integralRowVec( const T*, ST*, int )
+{ return 0; }
+
+template<typename T, typename QT> static inline int
+integralSqRowVec( const T*, QT*, int )
+{ return 0; }
+
+template<typename ST> static inline int
+integralAddRowVec( const ST*, ST*, int )
+{ return 0; }
+
+#if CV_SSE2
+
+static inline int integralRowVec( const uchar* src, int* sum, int width )
 {
-    int x, y, k;
+    int x = 0;
+    __m128i z = _mm_setzero_si128(), s = z;
+
+    // the in-register prefix of 8 bytes fits into 16 bits
+    for( ; x <= width - 8; x += 8 )
+    {
+        __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+        __m128i v0 = _mm_add_epi32(_mm_unpacklo_epi16(v, z), s);
+        __m128i v1 = _mm_add_epi32(_mm_unpackhi_epi16(v, z), s);
+        _mm_storeu_si128((__m128i*)(sum + x), v0);
+        _mm_storeu_si128((__m128i*)(sum + x + 4), v1);
+        s = _mm_shuffle_epi32(v1, _MM_SHUFFLE(3, 3, 3, 3));
+    }
 
-    int srcstep = (int)(_srcstep/sizeof(T));
-    int sumstep = (int)(_sumstep/sizeof(ST));
-    int tiltedstep = (int)(_tiltedstep/sizeof(ST));
-    int sqsumstep = (int)(_sqsumstep/sizeof(QT));
+    return x;
+}
 
-    size.width *= cn;
+static inline int integralRowVec( const uchar* src, float* sum, int width )
+{
+    // integer partial sums are converted to float exactly only while they are below 2^24
+    if( width > (1 << 24)/255 )
+        return 0;
 
-    memset( sum, 0, (size.width+cn)*sizeof(sum[0]));
-    sum += sumstep + cn;
+    int x = 0;
+    __m128i z = _mm_setzero_si128(), s = z;
 
-    if( sqsum )
+    for( ; x <= width - 8; x += 8 )
     {
-        memset( sqsum, 0, (size.width+cn)*sizeof(sqsum[0]));
-        sqsum += sqsumstep + cn;
+        __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 2));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 4));
+        v = _mm_add_epi16(v, _mm_slli_si128(v, 8));
+        __m128i v0 = _mm_add_epi32(_mm_unpacklo_epi16(v, z), s);
+        __m128i v1 = _mm_add_epi32(_mm_unpackhi_epi16(v, z), s);
+        _mm_storeu_ps(sum + x, _mm_cvtepi32_ps(v0));
+        _mm_storeu_ps(sum + x + 4, _mm_cvtepi32_ps(v1));
+        s = _mm_shuffle_epi32(v1, _MM_SHUFFLE(3, 3, 3, 3));
     }
 
-    if( tilted )
+    return x;
+}
+
+static inline int integralSqRowVec( const uchar* src, double* sqsum, int width )
+{
+    // the partial sums of squares are accumulated in 32-bit integers
+    if( width > INT_MAX/(255*255) )
+        return 0;
+
+    int x = 0;
+    __m128i z = _mm_setzero_si128(), s = z;
+
+    for( ; x <= width - 8; x += 8 )
     {
-        memset( tilted, 0, (size.width+cn)*sizeof(tilted[0]));
-        tilted += tiltedstep + cn;
+        __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+        v = _mm_mullo_epi16(v, v);
+        __m128i v0 = _mm_unpacklo_epi16(v, z), v1 = _mm_unpackhi_epi16(v, z);
+        v0 = _mm_add_epi32(v0, _mm_slli_si128(v0, 4));
+        v1 = _mm_add_epi32(v1, _mm_slli_si128(v1, 4));
+        v0 = _mm_add_epi32(v0, _mm_slli_si128(v0, 8));
+        v1 = _mm_add_epi32(v1, _mm_slli_si128(v1, 8));
+        v0 = _mm_add_epi32(v0, s);
+        v1 = _mm_add_epi32(v1, _mm_shuffle_epi32(v0, _MM_SHUFFLE(3, 3, 3, 3)));
+        s = _mm_shuffle_epi32(v1, _MM_SHUFFLE(3, 3, 3, 3));
+        _mm_storeu_pd(sqsum + x, _mm_cvtepi32_pd(v0));
+        _mm_storeu_pd(sqsum + x + 2, _mm_cvtepi32_pd(_mm_srli_si128(v0, 8)));
+        _mm_storeu_pd(sqsum + x + 4, _mm_cvtepi32_pd(v1));
+        _mm_storeu_pd(sqsum + x + 6, _mm_cvtepi32_pd(_mm_srli_si128(v1, 8)));
     }
 
-    if( sqsum == 0 && tilted == 0 )
+    return x;
+}
+
+static inline int integralAddRowVec( const int* prev, int* sum, int n )
+{
+    int x = 0;
+    for( ; x <= n - 8; x += 8 )
     {
-        for( y = 0; y < size.height; y++, src += srcstep - cn, sum += sumstep - cn )
+        __m128i v0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(sum + x)),
+                                   _mm_loadu_si128((const __m128i*)(prev + x)));
+        __m128i v1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(sum + x + 4)),
+                                   _mm_loadu_si128((const __m128i*)(prev + x + 4)));
+        _mm_storeu_si128((__m128i*)(sum + x), v0);
+        _mm_storeu_si128((__m128i*)(sum + x + 4), v1);
+    }
+    return x;
+}
+
+static inline int integralAddRowVec( const float* prev, float* sum, int n )
+{
+    int x = 0;
+    for( ; x <= n - 8; x += 8 )
+    {
+        __m128 v0 = _mm_add_ps(_mm_loadu_ps(prev + x), _mm_loadu_ps(sum + x));
+        __m128 v1 = _mm_add_ps(_mm_loadu_ps(prev + x + 4), _mm_loadu_ps(sum + x + 4));
+        _mm_storeu_ps(sum + x, v0);
+        _mm_storeu_ps(sum + x + 4, v1);
+    }
+    return x;
+}
+
+static inline int integralAddRowVec( const double* prev, double* sum, int n )
+{
+    int x = 0;
+    for( ; x <= n - 4; x += 4 )
+    {
+        __m128d v0 = _mm_add_pd(_mm_loadu_pd(prev + x), _mm_loadu_pd(sum + x));
+        __m128d v1 = _mm_add_pd(_mm_loadu_pd(prev + x + 2), _mm_loadu_pd(sum + x + 2));
+        _mm_storeu_pd(sum + x, v0);
+        _mm_storeu_pd(sum + x + 2, v1);
+    }
+    return x;
+}
+
+#endif
+
+// fills one row of sum and/or sqsum (either may be NULL) with the horizontal prefix sums
+template<typename T, typename ST, typename QT> static void
+integralRow_( const T* src, ST* sum, QT* sqsum, int width, int cn, bool vec )
+{
+    int x, k;
+
+    if( sum )
+    {
+        for( k = 0; k < cn; k++ )
+            sum[k] = 0;
+        sum += cn;
+        x = vec && cn == 1 ? integralRowVec(src, sum, width) : 0;
+
+        for( k = 0; k < cn; k++ )
         {
-            for( k = 0; k < cn; k++, src++, sum++ )
+            int i = x + k;
+            ST s = i >= cn ? sum[i - cn] : (ST)0;
+            for( ; i < width; i += cn )
             {
-                ST s = sum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
-                {
-                    s += src[x];
-                    sum[x] = sum[x - sumstep] + s;
-                }
+                s += src[i];
+                sum[i] = s;
             }
         }
     }
-    else if( tilted == 0 )
+
+    if( sqsum )
     {
-        for( y = 0; y < size.height; y++, src += srcstep - cn,
-                        sum += sumstep - cn, sqsum += sqsumstep - cn )
+        for( k = 0; k < cn; k++ )
+            sqsum[k] = 0;
+        sqsum += cn;
+        x = vec && cn == 1 ? integralSqRowVec(src, sqsum, width) : 0;
+
+        for( k = 0; k < cn; k++ )
         {
-            for( k = 0; k < cn; k++, src++, sum++, sqsum++ )
+            int i = x + k;
+            QT sq = i >= cn ? sqsum[i - cn] : (QT)0;
+            for( ; i < width; i += cn )
             {
-                ST s = sum[-cn] = 0;
-                QT sq = sqsum[-cn] = 0;
-                for( x = 0; x < size.width; x += cn )
-                {
-                    T it = src[x];
-                    s += it;
-                    sq += (QT)it*it;
-                    ST t = sum[x - sumstep] + s;
-                    QT tq = sqsum[x - sqsumstep] + sq;
-                    sum[x] = t;
-                    sqsum[x] = tq;
-                }
+                T it = src[i];
+                sq += (QT)it*it;
+                sqsum[i] = sq;
             }
         }
     }
+}
+
+// sum[x] += prev[x]
+template<typename ST> static void
+integralAddRow_( const ST* prev, ST* sum, int n, bool vec )
+{
+    int x = vec ? integralAddRowVec(prev, sum, n) : 0;
+    for( ; x <= n - 4; x += 4 )
+    {
+        ST t0 = prev[x] + sum[x], t1 = prev[x+1] + sum[x+1];
+        sum[x] = t0; sum[x+1] = t1;
+        t0 = prev[x+2] + sum[x+2]; t1 = prev[x+3] + sum[x+3];
+        sum[x+2] = t0; sum[x+3] = t1;
+    }
+    for( ; x < n; x++ )
+        sum[x] += prev[x];
+}
+
+template<typename T, typename ST, typename QT>
+class IntegralRowInvoker : public ParallelLoopBody
+{
+public:
+    IntegralRowInvoker( const Mat& _src, Mat& _sum, Mat& _sqsum, bool _vec )
+        : src(_src), sum(_sum), sqsum(_sqsum), vec(_vec)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cn = src.channels(), width = src.cols*cn;
+        for( int y = range.start; y < range.end; y++ )
+            integralRow_( (const T*)src.ptr(y), sum.data ? (ST*)sum.ptr(y+1) : 0,
+                          sqsum.data ? (QT*)sqsum.ptr(y+1) : 0, width, cn, vec );
+    }
+
+private:
+    const Mat& src;
+    Mat& sum;
+    Mat& sqsum;
+    bool vec;
+};
+
+// accumulates the rows of an integral image top-down within vertical strips
+template<typename ST>
+class IntegralColumnInvoker : public ParallelLoopBody
+{
+public:
+    enum { BLOCK_SIZE = 64 };
+
+    IntegralColumnInvoker( Mat& _sum, bool _vec ) : sum(_sum), vec(_vec)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int n = sum.cols*sum.channels();
+        int x0 = range.start*BLOCK_SIZE, x1 = std::min(range.end*BLOCK_SIZE, n);
+        for( int y = 1; y < sum.rows; y++ )
+            integralAddRow_( (const ST*)sum.ptr(y-1) + x0, (ST*)sum.ptr(y) + x0, x1 - x0, vec );
+    }
+
+private:
+    Mat& sum;
+    bool vec;
+};
+
+template<typename T, typename ST, typename QT> static void
+integralUpright_( const Mat& src, Mat& sum, Mat& sqsum )
+{
+    bool vec = checkHardwareSupport(CV_CPU_SSE2);
+    int n = (src.cols + 1)*src.channels();
+
+    if( sum.data )
+        memset( sum.data, 0, n*sizeof(ST) );
+    if( sqsum.data )
+        memset( sqsum.data, 0, n*sizeof(QT) );
+
+    IntegralRowInvoker<T, ST, QT> rowBody(src, sum, sqsum, vec);
+
+    if( getNumThreads() > 1 && (double)src.total()*src.channels() >= 1 << 16 )
+    {
+        int nblocks = (n + IntegralColumnInvoker<ST>::BLOCK_SIZE - 1)/IntegralColumnInvoker<ST>::BLOCK_SIZE;
+        parallel_for_(Range(0, src.rows), rowBody);
+        if( sum.data )
+            parallel_for_(Range(0, nblocks), IntegralColumnInvoker<ST>(sum, vec));
+        if( sqsum.data )
+            parallel_for_(Range(0, nblocks), IntegralColumnInvoker<QT>(sqsum, vec));
+    }
     else
     {
-        AutoBuffer<ST> _buf(size.width+cn);
-        ST* buf = _buf;
-        ST s;
-        QT sq;
-        for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
+        // single pass: the row above is still in cache when it is added
+        for( int y = 0; y < src.rows; y++ )
         {
-            sum[-cn] = tilted[-cn] = 0;
+            rowBody(Range(y, y + 1));
+            if( sum.data )
+                integralAddRow_( (const ST*)sum.ptr(y), (ST*)sum.ptr(y+1), n, vec );
+            if( sqsum.data )
+                integralAddRow_( (const QT*)sqsum.ptr(y), (QT*)sqsum.ptr(y+1), n, vec );
+        }
+    }
+}
 
-            for( x = 0, s = 0, sq = 0; x < size.width; x += cn )
-            {
-                T it = src[x];
-                buf[x] = tilted[x] = it;
-                s += it;
-                sq += (QT)it*it;
-                sum[x] = s;
-                if( sqsum )
-                    sqsum[x] = sq;
-            }
+typedef void (*IntegralUprightFunc)( const Mat& src, Mat& sum, Mat& sqsum );
 
-            if( size.width == cn )
-                buf[cn] = 0;
+/*
+   The tilted sum is computed row by row. Besides the previous row of the result,
+   it needs buf[x] = I(y,x) + I(y-1,x+1) + I(y-2,x+2) + ..., the sums along the
+   up-right diagonals of the source:
 
-            if( sqsum )
-            {
-                sqsum[-cn] = 0;
-                sqsum++;
-            }
-        }
+     tilted(y+1,x+1) = buf[x] + ((buf[x+1] + I(y,x)) + tilted(y,x)),
+     buf[x-1] = buf[x] + I(y,x-1)
 
-        for( y = 1; y < size.height; y++ )
-        {
-            src += srcstep - cn;
-            sum += sumstep - cn;
-            tilted += tiltedstep - cn;
-            buf += -cn;
+   The elements of a row do not depend on each other, so the rows are vectorized.
+   The additions are performed in the same order as in the former fused loop,
+   so the floating-point results do not change.
+*/
 
-            if( sqsum )
-                sqsum += sqsumstep - cn;
+template<typename T, typename ST> static inline int
+integralTiltedRowVec( const T*, const ST*, ST*, ST*, int x, int, int )
+{ return x; }
 
-            for( k = 0; k < cn; k++, src++, sum++, tilted++, buf++ )
-            {
-                T it = src[0];
-                ST t0 = s = it;
-                QT tq0 = sq = (QT)it*it;
-
-                sum[-cn] = 0;
-                if( sqsum )
-                    sqsum[-cn] = 0;
-                tilted[-cn] = tilted[-tiltedstep];
-
-                sum[0] = sum[-sumstep] + t0;
-                if( sqsum )
-                    sqsum[0] = sqsum[-sqsumstep] + tq0;
-                tilted[0] = tilted[-tiltedstep] + t0 + buf[cn];
-
-                for( x = cn; x < size.width - cn; x += cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    t1 += buf[x + cn] + t0 + tilted[x - tiltedstep - cn];
-                    tilted[x] = t1;
-                }
-
-                if( size.width > cn )
-                {
-                    ST t1 = buf[x];
-                    buf[x - cn] = t1 + t0;
-                    t0 = it = src[x];
-                    tq0 = (QT)it*it;
-                    s += t0;
-                    sq += tq0;
-                    sum[x] = sum[x - sumstep] + s;
-                    if( sqsum )
-                        sqsum[x] = sqsum[x - sqsumstep] + sq;
-                    tilted[x] = t0 + t1 + tilted[x - tiltedstep - cn];
-                    buf[x] = t0;
-                }
-
-                if( sqsum )
-                    sqsum++;
-            }
-        }
+#if CV_SSE2
+
+static inline int integralTiltedRowVec( const uchar* src, const int* prev, int* buf, int* tilted,
+                                        int x, int n, int cn )
+{
+    __m128i z = _mm_setzero_si128();
+    for( ; x <= n - 8; x += 8 )
+    {
+        __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+        __m128i vp = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x - cn)), z);
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(buf + x));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(buf + x + 4));
+        __m128i t0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(buf + x + cn)), _mm_unpacklo_epi16(v, z));
+        __m128i t1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(buf + x + cn + 4)), _mm_unpackhi_epi16(v, z));
+        t0 = _mm_add_epi32(b0, _mm_add_epi32(t0, _mm_loadu_si128((const __m128i*)(prev + x))));
+        t1 = _mm_add_epi32(b1, _mm_add_epi32(t1, _mm_loadu_si128((const __m128i*)(prev + x + 4))));
+        _mm_storeu_si128((__m128i*)(tilted + x), t0);
+        _mm_storeu_si128((__m128i*)(tilted + x + 4), t1);
+        _mm_storeu_si128((__m128i*)(buf + x - cn), _mm_add_epi32(b0, _mm_unpacklo_epi16(vp, z)));
+        _mm_storeu_si128((__m128i*)(buf + x - cn + 4), _mm_add_epi32(b1, _mm_unpackhi_epi16(vp, z)));
     }
+    return x;
 }
 
+static inline int integralTiltedRowVec( const uchar* src, const float* prev, float* buf, float* tilted,
+                                        int x, int n, int cn )
+{
+    __m128i z = _mm_setzero_si128();
+    for( ; x <= n - 8; x += 8 )
+    {
+        __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+        __m128i vp = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x - cn)), z);
+        __m128 b0 = _mm_loadu_ps(buf + x), b1 = _mm_loadu_ps(buf + x + 4);
+        __m128 t0 = _mm_add_ps(_mm_loadu_ps(buf + x + cn), _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, z)));
+        __m128 t1 = _mm_add_ps(_mm_loadu_ps(buf + x + cn + 4), _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, z)));
+        t0 = _mm_add_ps(b0, _mm_add_ps(t0, _mm_loadu_ps(prev + x)));
+        t1 = _mm_add_ps(b1, _mm_add_ps(t1, _mm_loadu_ps(prev + x + 4)));
+        _mm_storeu_ps(tilted + x, t0);
+        _mm_storeu_ps(tilted + x + 4, t1);
+        _mm_storeu_ps(buf + x - cn, _mm_add_ps(b0, _mm_cvtepi32_ps(_mm_unpacklo_epi16(vp, z))));
+        _mm_storeu_ps(buf + x - cn + 4, _mm_add_ps(b1, _mm_cvtepi32_ps(_mm_unpackhi_epi16(vp, z))));
+    }
+    return x;
+}
 
-#define DEF_INTEGRAL_FUNC(suffix, T, ST, QT) \
-static void integral_##suffix( T* src, size_t srcstep, ST* sum, size_t sumstep, QT* sqsum, size_t sqsumstep, \
-                              ST* tilted, size_t tiltedstep, Size size, int cn ) \
-{ integral_(src, srcstep, sum, sumstep, sqsum, sqsumstep, tilted, tiltedstep, size, cn); }
+static inline int integralTiltedRowVec( const float* src, const float* prev, float* buf, float* tilted,
+                                        int x, int n, int cn )
+{
+    for( ; x <= n - 4; x += 4 )
+    {
+        __m128 b0 = _mm_loadu_ps(buf + x);
+        __m128 t0 = _mm_add_ps(_mm_loadu_ps(buf + x + cn), _mm_loadu_ps(src + x));
+        t0 = _mm_add_ps(b0, _mm_add_ps(t0, _mm_loadu_ps(prev + x)));
+        _mm_storeu_ps(tilted + x, t0);
+        _mm_storeu_ps(buf + x - cn, _mm_add_ps(b0, _mm_loadu_ps(src + x - cn)));
+    }
+    return x;
+}
 
-DEF_INTEGRAL_FUNC(8u32s, uchar, int, double)
-DEF_INTEGRAL_FUNC(8u32f, uchar, float, double)
-DEF_INTEGRAL_FUNC(8u64f, uchar, double, double)
-DEF_INTEGRAL_FUNC(32f, float, float, double)
-DEF_INTEGRAL_FUNC(32f64f, float, double, double)
-DEF_INTEGRAL_FUNC(64f, double, double, double)
+static inline int integralTiltedRowVec( const double* src, const double* prev, double* buf, double* tilted,
+                                        int x, int n, int cn )
+{
+    for( ; x <= n - 2; x += 2 )
+    {
+        __m128d b0 = _mm_loadu_pd(buf + x);
+        __m128d t0 = _mm_add_pd(_mm_loadu_pd(buf + x + cn), _mm_loadu_pd(src + x));
+        t0 = _mm_add_pd(b0, _mm_add_pd(t0, _mm_loadu_pd(prev + x)));
+        _mm_storeu_pd(tilted + x, t0);
+        _mm_storeu_pd(buf + x - cn, _mm_add_pd(b0, _mm_loadu_pd(src + x - cn)));
+    }
+    return x;
+}
+
+#endif
+
+template<typename T, typename ST> static void
+integralTilted_( const Mat& src, Mat& tilted )
+{
+    bool vec = checkHardwareSupport(CV_CPU_SSE2);
+    int x, cn = src.channels(), width = src.cols*cn;
+    AutoBuffer<ST> _buf(width + cn);
+    ST* buf = _buf;
+
+    memset( tilted.data, 0, (width + cn)*sizeof(ST) );
+
+    const T* s = (const T*)src.data;
+    ST* t = (ST*)tilted.ptr(1);
+    for( x = 0; x < cn; x++ )
+        t[x] = buf[width + x] = 0;
+    t += cn;
+    for( x = 0; x < width; x++ )
+        buf[x] = t[x] = s[x];
+
+    for( int y = 1; y < src.rows; y++ )
+    {
+        const ST* prev = (const ST*)tilted.ptr(y);
+        s = (const T*)src.ptr(y);
+        t = (ST*)tilted.ptr(y+1);
+        for( x = 0; x < cn; x++ )
+            t[x] = prev[x + cn];
+        t += cn;
+
+        for( x = 0; x < cn; x++ )
+            t[x] = prev[x + cn] + s[x] + buf[x + cn];
+
+        if( width == cn )
+            continue;
+
+        // every element reads buf[x] and buf[x+cn] before buf[x-cn] is overwritten
+        x = vec ? integralTiltedRowVec(s, prev, buf, t, x, width - cn, cn) : x;
+        for( ; x < width - cn; x++ )
+        {
+            ST b = buf[x];
+            t[x] = b + (buf[x + cn] + s[x] + prev[x]);
+            buf[x - cn] = b + s[x - cn];
+        }
+
+        for( ; x < width; x++ )
+        {
+            ST b = buf[x];
+            t[x] = s[x] + b + prev[x];
+            buf[x - cn] = b + s[x - cn];
+            buf[x] = s[x];
+        }
+    }
+}
 
-typedef void (*IntegralFunc)(const uchar* src, size_t srcstep, uchar* sum, size_t sumstep,
-                             uchar* sqsum, size_t sqsumstep, uchar* tilted, size_t tstep,
-                             Size size, int cn );
+typedef void (*IntegralTiltedFunc)( const Mat& src, Mat& tilted );
 
 }
 
@@ -234,8 +494,14 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
     if( sdepth <= 0 )
         sdepth = depth == CV_8U ? CV_32S : CV_64F;
     sdepth = CV_MAT_DEPTH(sdepth);
-    _sum.create( isize, CV_MAKETYPE(sdepth, cn) );
-    sum = _sum.getMat();
+
+    // only the requested outputs are computed; sum may be omitted when sqsum or tilted is given
+    CV_Assert( _sum.needed() || _sqsum.needed() || _tilted.needed() );
+    if( _sum.needed() )
+    {
+        _sum.create( isize, CV_MAKETYPE(sdepth, cn) );
+        sum = _sum.getMat();
+    }
 
     if( _tilted.needed() )
     {
@@ -249,25 +515,47 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
         sqsum = _sqsum.getMat();
     }
 
-    IntegralFunc func = 0;
+    IntegralUprightFunc func = 0;
+    IntegralTiltedFunc tfunc = 0;
 
     if( depth == CV_8U && sdepth == CV_32S )
-        func = (IntegralFunc)GET_OPTIMIZED(integral_8u32s);
+    {
+        func = integralUpright_<uchar, int, double>;
+        tfunc = integralTilted_<uchar, int>;
+    }
     else if( depth == CV_8U && sdepth == CV_32F )
-        func = (IntegralFunc)integral_8u32f;
+    {
+        func = integralUpright_<uchar, float, double>;
+        tfunc = integralTilted_<uchar, float>;
+    }
     else if( depth == CV_8U && sdepth == CV_64F )
-        func = (IntegralFunc)integral_8u64f;
+    {
+        func = integralUpright_<uchar, double, double>;
+        tfunc = integralTilted_<uchar, double>;
+    }
     else if( depth == CV_32F && sdepth == CV_32F )
-        func = (IntegralFunc)integral_32f;
+    {
+        func = integralUpright_<float, float, double>;
+        tfunc = integralTilted_<float, float>;
+    }
     else if( depth == CV_32F && sdepth == CV_64F )
-        func = (IntegralFunc)integral_32f64f;
+    {
+        func = integralUpright_<float, double, double>;
+        tfunc = integralTilted_<float, double>;
+    }
     else if( depth == CV_64F && sdepth == CV_64F )
-        func = (IntegralFunc)integral_64f;
+    {
+        func = integralUpright_<double, double, double>;
+        tfunc = integralTilted_<double, double>;
+    }
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
-    func( src.data, src.step, sum.data, sum.step, sqsum.data, sqsum.step,
-          tilted.data, tilted.step, src.size(), cn );
+    // the tilted sum is computed in a separate pass, serial over the rows but vectorized along them
+    if( sum.data || sqsum.data )
+        func( src, sum, sqsum );
+    if( tilted.data )
+        tfunc( src, tilted );
 }
 
 void cv::integral( InputArray src, OutputArray sum, int sdepth )
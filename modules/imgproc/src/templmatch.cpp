@@ -44,74 +44,43 @@
 namespace cv
 {
 
-void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
-                Size corrsize, int ctype,
-                Point anchor, double delta, int borderType )
+// computes the size of the correlation blocks and of their DFT for templates up to templsize
+static void getCrossCorrBlocks( Size templsize, Size corrsize, Size& blocksize, Size& dftsize )
 {
     const double blockScale = 4.5;
     const int minBlockSize = 256;
-    std::vector<uchar> buf;
-
-    Mat templ = _templ;
-    int depth = img.depth(), cn = img.channels();
-    int tdepth = templ.depth(), tcn = templ.channels();
-    int cdepth = CV_MAT_DEPTH(ctype), ccn = CV_MAT_CN(ctype);
 
-    CV_Assert( img.dims <= 2 && templ.dims <= 2 && corr.dims <= 2 );
-
-    if( depth != tdepth && tdepth != std::max(CV_32F, depth) )
-    {
-        _templ.convertTo(templ, std::max(CV_32F, depth));
-        tdepth = templ.depth();
-    }
+    blocksize.width = cvRound(templsize.width*blockScale);
+    blocksize.width = std::max( blocksize.width, minBlockSize - templsize.width + 1 );
+    blocksize.width = std::min( blocksize.width, corrsize.width );
+    blocksize.height = cvRound(templsize.height*blockScale);
+    blocksize.height = std::max( blocksize.height, minBlockSize - templsize.height + 1 );
+    blocksize.height = std::min( blocksize.height, corrsize.height );
 
-    CV_Assert( depth == tdepth || tdepth == CV_32F);
-    CV_Assert( corrsize.height <= img.rows + templ.rows - 1 &&
-               corrsize.width <= img.cols + templ.cols - 1 );
-
-    CV_Assert( ccn == 1 || delta == 0 );
-
-    corr.create(corrsize, ctype);
-
-    int maxDepth = depth > CV_8S ? CV_64F : std::max(std::max(CV_32F, tdepth), cdepth);
-    Size blocksize, dftsize;
-
-    blocksize.width = cvRound(templ.cols*blockScale);
-    blocksize.width = std::max( blocksize.width, minBlockSize - templ.cols + 1 );
-    blocksize.width = std::min( blocksize.width, corr.cols );
-    blocksize.height = cvRound(templ.rows*blockScale);
-    blocksize.height = std::max( blocksize.height, minBlockSize - templ.rows + 1 );
-    blocksize.height = std::min( blocksize.height, corr.rows );
-
-    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templ.cols - 1), 2);
-    dftsize.height = getOptimalDFTSize(blocksize.height + templ.rows - 1);
+    dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templsize.width - 1), 2);
+    dftsize.height = getOptimalDFTSize(blocksize.height + templsize.height - 1);
     if( dftsize.width <= 0 || dftsize.height <= 0 )
         CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
 
     // recompute block size
-    blocksize.width = dftsize.width - templ.cols + 1;
-    blocksize.width = MIN( blocksize.width, corr.cols );
-    blocksize.height = dftsize.height - templ.rows + 1;
-    blocksize.height = MIN( blocksize.height, corr.rows );
+    blocksize.width = dftsize.width - templsize.width + 1;
+    blocksize.width = MIN( blocksize.width, corrsize.width );
+    blocksize.height = dftsize.height - templsize.height + 1;
+    blocksize.height = MIN( blocksize.height, corrsize.height );
+}
 
-    Mat dftTempl( dftsize.height*tcn, dftsize.width, maxDepth );
-    Mat dftImg( dftsize, maxDepth );
+// computes DFT of each template plane; the spectra of the planes are stacked vertically
+static void getTemplSpectrum( const Mat& templ, Size dftsize, int maxDepth, Mat& dftTempl )
+{
+    int tdepth = templ.depth(), tcn = templ.channels();
+    std::vector<uchar> buf;
 
-    int i, k, bufSize = 0;
     if( tcn > 1 && tdepth != maxDepth )
-        bufSize = templ.cols*templ.rows*CV_ELEM_SIZE(tdepth);
-
-    if( cn > 1 && depth != maxDepth )
-        bufSize = std::max( bufSize, (blocksize.width + templ.cols - 1)*
-            (blocksize.height + templ.rows - 1)*CV_ELEM_SIZE(depth));
-
-    if( (ccn > 1 || cn > 1) && cdepth != maxDepth )
-        bufSize = std::max( bufSize, blocksize.width*blocksize.height*CV_ELEM_SIZE(cdepth));
+        buf.resize(templ.cols*templ.rows*CV_ELEM_SIZE(tdepth));
 
-    buf.resize(bufSize);
+    dftTempl.create( dftsize.height*tcn, dftsize.width, maxDepth );
 
-    // compute DFT of each template plane
-    for( k = 0; k < tcn; k++ )
+    for( int k = 0; k < tcn; k++ )
     {
         int yofs = k*dftsize.height;
         Mat src = templ;
@@ -135,9 +104,158 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
         }
         dft(dst, dst, 0, templ.rows);
     }
+}
+
+/*
+   Correlates the image with one or more templates by blocks; the blocks are processed in parallel,
+   each thread with its own DFT buffers. The DFT of every image block is computed once and
+   multiplied by the spectra of all the templates. Since all the templates share the same
+   block layout (computed for the largest of them), the correlation of a smaller template within
+   a block never wraps around.
+*/
+class CrossCorrInvoker : public ParallelLoopBody
+{
+public:
+    CrossCorrInvoker( const Mat& _img0, Point _roiofs, const vector<Mat>& _templs,
+                      const vector<Mat>& _spectra, vector<Mat>& _corrs, Size _corrsize,
+                      Size _templsize, Size _blocksize, Size _dftsize, int _maxDepth,
+                      Point _anchor, double _delta, int _borderType )
+        : img0(_img0), roiofs(_roiofs), templs(_templs), spectra(_spectra), corrs(_corrs),
+          corrsize(_corrsize), templsize(_templsize), blocksize(_blocksize), dftsize(_dftsize),
+          maxDepth(_maxDepth), anchor(_anchor), delta(_delta), borderType(_borderType)
+    {
+        int depth = img0.depth(), cn = img0.channels();
+        int cdepth = corrs[0].depth(), ccn = corrs[0].channels();
+
+        tileCountX = (corrsize.width + blocksize.width - 1)/blocksize.width;
+        bufSize = 0;
+
+        if( cn > 1 && depth != maxDepth )
+            bufSize = (blocksize.width + templsize.width - 1)*
+                (blocksize.height + templsize.height - 1)*CV_ELEM_SIZE(depth);
+
+        if( (ccn > 1 || cn > 1) && cdepth != maxDepth )
+            bufSize = std::max( bufSize, blocksize.width*blocksize.height*CV_ELEM_SIZE(cdepth));
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int depth = img0.depth(), cn = img0.channels();
+        int cdepth = corrs[0].depth(), ccn = corrs[0].channels();
+        Mat dftImg( dftsize, maxDepth ), dftCorr( dftsize, maxDepth );
+        std::vector<uchar> buf(bufSize);
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            int x = (i%tileCountX)*blocksize.width;
+            int y = (i/tileCountX)*blocksize.height;
+
+            Size bsz(std::min(blocksize.width, corrsize.width - x),
+                     std::min(blocksize.height, corrsize.height - y));
+            Size dsz(bsz.width + templsize.width - 1, bsz.height + templsize.height - 1);
+            int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
+            int x1 = std::max(0, x0), y1 = std::max(0, y0);
+            int x2 = std::min(img0.cols, x0 + dsz.width);
+            int y2 = std::min(img0.rows, y0 + dsz.height);
+            Mat src0(img0, Range(y1, y2), Range(x1, x2));
+            Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
+            Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
+
+            for( int k = 0; k < cn; k++ )
+            {
+                Mat src = src0;
+                dftImg = Scalar::all(0);
+
+                if( cn > 1 )
+                {
+                    src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &src, 1, pairs, 1);
+                }
+
+                if( dst1.data != src.data )
+                    src.convertTo(dst1, dst1.depth());
+
+                if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
+                    copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
+                                   x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+
+                dft( dftImg, dftImg, 0, dsz.height );
+
+                for( size_t t = 0; t < templs.size(); t++ )
+                {
+                    Mat& corr = corrs[t];
+                    if( x >= corr.cols || y >= corr.rows )
+                        continue;
+
+                    Size csz(std::min(bsz.width, corr.cols - x), std::min(bsz.height, corr.rows - y));
+                    Mat cdst(corr, Rect(x, y, csz.width, csz.height));
+                    Mat dftTempl1(spectra[t], Rect(0, templs[t].channels() > 1 ? k*dftsize.height : 0,
+                                                   dftsize.width, dftsize.height));
+                    mulSpectrums(dftImg, dftTempl1, dftCorr, 0, true);
+                    dft( dftCorr, dftCorr, DFT_INVERSE + DFT_SCALE, csz.height );
+
+                    src = dftCorr(Rect(0, 0, csz.width, csz.height));
+
+                    if( ccn > 1 )
+                    {
+                        if( cdepth != maxDepth )
+                        {
+                            Mat plane(csz, cdepth, &buf[0]);
+                            src.convertTo(plane, cdepth, 1, delta);
+                            src = plane;
+                        }
+                        int pairs[] = {0, k};
+                        mixChannels(&src, 1, &cdst, 1, pairs, 1);
+                    }
+                    else
+                    {
+                        if( k == 0 )
+                            src.convertTo(cdst, cdepth, 1, delta);
+                        else
+                        {
+                            if( maxDepth != cdepth )
+                            {
+                                Mat plane(csz, cdepth, &buf[0]);
+                                src.convertTo(plane, cdepth);
+                                src = plane;
+                            }
+                            add(src, cdst, cdst);
+                        }
+                    }
+                }
+            }
+        }
+    }
 
-    int tileCountX = (corr.cols + blocksize.width - 1)/blocksize.width;
-    int tileCountY = (corr.rows + blocksize.height - 1)/blocksize.height;
+private:
+    const Mat& img0;
+    Point roiofs;
+    const vector<Mat>& templs;
+    const vector<Mat>& spectra;
+    vector<Mat>& corrs;
+    Size corrsize, templsize, blocksize, dftsize;
+    int maxDepth;
+    Point anchor;
+    double delta;
+    int borderType;
+    int tileCountX, bufSize;
+};
+
+// the correlation with several templates; corrs must be allocated already
+static void crossCorr( const Mat& img, const vector<Mat>& templs, const vector<Mat>& spectra,
+                       vector<Mat>& corrs, Size templsize, Size blocksize, Size dftsize,
+                       int maxDepth, Point anchor, double delta, int borderType )
+{
+    Size corrsize(0, 0);
+    for( size_t t = 0; t < corrs.size(); t++ )
+    {
+        corrsize.width = std::max(corrsize.width, corrs[t].cols);
+        corrsize.height = std::max(corrsize.height, corrs[t].rows);
+    }
+
+    int tileCountX = (corrsize.width + blocksize.width - 1)/blocksize.width;
+    int tileCountY = (corrsize.height + blocksize.height - 1)/blocksize.height;
     int tileCount = tileCountX * tileCountY;
 
     Size wholeSize = img.size();
@@ -153,126 +271,173 @@ void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
     borderType |= BORDER_ISOLATED;
 
     // calculate correlation by blocks
-    for( i = 0; i < tileCount; i++ )
+    parallel_for_(Range(0, tileCount),
+                  CrossCorrInvoker(img0, roiofs, templs, spectra, corrs, corrsize, templsize,
+                                   blocksize, dftsize, maxDepth, anchor, delta, borderType));
+}
+
+void crossCorr( const Mat& img, const Mat& _templ, Mat& corr,
+                Size corrsize, int ctype,
+                Point anchor, double delta, int borderType )
+{
+    Mat templ = _templ;
+    int depth = img.depth();
+    int tdepth = templ.depth();
+    int cdepth = CV_MAT_DEPTH(ctype), ccn = CV_MAT_CN(ctype);
+
+    CV_Assert( img.dims <= 2 && templ.dims <= 2 && corr.dims <= 2 );
+
+    if( depth != tdepth && tdepth != std::max(CV_32F, depth) )
     {
-        int x = (i%tileCountX)*blocksize.width;
-        int y = (i/tileCountX)*blocksize.height;
-
-        Size bsz(std::min(blocksize.width, corr.cols - x),
-                 std::min(blocksize.height, corr.rows - y));
-        Size dsz(bsz.width + templ.cols - 1, bsz.height + templ.rows - 1);
-        int x0 = x - anchor.x + roiofs.x, y0 = y - anchor.y + roiofs.y;
-        int x1 = std::max(0, x0), y1 = std::max(0, y0);
-        int x2 = std::min(img0.cols, x0 + dsz.width);
-        int y2 = std::min(img0.rows, y0 + dsz.height);
-        Mat src0(img0, Range(y1, y2), Range(x1, x2));
-        Mat dst(dftImg, Rect(0, 0, dsz.width, dsz.height));
-        Mat dst1(dftImg, Rect(x1-x0, y1-y0, x2-x1, y2-y1));
-        Mat cdst(corr, Rect(x, y, bsz.width, bsz.height));
-
-        for( k = 0; k < cn; k++ )
-        {
-            Mat src = src0;
-            dftImg = Scalar::all(0);
+        _templ.convertTo(templ, std::max(CV_32F, depth));
+        tdepth = templ.depth();
+    }
 
-            if( cn > 1 )
-            {
-                src = depth == maxDepth ? dst1 : Mat(y2-y1, x2-x1, depth, &buf[0]);
-                int pairs[] = {k, 0};
-                mixChannels(&src0, 1, &src, 1, pairs, 1);
-            }
+    CV_Assert( depth == tdepth || tdepth == CV_32F);
+    CV_Assert( corrsize.height <= img.rows + templ.rows - 1 &&
+               corrsize.width <= img.cols + templ.cols - 1 );
 
-            if( dst1.data != src.data )
-                src.convertTo(dst1, dst1.depth());
+    CV_Assert( ccn == 1 || delta == 0 );
 
-            if( x2 - x1 < dsz.width || y2 - y1 < dsz.height )
-                copyMakeBorder(dst1, dst, y1-y0, dst.rows-dst1.rows-(y1-y0),
-                               x1-x0, dst.cols-dst1.cols-(x1-x0), borderType);
+    corr.create(corrsize, ctype);
 
-            dft( dftImg, dftImg, 0, dsz.height );
-            Mat dftTempl1(dftTempl, Rect(0, tcn > 1 ? k*dftsize.height : 0,
-                                         dftsize.width, dftsize.height));
-            mulSpectrums(dftImg, dftTempl1, dftImg, 0, true);
-            dft( dftImg, dftImg, DFT_INVERSE + DFT_SCALE, bsz.height );
+    int maxDepth = depth > CV_8S ? CV_64F : std::max(std::max(CV_32F, tdepth), cdepth);
+    Size blocksize, dftsize;
+    getCrossCorrBlocks(templ.size(), corr.size(), blocksize, dftsize);
 
-            src = dftImg(Rect(0, 0, bsz.width, bsz.height));
+    vector<Mat> templs(1, templ), spectra(1), corrs(1, corr);
+    getTemplSpectrum(templ, dftsize, maxDepth, spectra[0]);
+    crossCorr(img, templs, spectra, corrs, templ.size(), blocksize, dftsize,
+              maxDepth, anchor, delta, borderType);
+}
+
+
+class MatchTemplateNormInvoker : public ParallelLoopBody
+{
+public:
+    MatchTemplateNormInvoker( const Mat& _sum, const Mat& _sqsum, Size _templsize, Mat& _result,
+                              int _method, const Scalar& _templMean, double _templNorm,
+                              double _templSum2, double _invArea )
+        : sum(_sum), sqsum(_sqsum), templsize(_templsize), result(_result), method(_method),
+          templMean(_templMean), templNorm(_templNorm), templSum2(_templSum2), invArea(_invArea)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int cn = sum.data ? sum.channels() : sqsum.channels();
+        int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                      method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+        bool isNormed = method == CV_TM_CCORR_NORMED ||
+                        method == CV_TM_SQDIFF_NORMED ||
+                        method == CV_TM_CCOEFF_NORMED;
 
-            if( ccn > 1 )
+        const double *p0 = 0, *p1 = 0, *p2 = 0, *p3 = 0;
+        const double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+
+        if( sum.data )
+        {
+            p0 = (const double*)sum.data;
+            p1 = p0 + templsize.width*cn;
+            p2 = (const double*)(sum.data + templsize.height*sum.step);
+            p3 = p2 + templsize.width*cn;
+        }
+
+        if( sqsum.data )
+        {
+            q0 = (const double*)sqsum.data;
+            q1 = q0 + templsize.width*cn;
+            q2 = (const double*)(sqsum.data + templsize.height*sqsum.step);
+            q3 = q2 + templsize.width*cn;
+        }
+
+        int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
+        int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
+
+        int i, j, k;
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            float* rrow = (float*)(result.data + i*result.step);
+            int idx = i * sumstep;
+            int idx2 = i * sqstep;
+
+            for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
             {
-                if( cdepth != maxDepth )
+                double num = rrow[j], t;
+                double wndMean2 = 0, wndSum2 = 0;
+
+                if( numType == 1 )
                 {
-                    Mat plane(bsz, cdepth, &buf[0]);
-                    src.convertTo(plane, cdepth, 1, delta);
-                    src = plane;
+                    for( k = 0; k < cn; k++ )
+                    {
+                        t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
+                        wndMean2 += CV_SQR(t);
+                        num -= t*templMean[k];
+                    }
+
+                    wndMean2 *= invArea;
                 }
-                int pairs[] = {0, k};
-                mixChannels(&src, 1, &cdst, 1, pairs, 1);
-            }
-            else
-            {
-                if( k == 0 )
-                    src.convertTo(cdst, cdepth, 1, delta);
-                else
+
+                if( isNormed || numType == 2 )
                 {
-                    if( maxDepth != cdepth )
+                    for( k = 0; k < cn; k++ )
                     {
-                        Mat plane(bsz, cdepth, &buf[0]);
-                        src.convertTo(plane, cdepth);
-                        src = plane;
+                        t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
+                        wndSum2 += t;
                     }
-                    add(src, cdst, cdst);
+
+                    if( numType == 2 )
+                        num = wndSum2 - 2*num + templSum2;
+                }
+
+                if( isNormed )
+                {
+                    t = sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
+                    if( fabs(num) < t )
+                        num /= t;
+                    else if( fabs(num) < t*1.125 )
+                        num = num > 0 ? 1 : -1;
+                    else
+                        num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
                 }
+
+                rrow[j] = (float)num;
             }
         }
     }
-}
-
-}
 
-/*****************************************************************************************/
-
-void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result, int method )
+private:
+    const Mat& sum;
+    const Mat& sqsum;
+    Size templsize;
+    Mat& result;
+    int method;
+    Scalar templMean;
+    double templNorm, templSum2, invArea;
+};
+
+/*
+   Turns the correlation into the requested measure using the integrals of the image:
+   sum is needed for CV_TM_CCOEFF*, sqsum for all the methods but CV_TM_CCORR and CV_TM_CCOEFF.
+*/
+static void normalizeTemplMatch( const Mat& sum, const Mat& sqsum, const Mat& templ,
+                                 Mat& result, int method )
 {
-    CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
-
     int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
                   method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
-    bool isNormed = method == CV_TM_CCORR_NORMED ||
-                    method == CV_TM_SQDIFF_NORMED ||
-                    method == CV_TM_CCOEFF_NORMED;
-
-    Mat img = _img.getMat(), templ = _templ.getMat();
-    if( img.rows < templ.rows || img.cols < templ.cols )
-        std::swap(img, templ);
-
-    CV_Assert( (img.depth() == CV_8U || img.depth() == CV_32F) &&
-               img.type() == templ.type() );
-
-    Size corrSize(img.cols - templ.cols + 1, img.rows - templ.rows + 1);
-    _result.create(corrSize, CV_32F);
-    Mat result = _result.getMat();
-
-    int cn = img.channels();
-    crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
-
-    if( method == CV_TM_CCORR )
-        return;
 
     double invArea = 1./((double)templ.rows * templ.cols);
 
-    Mat sum, sqsum;
     Scalar templMean, templSdv;
-    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
     double templNorm = 0, templSum2 = 0;
 
     if( method == CV_TM_CCOEFF )
     {
-        integral(img, sum, CV_64F);
         templMean = mean(templ);
     }
     else
     {
-        integral(img, sum, sqsum, CV_64F);
         meanStdDev( templ, templMean, templSdv );
 
         templNorm = CV_SQR(templSdv[0]) + CV_SQR(templSdv[1]) +
@@ -297,72 +462,146 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
         templSum2 /= invArea;
         templNorm = sqrt(templNorm);
         templNorm /= sqrt(invArea); // care of accuracy here
-
-        q0 = (double*)sqsum.data;
-        q1 = q0 + templ.cols*cn;
-        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
-        q3 = q2 + templ.cols*cn;
     }
 
-    double* p0 = (double*)sum.data;
-    double* p1 = p0 + templ.cols*cn;
-    double* p2 = (double*)(sum.data + templ.rows*sum.step);
-    double* p3 = p2 + templ.cols*cn;
+    parallel_for_(Range(0, result.rows),
+                  MatchTemplateNormInvoker(sum, sqsum, templ.size(), result, method,
+                                           templMean, templNorm, templSum2, invArea));
+}
+
+// computes only the integrals needed by normalizeTemplMatch()
+static void getTemplMatchIntegrals( const Mat& img, int method, Mat& sum, Mat& sqsum )
+{
+    if( method == CV_TM_CCOEFF )
+        integral(img, sum, CV_64F);
+    else if( method == CV_TM_CCOEFF_NORMED )
+        integral(img, sum, sqsum, CV_64F);
+    else
+        integral(img, noArray(), sqsum, CV_64F);
+}
+
+}
+
+/*****************************************************************************************/
+
+void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result, int method )
+{
+    CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
+
+    Mat img = _img.getMat(), templ = _templ.getMat();
+    if( img.rows < templ.rows || img.cols < templ.cols )
+        std::swap(img, templ);
+
+    CV_Assert( (img.depth() == CV_8U || img.depth() == CV_32F) &&
+               img.type() == templ.type() );
 
-    int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
-    int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
+    Size corrSize(img.cols - templ.cols + 1, img.rows - templ.rows + 1);
+    _result.create(corrSize, CV_32F);
+    Mat result = _result.getMat();
 
-    int i, j, k;
+    crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
 
-    for( i = 0; i < result.rows; i++ )
+    if( method == CV_TM_CCORR )
+        return;
+
+    Mat sum, sqsum;
+    getTemplMatchIntegrals( img, method, sum, sqsum );
+    normalizeTemplMatch( sum, sqsum, templ, result, method );
+}
+
+/*****************************************************************************************/
+
+cv::TemplateMatcher::TemplateMatcher() : method(CV_TM_SQDIFF), dftsize(0, 0)
+{
+}
+
+cv::TemplateMatcher::TemplateMatcher( InputArrayOfArrays _templs, int _method ) : dftsize(0, 0)
+{
+    setTemplates(_templs, _method);
+}
+
+cv::TemplateMatcher::~TemplateMatcher()
+{
+}
+
+void cv::TemplateMatcher::setTemplates( InputArrayOfArrays _templs, int _method )
+{
+    CV_Assert( CV_TM_SQDIFF <= _method && _method <= CV_TM_CCOEFF_NORMED );
+
+    std::vector<Mat> t;
+    _templs.getMatVector(t);
+
+    templs.resize(t.size());
+    for( size_t i = 0; i < t.size(); i++ )
     {
-        float* rrow = (float*)(result.data + i*result.step);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
+        CV_Assert( t[i].dims <= 2 && t[i].type() == t[0].type() &&
+                   (t[i].depth() == CV_8U || t[i].depth() == CV_32F) );
+        t[i].copyTo(templs[i]);
+    }
 
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
-        {
-            double num = rrow[j], t;
-            double wndMean2 = 0, wndSum2 = 0;
+    method = _method;
+    spectra.clear();
+    dftsize = Size(0, 0);
+}
 
-            if( numType == 1 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = p0[idx+k] - p1[idx+k] - p2[idx+k] + p3[idx+k];
-                    wndMean2 += CV_SQR(t);
-                    num -= t*templMean[k];
-                }
+int cv::TemplateMatcher::getMethod() const
+{
+    return method;
+}
 
-                wndMean2 *= invArea;
-            }
+const std::vector<cv::Mat>& cv::TemplateMatcher::getTemplates() const
+{
+    return templs;
+}
 
-            if( isNormed || numType == 2 )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    t = q0[idx2+k] - q1[idx2+k] - q2[idx2+k] + q3[idx2+k];
-                    wndSum2 += t;
-                }
+void cv::TemplateMatcher::match( InputArray _img, OutputArrayOfArrays _results )
+{
+    Mat img = _img.getMat();
+    size_t i, n = templs.size();
 
-                if( numType == 2 )
-                    num = wndSum2 - 2*num + templSum2;
-            }
+    CV_Assert( n > 0 && img.dims <= 2 && img.type() == templs[0].type() );
 
-            if( isNormed )
-            {
-                t = sqrt(MAX(wndSum2 - wndMean2,0))*templNorm;
-                if( fabs(num) < t )
-                    num /= t;
-                else if( fabs(num) < t*1.125 )
-                    num = num > 0 ? 1 : -1;
-                else
-                    num = method != CV_TM_SQDIFF_NORMED ? 0 : 1;
-            }
+    Size templsize(0, 0), corrsize(0, 0);
+    for( i = 0; i < n; i++ )
+    {
+        CV_Assert( templs[i].cols <= img.cols && templs[i].rows <= img.rows );
+        templsize.width = std::max(templsize.width, templs[i].cols);
+        templsize.height = std::max(templsize.height, templs[i].rows);
+        corrsize.width = std::max(corrsize.width, img.cols - templs[i].cols + 1);
+        corrsize.height = std::max(corrsize.height, img.rows - templs[i].rows + 1);
+    }
 
-            rrow[j] = (float)num;
-        }
+    // the same working depth as crossCorr() uses for the CV_32F result of matchTemplate()
+    int maxDepth = img.depth() > CV_8S ? CV_64F : CV_32F;
+    Size blocksize, dftsize1;
+    getCrossCorrBlocks(templsize, corrsize, blocksize, dftsize1);
+
+    // the spectra stay valid as long as the DFT size does not change
+    if( dftsize1 != dftsize || spectra.size() != n )
+    {
+        spectra.resize(n);
+        for( i = 0; i < n; i++ )
+            getTemplSpectrum(templs[i], dftsize1, maxDepth, spectra[i]);
+        dftsize = dftsize1;
+    }
+
+    std::vector<Mat> results(n);
+    _results.create((int)n, 1, CV_32F);
+    for( i = 0; i < n; i++ )
+    {
+        _results.create(img.rows - templs[i].rows + 1, img.cols - templs[i].cols + 1, CV_32F, (int)i);
+        results[i] = _results.getMat((int)i);
     }
+
+    crossCorr( img, templs, spectra, results, templsize, blocksize, dftsize, maxDepth, Point(0,0), 0, 0 );
+
+    if( method == CV_TM_CCORR )
+        return;
+
+    Mat sum, sqsum;
+    getTemplMatchIntegrals( img, method, sum, sqsum );
+    for( i = 0; i < n; i++ )
+        normalizeTemplMatch( sum, sqsum, templs[i], results[i], method );
 }
 
 
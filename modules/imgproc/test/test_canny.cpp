@@ -284,4 +284,28 @@ int CV_CannyTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_Canny, accuracy) { CV_CannyTest test; test.safe_run(); }
 
+// the image is processed by bands in parallel, the edges crossing the bands must be the same
+TEST(Imgproc_Canny, parallel_bands)
+{
+    RNG& rng = theRNG();
+    Mat src(480, 641, CV_8UC3);
+    rng.fill(src, RNG::UNIFORM, 0, 256);
+    GaussianBlur(src, src, Size(7, 7), 2.5);
+
+    cvtest::ParallelSettingsGuard guard;
+    for( int k = 0; k < 4; k++ )
+    {
+        Mat img = k % 2 ? src : src.colRange(7, 600), ref, dst;
+        bool L2gradient = k >= 2;
+
+        setNumThreads(1);
+        Canny(img, ref, 5, 20, 3, L2gradient);
+        setNumThreads(4);
+        Canny(img, dst, 5, 20, 3, L2gradient);
+
+        EXPECT_GT(countNonZero(ref), 0);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "L2gradient = " << L2gradient;
+    }
+}
+
 /* End of file. */
@@ -1951,3 +1951,25 @@ TEST(Imgproc_ColorLab_Full, accuracy)
 //    imshow("OpenCV", recons);
 //    waitKey();
 }
+
+// the SIMD paths (including the runtime-dispatched AVX2 kernel) must give the same results as the plain C code
+TEST(Imgproc_ColorGray, optimized_equals_plain)
+{
+    RNG& rng = theRNG();
+    const int codes[][2] = { { CV_8UC3, CV_BGR2GRAY }, { CV_8UC3, CV_RGB2GRAY }, { CV_8UC4, CV_BGRA2GRAY }, { CV_8UC4, CV_RGBA2GRAY } };
+    const Size sizes[] = { Size(640, 480), Size(37, 21), Size(1, 50) };
+    cvtest::ParallelSettingsGuard guard;
+
+    for( size_t i = 0; i < sizeof(codes)/sizeof(codes[0]); i++ )
+        for( size_t j = 0; j < sizeof(sizes)/sizeof(sizes[0]); j++ )
+        {
+            Mat src(sizes[j], codes[i][0]), dst[2];
+            rng.fill(src, RNG::UNIFORM, 0, 256);
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                cvtColor(src, dst[k], codes[i][1]);
+            }
+            EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "code " << codes[i][1] << ", size " << j;
+        }
+}
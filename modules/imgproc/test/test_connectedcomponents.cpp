@@ -0,0 +1,146 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+// reference labeling: breadth-first search started from the unlabeled pixels in raster order
+static int ccReference( const Mat& src, Mat& labels, int connectivity, Mat& stats, Mat& centroids )
+{
+    labels = Mat::zeros(src.size(), CV_32S);
+    vector<Point> queue;
+    int nlabels = 1;
+
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols; x++ )
+        {
+            if( !src.at<uchar>(y, x) || labels.at<int>(y, x) )
+                continue;
+            queue.clear();
+            queue.push_back(Point(x, y));
+            labels.at<int>(y, x) = nlabels;
+            for( size_t i = 0; i < queue.size(); i++ )
+            {
+                Point p = queue[i];
+                for( int dy = -1; dy <= 1; dy++ )
+                    for( int dx = -1; dx <= 1; dx++ )
+                    {
+                        Point q(p.x + dx, p.y + dy);
+                        if( (dx == 0 && dy == 0) || (connectivity == 4 && dx != 0 && dy != 0) ||
+                            q.x < 0 || q.y < 0 || q.x >= src.cols || q.y >= src.rows ||
+                            !src.at<uchar>(q) || labels.at<int>(q) )
+                            continue;
+                        labels.at<int>(q) = nlabels;
+                        queue.push_back(q);
+                    }
+            }
+            nlabels++;
+        }
+
+    stats = Mat::zeros(nlabels, CC_STAT_MAX, CV_32S);
+    centroids = Mat::zeros(nlabels, 2, CV_64F);
+    vector<Rect> boxes(nlabels);
+    for( int y = 0; y < src.rows; y++ )
+        for( int x = 0; x < src.cols; x++ )
+        {
+            int l = labels.at<int>(y, x);
+            Rect r(x, y, 1, 1);
+            boxes[l] = stats.at<int>(l, CC_STAT_AREA)++ == 0 ? r : boxes[l] | r;
+            centroids.at<double>(l, 0) += x;
+            centroids.at<double>(l, 1) += y;
+        }
+    for( int l = 0; l < nlabels; l++ )
+    {
+        int* row = stats.ptr<int>(l);
+        row[CC_STAT_LEFT] = boxes[l].x;
+        row[CC_STAT_TOP] = boxes[l].y;
+        row[CC_STAT_WIDTH] = boxes[l].width;
+        row[CC_STAT_HEIGHT] = boxes[l].height;
+        if( row[CC_STAT_AREA] > 0 )
+            centroids.row(l) *= 1./row[CC_STAT_AREA];
+    }
+    return nlabels;
+}
+
+TEST(Imgproc_ConnectedComponents, accuracy)
+{
+    RNG& rng = theRNG();
+    cvtest::ParallelSettingsGuard guard;
+
+    for( int iter = 0; iter < 4; iter++ )
+    {
+        Mat src(400 + iter*37, 300 + iter*53, CV_8U);
+        rng.fill(src, RNG::UNIFORM, 0, 100);
+        // sparse noise, dense noise, blobs and a mask without background
+        src = iter == 0 ? src < 10 : iter == 1 ? src < 55 : iter == 3 ? src >= 0 : src;
+        if( iter == 2 )
+        {
+            GaussianBlur(src, src, Size(15, 15), 5);
+            src = src > 50;
+        }
+
+        for( int connectivity = 4; connectivity <= 8; connectivity += 4 )
+        {
+            Mat ref, refStats, refCentroids;
+            int nref = ccReference(src, ref, connectivity, refStats, refCentroids);
+
+            for( int k = 0; k < 3; k++ )
+            {
+                Mat labels, stats, centroids;
+                setNumThreads(k == 0 ? 1 : 4);
+                int ltype = k == 2 ? CV_16U : CV_32S;
+                int n = connectedComponentsWithStats(src, labels, stats, centroids, connectivity, ltype);
+                int n1 = connectedComponents(src, labels, connectivity, ltype);
+
+                ASSERT_EQ(nref, n) << "iter=" << iter << " connectivity=" << connectivity;
+                ASSERT_EQ(nref, n1);
+                ASSERT_EQ(ltype, labels.type());
+                labels.convertTo(labels, CV_32S);
+                EXPECT_EQ(0, norm(ref, labels, NORM_INF));
+                EXPECT_EQ(0, norm(refStats, stats, NORM_INF));
+                EXPECT_LE(norm(refCentroids, centroids, NORM_INF), 1e-9);
+            }
+        }
+    }
+}
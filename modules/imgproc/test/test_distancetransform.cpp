@@ -295,3 +295,134 @@ void CV_DisTransTest::prepare_to_validation( int /*test_case_idx*/ )
 TEST(Imgproc_DistanceTransform, accuracy) { CV_DisTransTest test; test.safe_run(); }
 
 
+
+TEST(Imgproc_DistanceTransform, parallel)
+{
+    RNG& rng = theRNG();
+    Mat src(480, 640, CV_8U);
+    rng.fill(src, RNG::UNIFORM, 0, 1000);
+    src = src > 2;
+    src(Rect(100, 200, 50, 30)) = Scalar::all(0);
+
+    cvtest::ParallelSettingsGuard guard;
+    const int types[][2] =
+    {
+        { CV_DIST_C, 3 }, { CV_DIST_L1, 3 }, { CV_DIST_L2, 3 }, { CV_DIST_L2, 5 }
+    };
+
+    for( int k = 0; k < 4; k++ )
+    {
+        Mat ref, dst;
+        setNumThreads(1);
+        distanceTransform(src, ref, types[k][0], types[k][1]);
+        setNumThreads(4);
+        distanceTransform(src, dst, types[k][0], types[k][1]);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "distanceType=" << types[k][0] << " maskSize=" << types[k][1];
+    }
+
+    // 8-bit L1 distance map, computed in-place
+    Mat ref8u(src.size(), CV_8U), dst8u = src.clone();
+    CvMat c_src = src, c_ref8u = ref8u, c_dst8u = dst8u;
+    setNumThreads(1);
+    cvDistTransform(&c_src, &c_ref8u, CV_DIST_L1, 3);
+    setNumThreads(4);
+    cvDistTransform(&c_dst8u, &c_dst8u, CV_DIST_L1, 3);
+    EXPECT_EQ(0, norm(ref8u, dst8u, NORM_INF));
+
+    // Voronoi labels: the distances must match the serial version and every label must
+    // point to a zero pixel at that very distance (ties may be resolved differently)
+    Mat ref, dst, labels, labels0;
+    setNumThreads(1);
+    distanceTransform(src, ref, labels0, CV_DIST_L2, 5, DIST_LABEL_PIXEL);
+    setNumThreads(4);
+    distanceTransform(src, dst, labels, CV_DIST_L2, 5, DIST_LABEL_PIXEL);
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+
+    vector<Point> zeros;
+    for( int i = 0; i < src.rows; i++ )
+        for( int j = 0; j < src.cols; j++ )
+            if( src.at<uchar>(i, j) == 0 )
+                zeros.push_back(Point(j, i));
+
+    const int a = cvRound(65536), b = cvRound(1.4*65536), c = cvRound(2.1969*65536);
+    int nerrors = 0;
+    for( int i = 0; i < src.rows; i++ )
+        for( int j = 0; j < src.cols; j++ )
+        {
+            int l = labels.at<int>(i, j);
+            ASSERT_TRUE(1 <= l && l <= (int)zeros.size());
+            int x = std::abs(j - zeros[l-1].x), y = std::abs(i - zeros[l-1].y);
+            if( x < y )
+                std::swap(x, y);
+            int d = x >= y*2 ? y*c + (x - y*2)*a : (x - y)*c + (y*2 - x)*b;
+            nerrors += (float)(d*(1.f/65536)) != dst.at<float>(i, j);
+        }
+    EXPECT_EQ(0, nerrors);
+}
+
+// A few isolated zeros in a large image give long distances, which the chamfer passes and
+// the saturated 8-bit L1 map (icvDistanceATS_L1_8u in one thread) carry across many stripes.
+TEST(Imgproc_DistanceTransform, sparse_zeros)
+{
+    Mat src(1200, 1600, CV_8U, Scalar::all(1));
+    const Point zeros[] = { Point(1500, 7), Point(3, 600), Point(900, 1190) };
+    for( int k = 0; k < 3; k++ )
+        src.at<uchar>(zeros[k]) = 0;
+
+    // the exact C and L1 distances to the nearest zero
+    Mat distC(src.size(), CV_32F), distL1(src.size(), CV_32F);
+    for( int i = 0; i < src.rows; i++ )
+        for( int j = 0; j < src.cols; j++ )
+        {
+            int c = INT_MAX, l1 = INT_MAX;
+            for( int k = 0; k < 3; k++ )
+            {
+                int x = std::abs(j - zeros[k].x), y = std::abs(i - zeros[k].y);
+                c = std::min(c, std::max(x, y));
+                l1 = std::min(l1, x + y);
+            }
+            distC.at<float>(i, j) = (float)c;
+            distL1.at<float>(i, j) = (float)l1;
+        }
+
+    cvtest::ParallelSettingsGuard guard;
+    const int types[][2] =
+    {
+        { CV_DIST_C, 3 }, { CV_DIST_L1, 3 }, { CV_DIST_L2, 3 }, { CV_DIST_L2, 5 }
+    };
+
+    for( int k = 0; k < 4; k++ )
+    {
+        Mat ref, dst;
+        setNumThreads(1);
+        distanceTransform(src, ref, types[k][0], types[k][1]);
+        setNumThreads(4);
+        distanceTransform(src, dst, types[k][0], types[k][1]);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "distanceType=" << types[k][0] << " maskSize=" << types[k][1];
+
+        if( types[k][0] == CV_DIST_C )
+            EXPECT_EQ(0, norm(distC, dst, NORM_INF));
+        else if( types[k][0] == CV_DIST_L1 )
+            EXPECT_EQ(0, norm(distL1, dst, NORM_INF));
+        else
+        {
+            // the reference accumulates the distances in floating point
+            Mat ts_ref(src.size(), CV_32F);
+            CvMat c_src = src, c_ts_ref = ts_ref;
+            cvTsDistTransform(&c_src, &c_ts_ref, types[k][0], types[k][1], 0, 0);
+            EXPECT_LE(norm(ts_ref, dst, NORM_INF), 0.1) << "maskSize=" << types[k][1];
+        }
+    }
+
+    // the 8-bit L1 map saturates at 255
+    Mat ref8u, dst8u(src.size(), CV_8U);
+    distL1.convertTo(ref8u, CV_8U);
+    CvMat c_src = src, c_dst8u = dst8u;
+    for( int t = 0; t < 2; t++ )
+    {
+        setNumThreads(t == 0 ? 1 : 4);
+        dst8u = Scalar::all(0);
+        cvDistTransform(&c_src, &c_dst8u, CV_DIST_L1, 3);
+        EXPECT_EQ(0, norm(ref8u, dst8u, NORM_INF)) << "threads " << (t == 0 ? 1 : 4);
+    }
+}
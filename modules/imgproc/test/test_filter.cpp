@@ -1887,3 +1887,320 @@ protected:
 
 TEST(Imgproc_Filtering, supportedFormats) { CV_FilterSupportedFormatsTest test; test.safe_run(); }
 
+
+// FilterEngine::apply() processes the image by stripes in parallel;
+// the result must be the same as the one of the serial start()/proceed() loop.
+TEST(Imgproc_FilterEngine, parallel_stripes)
+{
+    RNG& rng = theRNG();
+    Mat big(720, 800, CV_8UC3), big32f;
+    rng.fill(big, RNG::UNIFORM, 0, 256);
+    big.convertTo(big32f, CV_32F, 1./255);
+
+    Mat kernel2d(5, 7, CV_32F);
+    rng.fill(kernel2d, RNG::UNIFORM, -1, 1);
+
+    Ptr<FilterEngine> engines[] =
+    {
+        createGaussianFilter(CV_8UC3, Size(5, 5), 1.5),
+        createDerivFilter(CV_8UC3, CV_16SC3, 1, 0, 3, BORDER_REPLICATE),
+        createBoxFilter(CV_8UC3, CV_8UC3, Size(7, 7), Point(-1,-1), true, BORDER_REFLECT),
+        createLinearFilter(CV_32FC3, CV_32FC3, kernel2d, Point(2, 1), 0., BORDER_CONSTANT, -1, Scalar::all(0.5)),
+        createMorphologyFilter(MORPH_DILATE, CV_8UC3, getStructuringElement(MORPH_ELLIPSE, Size(5, 5)))
+    };
+
+    cvtest::ParallelSettingsGuard guard;
+    setNumThreads(4);
+
+    for( size_t i = 0; i < sizeof(engines)/sizeof(engines[0]); i++ )
+    {
+        FilterEngine& f = *engines[i];
+        const Mat& whole = CV_MAT_DEPTH(f.srcType) == CV_32F ? big32f : big;
+
+        for( int isolated = 0; isolated < 2; isolated++ )
+        {
+            Mat src = whole(Rect(3, 5, 777, 700));
+            Rect roi(10, 20, 700, 600);
+            Mat dst(roi.size(), f.dstType), ref(roi.size(), f.dstType);
+
+            f.apply(src, dst, roi, Point(), isolated != 0);
+
+            int y = f.start(src, roi, isolated != 0);
+            f.proceed(src.ptr(y), (int)src.step, f.endY - f.startY, ref.data, (int)ref.step);
+
+            EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "engine " << i << ", isolated " << isolated;
+        }
+    }
+}
+
+TEST(Imgproc_FilterPipeline, accuracy)
+{
+    RNG& rng = theRNG();
+    Mat src(123, 211, CV_8UC3);
+    rng.fill(src, RNG::UNIFORM, 0, 256);
+
+    // BGR -> gray -> Gaussian -> Sobel x, y -> L2 magnitude, computed stage by stage
+    Mat gray, smoothed, dx, dy, fdx, fdy, ref;
+    cvtColor(src, gray, COLOR_BGR2GRAY);
+    GaussianBlur(gray, smoothed, Size(5, 5), 1.2);
+    Sobel(smoothed, dx, CV_16S, 1, 0, 3);
+    Sobel(smoothed, dy, CV_16S, 0, 1, 5);
+    dx.convertTo(fdx, CV_32F);
+    dy.convertTo(fdy, CV_32F);
+    magnitude(fdx, fdy, ref);
+
+    FilterPipeline p;
+    p.addRowOp(getColorConversionRowOp(CV_8UC3, COLOR_BGR2GRAY));
+    p.addFilter(createGaussianFilter(CV_8UC1, Size(5, 5), 1.2));
+    p.addFilterPair(createDerivFilter(CV_8UC1, CV_16SC1, 1, 0, 3),
+                    createDerivFilter(CV_8UC1, CV_16SC1, 0, 1, 5),
+                    getMagnitudeRowOp(CV_16SC1));
+    ASSERT_EQ(CV_8UC3, p.srcType());
+    ASSERT_EQ(CV_32FC1, p.dstType());
+
+    int strips[] = { 0, 1, 2, 7, 1000 };
+    for( size_t i = 0; i < sizeof(strips)/sizeof(strips[0]); i++ )
+    {
+        Mat dst;
+        p.apply(src, dst, strips[i]);
+        EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "strip rows " << strips[i];
+    }
+
+    // L1 magnitude converted back to 8 bits, in-place
+    Mat ref8u, dst = gray.clone();
+    Sobel(gray, dx, CV_16S, 1, 0, 3);
+    Sobel(gray, dy, CV_16S, 0, 1, 3);
+    convertScaleAbs(abs(dx) + abs(dy), ref8u, 0.25);
+
+    p.clear();
+    p.addFilterPair(createDerivFilter(CV_8UC1, CV_16SC1, 1, 0, 3),
+                    createDerivFilter(CV_8UC1, CV_16SC1, 0, 1, 3),
+                    getMagnitudeRowOp(CV_16SC1, false));
+    p.addRowOp(getConvertRowOp(CV_32FC1, CV_8UC1, 0.25));
+    p.apply(dst, dst, 5);
+    EXPECT_EQ(0, norm(dst, ref8u, NORM_INF));
+
+    // the row converters set up once give the same rows as cvtColor, including
+    // the 4:2:2 formats that are converted by cvtColor row by row
+    Mat src32f;
+    src.convertTo(src32f, CV_32F, 1./255);
+    const int codes[][2] =
+    {
+        { CV_8UC3, COLOR_BGR2HSV }, { CV_8UC3, COLOR_RGB2Lab }, { CV_32FC3, COLOR_BGR2Luv },
+        { CV_32FC3, COLOR_BGR2GRAY }, { CV_8UC2, COLOR_YUV2BGR_YUY2 }
+    };
+    for( size_t i = 0; i < sizeof(codes)/sizeof(codes[0]); i++ )
+    {
+        Mat s = codes[i][0] == CV_8UC3 ? src : codes[i][0] == CV_32FC3 ? src32f :
+            Mat(src.rows, src.cols/2*2, CV_8UC2, src.data, src.step);
+        Mat d;
+        cvtColor(s, ref, codes[i][1]);
+        p.clear();
+        p.addRowOp(getColorConversionRowOp(codes[i][0], codes[i][1]));
+        p.apply(s, d);
+        EXPECT_EQ(0, norm(d, ref, NORM_INF)) << "code " << codes[i][1];
+    }
+}
+
+// The up-right integrals are computed by separate row and column passes (in parallel
+// when possible), the tilted one by a vectorized pass over the rows; the results must not
+// depend on the outputs requested, the number of threads or the SIMD code.
+TEST(Imgproc_Integral, parallel_and_partial_outputs)
+{
+    RNG& rng = theRNG();
+    const int types[][2] =
+    {
+        { CV_8UC1, CV_32S }, { CV_8UC3, CV_32S }, { CV_8UC1, CV_32F }, { CV_8UC1, CV_64F },
+        { CV_32FC1, CV_32F }, { CV_32FC2, CV_64F }, { CV_64FC1, CV_64F }
+    };
+
+    cvtest::ParallelSettingsGuard guard;
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+    {
+        Mat src(493, 611, types[i][0]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+        int sdepth = types[i][1];
+
+        Mat sum0, sqsum0, tilted0;
+        integral(src, sum0, sqsum0, tilted0, sdepth);
+
+        for( int t = 1; t <= 4; t *= 4 )
+        {
+            setNumThreads(t);
+
+            Mat sum, sqsum, sum1, sqsum1;
+            integral(src, sum, sqsum, sdepth);
+            integral(src, sum1, sdepth);
+            integral(src, noArray(), sqsum1, sdepth);
+
+            EXPECT_EQ(0, norm(sum, sum0, NORM_INF)) << "case " << i << ", threads " << t;
+            EXPECT_EQ(0, norm(sqsum, sqsum0, NORM_INF)) << "case " << i << ", threads " << t;
+            EXPECT_EQ(0, norm(sum1, sum0, NORM_INF)) << "case " << i << ", threads " << t;
+            EXPECT_EQ(0, norm(sqsum1, sqsum0, NORM_INF)) << "case " << i << ", threads " << t;
+        }
+
+        Mat sqsum2, tilted2;
+        integral(src, noArray(), sqsum2, tilted2, sdepth);
+        EXPECT_EQ(0, norm(sqsum2, sqsum0, NORM_INF)) << "case " << i;
+        EXPECT_EQ(0, norm(tilted2, tilted0, NORM_INF)) << "case " << i;
+
+        setUseOptimized(false);
+        Mat sum3, sqsum3, tilted3;
+        integral(src, sum3, sqsum3, tilted3, sdepth);
+        setUseOptimized(true);
+        EXPECT_EQ(0, norm(sum3, sum0, NORM_INF)) << "case " << i;
+        EXPECT_EQ(0, norm(sqsum3, sqsum0, NORM_INF)) << "case " << i;
+        EXPECT_EQ(0, norm(tilted3, tilted0, NORM_INF)) << "case " << i;
+    }
+}
+
+// pyrDown/pyrUp process horizontal bands in parallel, and buildPyramid computes all the levels
+// in a single pass when running in one thread; neither may change the result.
+TEST(Imgproc_Pyramid, parallel_and_streaming)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC2, CV_32FC1, CV_32FC4, CV_64FC1 };
+    const Size sizes[] = { Size(641, 483), Size(300, 2), Size(1, 97), Size(1024, 768) };
+    const int borders[] = { BORDER_DEFAULT, BORDER_REPLICATE };
+
+    cvtest::ParallelSettingsGuard guard;
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+        for( size_t j = 0; j < sizeof(sizes)/sizeof(sizes[0]); j++ )
+        {
+            Mat src(sizes[j], types[i]);
+            rng.fill(src, RNG::UNIFORM, 0, 256);
+
+            Mat down[2], up[2];
+
+            for( int t = 0; t < 2; t++ )
+            {
+                setNumThreads(t == 0 ? 1 : 4);
+                pyrDown(src, down[t]);
+                pyrUp(src, up[t]);
+            }
+
+            EXPECT_EQ(0, norm(down[0], down[1], NORM_INF)) << "type " << types[i] << ", size " << j;
+            EXPECT_EQ(0, norm(up[0], up[1], NORM_INF)) << "type " << types[i] << ", size " << j;
+
+            for( int b = 0; b < 2; b++ )
+            {
+                // the single-pass pyramid (one thread), the parallel one
+                // and the levels computed one by one must be the same
+                vector<Mat> pyr[2];
+                for( int t = 0; t < 2; t++ )
+                {
+                    setNumThreads(t == 0 ? 1 : 4);
+                    buildPyramid(src, pyr[t], 4, borders[b]);
+                }
+
+                setNumThreads(1);
+                ASSERT_EQ(5u, pyr[0].size());
+                ASSERT_EQ(5u, pyr[1].size());
+                Mat level = src;
+                for( int k = 0; k <= 4; k++ )
+                {
+                    if( k > 0 )
+                    {
+                        Mat next;
+                        pyrDown(level, next, Size(), borders[b]);
+                        level = next;
+                    }
+                    for( int t = 0; t < 2; t++ )
+                    {
+                        ASSERT_EQ(level.size(), pyr[t][k].size());
+                        EXPECT_EQ(0, norm(level, pyr[t][k], NORM_INF)) << "type " << types[i] << ", size " << j
+                            << ", border " << borders[b] << ", threads " << (t == 0 ? 1 : 4) << ", level " << k;
+                    }
+                }
+            }
+        }
+}
+
+// long rectangular and line kernels go through the van Herk/Gil-Werman filters;
+// the compound operations and the in-place iterations are processed by parallel bands
+TEST(Imgproc_Morphology, vhgw_and_parallel)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_16SC1, CV_32FC1, CV_64FC1 };
+    const Size ksizes[] = { Size(31, 31), Size(41, 1), Size(1, 41), Size(17, 23) };
+    cvtest::ParallelSettingsGuard guard;
+
+    for( int t = 0; t < 5; t++ )
+    {
+        Mat src(160, 173, types[t]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+
+        for( int k = 0; k < 4; k++ )
+        {
+            Mat kernel = getStructuringElement(MORPH_RECT, ksizes[k]);
+            Point anchor(ksizes[k].width/3, ksizes[k].height/3);
+            Mat dst, ref;
+
+            erode(src, dst, kernel, anchor, 1, BORDER_REPLICATE);
+            cvtest::erode(src, ref, kernel, anchor, BORDER_REPLICATE);
+            EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "type " << types[t] << ", ksize " << ksizes[k];
+
+            dilate(src, dst, kernel, anchor, 1, BORDER_REPLICATE);
+            cvtest::dilate(src, ref, kernel, anchor, BORDER_REPLICATE);
+            EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "type " << types[t] << ", ksize " << ksizes[k];
+        }
+    }
+
+    Mat src(480, 640, CV_8UC1);
+    rng.fill(src, RNG::UNIFORM, 0, 256);
+    Mat ellipse = getStructuringElement(MORPH_ELLIPSE, Size(9, 9));
+    Mat rect = getStructuringElement(MORPH_RECT, Size(25, 25));
+
+    for( int op = MORPH_ERODE; op <= MORPH_BLACKHAT; op++ )
+        for( int i = 0; i < 2; i++ )
+        {
+            const Mat& kernel = i == 0 ? ellipse : rect;
+            Mat ref, dst = src.clone();
+            setNumThreads(1);
+            morphologyEx(src, ref, op, kernel, Point(-1, -1), 2);
+            setNumThreads(4);
+            morphologyEx(dst, dst, op, kernel, Point(-1, -1), 2);
+            EXPECT_EQ(0, norm(dst, ref, NORM_INF)) << "op " << op << ", kernel " << i;
+        }
+}
+
+// the fixed-point 8-bit separable filters go through the runtime-dispatched AVX2 row and
+// symmetrical column kernels. The integer Sobel filters must give the same results as the
+// plain C code; the SIMD column filters of GaussianBlur compute in float, unlike the C code,
+// so they may differ from it by 1.
+TEST(Imgproc_SepFilter, optimized_equals_plain)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4 };
+    const int ksizes[] = { 3, 5, 7, 11 };
+    cvtest::ParallelSettingsGuard guard;
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+    {
+        Mat src(311, 453, types[i]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+
+        for( size_t j = 0; j < sizeof(ksizes)/sizeof(ksizes[0]); j++ )
+        {
+            Mat blurred[2], dx[2], dy[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                GaussianBlur(src, blurred[k], Size(ksizes[j], ksizes[j] + 2), 0, 0, BORDER_REFLECT_101);
+                if( ksizes[j] <= 7 )
+                {
+                    Sobel(src, dx[k], CV_16S, 1, 0, ksizes[j]);
+                    Sobel(src, dy[k], CV_16S, 0, 1, ksizes[j]);
+                }
+            }
+            EXPECT_LE(norm(blurred[0], blurred[1], NORM_INF), 1) << "type " << types[i] << ", ksize " << ksizes[j];
+            if( ksizes[j] <= 7 )
+            {
+                EXPECT_EQ(0, norm(dx[0], dx[1], NORM_INF)) << "type " << types[i] << ", ksize " << ksizes[j];
+                EXPECT_EQ(0, norm(dy[0], dy[1], NORM_INF)) << "type " << types[i] << ", ksize " << ksizes[j];
+            }
+        }
+    }
+}
@@ -1834,4 +1834,58 @@ TEST(Imgproc_Hist_CalcBackProject, accuracy) { CV_CalcBackProjectTest test; test
 TEST(Imgproc_Hist_CalcBackProjectPatch, accuracy) { CV_CalcBackProjectPatchTest test; test.safe_run(); }
 TEST(Imgproc_Hist_BayesianProb, accuracy) { CV_BayesianProbTest test; test.safe_run(); }
 
+
+// The histograms are accumulated by stripes with private partial histograms when several threads
+// are available; the results must not depend on the number of threads.
+TEST(Imgproc_Hist_Calc, parallel)
+{
+    RNG& rng = theRNG();
+    Mat big(600, 700, CV_8UC3), big32f, mask(600, 700, CV_8U);
+    rng.fill(big, RNG::UNIFORM, 0, 256);
+    rng.fill(mask, RNG::UNIFORM, 0, 2);
+    big.convertTo(big32f, CV_32F, 1./255);
+
+    // a continuous image and a ROI
+    Mat images[] = { big, big(Rect(7, 3, 650, 580)) };
+    Mat images32f[] = { big32f, big32f(Rect(7, 3, 650, 580)) };
+    Mat masks[] = { mask, mask(Rect(7, 3, 650, 580)) };
+
+    int channels[] = { 2, 0, 1 };
+    int sizes[] = { 256, 30, 32, 8 }, sizes32f[] = { 3, 3 };
+    float r0[] = { 0, 256 }, r1[] = { 0.f, 0.25f, 0.5f, 1.1f };
+    const float* ranges8u[] = { r0, r0, r0 };
+    const float* ranges32f[] = { r1, r1 };
+
+    cvtest::ParallelSettingsGuard guard;
+
+    for( int i = 0; i < 2; i++ )
+    {
+        Mat hist[2][5], bproj[2][2], eq[2];
+
+        for( int t = 0; t < 2; t++ )
+        {
+            setNumThreads(t == 0 ? 1 : 4);
+            calcHist(&images[i], 1, channels, Mat(), hist[t][0], 1, sizes, ranges8u);
+            calcHist(&images[i], 1, channels, masks[i], hist[t][1], 1, sizes, ranges8u);
+            calcHist(&images[i], 1, channels, Mat(), hist[t][2], 3, sizes + 1, ranges8u);
+            calcHist(&images32f[i], 1, channels, masks[i], hist[t][3], 2, sizes32f, ranges32f, false);
+            calcHist(&images32f[i], 1, channels, Mat(), hist[t][4], 2, sizes32f, ranges32f, false);
+
+            calcBackProject(&images[i], 1, channels, hist[t][2], bproj[t][0], ranges8u, 0.01);
+            calcBackProject(&images32f[i], 1, channels, hist[t][4], bproj[t][1], ranges32f, 0.01, false);
+
+            Mat gray;
+            extractChannel(images[i], gray, 1);
+            equalizeHist(gray, eq[t]);
+        }
+
+        for( int k = 0; k < 5; k++ )
+            EXPECT_EQ(0, norm(hist[0][k], hist[1][k], NORM_INF)) << "image " << i << ", hist " << k;
+        EXPECT_EQ(images[i].total()*1., sum(hist[0][2])[0]);
+        for( int k = 0; k < 2; k++ )
+            EXPECT_EQ(0, norm(bproj[0][k], bproj[1][k], NORM_INF)) << "image " << i << ", backproject " << k;
+        EXPECT_EQ(0, norm(eq[0], eq[1], NORM_INF)) << "image " << i;
+    }
+}
+
 /* End Of File */
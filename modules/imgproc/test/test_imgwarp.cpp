@@ -1545,4 +1545,61 @@ TEST(Imgproc_InitUndistortMap, accuracy) { CV_UndistortMapTest test; test.safe_r
 TEST(Imgproc_GetRectSubPix, accuracy) { CV_GetRectSubPixTest test; test.safe_run(); }
 TEST(Imgproc_GetQuadSubPix, accuracy) { CV_GetQuadSubPixTest test; test.safe_run(); }
 
+// the SIMD paths (including the runtime-dispatched AVX/AVX2 kernels) must give the same results as the plain C code
+TEST(Imgproc_Resize, optimized_equals_plain)
+{
+    RNG& rng = theRNG();
+    cvtest::ParallelSettingsGuard guard;
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_32FC1, CV_32FC3 };
+    const Size dsizes[] = { Size(333, 250), Size(1031, 777), Size(64, 1200) };
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+    {
+        Mat src(517, 640, types[i]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+
+        for( size_t j = 0; j < sizeof(dsizes)/sizeof(dsizes[0]); j++ )
+        {
+            Mat dst[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                resize(src, dst[k], dsizes[j], 0, 0, INTER_LINEAR);
+            }
+            EXPECT_EQ(0, norm(dst[0], dst[1], NORM_INF)) << "type " << types[i] << ", size " << dsizes[j];
+        }
+    }
+}
+
+TEST(Imgproc_Warp, optimized_equals_plain)
+{
+    RNG& rng = theRNG();
+    cvtest::ParallelSettingsGuard guard;
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32FC1 };
+    const int interps[] = { INTER_NEAREST, INTER_LINEAR };
+
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+    {
+        Mat src(480, 640, types[i]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+        Mat A = getRotationMatrix2D(Point2f(320.f, 240.f), 17., 1.3);
+        Point2f from[] = { Point2f(0, 0), Point2f(639, 0), Point2f(639, 479), Point2f(0, 479) };
+        Point2f to[] = { Point2f(20, 35), Point2f(600, 5), Point2f(630, 470), Point2f(3, 400) };
+        Mat P = getPerspectiveTransform(from, to);
+
+        for( size_t j = 0; j < sizeof(interps)/sizeof(interps[0]); j++ )
+        {
+            Mat affine[2], persp[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                setUseOptimized(k == 0);
+                warpAffine(src, affine[k], A, Size(700, 500), interps[j], BORDER_REFLECT);
+                warpPerspective(src, persp[k], P, Size(700, 500), interps[j], BORDER_CONSTANT);
+            }
+            EXPECT_EQ(0, norm(affine[0], affine[1], NORM_INF)) << "type " << types[i] << ", interpolation " << interps[j];
+            EXPECT_EQ(0, norm(persp[0], persp[1], NORM_INF)) << "type " << types[i] << ", interpolation " << interps[j];
+        }
+    }
+}
+
 /* End of file. */
@@ -334,3 +334,58 @@ void CV_TemplMatchTest::prepare_to_validation( int /*test_case_idx*/ )
 }
 
 TEST(Imgproc_MatchTemplate, accuracy) { CV_TemplMatchTest test; test.safe_run(); }
+
+// The blocks are correlated in parallel; TemplateMatcher shares the image DFT between the templates.
+TEST(Imgproc_MatchTemplate, parallel_and_batch)
+{
+    RNG& rng = theRNG();
+    Mat img8u(480, 640, CV_8UC3);
+    rng.fill(img8u, RNG::UNIFORM, 0, 256);
+    GaussianBlur(img8u, img8u, Size(5, 5), 2);
+
+    cvtest::ParallelSettingsGuard guard;
+
+    for( int k = 0; k < 2; k++ )
+    {
+        int depth = k == 0 ? CV_8U : CV_32F;
+        Mat img;
+        img8u.convertTo(img, depth, depth == CV_8U ? 1 : 1./255);
+
+        vector<Mat> templs;
+        templs.push_back(img(Rect(100, 200, 61, 45)).clone());
+        templs.push_back(img(Rect(500, 30, 17, 90)).clone());
+        templs.push_back(img(Rect(440, 350, 120, 80)).clone());
+
+        for( int method = CV_TM_SQDIFF; method <= CV_TM_CCOEFF_NORMED; method++ )
+        {
+            vector<Mat> refs(templs.size());
+            for( size_t i = 0; i < templs.size(); i++ )
+            {
+                Mat ref1;
+                setNumThreads(1);
+                matchTemplate(img, templs[i], refs[i], method);
+                setNumThreads(4);
+                matchTemplate(img, templs[i], ref1, method);
+                EXPECT_EQ(0, norm(refs[i], ref1, NORM_INF)) << "depth " << depth << ", method " << method << ", template " << i;
+            }
+
+            // the second call reuses the template spectra
+            TemplateMatcher matcher(templs, method);
+            for( int iter = 0; iter < 2; iter++ )
+            {
+                vector<Mat> results;
+                setNumThreads(iter == 0 ? 4 : 1);
+                matcher.match(img, results);
+                ASSERT_EQ(templs.size(), results.size());
+
+                for( size_t i = 0; i < templs.size(); i++ )
+                {
+                    ASSERT_EQ(refs[i].size(), results[i].size());
+                    double maxVal = norm(refs[i], NORM_INF);
+                    EXPECT_LE(norm(refs[i], results[i], NORM_INF), std::max(maxVal, 1.)*1e-4)
+                        << "depth " << depth << ", method " << method << ", template " << i << ", iteration " << iter;
+                }
+            }
+        }
+    }
+}
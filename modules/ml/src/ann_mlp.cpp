@@ -40,10 +40,6 @@
 
 #include "precomp.hpp"
 
-#ifdef HAVE_TBB
-#include <tbb/tbb.h>
-#endif
-
 CvANN_MLP_TrainParams::CvANN_MLP_TrainParams()
 {
     term_crit = cvTermCriteria( CV_TERMCRIT_ITER + CV_TERMCRIT_EPS, 1000, 0.01 );
@@ -1022,7 +1018,7 @@ int CvANN_MLP::train_backprop( CvVectors x0, CvVectors u, const double* sw )
     return iter;
 }
 
-struct rprop_loop {
+struct rprop_loop : cv::ParallelLoopBody {
   rprop_loop(const CvANN_MLP* _point, double**& _weights, int& _count, int& _ivcount, CvVectors* _x0,
      int& _l_count, CvMat*& _layer_sizes, int& _ovcount, int& _max_count,
      CvVectors* _u, const double*& _sw, double& _inv_count, CvMat*& _dEdw, int& _dcount0, double* _E, int _buf_sz)
@@ -1063,8 +1059,9 @@ struct rprop_loop {
   int buf_sz;
 
 
-  void operator()( const cv::BlockedRange& range ) const
+  void operator()( const cv::Range& range ) const
   {
+    static cv::Mutex mutex;
     double* buf_ptr;
     double** x = 0;
     double **df = 0;
@@ -1084,7 +1081,7 @@ struct rprop_loop {
         buf_ptr += (df[i] - x[i])*2;
     }
 
-    for(int si = range.begin(); si < range.end(); si++ )
+    for(int si = range.start; si < range.end; si++ )
     {
         if (si % dcount0 != 0) continue;
         int n1, n2, k;
@@ -1136,6 +1133,7 @@ struct rprop_loop {
         grad2->data.db = buf_ptr + max_count*dcount;
 
         // calculate error
+        double E0 = 0;
         if( u->type == CV_32F )
             for(int i = 0; i < dcount; i++ )
             {
@@ -1150,7 +1148,7 @@ struct rprop_loop {
                     gdata[j] = t*sweight;
                     E1 += t*t;
                 }
-                *E += sweight*E1;
+                E0 += sweight*E1;
             }
         else
             for(int i = 0; i < dcount; i++ )
@@ -1166,22 +1164,20 @@ struct rprop_loop {
                     gdata[j] = t*sweight;
                     E1 += t*t;
                 }
-                *E += sweight*E1;
+                E0 += sweight*E1;
             }
 
+        mutex.lock();
+        *E += E0;
+        mutex.unlock();
+
         // backward pass, update dEdw
-        #ifdef HAVE_TBB
-        static tbb::spin_mutex mutex;
-        tbb::spin_mutex::scoped_lock lock;
-        #endif
         for(int i = l_count-1; i > 0; i-- )
         {
             n1 = layer_sizes->data.i[i-1]; n2 = layer_sizes->data.i[i];
             cvInitMatHeader( &_df, dcount, n2, CV_64F, df[i] );
             cvMul( grad1, &_df, grad1 );
-            #ifdef HAVE_TBB
-            lock.acquire(mutex);
-            #endif
+            mutex.lock();
             cvInitMatHeader( &_dEdw, n1, n2, CV_64F, dEdw->data.db+(weights[i]-weights[0]) );
             cvInitMatHeader( x1, dcount, n1, CV_64F, x[i-1] );
             cvGEMM( x1, grad1, 1, &_dEdw, 1, &_dEdw, CV_GEMM_A_T );
@@ -1197,9 +1193,7 @@ struct rprop_loop {
 
            if (i > 1)
                cvInitMatHeader( &_w, n1, n2, CV_64F, weights[i] );
-           #ifdef HAVE_TBB
-           lock.release();
-           #endif
+           mutex.unlock();
            cvInitMatHeader( grad2, dcount, n1, CV_64F, grad2->data.db );
            if( i > 1 )
                cvGEMM( grad1, &_w, 1, 0, 0, grad2, CV_GEMM_B_T );
@@ -1296,10 +1290,13 @@ int CvANN_MLP::train_rprop( CvVectors x0, CvVectors u, const double* sw )
         int n1, n2, j, k;
         double E = 0;
 
-        // first, iterate through all the samples and compute dEdw
-        cv::parallel_for(cv::BlockedRange(0, count),
+        // first, iterate through all the samples and compute dEdw;
+        // each stripe allocates its own buffers and processes the blocks of dcount0 samples
+        // that start inside it, so there is no point in having more stripes than blocks
+        cv::parallel_for_(cv::Range(0, count),
             rprop_loop(this, weights, count, ivcount, &x0, l_count, layer_sizes,
-                       ovcount, max_count, &u, sw, inv_count, dEdw, dcount0, &E, buf_sz)
+                       ovcount, max_count, &u, sw, inv_count, dEdw, dcount0, &E, buf_sz),
+            (count + dcount0 - 1)/dcount0
         );
 
         // now update weights
@@ -392,6 +392,15 @@ public:
                                    Size maxSize=Size(),
                                    bool outputRejectLevels=false );
 
+    // detects objects in several images at once; all (image, scale, strip) tiles
+    // are processed as a single parallel loop, objects[i] receives the result for images[i]
+    virtual void detectMultiScale( const vector<Mat>& images,
+                                   CV_OUT vector<vector<Rect> >& objects,
+                                   double scaleFactor=1.1,
+                                   int minNeighbors=3, int flags=0,
+                                   Size minSize=Size(),
+                                   Size maxSize=Size() );
+
 
     bool isOldFormatCascade() const;
     virtual Size getOriginalWindowSize() const;
@@ -412,6 +421,9 @@ protected:
            FIND_BIGGEST_OBJECT = 4, DO_ROUGH_SEARCH = 8 };
 
     friend class CascadeClassifierInvoker;
+    friend class CascadeBatchPrepareInvoker;
+    friend class CascadeBatchInvoker;
+    friend class CascadeWindowBlock;
 
     template<class FEval>
     friend int predictOrdered( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight);
@@ -420,10 +432,10 @@ protected:
     friend int predictCategorical( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight);
 
     template<class FEval>
-    friend int predictOrderedStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight);
+    friend int predictOrderedStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight, int startStage);
 
     template<class FEval>
-    friend int predictCategoricalStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight);
+    friend int predictCategoricalStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &featureEvaluator, double& weight, int startStage);
 
     bool setImage( Ptr<FeatureEvaluator>& feval, const Mat& image);
     virtual int runAt( Ptr<FeatureEvaluator>& feval, Point pt, double& weight );
@@ -0,0 +1,166 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "../precomp.hpp"
+#include "../cascadedetect.hpp"
+#include "cascadedetect_avx2.hpp"
+
+namespace cv
+{
+namespace avx2
+{
+
+// Loads the integral image values of 8 windows that are xstep (1 or 2) pixels apart.
+static inline __m256i loadSum8( const int* ptr, int xstep )
+{
+    __m256i a = _mm256_loadu_si256((const __m256i*)ptr);
+    if( xstep == 1 )
+        return a;
+    __m256i b = _mm256_loadu_si256((const __m256i*)(ptr + 8));
+    // the even elements of each 128-bit lane, then the 64-bit halves are put in order
+    __m256i ab = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2,0,2,0)));
+    return _mm256_permute4x64_epi64(ab, _MM_SHUFFLE(3,1,2,0));
+}
+
+static inline __m256i calcSum8( const int* p0, const int* p1, const int* p2, const int* p3, int offset, int xstep )
+{
+    return _mm256_add_epi32(_mm256_sub_epi32(_mm256_sub_epi32(loadSum8(p0 + offset, xstep), loadSum8(p1 + offset, xstep)),
+                                             loadSum8(p2 + offset, xstep)),
+                            loadSum8(p3 + offset, xstep));
+}
+
+// the flags do not enable FMA, so the products and sums are rounded as in the scalar code
+void predictOrderedStump8( const CascadeBlockData& data, int offset, int xstep,
+                           const float* normFactors, int* results, int* startStages )
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 eps = _mm256_set1_ps(CV_CASCADE_BLOCK_FEATURE_EPS);
+    __m256 nf = _mm256_loadu_ps(normFactors);
+    int alive = 255, nodeOfs = 0;
+
+    for( int k = 0; k < 8; k++ )
+    {
+        results[k] = 1;
+        startStages[k] = data.nstages;
+    }
+
+    for( int si = 0; si < data.nstages && alive; si++ )
+    {
+        __m256 sum = _mm256_setzero_ps(), unsure = _mm256_setzero_ps();
+
+        for( int i = 0; i < data.ntrees[si]; i++, nodeOfs++ )
+        {
+            const int* const* p = data.ptrs + nodeOfs*12;
+            const float* w = data.weights + nodeOfs*3;
+
+            __m256 val = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(w[0]), _mm256_cvtepi32_ps(calcSum8(p[0], p[1], p[2], p[3], offset, xstep))),
+                                       _mm256_mul_ps(_mm256_set1_ps(w[1]), _mm256_cvtepi32_ps(calcSum8(p[4], p[5], p[6], p[7], offset, xstep))));
+            if( w[2] != 0.0f )
+                val = _mm256_add_ps(val, _mm256_mul_ps(_mm256_set1_ps(w[2]), _mm256_cvtepi32_ps(calcSum8(p[8], p[9], p[10], p[11], offset, xstep))));
+            val = _mm256_mul_ps(val, nf);
+
+            __m256 thresh = _mm256_set1_ps(data.nodeThresholds[nodeOfs]);
+            unsure = _mm256_or_ps(unsure, _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(val, thresh), absMask),
+                                                        _mm256_mul_ps(_mm256_and_ps(val, absMask), eps), _CMP_LE_OQ));
+            sum = _mm256_add_ps(sum, _mm256_blendv_ps(_mm256_set1_ps(data.leaves[nodeOfs*2+1]),
+                                                      _mm256_set1_ps(data.leaves[nodeOfs*2]),
+                                                      _mm256_cmp_ps(val, thresh, _CMP_LT_OQ)));
+        }
+
+        __m256 stageThresh = _mm256_set1_ps(data.stageThresholds[si]);
+        unsure = _mm256_or_ps(unsure, _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(sum, stageThresh), absMask),
+                                                    _mm256_set1_ps(data.stageMargins[si]), _CMP_LE_OQ));
+        alive = updateBlockStage(si, 8, _mm256_movemask_ps(_mm256_cmp_ps(sum, stageThresh, _CMP_LT_OQ)),
+                                 _mm256_movemask_ps(unsure), alive, results, startStages);
+    }
+}
+
+void predictCategoricalStump8( const CascadeBlockData& data, int offset, int xstep,
+                               int* results, int* startStages )
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    int alive = 255, nodeOfs = 0;
+
+    for( int k = 0; k < 8; k++ )
+    {
+        results[k] = 1;
+        startStages[k] = data.nstages;
+    }
+
+    for( int si = 0; si < data.nstages && alive; si++ )
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for( int i = 0; i < data.ntrees[si]; i++, nodeOfs++ )
+        {
+            const int* const* p = data.ptrs + nodeOfs*16;
+            __m256i cval = calcSum8(p[5], p[6], p[9], p[10], offset, xstep);
+
+#define LBP_BIT8(i0, i1, i2, i3, bit) \
+    _mm256_andnot_si256(_mm256_cmpgt_epi32(cval, calcSum8(p[i0], p[i1], p[i2], p[i3], offset, xstep)), _mm256_set1_epi32(bit))
+
+            __m256i c = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(LBP_BIT8( 0,  1,  4,  5, 128), LBP_BIT8( 1,  2,  5,  6, 64)),
+                                                        _mm256_or_si256(LBP_BIT8( 2,  3,  6,  7,  32), LBP_BIT8( 6,  7, 10, 11, 16))),
+                                        _mm256_or_si256(_mm256_or_si256(LBP_BIT8(10, 11, 14, 15,   8), LBP_BIT8( 9, 10, 13, 14,  4)),
+                                                        _mm256_or_si256(LBP_BIT8( 8,  9, 12, 13,   2), LBP_BIT8( 4,  5,  8,  9,  1))));
+#undef LBP_BIT8
+
+            // the subset words are gathered, the bits are tested in the vector
+            const int* subset = data.subsets + nodeOfs*data.subsetSize;
+            __m256i words = _mm256_i32gather_epi32(subset, _mm256_srli_epi32(c, 5), 4);
+            __m256i bits = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_and_si256(c, _mm256_set1_epi32(31)));
+            __m256i outside = _mm256_cmpeq_epi32(_mm256_and_si256(words, bits), _mm256_setzero_si256());
+            sum = _mm256_add_ps(sum, _mm256_blendv_ps(_mm256_set1_ps(data.leaves[nodeOfs*2]),
+                                                      _mm256_set1_ps(data.leaves[nodeOfs*2+1]),
+                                                      _mm256_castsi256_ps(outside)));
+        }
+
+        __m256 stageThresh = _mm256_set1_ps(data.stageThresholds[si]);
+        __m256 unsure = _mm256_cmp_ps(_mm256_and_ps(_mm256_sub_ps(sum, stageThresh), absMask),
+                                      _mm256_set1_ps(data.stageMargins[si]), _CMP_LE_OQ);
+        alive = updateBlockStage(si, 8, _mm256_movemask_ps(_mm256_cmp_ps(sum, stageThresh, _CMP_LT_OQ)),
+                                 _mm256_movemask_ps(unsure), alive, results, startStages);
+    }
+}
+
+}
+}
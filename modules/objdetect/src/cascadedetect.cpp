@@ -43,6 +43,9 @@
 #include <cstdio>
 
 #include "cascadedetect.hpp"
+#ifdef HAVE_DISPATCH_AVX2
+#  include "avx2/cascadedetect_avx2.hpp"
+#endif
 
 #include <string>
 
@@ -522,6 +525,16 @@ Ptr<FeatureEvaluator> HaarEvaluator::clone() const
     return ret;
 }
 
+Ptr<FeatureEvaluator> HaarEvaluator::cloneDetached() const
+{
+    HaarEvaluator* ret = new HaarEvaluator;
+    ret->origWinSize = origWinSize;
+    ret->features = new vector<Feature>(*features);
+    ret->featuresPtr = &(*ret->features)[0];
+    ret->hasTiltedFeatures = hasTiltedFeatures;
+    return ret;
+}
+
 bool HaarEvaluator::setImage( const Mat &image, Size _origWinSize )
 {
     int rn = image.rows+1, cn = image.cols+1;
@@ -586,6 +599,34 @@ bool  HaarEvaluator::setWindow( Point pt )
     return true;
 }
 
+bool HaarEvaluator::setWindowBlock( Point pt, int xstep, int n, float* normFactors )
+{
+    // the block loads may read a few elements past the last window
+    if( pt.x < 0 || pt.y < 0 ||
+        pt.x + n*xstep + origWinSize.width >= sum.cols ||
+        pt.y + origWinSize.height >= sum.rows )
+        return false;
+
+    size_t pOffset = pt.y * (sum.step/sizeof(int)) + pt.x;
+    size_t pqOffset = pt.y * (sqsum.step/sizeof(double)) + pt.x;
+
+    for( int k = 0; k < n; k++ )
+    {
+        int valsum = CALC_SUM(p, pOffset + k*xstep);
+        double valsqsum = CALC_SUM(pq, pqOffset + k*xstep);
+
+        double nf = (double)normrect.area() * valsqsum - (double)valsum * valsum;
+        if( nf > 0. )
+            nf = sqrt(nf);
+        else
+            nf = 1.;
+        normFactors[k] = (float)(1./nf);
+    }
+    offset = (int)pOffset;
+
+    return true;
+}
+
 //----------------------------------------------  LBPEvaluator -------------------------------------
 bool LBPEvaluator::Feature :: read(const FileNode& node )
 {
@@ -628,6 +669,15 @@ Ptr<FeatureEvaluator> LBPEvaluator::clone() const
     return ret;
 }
 
+Ptr<FeatureEvaluator> LBPEvaluator::cloneDetached() const
+{
+    LBPEvaluator* ret = new LBPEvaluator;
+    ret->origWinSize = origWinSize;
+    ret->features = new vector<Feature>(*features);
+    ret->featuresPtr = &(*ret->features)[0];
+    return ret;
+}
+
 bool LBPEvaluator::setImage( const Mat& image, Size _origWinSize )
 {
     int rn = image.rows+1, cn = image.cols+1;
@@ -658,6 +708,17 @@ bool LBPEvaluator::setWindow( Point pt )
     return true;
 }
 
+bool LBPEvaluator::setWindowBlock( Point pt, int xstep, int n )
+{
+    // the block loads may read a few elements past the last window
+    if( pt.x < 0 || pt.y < 0 ||
+        pt.x + n*xstep + origWinSize.width >= sum.cols ||
+        pt.y + origWinSize.height >= sum.rows )
+        return false;
+    offset = pt.y * ((int)sum.step/sizeof(int)) + pt.x;
+    return true;
+}
+
 //----------------------------------------------  HOGEvaluator ---------------------------------------
 bool HOGEvaluator::Feature :: read( const FileNode& node )
 {
@@ -709,6 +770,15 @@ Ptr<FeatureEvaluator> HOGEvaluator::clone() const
     return ret;
 }
 
+Ptr<FeatureEvaluator> HOGEvaluator::cloneDetached() const
+{
+    HOGEvaluator* ret = new HOGEvaluator;
+    ret->origWinSize = origWinSize;
+    ret->features = new vector<Feature>(*features);
+    ret->featuresPtr = &(*ret->features)[0];
+    return ret;
+}
+
 bool HOGEvaluator::setImage( const Mat& image, Size winSize )
 {
     int rows = image.rows + 1;
@@ -899,11 +969,11 @@ int CascadeClassifier::runAt( Ptr<FeatureEvaluator>& evaluator, Point pt, double
     if( data.isStumpBased )
     {
         if( data.featureType == FeatureEvaluator::HAAR )
-            return predictOrderedStump<HaarEvaluator>( *this, evaluator, weight );
+            return predictOrderedStump<HaarEvaluator>( *this, evaluator, weight, 0 );
         else if( data.featureType == FeatureEvaluator::LBP )
-            return predictCategoricalStump<LBPEvaluator>( *this, evaluator, weight );
+            return predictCategoricalStump<LBPEvaluator>( *this, evaluator, weight, 0 );
         else if( data.featureType == FeatureEvaluator::HOG )
-            return predictOrderedStump<HOGEvaluator>( *this, evaluator, weight );
+            return predictOrderedStump<HOGEvaluator>( *this, evaluator, weight, 0 );
         else
             return -2;
     }
@@ -943,6 +1013,311 @@ void CascadeClassifier::setFaceDetectionMaskGenerator()
 #endif
 }
 
+#if CV_SSE2
+// Loads the integral image values of 4 windows that are xstep (1 or 2) pixels apart.
+// Adjacent windows read adjacent elements, so no gather is needed.
+static inline __m128i loadSum4( const int* ptr, int xstep )
+{
+    __m128i a = _mm_loadu_si128((const __m128i*)ptr);
+    if( xstep == 1 )
+        return a;
+    __m128i b = _mm_loadu_si128((const __m128i*)(ptr + 4));
+    return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2,0,2,0)));
+}
+
+static inline __m128i calcSum4( const int* p0, const int* p1, const int* p2, const int* p3, int offset, int xstep )
+{
+    return _mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(loadSum4(p0 + offset, xstep), loadSum4(p1 + offset, xstep)),
+                                       loadSum4(p2 + offset, xstep)),
+                         loadSum4(p3 + offset, xstep));
+}
+
+/*
+   Block versions of predictOrderedStump and predictCategoricalStump for early rejection.
+   They run the first stages of the cascade on the 4 windows set by setWindowBlock() at once,
+   with the stage sums accumulated in float. results[k] receives -si if window k is rejected
+   by the stage si and 1 otherwise; startStages[k] is the stage the scalar function continues from.
+   A window whose feature value or stage sum is so close to the threshold that the float
+   rounding could change the decision is left to the scalar function from the first stage,
+   so the detections are identical to those of CascadeClassifier::runAt().
+*/
+static void predictOrderedStump4( const CascadeBlockData& data, int offset, int xstep,
+                                  const float* normFactors, int* results, int* startStages )
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 eps = _mm_set1_ps(CV_CASCADE_BLOCK_FEATURE_EPS);
+    __m128 nf = _mm_loadu_ps(normFactors);
+    int alive = 15, nodeOfs = 0;
+
+    for( int k = 0; k < 4; k++ )
+    {
+        results[k] = 1;
+        startStages[k] = data.nstages;
+    }
+
+    for( int si = 0; si < data.nstages && alive; si++ )
+    {
+        __m128 sum = _mm_setzero_ps(), unsure = _mm_setzero_ps();
+
+        for( int i = 0; i < data.ntrees[si]; i++, nodeOfs++ )
+        {
+            const int* const* p = data.ptrs + nodeOfs*12;
+            const float* w = data.weights + nodeOfs*3;
+
+            // the same operations as in HaarEvaluator::Feature::calc(), so the feature values are bit-exact
+            __m128 val = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(w[0]), _mm_cvtepi32_ps(calcSum4(p[0], p[1], p[2], p[3], offset, xstep))),
+                                    _mm_mul_ps(_mm_set1_ps(w[1]), _mm_cvtepi32_ps(calcSum4(p[4], p[5], p[6], p[7], offset, xstep))));
+            if( w[2] != 0.0f )
+                val = _mm_add_ps(val, _mm_mul_ps(_mm_set1_ps(w[2]), _mm_cvtepi32_ps(calcSum4(p[8], p[9], p[10], p[11], offset, xstep))));
+            val = _mm_mul_ps(val, nf);
+
+            __m128 thresh = _mm_set1_ps(data.nodeThresholds[nodeOfs]);
+            unsure = _mm_or_ps(unsure, _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(val, thresh), absMask),
+                                                    _mm_mul_ps(_mm_and_ps(val, absMask), eps)));
+            __m128 mask = _mm_cmplt_ps(val, thresh);
+            sum = _mm_add_ps(sum, _mm_or_ps(_mm_and_ps(mask, _mm_set1_ps(data.leaves[nodeOfs*2])),
+                                            _mm_andnot_ps(mask, _mm_set1_ps(data.leaves[nodeOfs*2+1]))));
+        }
+
+        __m128 stageThresh = _mm_set1_ps(data.stageThresholds[si]);
+        unsure = _mm_or_ps(unsure, _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(sum, stageThresh), absMask),
+                                                _mm_set1_ps(data.stageMargins[si])));
+        alive = updateBlockStage(si, 4, _mm_movemask_ps(_mm_cmplt_ps(sum, stageThresh)),
+                                 _mm_movemask_ps(unsure), alive, results, startStages);
+    }
+}
+
+static void predictCategoricalStump4( const CascadeBlockData& data, int offset, int xstep,
+                                      int* results, int* startStages )
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    int alive = 15, nodeOfs = 0;
+
+    for( int k = 0; k < 4; k++ )
+    {
+        results[k] = 1;
+        startStages[k] = data.nstages;
+    }
+
+    for( int si = 0; si < data.nstages && alive; si++ )
+    {
+        __m128 sum = _mm_setzero_ps();
+
+        for( int i = 0; i < data.ntrees[si]; i++, nodeOfs++ )
+        {
+            const int* const* p = data.ptrs + nodeOfs*16;
+            __m128i cval = calcSum4(p[5], p[6], p[9], p[10], offset, xstep);
+
+// sets 'bit' in the lanes where the block sum is not less than the central one, as LBPEvaluator::Feature::calc() does
+#define LBP_BIT4(i0, i1, i2, i3, bit) \
+    _mm_andnot_si128(_mm_cmpgt_epi32(cval, calcSum4(p[i0], p[i1], p[i2], p[i3], offset, xstep)), _mm_set1_epi32(bit))
+
+            __m128i c = _mm_or_si128(_mm_or_si128(_mm_or_si128(LBP_BIT4( 0,  1,  4,  5, 128), LBP_BIT4( 1,  2,  5,  6, 64)),
+                                                  _mm_or_si128(LBP_BIT4( 2,  3,  6,  7,  32), LBP_BIT4( 6,  7, 10, 11, 16))),
+                                     _mm_or_si128(_mm_or_si128(LBP_BIT4(10, 11, 14, 15,   8), LBP_BIT4( 9, 10, 13, 14,  4)),
+                                                  _mm_or_si128(LBP_BIT4( 8,  9, 12, 13,   2), LBP_BIT4( 4,  5,  8,  9,  1))));
+#undef LBP_BIT4
+
+            int CV_DECL_ALIGNED(16) codes[4];
+            float CV_DECL_ALIGNED(16) leaves[4];
+            _mm_store_si128((__m128i*)codes, c);
+            const int* subset = data.subsets + nodeOfs*data.subsetSize;
+
+            // the subset lookup is a gather, it is cheaper done per lane
+            for( int k = 0; k < 4; k++ )
+                leaves[k] = data.leaves[subset[codes[k]>>5] & (1 << (codes[k] & 31)) ? nodeOfs*2 : nodeOfs*2+1];
+            sum = _mm_add_ps(sum, _mm_load_ps(leaves));
+        }
+
+        // the LBP codes are exact, only the stage sums need a margin
+        __m128 stageThresh = _mm_set1_ps(data.stageThresholds[si]);
+        __m128 unsure = _mm_cmple_ps(_mm_and_ps(_mm_sub_ps(sum, stageThresh), absMask),
+                                     _mm_set1_ps(data.stageMargins[si]));
+        alive = updateBlockStage(si, 4, _mm_movemask_ps(_mm_cmplt_ps(sum, stageThresh)),
+                                 _mm_movemask_ps(unsure), alive, results, startStages);
+    }
+}
+#endif
+
+/*
+   Classification of horizontally adjacent windows in blocks: 8 windows with AVX2, 4 with SSE2.
+   The first stages of a stump-based Haar or LBP cascade are run on the whole block (see
+   predictOrderedStump4), which rejects most of the windows; the remaining ones continue
+   through the rest of the cascade one by one. The results are identical to those of
+   CascadeClassifier::runAt().
+*/
+class CascadeWindowBlock
+{
+public:
+    enum { MAX_SIZE = 8, STAGES = 10 };
+
+    // the reject levels need the weights of all the windows, so there is no block evaluation then
+    CascadeWindowBlock( CascadeClassifier& _cc, Ptr<FeatureEvaluator>& evaluator, int _xstep, bool outputRejectLevels )
+        : cc(&_cc), xstep(_xstep), size(0), x0(-1), valid(false)
+    {
+        int featureType = cc->data.featureType;
+        if( outputRejectLevels || !cc->data.isStumpBased || (xstep != 1 && xstep != 2) ||
+            (featureType != FeatureEvaluator::HAAR && featureType != FeatureEvaluator::LBP) )
+            return;
+
+        // checked for every block object, so that setUseOptimized() takes effect
+#ifdef HAVE_DISPATCH_AVX2
+        if( checkHardwareSupport(CV_CPU_AVX2) )
+            size = 8;
+#endif
+#if CV_SSE2
+        if( size == 0 && checkHardwareSupport(CV_CPU_SSE2) )
+            size = 4;
+#endif
+        if( size > 0 )
+            flatten( evaluator );
+    }
+
+    // must be called at the beginning of every row
+    void reset() { x0 = -1; }
+
+    // same as CascadeClassifier::runAt(); the windows of a row must be visited from left to right
+    int runAt( Ptr<FeatureEvaluator>& evaluator, Point pt, double& weight )
+    {
+        if( size == 0 )
+            return cc->runAt( evaluator, pt, weight );
+        if( x0 < 0 || pt.x >= x0 + size*xstep )
+        {
+            x0 = pt.x;
+            valid = runBlock( evaluator, pt );
+        }
+        if( !valid )
+            return cc->runAt( evaluator, pt, weight );
+
+        int k = (pt.x - x0)/xstep;
+        if( results[k] <= 0 )
+            return results[k];
+        if( !evaluator->setWindow(pt) )
+            return -1;
+        return cc->data.featureType == FeatureEvaluator::HAAR ?
+            predictOrderedStump<HaarEvaluator>( *cc, evaluator, weight, startStages[k] ) :
+            predictCategoricalStump<LBPEvaluator>( *cc, evaluator, weight, startStages[k] );
+    }
+
+private:
+    // copies the first stages of the cascade to the flat arrays of CascadeBlockData
+    void flatten( Ptr<FeatureEvaluator>& evaluator )
+    {
+        const CascadeClassifier::Data& cdata = cc->data;
+        bool haar = cdata.featureType == FeatureEvaluator::HAAR;
+        int si, i, nodeOfs = 0, nstages = std::min((int)cdata.stages.size(), (int)STAGES);
+
+        ntrees.resize(nstages);
+        stageThresholds.resize(nstages);
+        stageMargins.resize(nstages);
+        for( si = 0; si < nstages; si++ )
+        {
+            const CascadeClassifier::Data::Stage& stage = cdata.stages[si];
+            // the error of a float sum of n terms is below (n-1)*2^-24 times the sum of their magnitudes
+            double maxAbsSum = 0;
+            for( i = 0; i < stage.ntrees; i++ )
+                maxAbsSum += std::max(std::abs(cdata.leaves[(nodeOfs + i)*2]), std::abs(cdata.leaves[(nodeOfs + i)*2+1]));
+            ntrees[si] = stage.ntrees;
+            stageThresholds[si] = stage.threshold;
+            stageMargins[si] = (float)((stage.ntrees + 1)*maxAbsSum/(1 << 23));
+            nodeOfs += stage.ntrees;
+        }
+
+        int nnodes = nodeOfs;
+        if( haar )
+        {
+            const HaarEvaluator::Feature* features = ((HaarEvaluator&)*evaluator).featuresPtr;
+            ptrs.resize(nnodes*12);
+            weights.resize(nnodes*3);
+            nodeThresholds.resize(nnodes);
+            for( i = 0; i < nnodes; i++ )
+            {
+                const HaarEvaluator::Feature& f = features[cdata.nodes[i].featureIdx];
+                for( int r = 0; r < HaarEvaluator::Feature::RECT_NUM; r++ )
+                {
+                    weights[i*3 + r] = f.rect[r].weight;
+                    for( int j = 0; j < 4; j++ )
+                        ptrs[i*12 + r*4 + j] = f.rect[r].weight != 0.0f ? f.p[r][j] : 0;
+                }
+                nodeThresholds[i] = cdata.nodes[i].threshold;
+            }
+        }
+        else
+        {
+            const LBPEvaluator::Feature* features = ((LBPEvaluator&)*evaluator).featuresPtr;
+            ptrs.resize(nnodes*16);
+            for( i = 0; i < nnodes; i++ )
+            {
+                const LBPEvaluator::Feature& f = features[cdata.nodes[i].featureIdx];
+                for( int j = 0; j < 16; j++ )
+                    ptrs[i*16 + j] = f.p[j];
+            }
+        }
+
+        data.nstages = nstages;
+        data.ntrees = &ntrees[0];
+        data.stageThresholds = &stageThresholds[0];
+        data.stageMargins = &stageMargins[0];
+        data.leaves = &cdata.leaves[0];
+        data.ptrs = &ptrs[0];
+        data.nodeThresholds = haar ? &nodeThresholds[0] : 0;
+        data.weights = haar ? &weights[0] : 0;
+        data.subsets = haar ? 0 : &cdata.subsets[0];
+        data.subsetSize = (cdata.ncategories + 31)/32;
+    }
+
+    bool runBlock( Ptr<FeatureEvaluator>& evaluator, Point pt )
+    {
+        if( cc->data.featureType == FeatureEvaluator::HAAR )
+        {
+            HaarEvaluator& haarEvaluator = (HaarEvaluator&)*evaluator;
+            float normFactors[MAX_SIZE];
+            if( !haarEvaluator.setWindowBlock(pt, xstep, size, normFactors) )
+                return false;
+#ifdef HAVE_DISPATCH_AVX2
+            if( size == 8 )
+            {
+                avx2::predictOrderedStump8( data, haarEvaluator.offset, xstep, normFactors, results, startStages );
+                return true;
+            }
+#endif
+#if CV_SSE2
+            predictOrderedStump4( data, haarEvaluator.offset, xstep, normFactors, results, startStages );
+#endif
+        }
+        else
+        {
+            LBPEvaluator& lbpEvaluator = (LBPEvaluator&)*evaluator;
+            if( !lbpEvaluator.setWindowBlock(pt, xstep, size) )
+                return false;
+#ifdef HAVE_DISPATCH_AVX2
+            if( size == 8 )
+            {
+                avx2::predictCategoricalStump8( data, lbpEvaluator.offset, xstep, results, startStages );
+                return true;
+            }
+#endif
+#if CV_SSE2
+            predictCategoricalStump4( data, lbpEvaluator.offset, xstep, results, startStages );
+#endif
+        }
+        return true;
+    }
+
+    CascadeClassifier* cc;
+    int xstep;
+    int size;
+    int x0;
+    bool valid;
+    int results[MAX_SIZE];
+    int startStages[MAX_SIZE];
+
+    CascadeBlockData data;
+    vector<int> ntrees;
+    vector<float> stageThresholds, stageMargins, nodeThresholds, weights;
+    vector<const int*> ptrs;
+};
+
 class CascadeClassifierInvoker : public ParallelLoopBody
 {
 public:
@@ -967,10 +1342,13 @@ public:
 
         Size winSize(cvRound(classifier->data.origWinSize.width * scalingFactor), cvRound(classifier->data.origWinSize.height * scalingFactor));
 
+        CascadeWindowBlock block( *classifier, evaluator, yStep, rejectLevels != 0 );
+
         int y1 = range.start * stripSize;
         int y2 = min(range.end * stripSize, processingRectSize.height);
         for( int y = y1; y < y2; y += yStep )
         {
+            block.reset();
             for( int x = 0; x < processingRectSize.width; x += yStep )
             {
                 if ( (!mask.empty()) && (mask.at<uchar>(Point(x,y))==0)) {
@@ -978,7 +1356,7 @@ public:
                 }
 
                 double gypWeight;
-                int result = classifier->runAt(evaluator, Point(x, y), gypWeight);
+                int result = block.runAt(evaluator, Point(x, y), gypWeight);
 
 #if defined (LOG_CASCADE_STATISTIC)
 
@@ -1203,6 +1581,256 @@ void CascadeClassifier::detectMultiScale( const Mat& image, vector<Rect>& object
         minNeighbors, flags, minObjectSize, maxObjectSize, false );
 }
 
+static Ptr<FeatureEvaluator> cloneDetachedEvaluator( const Ptr<FeatureEvaluator>& evaluator )
+{
+    switch( evaluator->getFeatureType() )
+    {
+    case FeatureEvaluator::HAAR:
+        return ((const HaarEvaluator&)*evaluator).cloneDetached();
+    case FeatureEvaluator::LBP:
+        return ((const LBPEvaluator&)*evaluator).cloneDetached();
+    case FeatureEvaluator::HOG:
+        return ((const HOGEvaluator&)*evaluator).cloneDetached();
+    default:
+        break;
+    }
+    return Ptr<FeatureEvaluator>();
+}
+
+// one (image, scale) pair of a batch
+struct CascadeScaleLevel
+{
+    int imageIdx;
+    double factor;
+    int yStep;
+    Size scaledImageSize;
+    Size processingRectSize;
+    Mat scaledImage;
+    Mat mask;
+    Ptr<FeatureEvaluator> evaluator;
+    bool valid;
+};
+
+// a horizontal strip of the window positions of one scale level
+struct CascadeTile
+{
+    int levelIdx;
+    int y1, y2;
+};
+
+// resizes the images and computes the integral images of all the scale levels
+class CascadeBatchPrepareInvoker : public ParallelLoopBody
+{
+public:
+    CascadeBatchPrepareInvoker( CascadeClassifier& _cc, const vector<Mat>& _images, vector<CascadeScaleLevel>& _levels )
+        : classifier(&_cc), images(&_images), levels(&_levels)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            CascadeScaleLevel& level = (*levels)[i];
+            resize( (*images)[level.imageIdx], level.scaledImage, level.scaledImageSize, 0, 0, CV_INTER_LINEAR );
+            level.evaluator = cloneDetachedEvaluator( classifier->featureEvaluator );
+            level.valid = !level.evaluator.empty() &&
+                level.evaluator->setImage( level.scaledImage, classifier->data.origWinSize );
+        }
+    }
+
+    CascadeClassifier* classifier;
+    const vector<Mat>* images;
+    vector<CascadeScaleLevel>* levels;
+};
+
+// scans the tiles of a batch; every tile writes its candidates to its own vector,
+// so the result does not depend on the way the tiles are distributed between threads
+class CascadeBatchInvoker : public ParallelLoopBody
+{
+public:
+    CascadeBatchInvoker( CascadeClassifier& _cc, const vector<CascadeScaleLevel>& _levels,
+                         const vector<CascadeTile>& _tiles, vector<vector<Rect> >& _tileObjects )
+        : classifier(&_cc), levels(&_levels), tiles(&_tiles), tileObjects(&_tileObjects)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        Ptr<FeatureEvaluator> evaluator;
+        int currentLevel = -1;
+
+        for( int t = range.start; t < range.end; t++ )
+        {
+            const CascadeTile& tile = (*tiles)[t];
+            const CascadeScaleLevel& level = (*levels)[tile.levelIdx];
+
+            // the neighbouring tiles usually belong to the same level, so the
+            // window state clone is shared by them
+            if( tile.levelIdx != currentLevel )
+            {
+                evaluator = level.evaluator->clone();
+                currentLevel = tile.levelIdx;
+            }
+
+            double factor = level.factor;
+            int yStep = level.yStep;
+            Size winSize(cvRound(classifier->data.origWinSize.width * factor), cvRound(classifier->data.origWinSize.height * factor));
+            vector<Rect>& rectangles = (*tileObjects)[t];
+            CascadeWindowBlock block( *classifier, evaluator, yStep, false );
+
+            for( int y = tile.y1; y < tile.y2; y += yStep )
+            {
+                block.reset();
+                for( int x = 0; x < level.processingRectSize.width; x += yStep )
+                {
+                    if( !level.mask.empty() && level.mask.at<uchar>(Point(x,y)) == 0 )
+                        continue;
+
+                    double gypWeight;
+                    int result = block.runAt(evaluator, Point(x, y), gypWeight);
+
+                    if( result > 0 )
+                        rectangles.push_back(Rect(cvRound(x*factor), cvRound(y*factor),
+                                                  winSize.width, winSize.height));
+                    if( result == 0 )
+                        x += yStep;
+                }
+            }
+        }
+    }
+
+    CascadeClassifier* classifier;
+    const vector<CascadeScaleLevel>* levels;
+    const vector<CascadeTile>* tiles;
+    vector<vector<Rect> >* tileObjects;
+};
+
+void CascadeClassifier::detectMultiScale( const vector<Mat>& images, vector<vector<Rect> >& objects,
+                                          double scaleFactor, int minNeighbors,
+                                          int flags, Size minObjectSize, Size maxObjectSize )
+{
+    const double GROUP_EPS = 0.2;
+    const int PTS_PER_TILE = 1000;
+
+    CV_Assert( scaleFactor > 1 );
+
+    size_t i, nimages = images.size();
+    objects.clear();
+    objects.resize(nimages);
+
+    if( empty() )
+        return;
+
+    if( isOldFormatCascade() )
+    {
+        // the old format cascades are processed by cvHaarDetectObjects, image by image
+        for( i = 0; i < nimages; i++ )
+            if( !images[i].empty() )
+                detectMultiScale( images[i], objects[i], scaleFactor, minNeighbors, flags, minObjectSize, maxObjectSize );
+        return;
+    }
+
+    Size originalWindowSize = getOriginalWindowSize();
+    bool isHOG = getFeatureType() == FeatureEvaluator::HOG;
+    vector<Mat> grayImages(nimages);
+    vector<CascadeScaleLevel> levels;
+
+    for( i = 0; i < nimages; i++ )
+    {
+        const Mat& image = images[i];
+        CV_Assert( image.depth() == CV_8U );
+
+        if( image.empty() )
+            continue;
+
+        grayImages[i] = image;
+        if( image.channels() > 1 )
+            cvtColor(image, grayImages[i], CV_BGR2GRAY);
+
+        Size maxSize = maxObjectSize.height == 0 || maxObjectSize.width == 0 ? image.size() : maxObjectSize;
+
+        for( double factor = 1; ; factor *= scaleFactor )
+        {
+            Size windowSize( cvRound(originalWindowSize.width*factor), cvRound(originalWindowSize.height*factor) );
+            Size scaledImageSize( cvRound( image.cols/factor ), cvRound( image.rows/factor ) );
+            Size processingRectSize( scaledImageSize.width - originalWindowSize.width + 1, scaledImageSize.height - originalWindowSize.height + 1 );
+
+            if( processingRectSize.width <= 0 || processingRectSize.height <= 0 )
+                break;
+            if( windowSize.width > maxSize.width || windowSize.height > maxSize.height )
+                break;
+            if( windowSize.width < minObjectSize.width || windowSize.height < minObjectSize.height )
+                continue;
+
+            CascadeScaleLevel level;
+            level.imageIdx = (int)i;
+            level.factor = factor;
+            level.yStep = isHOG ? 4 : factor > 2. ? 1 : 2;
+            level.scaledImageSize = scaledImageSize;
+            level.processingRectSize = processingRectSize;
+            level.valid = false;
+            levels.push_back(level);
+        }
+    }
+
+    // build the scale pyramids of all the images at once
+    parallel_for_(Range(0, (int)levels.size()), CascadeBatchPrepareInvoker(*this, grayImages, levels));
+
+    if( !maskGenerator.empty() )
+    {
+        // the mask generators are stateful, so they are run sequentially, image by image
+        int currentImage = -1;
+        for( i = 0; i < levels.size(); i++ )
+        {
+            CascadeScaleLevel& level = levels[i];
+            if( level.imageIdx != currentImage )
+            {
+                currentImage = level.imageIdx;
+                maskGenerator->initializeMask(images[currentImage]);
+            }
+            if( level.valid )
+                level.mask = maskGenerator->generateMask(level.scaledImage);
+        }
+    }
+
+    // split every level into strips of roughly the same number of window positions
+    vector<CascadeTile> tiles;
+    for( i = 0; i < levels.size(); i++ )
+    {
+        const CascadeScaleLevel& level = levels[i];
+        if( !level.valid )
+            continue;
+
+        int yStep = level.yStep;
+        Size sz = level.processingRectSize;
+        int stripCount = ((sz.width/yStep)*((sz.height + yStep-1)/yStep) + PTS_PER_TILE/2)/PTS_PER_TILE;
+        stripCount = std::min(std::max(stripCount, 1), 100);
+        int stripSize = (((sz.height + stripCount - 1)/stripCount + yStep-1)/yStep)*yStep;
+
+        for( int y = 0; y < sz.height; y += stripSize )
+        {
+            CascadeTile tile;
+            tile.levelIdx = (int)i;
+            tile.y1 = y;
+            tile.y2 = std::min(y + stripSize, sz.height);
+            tiles.push_back(tile);
+        }
+    }
+
+    vector<vector<Rect> > tileObjects(tiles.size());
+    parallel_for_(Range(0, (int)tiles.size()), CascadeBatchInvoker(*this, levels, tiles, tileObjects));
+
+    for( i = 0; i < tiles.size(); i++ )
+    {
+        vector<Rect>& dst = objects[levels[tiles[i].levelIdx].imageIdx];
+        dst.insert(dst.end(), tileObjects[i].begin(), tileObjects[i].end());
+    }
+
+    for( i = 0; i < nimages; i++ )
+        groupRectangles( objects[i], minNeighbors, GROUP_EPS );
+}
+
 bool CascadeClassifier::Data::read(const FileNode &root)
 {
     static const float THRESHOLD_EPS = 1e-5f;
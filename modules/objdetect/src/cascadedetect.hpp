@@ -91,6 +91,9 @@ public:
 
     virtual bool read( const FileNode& node );
     virtual Ptr<FeatureEvaluator> clone() const;
+    // unlike clone(), gives the copy its own feature table and integral images,
+    // so that both evaluators can hold different images at the same time
+    Ptr<FeatureEvaluator> cloneDetached() const;
     virtual int getFeatureType() const { return FeatureEvaluator::HAAR; }
 
     virtual bool setImage(const Mat&, Size origWinSize);
@@ -101,7 +104,13 @@ public:
     virtual double calcOrd(int featureIdx) const
     { return (*this)(featureIdx); }
 
+    // the same as setWindow(), but for the n windows at pt, pt + (xstep, 0), ..., pt + ((n-1)*xstep, 0);
+    // the variance normalization factors of the windows are stored to normFactors
+    bool setWindowBlock( Point pt, int xstep, int n, float* normFactors );
+
 protected:
+    friend class CascadeWindowBlock;
+
     Size origWinSize;
     Ptr<vector<Feature> > features;
     Feature* featuresPtr; // optimization
@@ -183,6 +192,7 @@ public:
 
     virtual bool read( const FileNode& node );
     virtual Ptr<FeatureEvaluator> clone() const;
+    Ptr<FeatureEvaluator> cloneDetached() const;
     virtual int getFeatureType() const { return FeatureEvaluator::LBP; }
 
     virtual bool setImage(const Mat& image, Size _origWinSize);
@@ -192,7 +202,13 @@ public:
     { return featuresPtr[featureIdx].calc(offset); }
     virtual int calcCat(int featureIdx) const
     { return (*this)(featureIdx); }
+
+    // the same as setWindow(), but for the n windows at pt, pt + (xstep, 0), ..., pt + ((n-1)*xstep, 0)
+    bool setWindowBlock( Point pt, int xstep, int n );
+
 protected:
+    friend class CascadeWindowBlock;
+
     Size origWinSize;
     Ptr<vector<Feature> > features;
     Feature* featuresPtr; // optimization
@@ -261,6 +277,7 @@ public:
     virtual ~HOGEvaluator();
     virtual bool read( const FileNode& node );
     virtual Ptr<FeatureEvaluator> clone() const;
+    Ptr<FeatureEvaluator> cloneDetached() const;
     virtual int getFeatureType() const { return FeatureEvaluator::HOG; }
     virtual bool setImage( const Mat& image, Size winSize );
     virtual bool setWindow( Point pt );
@@ -402,7 +419,8 @@ inline int predictCategorical( CascadeClassifier& cascade, Ptr<FeatureEvaluator>
 }
 
 template<class FEval>
-inline int predictOrderedStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &_featureEvaluator, double& sum )
+inline int predictOrderedStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &_featureEvaluator, double& sum,
+                                int startStage )
 {
     int nodeOfs = 0, leafOfs = 0;
     FEval& featureEvaluator = (FEval&)*_featureEvaluator;
@@ -410,8 +428,12 @@ inline int predictOrderedStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator
     CascadeClassifier::Data::DTreeNode* cascadeNodes = &cascade.data.nodes[0];
     CascadeClassifier::Data::Stage* cascadeStages = &cascade.data.stages[0];
 
+    for( int stageIdx = 0; stageIdx < startStage; stageIdx++ )
+        nodeOfs += cascadeStages[stageIdx].ntrees;
+    leafOfs = nodeOfs*2;
+
     int nstages = (int)cascade.data.stages.size();
-    for( int stageIdx = 0; stageIdx < nstages; stageIdx++ )
+    for( int stageIdx = startStage; stageIdx < nstages; stageIdx++ )
     {
         CascadeClassifier::Data::Stage& stage = cascadeStages[stageIdx];
         sum = 0.0;
@@ -432,7 +454,8 @@ inline int predictOrderedStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator
 }
 
 template<class FEval>
-inline int predictCategoricalStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &_featureEvaluator, double& sum )
+inline int predictCategoricalStump( CascadeClassifier& cascade, Ptr<FeatureEvaluator> &_featureEvaluator, double& sum,
+                                    int startStage )
 {
     int nstages = (int)cascade.data.stages.size();
     int nodeOfs = 0, leafOfs = 0;
@@ -443,10 +466,14 @@ inline int predictCategoricalStump( CascadeClassifier& cascade, Ptr<FeatureEvalu
     CascadeClassifier::Data::DTreeNode* cascadeNodes = &cascade.data.nodes[0];
     CascadeClassifier::Data::Stage* cascadeStages = &cascade.data.stages[0];
 
+    for( int si = 0; si < startStage; si++ )
+        nodeOfs += cascadeStages[si].ntrees;
+    leafOfs = nodeOfs*2;
+
 #ifdef HAVE_TEGRA_OPTIMIZATION
     float tmp = 0; // float accumulator -- float operations are quicker
 #endif
-    for( int si = 0; si < nstages; si++ )
+    for( int si = startStage; si < nstages; si++ )
     {
         CascadeClassifier::Data::Stage& stage = cascadeStages[si];
         int wi, ntrees = stage.ntrees;
@@ -486,5 +513,55 @@ inline int predictCategoricalStump( CascadeClassifier& cascade, Ptr<FeatureEvalu
 
     return 1;
 }
+
+/*
+   The first stages of a stump-based Haar or LBP cascade in a flat form, with the integral
+   image pointers of the features resolved, for the classification of window blocks
+   (see CascadeWindowBlock). Node i of the stages uses ptrs[i*PTRS + j], where PTRS is
+   3*4 (the corners of the Haar rectangles) or 16 (the LBP grid), and leaves[i*2], leaves[i*2+1].
+*/
+struct CascadeBlockData
+{
+    int nstages;
+    const int* ntrees;
+    const float* stageThresholds;
+    // the bound of the rounding error of a stage sum accumulated in float
+    const float* stageMargins;
+    const float* leaves;
+    const int* const* ptrs;
+
+    // Haar
+    const float* nodeThresholds;
+    const float* weights; // 3 per node, the third one may be 0
+
+    // LBP
+    const int* subsets;
+    int subsetSize;
+};
+
+// the relative error bound of the feature values computed in float by the block classifiers
+#define CV_CASCADE_BLOCK_FEATURE_EPS (1.f/(1 << 20))
+
+/*
+   Applies the stage si to the alive windows of a block, given the bit masks of the windows
+   whose stage sum is less than the threshold and of those whose result cannot be trusted.
+   The latter are left to the scalar code from the first stage. Returns the windows still alive.
+   It is static, so that every instruction set specific translation unit has its own copy.
+*/
+static inline int updateBlockStage( int si, int n, int less, int unsure, int alive,
+                                    int* results, int* startStages )
+{
+    unsure &= alive;
+    int rejected = less & alive & ~unsure;
+    for( int k = 0; k < n; k++ )
+    {
+        if( unsure & (1 << k) )
+            startStages[k] = 0;
+        else if( rejected & (1 << k) )
+            results[k] = -si;
+    }
+    return alive & ~(unsure | rejected);
+}
+
 }
 
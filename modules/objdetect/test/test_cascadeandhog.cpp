@@ -463,3 +463,141 @@ int CV_HOGDetectorTest::detectMultiScale( int di, const Mat& img,
 
 TEST(Objdetect_CascadeDetector, regression) { CV_CascadeDetectorTest test; test.safe_run(); }
 TEST(Objdetect_HOGDetector, regression) { CV_HOGDetectorTest test; test.safe_run(); }
+
+// the detections of an image come in no particular order, so they are compared sorted
+static bool rectLess(const Rect& a, const Rect& b)
+{
+    if( a.y != b.y ) return a.y < b.y;
+    if( a.x != b.x ) return a.x < b.x;
+    if( a.height != b.height ) return a.height < b.height;
+    return a.width < b.width;
+}
+
+// Converts a stump-based Haar cascade of the old format to the new one. The stock Haar
+// cascades are all in the old format, which is run by cvHaarDetectObjects() instead.
+static string convertOldHaarCascade( const string& filename )
+{
+    FileStorage in(filename, FileStorage::READ);
+    FileNode root = in.getFirstTopLevelNode();
+    FileStorage out(".xml", FileStorage::WRITE + FileStorage::MEMORY);
+    vector<FileNode> features;
+
+    out << "cascade" << "{" << "stageType" << "BOOST" << "featureType" << "HAAR"
+        << "height" << (int)root["size"][1] << "width" << (int)root["size"][0]
+        << "stageParams" << "{" << "maxDepth" << 1 << "}"
+        << "featureParams" << "{" << "maxCatCount" << 0 << "}"
+        << "stages" << "[";
+    for( FileNodeIterator it = root["stages"].begin(); it != root["stages"].end(); ++it )
+    {
+        FileNode trees = (*it)["trees"];
+        out << "{" << "stageThreshold" << (double)(*it)["stage_threshold"] << "weakClassifiers" << "[";
+        for( FileNodeIterator tit = trees.begin(); tit != trees.end(); ++tit )
+        {
+            FileNode node = (*tit)[0];
+            out << "{" << "internalNodes" << "[:" << 0 << -1 << (int)features.size() << (double)node["threshold"] << "]"
+                << "leafValues" << "[:" << (double)node["left_val"] << (double)node["right_val"] << "]" << "}";
+            features.push_back(node["feature"]);
+        }
+        out << "]" << "}";
+    }
+    out << "]" << "features" << "[";
+    for( size_t i = 0; i < features.size(); i++ )
+    {
+        FileNode rects = features[i]["rects"];
+        out << "{" << "rects" << "[";
+        for( FileNodeIterator rit = rects.begin(); rit != rects.end(); ++rit )
+            out << "[:" << (int)(*rit)[0] << (int)(*rit)[1] << (int)(*rit)[2] << (int)(*rit)[3] << (double)(*rit)[4] << "]";
+        out << "]" << "tilted" << (int)features[i]["tilted"] << "}";
+    }
+    out << "]" << "}";
+    return out.releaseAndGetString();
+}
+
+TEST(Objdetect_CascadeDetector, batch)
+{
+    string dataPath = cvtest::TS::ptr()->get_data_path();
+    const char* cascades[] = { "cascadeandhog/cascades/haarcascade_frontalface_alt.xml",
+                               "cascadeandhog/cascades/lbpcascade_frontalface.xml" };
+
+    Mat img = imread(dataPath + "shared/lena.png", 0);
+    ASSERT_FALSE(img.empty());
+
+    vector<Mat> images;
+    images.push_back(img);
+    images.push_back(Mat());
+    Mat small, flipped;
+    resize(img, small, Size(), 0.6, 0.6);
+    images.push_back(small);
+    flip(img, flipped, 1);
+    images.push_back(flipped);
+
+    for( size_t ci = 0; ci < sizeof(cascades)/sizeof(cascades[0]); ci++ )
+    {
+        // the old format Haar cascade is converted, as only the new format reaches the batch code
+        CascadeClassifier cascade;
+        if( ci == 0 )
+        {
+            FileStorage fs(convertOldHaarCascade(dataPath + cascades[ci]), FileStorage::READ + FileStorage::MEMORY);
+            ASSERT_TRUE(cascade.read(fs.getFirstTopLevelNode()));
+        }
+        else
+            ASSERT_TRUE(cascade.load(dataPath + cascades[ci]));
+
+        vector<vector<Rect> > objects;
+        cascade.detectMultiScale(images, objects, 1.1, 3, 0, Size(30, 30));
+        ASSERT_EQ(images.size(), objects.size());
+
+        size_t total = 0;
+        for( size_t i = 0; i < images.size(); i++ )
+        {
+            vector<Rect> expected;
+            if( !images[i].empty() )
+                cascade.detectMultiScale(images[i], expected, 1.1, 3, 0, Size(30, 30));
+            ASSERT_EQ(expected.size(), objects[i].size()) << cascades[ci] << ", image " << i;
+            std::sort(expected.begin(), expected.end(), rectLess);
+            std::sort(objects[i].begin(), objects[i].end(), rectLess);
+            for( size_t j = 0; j < expected.size(); j++ )
+                EXPECT_EQ(expected[j], objects[i][j]) << cascades[ci] << ", image " << i;
+            total += expected.size();
+        }
+        // the LBP cascade misses the face in the original image, so only the total count is checked
+        EXPECT_GT(total, 0u) << cascades[ci];
+    }
+}
+
+TEST(Objdetect_CascadeDetector, simd_equals_scalar)
+{
+    string dataPath = cvtest::TS::ptr()->get_data_path();
+    const char* cascades[] = { "cascadeandhog/cascades/haarcascade_frontalface_alt.xml",
+                               "cascadeandhog/cascades/lbpcascade_frontalface.xml" };
+
+    Mat img = imread(dataPath + "shared/lena.png", 0);
+    ASSERT_FALSE(img.empty());
+
+    for( size_t ci = 0; ci < sizeof(cascades)/sizeof(cascades[0]); ci++ )
+    {
+        CascadeClassifier cascade;
+        if( ci == 0 )
+        {
+            FileStorage fs(convertOldHaarCascade(dataPath + cascades[ci]), FileStorage::READ + FileStorage::MEMORY);
+            ASSERT_TRUE(cascade.read(fs.getFirstTopLevelNode()));
+        }
+        else
+            ASSERT_TRUE(cascade.load(dataPath + cascades[ci]));
+
+        // no grouping, so that every single window decision is compared
+        vector<Rect> expected, objects;
+        cvtest::ParallelSettingsGuard guard;
+        cv::setUseOptimized(false);
+        cascade.detectMultiScale(img, expected, 1.1, 0, 0, Size(30, 30));
+        cv::setUseOptimized(true);
+        cascade.detectMultiScale(img, objects, 1.1, 0, 0, Size(30, 30));
+
+        ASSERT_EQ(expected.size(), objects.size()) << cascades[ci];
+        std::sort(expected.begin(), expected.end(), rectLess);
+        std::sort(objects.begin(), objects.end(), rectLess);
+        for( size_t j = 0; j < expected.size(); j++ )
+            EXPECT_EQ(expected[j], objects[j]) << cascades[ci];
+        EXPECT_FALSE(objects.empty());
+    }
+}
@@ -57,21 +57,28 @@ void cv::fastNlMeansDenoising( InputArray _src, OutputArray _dst, float h,
         return;
 #endif
 
+    // every stripe allocates its own column-sum buffers and exploits row-to-row coherence,
+    // so the rows are split into a few stripes per worker thread only
+    double granularity = cv::getNumThreads()*4;
+
     switch (src.type()) {
         case CV_8U:
-            parallel_for(cv::BlockedRange(0, src.rows),
+            parallel_for_(cv::Range(0, src.rows),
                 FastNlMeansDenoisingInvoker<uchar>(
-                    src, dst, templateWindowSize, searchWindowSize, h));
+                    src, dst, templateWindowSize, searchWindowSize, h),
+                granularity);
             break;
         case CV_8UC2:
-            parallel_for(cv::BlockedRange(0, src.rows),
+            parallel_for_(cv::Range(0, src.rows),
                 FastNlMeansDenoisingInvoker<cv::Vec2b>(
-                    src, dst, templateWindowSize, searchWindowSize, h));
+                    src, dst, templateWindowSize, searchWindowSize, h),
+                granularity);
             break;
         case CV_8UC3:
-            parallel_for(cv::BlockedRange(0, src.rows),
+            parallel_for_(cv::Range(0, src.rows),
                 FastNlMeansDenoisingInvoker<cv::Vec3b>(
-                    src, dst, templateWindowSize, searchWindowSize, h));
+                    src, dst, templateWindowSize, searchWindowSize, h),
+                granularity);
             break;
         default:
             CV_Error(CV_StsBadArg,
@@ -157,24 +164,29 @@ void cv::fastNlMeansDenoisingMulti( InputArrayOfArrays _srcImgs, OutputArray _ds
     _dst.create(srcImgs[0].size(), srcImgs[0].type());
     Mat dst = _dst.getMat();
 
+    double granularity = cv::getNumThreads()*4;
+
     switch (srcImgs[0].type()) {
         case CV_8U:
-            parallel_for(cv::BlockedRange(0, srcImgs[0].rows),
+            parallel_for_(cv::Range(0, srcImgs[0].rows),
                 FastNlMeansMultiDenoisingInvoker<uchar>(
                     srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                    dst, templateWindowSize, searchWindowSize, h));
+                    dst, templateWindowSize, searchWindowSize, h),
+                granularity);
             break;
         case CV_8UC2:
-            parallel_for(cv::BlockedRange(0, srcImgs[0].rows),
+            parallel_for_(cv::Range(0, srcImgs[0].rows),
                 FastNlMeansMultiDenoisingInvoker<cv::Vec2b>(
                     srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                    dst, templateWindowSize, searchWindowSize, h));
+                    dst, templateWindowSize, searchWindowSize, h),
+                granularity);
             break;
         case CV_8UC3:
-            parallel_for(cv::BlockedRange(0, srcImgs[0].rows),
+            parallel_for_(cv::Range(0, srcImgs[0].rows),
                 FastNlMeansMultiDenoisingInvoker<cv::Vec3b>(
                     srcImgs, imgToDenoiseIndex, temporalWindowSize,
-                    dst, templateWindowSize, searchWindowSize, h));
+                    dst, templateWindowSize, searchWindowSize, h),
+                granularity);
             break;
         default:
             CV_Error(CV_StsBadArg,
@@ -91,6 +91,26 @@ inline int clipInt( int val, int min_val, int max_val )
     return val;
 }
 
+// restores the number of threads and the use of the optimized code when going out of scope,
+// so that a test changing them does not affect the next ones, even if it fails on an assertion
+class ParallelSettingsGuard
+{
+public:
+    ParallelSettingsGuard() : nthreads(cv::getNumThreads()), useOptimized(cv::useOptimized()) {}
+    ~ParallelSettingsGuard()
+    {
+        cv::setNumThreads(nthreads);
+        cv::setUseOptimized(useOptimized);
+    }
+
+private:
+    int nthreads;
+    bool useOptimized;
+
+    ParallelSettingsGuard(const ParallelSettingsGuard&);
+    ParallelSettingsGuard& operator=(const ParallelSettingsGuard&);
+};
+
 CV_EXPORTS double getMinVal(int depth);
 CV_EXPORTS double getMaxVal(int depth);
 